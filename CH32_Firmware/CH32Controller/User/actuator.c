@@ -0,0 +1,111 @@
+/*********************************************************************
+ * @file      actuator.c
+ * @author    Gemini
+ * @brief     蜂鸣器和舵机的非阻塞状态机的实现文件.
+ * @version   1.0
+ * @date      2026-10-16
+ *
+ * @copyright Copyright (c) 2025
+ *
+ *********************************************************************/
+#include "actuator.h"
+
+/**
+ * @brief  判断时刻 t 是否已到达, 毫秒计数回绕时依然正确.
+ */
+static uint8_t Time_Reached(uint32_t now, uint32_t t)
+{
+    return (int32_t)(now - t) >= 0;
+}
+
+/**
+ * @brief  根据报警和鸣叫状态刷新输出, 仅在电平变化时写硬件.
+ */
+static void Buzzer_Refresh(Buzzer_SM_t *sm)
+{
+    uint8_t on = sm->Alarm || (sm->Beeps_Left && sm->Beep_On);
+
+    if(sm->Output != on)
+    {
+        sm->Output = on;
+        sm->Set(on);
+    }
+}
+
+void Buzzer_SM_Init(Buzzer_SM_t *sm, void (*set)(uint8_t on))
+{
+    sm->Set = set;
+    sm->Alarm = 0;
+    sm->Output = 0;
+    sm->Beeps_Left = 0;
+    sm->Beep_On = 0;
+    sm->On_Ms = 0;
+    sm->Off_Ms = 0;
+    sm->Next_Ms = 0;
+    set(0);
+}
+
+void Buzzer_SM_Beep(Buzzer_SM_t *sm, uint32_t now, uint8_t count, uint16_t on_ms, uint16_t off_ms)
+{
+    sm->Beeps_Left = count;
+    sm->Beep_On = 1;
+    sm->On_Ms = on_ms;
+    sm->Off_Ms = off_ms;
+    sm->Next_Ms = now + on_ms;
+    Buzzer_Refresh(sm);
+}
+
+void Buzzer_SM_Set_Alarm(Buzzer_SM_t *sm, uint8_t on)
+{
+    sm->Alarm = on ? 1 : 0;
+    Buzzer_Refresh(sm);
+}
+
+void Buzzer_SM_Update(Buzzer_SM_t *sm, uint32_t now)
+{
+    if(sm->Beeps_Left && Time_Reached(now, sm->Next_Ms))
+    {
+        if(sm->Beep_On)
+        {
+            // 一次鸣叫结束, 进入间隔
+            sm->Beep_On = 0;
+            sm->Beeps_Left--;
+            sm->Next_Ms = now + sm->Off_Ms;
+        }
+        else
+        {
+            sm->Beep_On = 1;
+            sm->Next_Ms = now + sm->On_Ms;
+        }
+    }
+    Buzzer_Refresh(sm);
+}
+
+void Servo_SM_Init(Servo_SM_t *sm, void (*set_angle)(uint8_t angle), uint8_t locked_angle, uint8_t unlocked_angle)
+{
+    sm->Set_Angle = set_angle;
+    sm->Locked_Angle = locked_angle;
+    sm->Unlocked_Angle = unlocked_angle;
+    sm->Unlocked = 0;
+    sm->Relock_Ms = 0;
+    set_angle(locked_angle);
+}
+
+void Servo_SM_Unlock(Servo_SM_t *sm, uint32_t now, uint32_t hold_ms)
+{
+    sm->Relock_Ms = now + hold_ms;
+    if(!sm->Unlocked)
+    {
+        sm->Unlocked = 1;
+        sm->Set_Angle(sm->Unlocked_Angle);
+    }
+}
+
+void Servo_SM_Update(Servo_SM_t *sm, uint32_t now)
+{
+    if(sm->Unlocked && Time_Reached(now, sm->Relock_Ms))
+    {
+        sm->Unlocked = 0;
+        sm->Set_Angle(sm->Locked_Angle);
+    }
+}
@@ -0,0 +1,97 @@
+/*********************************************************************
+ * @file      actuator.h
+ * @author    Gemini
+ * @brief     蜂鸣器和舵机的非阻塞状态机的头文件.
+ * @version   1.0
+ * @date      2026-10-16
+ *
+ * @copyright Copyright (c) 2025
+ *
+ * @note      状态机只记录目标时刻, 由主循环周期性调用 *_Update(now) 推进,
+ *            不使用任何延时. 硬件输出通过回调函数完成, 本模块仅依赖标准C
+ *            头文件, 可在PC上用模拟时钟测试.
+ *
+ *********************************************************************/
+#ifndef __ACTUATOR_H
+#define __ACTUATOR_H
+
+#include <stdint.h>
+
+/**
+ * @brief  蜂鸣器状态机. 持续报警优先于定时鸣叫.
+ */
+typedef struct
+{
+    void (*Set)(uint8_t on);    // 硬件输出回调
+    uint8_t Alarm;              // 持续报警 (如Zigbee报警)
+    uint8_t Output;             // 当前输出电平
+    uint8_t Beeps_Left;         // 剩余鸣叫次数
+    uint8_t Beep_On;            // 定时鸣叫处于鸣叫阶段
+    uint16_t On_Ms;             // 每次鸣叫时长
+    uint16_t Off_Ms;            // 两次鸣叫的间隔
+    uint32_t Next_Ms;           // 下一次翻转输出的时刻
+} Buzzer_SM_t;
+
+/**
+ * @brief  舵机门锁状态机. 开锁后在保持时间到达时自动关锁.
+ */
+typedef struct
+{
+    void (*Set_Angle)(uint8_t angle);   // 硬件输出回调
+    uint8_t Locked_Angle;
+    uint8_t Unlocked_Angle;
+    uint8_t Unlocked;
+    uint32_t Relock_Ms;                 // 自动关锁的时刻
+} Servo_SM_t;
+
+/**
+ * @brief  初始化蜂鸣器状态机并关闭输出.
+ * @return none.
+ */
+void Buzzer_SM_Init(Buzzer_SM_t *sm, void (*set)(uint8_t on));
+
+/**
+ * @brief  开始定时鸣叫, 覆盖尚未完成的鸣叫.
+ * @param  now - 当前时间 (ms).
+ * @param  count - 鸣叫次数.
+ * @param  on_ms - 每次鸣叫时长 (ms).
+ * @param  off_ms - 两次鸣叫的间隔 (ms).
+ * @return none.
+ */
+void Buzzer_SM_Beep(Buzzer_SM_t *sm, uint32_t now, uint8_t count, uint16_t on_ms, uint16_t off_ms);
+
+/**
+ * @brief  开启或关闭持续报警.
+ * @return none.
+ */
+void Buzzer_SM_Set_Alarm(Buzzer_SM_t *sm, uint8_t on);
+
+/**
+ * @brief  推进蜂鸣器状态机.
+ * @param  now - 当前时间 (ms).
+ * @return none.
+ */
+void Buzzer_SM_Update(Buzzer_SM_t *sm, uint32_t now);
+
+/**
+ * @brief  初始化舵机状态机并转到关锁位置.
+ * @return none.
+ */
+void Servo_SM_Init(Servo_SM_t *sm, void (*set_angle)(uint8_t angle), uint8_t locked_angle, uint8_t unlocked_angle);
+
+/**
+ * @brief  开锁并在 hold_ms 后自动关锁. 已开锁时只延长保持时间.
+ * @param  now - 当前时间 (ms).
+ * @param  hold_ms - 保持开锁的时间 (ms).
+ * @return none.
+ */
+void Servo_SM_Unlock(Servo_SM_t *sm, uint32_t now, uint32_t hold_ms);
+
+/**
+ * @brief  推进舵机状态机.
+ * @param  now - 当前时间 (ms).
+ * @return none.
+ */
+void Servo_SM_Update(Servo_SM_t *sm, uint32_t now);
+
+#endif
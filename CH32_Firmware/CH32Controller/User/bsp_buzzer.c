@@ -2,18 +2,38 @@
  * @file      bsp_buzzer.c
  * @author    Gemini
  * @brief     有源蜂鸣器驱动模块的实现文件.
- * @version   1.0
- * @date      2025-06-07
+ * @version   2.0
+ * @date      2026-10-16
  *
  * @copyright Copyright (c) 2025
  *
  *********************************************************************/
 #include "bsp_buzzer.h"
+#include "actuator.h"
+#include "debug.h"
 
 // 蜂鸣器引脚定义 (根据PIN.txt)
 #define BUZZER_PORT   GPIOA
 #define BUZZER_PIN    GPIO_Pin_5
 
+static Buzzer_SM_t Buzzer_SM;
+
+/**
+ * @brief  状态机的硬件输出回调.
+ * @return none.
+ */
+static void Buzzer_Write(u8 on)
+{
+    if(on)
+    {
+        Buzzer_On();
+    }
+    else
+    {
+        Buzzer_Off();
+    }
+}
+
 /**
  * @brief  初始化蜂鸣器所连接的GPIO引脚.
  * @return none.
@@ -32,7 +52,7 @@ void Buzzer_Init(void)
     GPIO_Init(BUZZER_PORT, &GPIO_InitStructure);
 
     // 初始化后默认关闭蜂鸣器
-    Buzzer_Off();
+    Buzzer_SM_Init(&Buzzer_SM, Buzzer_Write);
 }
 
 /**
@@ -52,4 +72,31 @@ void Buzzer_On(void)
 void Buzzer_Off(void)
 {
     GPIO_ResetBits(BUZZER_PORT, BUZZER_PIN);
-} 
\ No newline at end of file
+} 
+
+/**
+ * @brief  非阻塞定时鸣叫.
+ * @return none.
+ */
+void Buzzer_Beep(u8 count, u16 on_ms, u16 off_ms)
+{
+    Buzzer_SM_Beep(&Buzzer_SM, SysTick_Get_Ms(), count, on_ms, off_ms);
+}
+
+/**
+ * @brief  开启或关闭持续报警.
+ * @return none.
+ */
+void Buzzer_Set_Alarm(u8 on)
+{
+    Buzzer_SM_Set_Alarm(&Buzzer_SM, on);
+}
+
+/**
+ * @brief  蜂鸣器状态机任务.
+ * @return none.
+ */
+void Buzzer_Task(void)
+{
+    Buzzer_SM_Update(&Buzzer_SM, SysTick_Get_Ms());
+}
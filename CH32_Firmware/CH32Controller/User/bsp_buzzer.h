@@ -2,8 +2,8 @@
  * @file      bsp_buzzer.h
  * @author    Gemini
  * @brief     有源蜂鸣器驱动模块的头文件.
- * @version   1.0
- * @date      2025-06-07
+ * @version   2.0
+ * @date      2026-10-16
  *
  * @copyright Copyright (c) 2025
  *
@@ -31,5 +31,27 @@ void Buzzer_On(void);
  */
 void Buzzer_Off(void);
 
+/**
+ * @brief  非阻塞定时鸣叫, 由 Buzzer_Task() 推进.
+ * @param  count - 鸣叫次数.
+ * @param  on_ms - 每次鸣叫时长 (ms).
+ * @param  off_ms - 两次鸣叫的间隔 (ms).
+ * @return none.
+ */
+void Buzzer_Beep(u8 count, u16 on_ms, u16 off_ms);
+
+/**
+ * @brief  开启或关闭持续报警, 报警期间蜂鸣器常响.
+ * @param  on - 1: 开启, 0: 关闭.
+ * @return none.
+ */
+void Buzzer_Set_Alarm(u8 on);
+
+/**
+ * @brief  蜂鸣器状态机任务, 需在主循环中周期调用.
+ * @return none.
+ */
+void Buzzer_Task(void);
+
 
 #endif 
\ No newline at end of file
@@ -0,0 +1,56 @@
+/*********************************************************************
+ * @file      bsp_flash.c
+ * @author    Gemini
+ * @brief     片内Flash数据页驱动模块的实现文件.
+ * @version   1.0
+ * @date      2026-10-16
+ *
+ * @copyright Copyright (c) 2025
+ *
+ *********************************************************************/
+#include "bsp_flash.h"
+
+/**
+ * @brief  读取一个字.
+ * @return u32 - 读取值.
+ */
+static uint32_t BSP_Flash_Read(uint32_t addr)
+{
+    return *(volatile u32 *)addr;
+}
+
+/**
+ * @brief  擦除一个4K页.
+ * @return u8 - 1: 成功, 0: 失败.
+ */
+static uint8_t BSP_Flash_Erase(uint32_t page_addr)
+{
+    FLASH_Status status;
+
+    FLASH_Unlock();
+    FLASH_ClearFlag(FLASH_FLAG_EOP | FLASH_FLAG_WRPRTERR);
+    status = FLASH_ErasePage(page_addr);
+    FLASH_Lock();
+    return status == FLASH_COMPLETE;
+}
+
+/**
+ * @brief  编程一个字.
+ * @return u8 - 1: 成功, 0: 失败.
+ */
+static uint8_t BSP_Flash_Program(uint32_t addr, uint32_t word)
+{
+    FLASH_Status status;
+
+    FLASH_Unlock();
+    FLASH_ClearFlag(FLASH_FLAG_EOP | FLASH_FLAG_WRPRTERR);
+    status = FLASH_ProgramWord(addr, word);
+    FLASH_Lock();
+    return status == FLASH_COMPLETE;
+}
+
+const Flash_Log_Ops_t BSP_Flash_Ops = {
+    BSP_Flash_Read,
+    BSP_Flash_Erase,
+    BSP_Flash_Program
+};
@@ -0,0 +1,30 @@
+/*********************************************************************
+ * @file      bsp_flash.h
+ * @author    Gemini
+ * @brief     片内Flash数据页驱动模块的头文件.
+ * @version   1.0
+ * @date      2026-10-16
+ *
+ * @copyright Copyright (c) 2025
+ *
+ * @note      用户代码区的最后8K (两个4K擦除页) 保留为数据页, Ld/Link.ld
+ *            中的 FLASH 长度相应减为 280K. 擦除一页约需数十毫秒, 期间
+ *            CPU停止取指, 调用方需容忍这段阻塞.
+ *
+ *********************************************************************/
+#ifndef __BSP_FLASH_H
+#define __BSP_FLASH_H
+
+#include "ch32v30x.h"
+#include "flash_log.h"
+
+#define BSP_FLASH_PAGE_SIZE     4096
+#define BSP_FLASH_DATA_PAGE0    0x08046000u     // 必须位于 Link.ld 的 FLASH 区域之外
+#define BSP_FLASH_DATA_PAGE1    0x08047000u
+
+/**
+ * @brief  供 flash_log 使用的片内Flash操作.
+ */
+extern const Flash_Log_Ops_t BSP_Flash_Ops;
+
+#endif
@@ -2,8 +2,8 @@
  * @file      bsp_servo.c
  * @author    Gemini
  * @brief     舵机(SG90)驱动模块的实现文件.
- * @version   1.0
- * @date      2025-06-07
+ * @version   2.0
+ * @date      2026-10-16
  *
  * @copyright Copyright (c) 2025
  *
@@ -12,13 +12,17 @@
  *
  *********************************************************************/
 #include "bsp_servo.h"
+#include "actuator.h"
+#include "debug.h"
 
 // 舵机引脚定义 (根据PIN.txt)
 #define SERVO_PORT   GPIOC
 #define SERVO_PIN    GPIO_Pin_5
 
+static Servo_SM_t Servo_SM;
+
 /**
- * @brief  初始化舵机所连接的GPIO和TIM3_CH2 PWM.
+ * @brief  初始化舵机所连接的GPIO和TIM3_CH2 PWM, 并转到关锁位置.
  * @return none.
  */
 void Servo_Init(void)
@@ -58,6 +62,9 @@ void Servo_Init(void)
 
     // 6. 使能TIM3
     TIM_Cmd(TIM3, ENABLE);
+
+    // 7. 初始化门锁状态机 (转到关锁位置)
+    Servo_SM_Init(&Servo_SM, Servo_SetAngle, SERVO_LOCKED_ANGLE, SERVO_UNLOCKED_ANGLE);
 }
 
 /**
@@ -71,4 +78,22 @@ void Servo_SetAngle(u8 angle)
     // 脉宽 = 500 + angle * (2000 / 180)
     float pulse = (500.0f + angle * (2000.0f / 180.0f));
     TIM_SetCompare2(TIM3, (u16)pulse);
-} 
\ No newline at end of file
+} 
+
+/**
+ * @brief  非阻塞开锁.
+ * @return none.
+ */
+void Servo_Unlock(u32 hold_ms)
+{
+    Servo_SM_Unlock(&Servo_SM, SysTick_Get_Ms(), hold_ms);
+}
+
+/**
+ * @brief  门锁状态机任务.
+ * @return none.
+ */
+void Servo_Task(void)
+{
+    Servo_SM_Update(&Servo_SM, SysTick_Get_Ms());
+}
@@ -2,8 +2,8 @@
  * @file      bsp_servo.h
  * @author    Gemini
  * @brief     舵机(SG90)驱动模块的头文件.
- * @version   1.0
- * @date      2025-06-07
+ * @version   2.0
+ * @date      2026-10-16
  *
  * @copyright Copyright (c) 2025
  *
@@ -13,8 +13,12 @@
 
 #include "ch32v30x.h"
 
+#define SERVO_LOCKED_ANGLE      0       // 关锁角度
+#define SERVO_UNLOCKED_ANGLE    90      // 开锁角度
+#define SERVO_UNLOCK_HOLD_MS    5000    // 开锁后自动关锁的时间
+
 /**
- * @brief  初始化舵机所连接的GPIO和TIM3_CH2 PWM.
+ * @brief  初始化舵机所连接的GPIO和TIM3_CH2 PWM, 并转到关锁位置.
  * @return none.
  */
 void Servo_Init(void);
@@ -26,5 +30,18 @@ void Servo_Init(void);
  */
 void Servo_SetAngle(u8 angle);
 
+/**
+ * @brief  非阻塞开锁, hold_ms 后由 Servo_Task() 自动关锁.
+ * @param  hold_ms - 保持开锁的时间 (ms), 重复开锁会延长保持时间.
+ * @return none.
+ */
+void Servo_Unlock(u32 hold_ms);
+
+/**
+ * @brief  门锁状态机任务, 需在主循环中周期调用.
+ * @return none.
+ */
+void Servo_Task(void);
+
 
 #endif 
\ No newline at end of file
@@ -0,0 +1,94 @@
+/*********************************************************************
+ * @file      bsp_timebase.c
+ * @author    Gemini
+ * @brief     微秒级时基 (TIM4) 模块的实现文件.
+ * @version   1.0
+ * @date      2026-10-16
+ *
+ * @copyright Copyright (c) 2025
+ *
+ * @note      TIM4 以1MHz计数, 16位计数器每65.536ms溢出一次, 溢出中断
+ *            维护高16位. SysTick只有毫秒精度, 不足以测量任务执行时间.
+ *
+ *********************************************************************/
+#include "bsp_timebase.h"
+
+static volatile u16 Timebase_High = 0;
+
+/**
+ * @brief  初始化TIM4为1MHz自由运行计数器.
+ * @return none.
+ */
+void Timebase_Init(void)
+{
+    TIM_TimeBaseInitTypeDef TIM_TimeBaseStructure = {0};
+    NVIC_InitTypeDef NVIC_InitStructure = {0};
+    RCC_ClocksTypeDef RCC_Clocks;
+    u32 tim_clk;
+
+    // 1. 计算TIM4输入时钟: APB1分频不为1时, 定时器时钟为PCLK1的2倍
+    RCC_GetClocksFreq(&RCC_Clocks);
+    tim_clk = RCC_Clocks.PCLK1_Frequency;
+    if((RCC->CFGR0 & RCC_PPRE1) != RCC_PPRE1_DIV1)
+    {
+        tim_clk *= 2;
+    }
+
+    // 2. 配置TIM4: 1MHz计数, 周期65536
+    RCC_APB1PeriphClockCmd(RCC_APB1Periph_TIM4, ENABLE);
+    TIM_TimeBaseStructure.TIM_Period = 0xFFFF;
+    TIM_TimeBaseStructure.TIM_Prescaler = tim_clk / 1000000 - 1;
+    TIM_TimeBaseStructure.TIM_ClockDivision = TIM_CKD_DIV1;
+    TIM_TimeBaseStructure.TIM_CounterMode = TIM_CounterMode_Up;
+    TIM_TimeBaseInit(TIM4, &TIM_TimeBaseStructure);
+    TIM_ClearITPendingBit(TIM4, TIM_IT_Update);
+    TIM_ITConfig(TIM4, TIM_IT_Update, ENABLE);
+
+    // 3. 配置溢出中断
+    NVIC_InitStructure.NVIC_IRQChannel = TIM4_IRQn;
+    NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = 0;
+    NVIC_InitStructure.NVIC_IRQChannelSubPriority = 1;
+    NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
+    NVIC_Init(&NVIC_InitStructure);
+
+    // 4. 使能TIM4
+    TIM_Cmd(TIM4, ENABLE);
+}
+
+/**
+ * @brief  获取上电以来的微秒数.
+ * @return u32 - 微秒计数.
+ */
+u32 Timebase_Get_Us(void)
+{
+    u16 high, low;
+    u8 pending;
+
+    // 读取期间被溢出中断打断时重新读取
+    do
+    {
+        high = Timebase_High;
+        low = TIM_GetCounter(TIM4);
+        pending = TIM_GetITStatus(TIM4, TIM_IT_Update) != RESET;
+    } while(high != Timebase_High);
+
+    // 已溢出但中断尚未执行 (如在更高优先级中断中调用)
+    if(pending && low < 0x8000)
+    {
+        high++;
+    }
+    return ((u32)high << 16) | low;
+}
+
+/**
+ * @brief  TIM4中断服务函数的回调.
+ * @return none.
+ */
+void TIM4_IRQHandler_Callback(void)
+{
+    if(TIM_GetITStatus(TIM4, TIM_IT_Update) != RESET)
+    {
+        Timebase_High++;
+        TIM_ClearITPendingBit(TIM4, TIM_IT_Update);
+    }
+}
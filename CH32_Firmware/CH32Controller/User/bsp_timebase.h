@@ -0,0 +1,35 @@
+/*********************************************************************
+ * @file      bsp_timebase.h
+ * @author    Gemini
+ * @brief     微秒级时基 (TIM4) 模块的头文件.
+ * @version   1.0
+ * @date      2026-10-16
+ *
+ * @copyright Copyright (c) 2025
+ *
+ *********************************************************************/
+#ifndef __BSP_TIMEBASE_H
+#define __BSP_TIMEBASE_H
+
+#include "ch32v30x.h"
+
+/**
+ * @brief  初始化TIM4为1MHz自由运行计数器.
+ * @return none.
+ */
+void Timebase_Init(void);
+
+/**
+ * @brief  获取上电以来的微秒数 (约71分钟回绕一次).
+ * @return u32 - 微秒计数.
+ */
+u32 Timebase_Get_Us(void);
+
+/**
+ * @brief  TIM4中断服务函数的回调.
+ * @note   此函数应在 ch32v30x_it.c 的 TIM4_IRQHandler 中被调用.
+ * @return none.
+ */
+void TIM4_IRQHandler_Callback(void);
+
+#endif
@@ -0,0 +1,97 @@
+/*********************************************************************
+ * @file      bsp_uart_dma.c
+ * @author    Gemini
+ * @brief     串口DMA循环接收模块的实现文件.
+ * @version   1.0
+ * @date      2026-10-16
+ *
+ * @copyright Copyright (c) 2025
+ *
+ *********************************************************************/
+#include "bsp_uart_dma.h"
+
+/**
+ * @brief  根据DMA剩余传输计数推进环形队列的 Head.
+ * @note   此为模块内部函数.
+ * @return none.
+ */
+static void Uart_Dma_Rx_Sync(Uart_Dma_Rx_t *rx)
+{
+    Rx_Ring_Update(&rx->Ring, rx->Ring.Size - DMA_GetCurrDataCounter(rx->DMA_Channel));
+}
+
+/**
+ * @brief  启动DMA循环接收.
+ * @return none.
+ */
+void Uart_Dma_Rx_Init(Uart_Dma_Rx_t *rx, USART_TypeDef *usart, DMA_Channel_TypeDef *dma_channel,
+                      u32 dma_it_gl, volatile u8 *buf, u32 size)
+{
+    DMA_InitTypeDef DMA_InitStructure = {0};
+
+    rx->USARTx = usart;
+    rx->DMA_Channel = dma_channel;
+    rx->DMA_IT_GL = dma_it_gl;
+    Rx_Ring_Init(&rx->Ring, buf, size);
+
+    // 1. 配置DMA: 外设->内存, 字节宽度, 循环模式
+    RCC_AHBPeriphClockCmd(RCC_AHBPeriph_DMA1, ENABLE);
+    DMA_DeInit(dma_channel);
+    DMA_InitStructure.DMA_PeripheralBaseAddr = (u32)&usart->DATAR;
+    DMA_InitStructure.DMA_MemoryBaseAddr = (u32)buf;
+    DMA_InitStructure.DMA_DIR = DMA_DIR_PeripheralSRC;
+    DMA_InitStructure.DMA_BufferSize = size;
+    DMA_InitStructure.DMA_PeripheralInc = DMA_PeripheralInc_Disable;
+    DMA_InitStructure.DMA_MemoryInc = DMA_MemoryInc_Enable;
+    DMA_InitStructure.DMA_PeripheralDataSize = DMA_PeripheralDataSize_Byte;
+    DMA_InitStructure.DMA_MemoryDataSize = DMA_MemoryDataSize_Byte;
+    DMA_InitStructure.DMA_Mode = DMA_Mode_Circular;
+    DMA_InitStructure.DMA_Priority = DMA_Priority_High;
+    DMA_InitStructure.DMA_M2M = DMA_M2M_Disable;
+    DMA_Init(dma_channel, &DMA_InitStructure);
+
+    // 2. 半传输/完成中断保证每半圈至少同步一次写位置
+    DMA_ClearITPendingBit(dma_it_gl);
+    DMA_ITConfig(dma_channel, DMA_IT_HT | DMA_IT_TC, ENABLE);
+    DMA_Cmd(dma_channel, ENABLE);
+
+    // 3. 串口以DMA接收, IDLE中断标志一串数据结束, 错误中断统计线路错误
+    USART_DMACmd(usart, USART_DMAReq_Rx, ENABLE);
+    USART_ITConfig(usart, USART_IT_IDLE, ENABLE);
+    USART_ITConfig(usart, USART_IT_ERR, ENABLE);
+}
+
+/**
+ * @brief  串口中断处理: 清除IDLE/错误标志并同步DMA写位置.
+ * @return none.
+ */
+void Uart_Dma_Rx_Usart_Isr(Uart_Dma_Rx_t *rx)
+{
+    USART_TypeDef *usart = rx->USARTx;
+    u8 idle = USART_GetITStatus(usart, USART_IT_IDLE) != RESET;
+    u8 error = USART_GetFlagStatus(usart, USART_FLAG_ORE | USART_FLAG_NE | USART_FLAG_FE) != RESET;
+
+    if(idle || error)
+    {
+        // 先读状态寄存器再读数据寄存器, 清除IDLE及错误标志
+        (void)USART_ReceiveData(usart);
+        if(error)
+        {
+            Rx_Ring_Error(&rx->Ring);
+        }
+        Uart_Dma_Rx_Sync(rx);
+    }
+}
+
+/**
+ * @brief  DMA中断处理: 清除半传输/完成标志并同步DMA写位置.
+ * @return none.
+ */
+void Uart_Dma_Rx_Dma_Isr(Uart_Dma_Rx_t *rx)
+{
+    if(DMA_GetITStatus(rx->DMA_IT_GL) != RESET)
+    {
+        DMA_ClearITPendingBit(rx->DMA_IT_GL);
+        Uart_Dma_Rx_Sync(rx);
+    }
+}
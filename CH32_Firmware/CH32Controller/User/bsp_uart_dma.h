@@ -0,0 +1,63 @@
+/*********************************************************************
+ * @file      bsp_uart_dma.h
+ * @author    Gemini
+ * @brief     串口DMA循环接收模块的头文件.
+ * @version   1.0
+ * @date      2026-10-16
+ *
+ * @copyright Copyright (c) 2025
+ *
+ * @note      串口接收由DMA以循环模式搬运到环形缓冲区, CPU只在总线空闲
+ *            (IDLE)、DMA半传输/传输完成和接收错误时进入中断, 而不是每个
+ *            字节一次. 使用方负责配置两个中断的NVIC, 且两者抢占优先级
+ *            必须相同, 以免在同一环形队列上互相打断.
+ *
+ *********************************************************************/
+#ifndef __BSP_UART_DMA_H
+#define __BSP_UART_DMA_H
+
+#include "ch32v30x.h"
+#include "rx_ring.h"
+
+/**
+ * @brief  一个串口的DMA接收通道.
+ */
+typedef struct
+{
+    USART_TypeDef *USARTx;
+    DMA_Channel_TypeDef *DMA_Channel;
+    u32 DMA_IT_GL;          // 该DMA通道的全局中断标志, 如 DMA1_IT_GL5
+    Rx_Ring_t Ring;
+} Uart_Dma_Rx_t;
+
+/**
+ * @brief  启动DMA循环接收, 并使能串口IDLE/错误中断和DMA半传输/完成中断.
+ * @note   调用前串口须已完成 USART_Init().
+ * @param  rx          - 接收通道控制块.
+ * @param  usart       - 串口, 如 USART1.
+ * @param  dma_channel - 该串口RX对应的DMA通道, 如 DMA1_Channel5.
+ * @param  dma_it_gl   - 该DMA通道的全局中断标志, 如 DMA1_IT_GL5.
+ * @param  buf         - DMA目标缓冲区.
+ * @param  size        - 缓冲区大小, 必须为2的幂且不超过65535.
+ * @return none.
+ */
+void Uart_Dma_Rx_Init(Uart_Dma_Rx_t *rx, USART_TypeDef *usart, DMA_Channel_TypeDef *dma_channel,
+                      u32 dma_it_gl, volatile u8 *buf, u32 size);
+
+/**
+ * @brief  串口中断处理: 清除IDLE/错误标志并同步DMA写位置.
+ * @note   此函数应在对应串口的中断回调中调用.
+ * @param  rx - 接收通道控制块.
+ * @return none.
+ */
+void Uart_Dma_Rx_Usart_Isr(Uart_Dma_Rx_t *rx);
+
+/**
+ * @brief  DMA中断处理: 清除半传输/完成标志并同步DMA写位置.
+ * @note   此函数应在对应DMA通道的中断回调中调用.
+ * @param  rx - 接收通道控制块.
+ * @return none.
+ */
+void Uart_Dma_Rx_Dma_Isr(Uart_Dma_Rx_t *rx);
+
+#endif
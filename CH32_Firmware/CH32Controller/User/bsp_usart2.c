@@ -2,22 +2,25 @@
  * @file      bsp_usart2.c
  * @author    Gemini
  * @brief     USART2 (Zigbee) 模块的实现文件.
- * @version   1.0
- * @date      2025-06-08
+ * @version   2.0
+ * @date      2026-10-16
  *
  * @copyright Copyright (c) 2025
  *
+ * @note      接收由 DMA1_Channel6 循环搬运, 报警突发期间主循环忙于网络
+ *            协议栈时字节保存在DMA缓冲区中, 不再依赖逐字节中断.
+ *
  *********************************************************************/
 #include "bsp_usart2.h"
+#include "bsp_uart_dma.h"
 
-// 环形缓冲区大小
-#define RX_BUF_SIZE 16
-static u8 RxBuffer[RX_BUF_SIZE];
-static u8 RxWrite = 0;
-static u8 RxRead = 0;
+// DMA接收缓冲区大小, 必须为2的幂
+#define RX_BUF_SIZE 64
+static volatile u8 RxBuffer[RX_BUF_SIZE];
+static Uart_Dma_Rx_t Zigbee_Rx;
 
 /**
- * @brief  初始化UART2及其中断.
+ * @brief  初始化UART2及其DMA接收.
  * @return none.
  */
 void USART2_Init(void)
@@ -49,16 +52,20 @@ void USART2_Init(void)
     USART_InitStructure.USART_Mode = USART_Mode_Rx | USART_Mode_Tx;
     USART_Init(USART2, &USART_InitStructure);
 
-    // 4. 配置并使能接收中断
-    USART_ITConfig(USART2, USART_IT_RXNE, ENABLE);
+    // 4. 配置DMA循环接收 (USART2_RX -> DMA1_Channel6)
+    Uart_Dma_Rx_Init(&Zigbee_Rx, USART2, DMA1_Channel6, DMA1_IT_GL6, RxBuffer, RX_BUF_SIZE);
 
+    // 5. 串口与DMA中断使用相同的抢占优先级
     NVIC_InitStructure.NVIC_IRQChannel = USART2_IRQn;
     NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = 2;
     NVIC_InitStructure.NVIC_IRQChannelSubPriority = 2;
     NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
     NVIC_Init(&NVIC_InitStructure);
 
-    // 5. 使能USART2
+    NVIC_InitStructure.NVIC_IRQChannel = DMA1_Channel6_IRQn;
+    NVIC_Init(&NVIC_InitStructure);
+
+    // 6. 使能USART2
     USART_Cmd(USART2, ENABLE);
 }
 
@@ -68,15 +75,17 @@ void USART2_Init(void)
  */
 u8 USART2_GetData(u8 *data)
 {
-    if (RxRead != RxWrite)
-    {
-        *data = RxBuffer[RxRead];
-        RxRead = (RxRead + 1) % RX_BUF_SIZE;
-        return 1;
-    }
-    return 0;
+    return Rx_Ring_Read(&Zigbee_Rx.Ring, data, 1) ? 1 : 0;
 }
 
+/**
+ * @brief  获取USART2接收统计.
+ * @return none.
+ */
+void USART2_Get_Rx_Stats(Rx_Ring_Stats_t *stats)
+{
+    Rx_Ring_Get_Stats(&Zigbee_Rx.Ring, stats);
+}
 
 /**
  * @brief  USART2中断服务函数的回调.
@@ -85,16 +94,15 @@ u8 USART2_GetData(u8 *data)
  */
 void USART2_IRQHandler_Callback(void)
 {
-    if(USART_GetITStatus(USART2, USART_IT_RXNE) != RESET)
-    {
-        u8 res = USART_ReceiveData(USART2);
-        
-        // 存入环形缓冲区
-        if ((RxWrite + 1) % RX_BUF_SIZE != RxRead)
-        {
-            RxBuffer[RxWrite] = res;
-            RxWrite = (RxWrite + 1) % RX_BUF_SIZE;
-        }
-        // 如果缓冲区满了，则放弃该数据 (或在此添加错误处理)
-    }
-} 
\ No newline at end of file
+    Uart_Dma_Rx_Usart_Isr(&Zigbee_Rx);
+}
+
+/**
+ * @brief  DMA1通道6中断服务函数的回调.
+ * @note   此函数需要在 ch32v30x_it.c 的 DMA1_Channel6_IRQHandler 中被调用.
+ * @return none.
+ */
+void DMA1_Channel6_IRQHandler_Callback(void)
+{
+    Uart_Dma_Rx_Dma_Isr(&Zigbee_Rx);
+}
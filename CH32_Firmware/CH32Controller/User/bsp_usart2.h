@@ -2,8 +2,8 @@
  * @file      bsp_usart2.h
  * @author    Gemini
  * @brief     USART2 (Zigbee) 模块的头文件.
- * @version   1.0
- * @date      2025-06-08
+ * @version   2.0
+ * @date      2026-10-16
  *
  * @copyright Copyright (c) 2025
  *
@@ -12,6 +12,7 @@
 #define __BSP_USART2_H
 
 #include "ch32v30x.h"
+#include "rx_ring.h"
 
 #define ZIGBEE_BAUDRATE     115200  // 请确保此波特率与CC2530协调器模块一致
 
@@ -20,7 +21,7 @@
 #define SMOKE_ALARM_CMD     0xB1    // 烟雾传感器报警
 
 /**
- * @brief  初始化UART2及其中断，用于Zigbee通信.
+ * @brief  初始化UART2及其DMA接收，用于Zigbee通信.
  * @return none.
  */
 void USART2_Init(void);
@@ -32,6 +33,13 @@ void USART2_Init(void);
  */
 u8 USART2_GetData(u8 *data);
 
+/**
+ * @brief  获取USART2接收统计 (溢出、丢弃字节及线路错误).
+ * @param  stats - 用于存储统计信息的指针.
+ * @return none.
+ */
+void USART2_Get_Rx_Stats(Rx_Ring_Stats_t *stats);
+
 /**
  * @brief  USART2中断服务函数的回调.
  * @note   此函数应在 ch32v30x_it.c 的 USART2_IRQHandler 中被调用.
@@ -39,5 +47,12 @@ u8 USART2_GetData(u8 *data);
  */
 void USART2_IRQHandler_Callback(void);
 
+/**
+ * @brief  DMA1通道6中断服务函数的回调.
+ * @note   此函数应在 ch32v30x_it.c 的 DMA1_Channel6_IRQHandler 中被调用.
+ * @return none.
+ */
+void DMA1_Channel6_IRQHandler_Callback(void);
+
 
 #endif // __BSP_USART2_H 
\ No newline at end of file
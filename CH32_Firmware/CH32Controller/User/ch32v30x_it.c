@@ -20,15 +20,23 @@
 extern void USART1_IRQHandler_Callback(void);
 extern void USART2_IRQHandler_Callback(void);
 extern void SysTick_Handler_Callback(void);
+extern void TIM4_IRQHandler_Callback(void);
+extern void EXTI1_IRQHandler_Callback(void);
+extern void DMA1_Channel5_IRQHandler_Callback(void);
+extern void DMA1_Channel6_IRQHandler_Callback(void);
 
 void NMI_Handler(void) __attribute__((interrupt("WCH-Interrupt-fast")));
 void HardFault_Handler(void) __attribute__((interrupt("WCH-Interrupt-fast")));
 
 void SysTick_Handler(void) __attribute__((interrupt("WCH-Interrupt-fast")));
 void EXTI0_IRQHandler(void) __attribute__((interrupt("WCH-Interrupt-fast")));
+void EXTI1_IRQHandler(void) __attribute__((interrupt("WCH-Interrupt-fast")));
 void TIM2_IRQHandler(void) __attribute__((interrupt("WCH-Interrupt-fast")));
+void TIM4_IRQHandler(void) __attribute__((interrupt("WCH-Interrupt-fast")));
 void USART1_IRQHandler(void) __attribute__((interrupt("WCH-Interrupt-fast")));
 void USART2_IRQHandler(void) __attribute__((interrupt("WCH-Interrupt-fast")));
+void DMA1_Channel5_IRQHandler(void) __attribute__((interrupt("WCH-Interrupt-fast")));
+void DMA1_Channel6_IRQHandler(void) __attribute__((interrupt("WCH-Interrupt-fast")));
 
 /*********************************************************************
  * @fn      NMI_Handler
@@ -100,6 +108,20 @@ void EXTI0_IRQHandler(void)
     }
 }
 
+/*********************************************************************
+ * @fn      EXTI1_IRQHandler
+ *
+ * @brief   外部中断1服务程序.
+ * @note    连接到 DHT11 数据线 (PC1)，下降沿触发，仅在采样期间使能.
+ *          具体的时间戳记录在 `dht11.c` 的回调函数中完成.
+ *
+ * @return  none
+ */
+void EXTI1_IRQHandler(void)
+{
+    EXTI1_IRQHandler_Callback();
+}
+
 /*********************************************************************
  * @fn      TIM2_IRQHandler
  *
@@ -114,11 +136,25 @@ void TIM2_IRQHandler(void)
     TIM_ClearITPendingBit( TIM2, TIM_IT_Update );
 }
 
+/*********************************************************************
+ * @fn      TIM4_IRQHandler
+ *
+ * @brief   定时器4中断服务程序.
+ * @note    TIM4每65.536ms溢出一次，为调度器的微秒时基累加高16位.
+ *          具体处理在 `bsp_timebase.c` 的回调函数中完成.
+ *
+ * @return  none
+ */
+void TIM4_IRQHandler(void)
+{
+    TIM4_IRQHandler_Callback();
+}
+
 /*********************************************************************
  * @fn      USART1_IRQHandler
  *
  * @brief   串口1中断服务程序.
- * @note    当通过串口1接收到数据时触发.
+ * @note    串口1总线空闲、接收错误或发送缓冲区空时触发.
  *          具体的数据处理和命令解析在 `uart_handler.c` 的回调函数中完成.
  *
  * @return  none
@@ -132,7 +168,7 @@ void USART1_IRQHandler(void)
  * @fn      USART2_IRQHandler
  *
  * @brief   串口2中断服务程序.
- * @note    当通过串口2接收到Zigbee数据时触发.
+ * @note    串口2总线空闲或接收错误时触发, Zigbee数据由DMA接收.
  *          具体的数据处理在 `bsp_usart2.c` 的回调函数中完成.
  *
  * @return  none
@@ -142,4 +178,30 @@ void USART2_IRQHandler(void)
     USART2_IRQHandler_Callback();
 }
 
+/*********************************************************************
+ * @fn      DMA1_Channel5_IRQHandler
+ *
+ * @brief   DMA1通道5中断服务程序.
+ * @note    USART1接收DMA的半传输/传输完成中断.
+ *          具体的数据处理在 `uart_handler.c` 的回调函数中完成.
+ *
+ * @return  none
+ */
+void DMA1_Channel5_IRQHandler(void)
+{
+    DMA1_Channel5_IRQHandler_Callback();
+}
 
+/*********************************************************************
+ * @fn      DMA1_Channel6_IRQHandler
+ *
+ * @brief   DMA1通道6中断服务程序.
+ * @note    USART2接收DMA的半传输/传输完成中断.
+ *          具体的数据处理在 `bsp_usart2.c` 的回调函数中完成.
+ *
+ * @return  none
+ */
+void DMA1_Channel6_IRQHandler(void)
+{
+    DMA1_Channel6_IRQHandler_Callback();
+}
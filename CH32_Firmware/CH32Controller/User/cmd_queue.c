@@ -0,0 +1,81 @@
+/*********************************************************************
+ * @file      cmd_queue.c
+ * @author    Gemini
+ * @brief     单生产者/单消费者无锁命令队列的实现文件.
+ * @version   1.0
+ * @date      2026-10-16
+ *
+ * @copyright Copyright (c) 2025
+ *
+ *********************************************************************/
+#include "cmd_queue.h"
+#include <string.h>
+
+// 单核MCU上只需阻止编译器重排: 先写数据再发布索引
+#define CMD_QUEUE_BARRIER()  __asm__ volatile("" ::: "memory")
+
+/**
+ * @brief  初始化队列.
+ * @return none.
+ */
+void Cmd_Queue_Init(Cmd_Queue_t *q)
+{
+    q->Head = 0;
+    q->Tail = 0;
+    q->Dropped = 0;
+}
+
+/**
+ * @brief  队列剩余空间.
+ * @return 可再写入的命令条数.
+ */
+uint32_t Cmd_Queue_Free(const Cmd_Queue_t *q)
+{
+    return CMD_QUEUE_SIZE - (q->Head - q->Tail);
+}
+
+/**
+ * @brief  写入一条命令.
+ * @return 1: 成功, 0: 队列已满或负载过长.
+ */
+uint8_t Cmd_Queue_Push(Cmd_Queue_t *q, uint8_t op, const uint8_t *data, uint8_t len)
+{
+    uint32_t head = q->Head;
+    Cmd_t *slot;
+
+    if(len > CMD_QUEUE_DATA_MAX || head - q->Tail >= CMD_QUEUE_SIZE)
+    {
+        q->Dropped++;
+        return 0;
+    }
+
+    slot = &q->Buf[head & (CMD_QUEUE_SIZE - 1)];
+    slot->Op = op;
+    slot->Len = len;
+    if(len)
+    {
+        memcpy(slot->Data, data, len);
+    }
+    CMD_QUEUE_BARRIER();
+    q->Head = head + 1;
+    return 1;
+}
+
+/**
+ * @brief  取出一条命令.
+ * @return 1: 成功, 0: 队列为空.
+ */
+uint8_t Cmd_Queue_Pop(Cmd_Queue_t *q, Cmd_t *cmd)
+{
+    uint32_t tail = q->Tail;
+
+    if(tail == q->Head)
+    {
+        return 0;
+    }
+    CMD_QUEUE_BARRIER();
+    *cmd = q->Buf[tail & (CMD_QUEUE_SIZE - 1)];
+    CMD_QUEUE_BARRIER();
+    q->Tail = tail + 1;
+    return 1;
+}
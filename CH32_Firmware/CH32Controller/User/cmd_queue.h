@@ -0,0 +1,79 @@
+/*********************************************************************
+ * @file      cmd_queue.h
+ * @author    Gemini
+ * @brief     单生产者/单消费者无锁命令队列的头文件.
+ * @version   1.0
+ * @date      2026-10-16
+ *
+ * @copyright Copyright (c) 2025
+ *
+ * @note      生产者为USART1接收中断, 消费者为主循环. 两端各自只修改自己的
+ *            索引, 因此无需关中断. 本模块仅依赖标准C头文件, 可在PC上编译测试.
+ *
+ *********************************************************************/
+#ifndef __CMD_QUEUE_H
+#define __CMD_QUEUE_H
+
+#include <stdint.h>
+
+#define CMD_QUEUE_SIZE      16  // 队列深度, 必须为2的幂
+#define CMD_QUEUE_DATA_MAX  32  // 单条命令负载的最大长度
+
+#if (CMD_QUEUE_SIZE & (CMD_QUEUE_SIZE - 1)) != 0
+#error "CMD_QUEUE_SIZE must be a power of two"
+#endif
+
+/**
+ * @brief  队列中的一条命令.
+ */
+typedef struct
+{
+    uint8_t Op;
+    uint8_t Len;
+    uint8_t Data[CMD_QUEUE_DATA_MAX];
+} Cmd_t;
+
+/**
+ * @brief  命令队列. Head 只由生产者写, Tail 只由消费者写, 两者均为自由递增计数.
+ */
+typedef struct
+{
+    Cmd_t Buf[CMD_QUEUE_SIZE];
+    volatile uint32_t Head;
+    volatile uint32_t Tail;
+    uint32_t Dropped;   // 因队列满或负载过长被丢弃的命令数 (生产者侧)
+} Cmd_Queue_t;
+
+/**
+ * @brief  初始化队列.
+ * @param  q - 队列指针.
+ * @return none.
+ */
+void Cmd_Queue_Init(Cmd_Queue_t *q);
+
+/**
+ * @brief  队列剩余空间 (生产者调用).
+ * @param  q - 队列指针.
+ * @return 可再写入的命令条数.
+ */
+uint32_t Cmd_Queue_Free(const Cmd_Queue_t *q);
+
+/**
+ * @brief  写入一条命令 (仅生产者调用).
+ * @param  q - 队列指针.
+ * @param  op - 操作码.
+ * @param  data - 负载, len为0时可为NULL.
+ * @param  len - 负载长度.
+ * @return 1: 成功, 0: 队列已满或负载过长.
+ */
+uint8_t Cmd_Queue_Push(Cmd_Queue_t *q, uint8_t op, const uint8_t *data, uint8_t len);
+
+/**
+ * @brief  取出一条命令 (仅消费者调用).
+ * @param  q - 队列指针.
+ * @param  cmd - 用于存储命令的指针.
+ * @return 1: 成功, 0: 队列为空.
+ */
+uint8_t Cmd_Queue_Pop(Cmd_Queue_t *q, Cmd_t *cmd);
+
+#endif
@@ -0,0 +1,286 @@
+/*********************************************************************
+ * @file      ctrl_channel.c
+ * @author    Gemini
+ * @brief     UDP控制通道 (认证、防重放、限速与分发) 的实现文件.
+ * @version   1.1
+ * @date      2026-10-16
+ *
+ * @copyright Copyright (c) 2025
+ *
+ *********************************************************************/
+#include "ctrl_channel.h"
+
+// 曾随源码发布的默认密钥 "CH32-ctrl-key-01", 已公开, 不得使用
+static const uint8_t Ctrl_Default_Key[CTRL_KEY_SIZE] = {
+    0x43, 0x48, 0x33, 0x32, 0x2d, 0x63, 0x74, 0x72, 0x6c, 0x2d, 0x6b, 0x65, 0x79, 0x2d, 0x30, 0x31
+};
+
+#define ROTL64(x, b) (uint64_t)(((x) << (b)) | ((x) >> (64 - (b))))
+
+#define SIPROUND(v0, v1, v2, v3)                                             \
+    do                                                                       \
+    {                                                                        \
+        v0 += v1; v1 = ROTL64(v1, 13); v1 ^= v0; v0 = ROTL64(v0, 32);        \
+        v2 += v3; v3 = ROTL64(v3, 16); v3 ^= v2;                             \
+        v0 += v3; v3 = ROTL64(v3, 21); v3 ^= v0;                             \
+        v2 += v1; v1 = ROTL64(v1, 17); v1 ^= v2; v2 = ROTL64(v2, 32);        \
+    } while(0)
+
+/**
+ * @brief  按小端读取32位数.
+ * @return uint32_t - 读取值.
+ */
+static uint32_t Get_U32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+/**
+ * @brief  按小端读取64位数.
+ * @return uint64_t - 读取值.
+ */
+static uint64_t Get_U64(const uint8_t *p)
+{
+    return (uint64_t)Get_U32(p) | ((uint64_t)Get_U32(p + 4) << 32);
+}
+
+/**
+ * @brief  按小端写入32位数.
+ * @return none.
+ */
+static void Put_U32(uint8_t *p, uint32_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+/**
+ * @brief  计算 SipHash-2-4.
+ * @return uint64_t - 64位标签.
+ */
+uint64_t Ctrl_SipHash(const uint8_t *key, const uint8_t *data, uint32_t len)
+{
+    uint64_t k0 = Get_U64(key);
+    uint64_t k1 = Get_U64(key + 8);
+    uint64_t v0 = k0 ^ 0x736f6d6570736575ULL;
+    uint64_t v1 = k1 ^ 0x646f72616e646f6dULL;
+    uint64_t v2 = k0 ^ 0x6c7967656e657261ULL;
+    uint64_t v3 = k1 ^ 0x7465646279746573ULL;
+    uint64_t m;
+    uint32_t i, tail = len & 7;
+
+    for(i = 0; i + 8 <= len; i += 8)
+    {
+        m = Get_U64(data + i);
+        v3 ^= m;
+        SIPROUND(v0, v1, v2, v3);
+        SIPROUND(v0, v1, v2, v3);
+        v0 ^= m;
+    }
+
+    // 最后一个分组: 剩余字节, 最高字节为长度
+    m = (uint64_t)len << 56;
+    while(tail--)
+    {
+        m |= (uint64_t)data[i + tail] << (8 * tail);
+    }
+    v3 ^= m;
+    SIPROUND(v0, v1, v2, v3);
+    SIPROUND(v0, v1, v2, v3);
+    v0 ^= m;
+
+    v2 ^= 0xff;
+    SIPROUND(v0, v1, v2, v3);
+    SIPROUND(v0, v1, v2, v3);
+    SIPROUND(v0, v1, v2, v3);
+    SIPROUND(v0, v1, v2, v3);
+    return v0 ^ v1 ^ v2 ^ v3;
+}
+
+/**
+ * @brief  生成应答数据报.
+ * @return uint16_t - 应答长度.
+ */
+static uint16_t Ctrl_Make_Ack(const Ctrl_Channel_t *ch, uint32_t seq, uint8_t status, uint8_t *ack)
+{
+    uint64_t tag;
+    uint8_t i;
+
+    ack[0] = 'C';
+    ack[1] = 'A';
+    ack[2] = CTRL_VERSION;
+    Put_U32(ack + 3, seq);
+    ack[7] = status;
+    tag = Ctrl_SipHash(ch->Key, ack, 8);
+    for(i = 0; i < CTRL_TAG_SIZE; i++)
+    {
+        ack[8 + i] = (uint8_t)(tag >> (8 * i));
+    }
+    return CTRL_ACK_SIZE;
+}
+
+/**
+ * @brief  令牌桶: 补充令牌并尝试取出一个.
+ * @return uint8_t - 1: 成功, 0: 令牌耗尽.
+ */
+static uint8_t Ctrl_Take_Token(Ctrl_Channel_t *ch, uint32_t now_ms)
+{
+    uint32_t elapsed = now_ms - ch->Last_Ms;
+
+    // 限制单次补充量, 避免长时间空闲后乘法溢出
+    if(elapsed > CTRL_BURST * 1000)
+    {
+        elapsed = CTRL_BURST * 1000;
+    }
+    ch->Tokens += elapsed * CTRL_RATE_PER_S;
+    if(ch->Tokens > CTRL_BURST * 1000)
+    {
+        ch->Tokens = CTRL_BURST * 1000;
+    }
+    ch->Last_Ms = now_ms;
+
+    if(ch->Tokens < 1000)
+    {
+        return 0;
+    }
+    ch->Tokens -= 1000;
+    return 1;
+}
+
+/**
+ * @brief  检查密钥是否可用: 不能全部字节相同 (如未编程的0xFF), 不能为默认密钥.
+ * @return uint8_t - 1: 可用, 0: 不可用.
+ */
+static uint8_t Ctrl_Key_Is_Valid(const uint8_t *key)
+{
+    uint8_t same = 1, is_default = 1;
+    uint8_t i;
+
+    for(i = 0; i < CTRL_KEY_SIZE; i++)
+    {
+        if(key[i] != key[0])
+        {
+            same = 0;
+        }
+        if(key[i] != Ctrl_Default_Key[i])
+        {
+            is_default = 0;
+        }
+    }
+    return !same && !is_default;
+}
+
+/**
+ * @brief  初始化控制通道.
+ * @return uint8_t - 1: 成功, 0: 密钥无效或缺少回调.
+ */
+uint8_t Ctrl_Init(Ctrl_Channel_t *ch, const uint8_t *key, Ctrl_Exec_t exec, Ctrl_Persist_t persist,
+                  const uint32_t *seq_limit, uint32_t now_ms)
+{
+    uint8_t i;
+
+    ch->Exec = 0;
+    ch->Persist = persist;
+    ch->Last_Seq = 0;
+    ch->Has_Seq = 0;
+    ch->Seq_Limit = seq_limit ? *seq_limit : 0;
+    ch->Has_Limit = seq_limit != 0;
+    ch->Tokens = CTRL_BURST * 1000;
+    ch->Last_Ms = now_ms;
+    ch->Stats = (Ctrl_Stats_t){0};
+    if(key == 0 || exec == 0 || persist == 0 || !Ctrl_Key_Is_Valid(key))
+    {
+        return 0;
+    }
+    for(i = 0; i < CTRL_KEY_SIZE; i++)
+    {
+        ch->Key[i] = key[i];
+    }
+    ch->Exec = exec;
+    return 1;
+}
+
+/**
+ * @brief  处理一个收到的数据报.
+ * @return uint16_t - 应答长度, 0 表示不应答.
+ */
+uint16_t Ctrl_Handle(Ctrl_Channel_t *ch, uint32_t now_ms, const uint8_t *pkt, uint16_t len, uint8_t *ack)
+{
+    uint64_t tag;
+    uint8_t diff = 0;
+    uint8_t data_len, i;
+    uint32_t seq;
+
+    if(ch->Exec == 0)
+    {
+        return 0;
+    }
+
+    // 1. 格式检查
+    if(len < CTRL_CMD_HEADER + CTRL_TAG_SIZE || pkt[0] != 'C' || pkt[1] != 'M' || pkt[2] != CTRL_VERSION)
+    {
+        ch->Stats.Malformed++;
+        return 0;
+    }
+    data_len = pkt[8];
+    if(data_len > CTRL_MAX_DATA || len != CTRL_CMD_HEADER + data_len + CTRL_TAG_SIZE)
+    {
+        ch->Stats.Malformed++;
+        return 0;
+    }
+
+    // 2. 认证, 逐字节比较全部标签以避免时间侧信道
+    tag = Ctrl_SipHash(ch->Key, pkt, CTRL_CMD_HEADER + data_len);
+    for(i = 0; i < CTRL_TAG_SIZE; i++)
+    {
+        diff |= pkt[CTRL_CMD_HEADER + data_len + i] ^ (uint8_t)(tag >> (8 * i));
+    }
+    if(diff != 0)
+    {
+        ch->Stats.Bad_Tag++;
+        return 0;
+    }
+
+    // 3. 限速, 只针对认证通过的数据报, 伪造的数据报不会挤占合法命令
+    if(!Ctrl_Take_Token(ch, now_ms))
+    {
+        ch->Stats.Rate_Limited++;
+        return 0;
+    }
+
+    // 4. 防重放. 复位前执行过的SEQ均不大于保存的上限
+    seq = Get_U32(pkt + 3);
+    if(ch->Has_Seq && seq == ch->Last_Seq)
+    {
+        // 发送端未收到上次的应答而重传, 只应答不执行
+        ch->Stats.Duplicates++;
+        return Ctrl_Make_Ack(ch, seq, CTRL_ACK_OK, ack);
+    }
+    if((ch->Has_Seq && (int32_t)(seq - ch->Last_Seq) < 0) ||
+       (!ch->Has_Seq && ch->Has_Limit && (int32_t)(seq - ch->Seq_Limit) <= 0))
+    {
+        ch->Stats.Replays++;
+        return Ctrl_Make_Ack(ch, seq, CTRL_ACK_REPLAY, ack);
+    }
+
+    // 5. 先保存序号上限再执行, 保存失败则不执行也不应答, 由发送端重试
+    if(!ch->Has_Limit || (int32_t)(seq - ch->Seq_Limit) > 0)
+    {
+        if(!ch->Persist(seq + CTRL_SEQ_RESERVE))
+        {
+            ch->Stats.Persist_Errors++;
+            return 0;
+        }
+        ch->Seq_Limit = seq + CTRL_SEQ_RESERVE;
+        ch->Has_Limit = 1;
+    }
+
+    // 6. 执行并应答
+    ch->Last_Seq = seq;
+    ch->Has_Seq = 1;
+    ch->Stats.Accepted++;
+    ch->Exec(pkt[7], pkt + CTRL_CMD_HEADER, data_len);
+    return Ctrl_Make_Ack(ch, seq, CTRL_ACK_OK, ack);
+}
@@ -0,0 +1,131 @@
+/*********************************************************************
+ * @file      ctrl_channel.h
+ * @author    Gemini
+ * @brief     UDP控制通道 (认证、防重放、限速与分发) 的头文件.
+ * @version   1.1
+ * @date      2026-10-16
+ *
+ * @par       数据报格式 (多字节字段均为小端):
+ *            命令: | 'C' | 'M' | VER u8 | SEQ u32 | OP u8 | LEN u8 | DATA[LEN] | TAG u64 |
+ *            应答: | 'C' | 'A' | VER u8 | SEQ u32 | STATUS u8 | TAG u64 |
+ *            - OP/DATA 与串口链路相同, 见 link_protocol.h 中的 LINK_OP_*.
+ *            - TAG 为以共享密钥计算的 SipHash-2-4, 覆盖 TAG 之前的全部字节.
+ *            - SEQ 必须严格递增; 与上一条相同视为重传, 只应答不执行.
+ *              执行前将序号上限 (SEQ + CTRL_SEQ_RESERVE) 写入Flash, 复位后
+ *              不大于该上限的SEQ一律视为重放, 掉电前截获的数据报无法再次
+ *              执行. 上限无法保存时不执行. 发送端需使用跨重启单调递增的
+ *              SEQ (udp_server.py 以0.1秒为单位的时间生成).
+ *            - 认证失败或格式错误的数据报不应答, 避免被用于反射.
+ *            - 只有认证通过的数据报消耗令牌, 令牌耗尽时直接丢弃, 伪造的
+ *              数据报无法耗尽令牌而阻塞合法命令.
+ *            - 密钥须在部署时提供, 全部字节相同或为旧版默认密钥时拒绝启用.
+ *            对应的发送端实现见仓库根目录的 udp_server.py.
+ *
+ *            本模块只依赖标准C头文件, 时间与命令执行由调用方传入, 可在PC上
+ *            用录制的数据报测试.
+ *
+ * @copyright Copyright (c) 2025
+ *
+ *********************************************************************/
+#ifndef __CTRL_CHANNEL_H
+#define __CTRL_CHANNEL_H
+
+#include <stdint.h>
+
+#define CTRL_VERSION        1
+#define CTRL_KEY_SIZE       16
+#define CTRL_TAG_SIZE       8
+#define CTRL_CMD_HEADER     9       // MAGIC(2) VER SEQ(4) OP LEN
+#define CTRL_MAX_DATA       32
+#define CTRL_ACK_SIZE       (8 + CTRL_TAG_SIZE)
+
+#define CTRL_RATE_PER_S     10      // 令牌桶: 每秒补充的数据报数
+#define CTRL_BURST          5       // 令牌桶: 突发上限
+#define CTRL_SEQ_RESERVE    32      // 每次写Flash预留的序号数, 连续命令不必每条都写
+
+/**
+ * @brief  应答状态.
+ */
+typedef enum
+{
+    CTRL_ACK_OK = 0,        // 已执行 (或为重传)
+    CTRL_ACK_REPLAY         // SEQ 小于已执行的最大值, 未执行
+} Ctrl_Ack_Status_t;
+
+/**
+ * @brief  命令执行回调.
+ */
+typedef void (*Ctrl_Exec_t)(uint8_t op, const uint8_t *data, uint8_t len);
+
+/**
+ * @brief  序号上限保存回调, 返回前必须已写入非易失存储.
+ * @return uint8_t - 1: 成功, 0: 失败.
+ */
+typedef uint8_t (*Ctrl_Persist_t)(uint32_t seq_limit);
+
+/**
+ * @brief  控制通道统计.
+ */
+typedef struct
+{
+    uint32_t Accepted;
+    uint32_t Duplicates;
+    uint32_t Replays;
+    uint32_t Bad_Tag;
+    uint32_t Malformed;
+    uint32_t Rate_Limited;  // 令牌耗尽而丢弃
+    uint32_t Persist_Errors;// 序号上限写入失败而未执行
+} Ctrl_Stats_t;
+
+/**
+ * @brief  控制通道状态.
+ */
+typedef struct
+{
+    uint8_t Key[CTRL_KEY_SIZE];
+    Ctrl_Exec_t Exec;       // 为NULL时通道未启用
+    Ctrl_Persist_t Persist;
+    uint32_t Last_Seq;
+    uint8_t Has_Seq;        // 本次上电后是否已执行过命令
+    uint32_t Seq_Limit;     // 已保存的序号上限, 执行过的SEQ均不大于它
+    uint8_t Has_Limit;
+    uint32_t Tokens;        // 令牌数 x1000
+    uint32_t Last_Ms;       // 上次补充令牌的时间
+    Ctrl_Stats_t Stats;
+} Ctrl_Channel_t;
+
+/**
+ * @brief  初始化控制通道.
+ * @param  ch        - 通道.
+ * @param  key       - 16字节共享密钥.
+ * @param  exec      - 命令执行回调.
+ * @param  persist   - 序号上限保存回调.
+ * @param  seq_limit - 上次保存的序号上限, 从未保存过时为NULL.
+ * @param  now_ms    - 当前时间 (ms).
+ * @return uint8_t - 1: 成功, 0: 密钥无效 (全部字节相同或为已知的默认密钥)
+ *         或缺少回调, 通道不处理任何数据报.
+ */
+uint8_t Ctrl_Init(Ctrl_Channel_t *ch, const uint8_t *key, Ctrl_Exec_t exec, Ctrl_Persist_t persist,
+                  const uint32_t *seq_limit, uint32_t now_ms);
+
+/**
+ * @brief  处理一个收到的数据报.
+ * @param  ch     - 通道.
+ * @param  now_ms - 当前时间 (ms).
+ * @param  pkt    - 数据报.
+ * @param  len    - 数据报长度.
+ * @param  ack    - 输出: 应答数据报, 至少 CTRL_ACK_SIZE 字节.
+ * @return uint16_t - 应答长度, 0 表示不应答.
+ */
+uint16_t Ctrl_Handle(Ctrl_Channel_t *ch, uint32_t now_ms, const uint8_t *pkt, uint16_t len, uint8_t *ack);
+
+/**
+ * @brief  计算 SipHash-2-4.
+ * @param  key  - 16字节密钥.
+ * @param  data - 数据.
+ * @param  len  - 数据长度.
+ * @return uint64_t - 64位标签.
+ */
+uint64_t Ctrl_SipHash(const uint8_t *key, const uint8_t *data, uint32_t len);
+
+#endif
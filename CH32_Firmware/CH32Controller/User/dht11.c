@@ -2,36 +2,87 @@
  * @file      dht11.c
  * @author    Gemini
  * @brief     DHT11温湿度传感器驱动模块的实现文件.
- * @version   1.0
- * @date      2025-06-07
+ * @version   2.0
+ * @date      2026-10-16
  *
  * @copyright Copyright (c) 2025
  *
+ * @note      一次采样分三个阶段:
+ *            1. START:   主机拉低总线至少18ms.
+ *            2. CAPTURE: 释放总线并使能EXTI, 中断中记录下降沿时间戳,
+ *                        等待一帧的最长时间后结束.
+ *            3. IDLE:    解码并更新缓存, 失败时按指数退避重试.
+ *
  *********************************************************************/
 #include "dht11.h"
+#include "bsp_timebase.h"
 
 // DHT11 数据线连接的GPIO引脚 (PC1)
 #define DHT11_DATA_PORT     GPIOC
 #define DHT11_DATA_PIN      GPIO_Pin_1
+#define DHT11_EXTI_LINE     EXTI_Line1
+
+#define DHT11_START_MS      20      // 起始信号低电平时间
+#define DHT11_CAPTURE_MS    8       // 一帧最长约7ms
+#define DHT11_MAX_EDGES     48      // 容纳一帧及少量毛刺
+
+typedef enum
+{
+    DHT11_STATE_IDLE = 0,
+    DHT11_STATE_START,
+    DHT11_STATE_CAPTURE
+} DHT11_State_t;
+
+static DHT11_State_t DHT11_State = DHT11_STATE_IDLE;
+static u32 DHT11_State_Ms = 0;      // 进入当前阶段的时刻
+static u32 DHT11_Next_Ms = 0;       // 下一次采样的时刻
+static u32 DHT11_Backoff_Ms = 0;    // 当前重试间隔, 0 表示上次成功
+
+static volatile u32 DHT11_Edges[DHT11_MAX_EDGES];
+static volatile u8 DHT11_Edge_Count = 0;
+
+static u8 DHT11_Temp = 0;
+static u8 DHT11_Humi = 0;
+static u8 DHT11_Valid = 0;
+static u32 DHT11_Read_Ms = 0;       // 缓存数据的采样时刻
+
+static DHT11_Stats_t DHT11_Stats = {0};
 
 // 模块内部静态函数声明
 static void DH11_GPIO_Init_OUT(void);
 static void DH11_GPIO_Init_IN(void);
-static void DHT11_Start(void);
-static u8 DHT11_Rec_Byte(void);
+static void DHT11_EXTI_Cmd(FunctionalState state);
+static void DHT11_Finish(void);
 
 /**
- * @brief  初始化DHT11传感器所使用的GPIO引脚.
+ * @brief  初始化DHT11数据引脚及其外部中断.
  *
  * @return none.
  */
 void DHT11_Init(void)
 {
+    NVIC_InitTypeDef NVIC_InitStructure = {0};
+
     // 使能GPIOC时钟，虽然上层main中可能已开启，但为确保模块独立性此处再次调用
-    RCC_APB2PeriphClockCmd(RCC_APB2Periph_GPIOC, ENABLE);
+    RCC_APB2PeriphClockCmd(RCC_APB2Periph_GPIOC | RCC_APB2Periph_AFIO, ENABLE);
 
     // 初始状态设置为输入模式，以检测总线空闲状态
     DH11_GPIO_Init_IN();
+
+    // PC1 -> EXTI1, 采集期间才使能
+    GPIO_EXTILineConfig(GPIO_PortSourceGPIOC, GPIO_PinSource1);
+    DHT11_EXTI_Cmd(DISABLE);
+
+    // 时间戳精度依赖中断延迟, 使用最高优先级
+    NVIC_InitStructure.NVIC_IRQChannel = EXTI1_IRQn;
+    NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = 0;
+    NVIC_InitStructure.NVIC_IRQChannelSubPriority = 0;
+    NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
+    NVIC_Init(&NVIC_InitStructure);
+
+    // 传感器上电后需约1s稳定
+    DHT11_State = DHT11_STATE_IDLE;
+    DHT11_Next_Ms = SysTick_Get_Ms() + DHT11_RETRY_MS;
 }
 
 /**
@@ -63,81 +114,171 @@ static void DH11_GPIO_Init_IN(void)
 }
 
 /**
- * @brief  主机向DHT11发送起始信号.
+ * @brief  使能或关闭数据线的下降沿中断.
  * @note   此为模块内部函数.
+ * @param  state - ENABLE 或 DISABLE.
  * @return none.
  */
-static void DHT11_Start(void)
+static void DHT11_EXTI_Cmd(FunctionalState state)
 {
-    DH11_GPIO_Init_OUT();                           // 切换为输出模式
-    GPIO_ResetBits(DHT11_DATA_PORT, DHT11_DATA_PIN);// 主机拉低总线
-    Delay_Ms(20);                                   // 延时至少18ms
-    GPIO_SetBits(DHT11_DATA_PORT, DHT11_DATA_PIN);  // 主机拉高总线
-    Delay_Us(30);                                   // 延时20-40us
-    DH11_GPIO_Init_IN();                            // 切换为输入模式，准备接收DHT11的响应
+    EXTI_InitTypeDef EXTI_InitStructure = {0};
+
+    EXTI_InitStructure.EXTI_Line = DHT11_EXTI_LINE;
+    EXTI_InitStructure.EXTI_Mode = EXTI_Mode_Interrupt;
+    EXTI_InitStructure.EXTI_Trigger = EXTI_Trigger_Falling;
+    EXTI_InitStructure.EXTI_LineCmd = state;
+    EXTI_Init(&EXTI_InitStructure);
+    EXTI_ClearITPendingBit(DHT11_EXTI_LINE);
 }
 
 /**
- * @brief  从DHT11接收一个字节的数据.
+ * @brief  结束一次采集: 解码、更新缓存并安排下一次采样.
  * @note   此为模块内部函数.
- * @return u8 - 接收到的8位数据.
+ * @return none.
  */
-static u8 DHT11_Rec_Byte(void)
+static void DHT11_Finish(void)
 {
-    u8 i, data = 0;
-    for (i = 0; i < 8; i++)
+    u32 edges[DHT11_MAX_EDGES];
+    u8 data[5];
+    u8 count, i;
+    DHT11_Status_t status;
+    u32 now = SysTick_Get_Ms();
+
+    DHT11_EXTI_Cmd(DISABLE);
+    count = DHT11_Edge_Count;
+    for(i = 0; i < count; i++)
+    {
+        edges[i] = DHT11_Edges[i];
+    }
+
+    status = DHT11_Decode(edges, count, data);
+    switch(status)
+    {
+    case DHT11_OK:
+        DHT11_Humi = data[0]; // 湿度整数部分
+        DHT11_Temp = data[2]; // 温度整数部分
+        DHT11_Valid = 1;
+        DHT11_Read_Ms = now;
+        DHT11_Stats.Ok++;
+        break;
+    case DHT11_ERR_NO_RESPONSE:
+        DHT11_Stats.No_Response++;
+        break;
+    case DHT11_ERR_CHECKSUM:
+        DHT11_Stats.Bad_Checksum++;
+        break;
+    default:
+        DHT11_Stats.Bad_Timing++;
+        break;
+    }
+
+    if(status == DHT11_OK)
     {
-        // 等待数据位的50us低电平结束
-        while (GPIO_ReadInputDataBit(DHT11_DATA_PORT, DHT11_DATA_PIN) == 0);
-        // 延时30us，用于判断是数据'0'还是数据'1'
-        Delay_Us(30);
-        data <<= 1;
-        // 如果延时后引脚仍为高电平，则表示接收到的是'1'
-        if (GPIO_ReadInputDataBit(DHT11_DATA_PORT, DHT11_DATA_PIN) == 1)
+        DHT11_Backoff_Ms = 0;
+        DHT11_Next_Ms = now + DHT11_PERIOD_MS;
+    }
+    else
+    {
+        // 失败时重试间隔逐次加倍, 避免传感器掉线时频繁占用总线
+        DHT11_Backoff_Ms = DHT11_Backoff_Ms ? DHT11_Backoff_Ms * 2 : DHT11_RETRY_MS;
+        if(DHT11_Backoff_Ms > DHT11_BACKOFF_MAX_MS)
         {
-            data |= 1;
+            DHT11_Backoff_Ms = DHT11_BACKOFF_MAX_MS;
         }
-        // 等待当前数据位的高电平结束
-        while (GPIO_ReadInputDataBit(DHT11_DATA_PORT, DHT11_DATA_PIN) == 1);
+        DHT11_Next_Ms = now + DHT11_Backoff_Ms;
     }
-    return data;
+    DHT11_State = DHT11_STATE_IDLE;
 }
 
 /**
- * @brief  从DHT11传感器读取温湿度数据.
- *
- * @param  temp 指向用于存储温度值的指针 (u8).
- * @param  humi 指向用于存储湿度值的指针 (u8).
+ * @brief  DHT11采样状态机, 应由调度器周期性调用 (建议5ms).
  *
- * @return u8 0: 成功, 1: 失败 (校验和错误或无响应).
+ * @return none.
  */
-u8 DHT11_Read_Data(u8 *temp, u8 *humi)
+void DHT11_Task(void)
 {
-    u8 buf[5];
-    u8 i;
+    u32 now = SysTick_Get_Ms();
 
-    DHT11_Start();
-    // 等待并检测DHT11的响应信号（拉低总线80us）
-    if (GPIO_ReadInputDataBit(DHT11_DATA_PORT, DHT11_DATA_PIN) == 0)
+    switch(DHT11_State)
     {
-        // 等待80us的低电平响应结束
-        while (GPIO_ReadInputDataBit(DHT11_DATA_PORT, DHT11_DATA_PIN) == 0);
-        // 等待80us的高电平准备信号结束
-        while (GPIO_ReadInputDataBit(DHT11_DATA_PORT, DHT11_DATA_PIN) == 1);
+    case DHT11_STATE_IDLE:
+        if((s32)(now - DHT11_Next_Ms) >= 0)
+        {
+            // 主机拉低总线, 发出起始信号
+            DH11_GPIO_Init_OUT();
+            GPIO_ResetBits(DHT11_DATA_PORT, DHT11_DATA_PIN);
+            DHT11_State_Ms = now;
+            DHT11_State = DHT11_STATE_START;
+        }
+        break;
 
-        // 循环接收5个字节的数据（湿度整数、湿度小数、温度整数、温度小数、校验和）
-        for(i = 0; i < 5; i++)
+    case DHT11_STATE_START:
+        if(now - DHT11_State_Ms >= DHT11_START_MS)
         {
-            buf[i] = DHT11_Rec_Byte();
+            // 释放总线, 传感器在20-40us后拉低作为响应
+            DHT11_Edge_Count = 0;
+            DHT11_EXTI_Cmd(ENABLE);
+            GPIO_SetBits(DHT11_DATA_PORT, DHT11_DATA_PIN);
+            DH11_GPIO_Init_IN();
+            DHT11_State_Ms = now;
+            DHT11_State = DHT11_STATE_CAPTURE;
         }
+        break;
 
-        // 校验数据和
-        if ((buf[0] + buf[1] + buf[2] + buf[3]) == buf[4])
+    case DHT11_STATE_CAPTURE:
+        if(now - DHT11_State_Ms >= DHT11_CAPTURE_MS)
         {
-            *humi = buf[0]; // 湿度整数部分
-            *temp = buf[2]; // 温度整数部分
-            return 0;       // 读取成功
+            DHT11_Finish();
         }
+        break;
     }
-    return 1; // 读取失败
-} 
\ No newline at end of file
+}
+
+/**
+ * @brief  获取最近一次有效的温湿度数据.
+ *
+ * @param  temp   指向用于存储温度值的指针 (u8).
+ * @param  humi   指向用于存储湿度值的指针 (u8).
+ * @param  age_ms 指向用于存储数据年龄的指针 (ms), 可为NULL.
+ *
+ * @return u8 0: 成功, 1: 上电后尚无有效数据.
+ */
+u8 DHT11_Get_Last(u8 *temp, u8 *humi, u32 *age_ms)
+{
+    if(!DHT11_Valid)
+    {
+        return 1;
+    }
+    *temp = DHT11_Temp;
+    *humi = DHT11_Humi;
+    if(age_ms != NULL)
+    {
+        *age_ms = SysTick_Get_Ms() - DHT11_Read_Ms;
+    }
+    return 0;
+}
+
+/**
+ * @brief  获取采样统计.
+ * @return const DHT11_Stats_t* - 统计信息.
+ */
+const DHT11_Stats_t *DHT11_Get_Stats(void)
+{
+    return &DHT11_Stats;
+}
+
+/**
+ * @brief  EXTI1中断服务函数的回调, 记录下降沿时间戳.
+ * @return none.
+ */
+void EXTI1_IRQHandler_Callback(void)
+{
+    if(EXTI_GetITStatus(DHT11_EXTI_LINE) != RESET)
+    {
+        if(DHT11_Edge_Count < DHT11_MAX_EDGES)
+        {
+            DHT11_Edges[DHT11_Edge_Count++] = Timebase_Get_Us();
+        }
+        EXTI_ClearITPendingBit(DHT11_EXTI_LINE);
+    }
+}
@@ -2,33 +2,75 @@
  * @file      dht11.h
  * @author    Gemini
  * @brief     DHT11温湿度传感器驱动模块的头文件
- * @version   1.0
- * @date      2025-06-07
+ * @version   2.0
+ * @date      2026-10-16
  *
  * @copyright Copyright (c) 2025
  *
+ * @note      驱动为非阻塞状态机: DHT11_Task() 发出起始信号后, 由EXTI中断
+ *            记录数据线的下降沿时间戳, 采集结束后交给 DHT11_Decode() 解码.
+ *            上层只读取缓存的最近一次有效数据及其数据年龄, 不会因传感器
+ *            掉线而阻塞主循环.
+ *
  *********************************************************************/
 #ifndef __DHT11_H
 #define __DHT11_H
 
 #include "ch32v30x_gpio.h"
 #include "debug.h"
+#include "dht11_decode.h"
+
+#define DHT11_PERIOD_MS         2000    // 正常采样周期
+#define DHT11_RETRY_MS          1000    // 首次失败后的重试间隔 (传感器要求两次采样间隔>=1s)
+#define DHT11_BACKOFF_MAX_MS    32000   // 连续失败时重试间隔的上限
+
+/**
+ * @brief  采样统计.
+ */
+typedef struct
+{
+    u32 Ok;
+    u32 No_Response;
+    u32 Bad_Timing;     // 含边沿不足一帧
+    u32 Bad_Checksum;
+} DHT11_Stats_t;
 
 /**
- * @brief  初始化DHT11传感器所使用的GPIO引脚.
+ * @brief  初始化DHT11数据引脚及其外部中断.
  *
  * @return none.
  */
 void DHT11_Init(void);
 
 /**
- * @brief  从DHT11传感器读取温湿度数据.
+ * @brief  DHT11采样状态机, 应由调度器周期性调用 (建议5ms).
  *
- * @param  temp 指向用于存储温度值的指针 (u8).
- * @param  humi 指向用于存储湿度值的指针 (u8).
+ * @return none.
+ */
+void DHT11_Task(void);
+
+/**
+ * @brief  获取最近一次有效的温湿度数据.
  *
- * @return u8 0: 成功, 1: 失败 (校验和错误或无响应).
+ * @param  temp   指向用于存储温度值的指针 (u8).
+ * @param  humi   指向用于存储湿度值的指针 (u8).
+ * @param  age_ms 指向用于存储数据年龄的指针 (ms), 可为NULL.
+ *
+ * @return u8 0: 成功, 1: 上电后尚无有效数据.
+ */
+u8 DHT11_Get_Last(u8 *temp, u8 *humi, u32 *age_ms);
+
+/**
+ * @brief  获取采样统计.
+ * @return const DHT11_Stats_t* - 统计信息.
+ */
+const DHT11_Stats_t *DHT11_Get_Stats(void);
+
+/**
+ * @brief  EXTI1中断服务函数的回调, 记录下降沿时间戳.
+ * @note   此函数应在 ch32v30x_it.c 的 EXTI1_IRQHandler 中被调用.
+ * @return none.
  */
-u8 DHT11_Read_Data(u8 *temp, u8 *humi);
+void EXTI1_IRQHandler_Callback(void);
 
-#endif 
\ No newline at end of file
+#endif
@@ -0,0 +1,67 @@
+/*********************************************************************
+ * @file      dht11_decode.c
+ * @author    Gemini
+ * @brief     DHT11单总线帧解码模块的实现文件.
+ * @version   1.0
+ * @date      2026-10-16
+ *
+ * @copyright Copyright (c) 2025
+ *
+ *********************************************************************/
+#include "dht11_decode.h"
+
+/**
+ * @brief  将下降沿时间戳序列解码为5字节数据.
+ * @param  edges - 下降沿时间戳 (us), 按捕获顺序排列.
+ * @param  count - 时间戳个数.
+ * @param  data  - 输出: 湿度整数、湿度小数、温度整数、温度小数、校验和.
+ * @return DHT11_Status_t - 解码结果.
+ */
+DHT11_Status_t DHT11_Decode(const uint32_t *edges, uint8_t count, uint8_t data[5])
+{
+    uint32_t width;
+    uint8_t i;
+
+    if(count == 0)
+    {
+        return DHT11_ERR_NO_RESPONSE;
+    }
+    if(count < DHT11_FRAME_EDGES)
+    {
+        return DHT11_ERR_SHORT;
+    }
+    edges += count - DHT11_FRAME_EDGES;
+
+    // 1. 响应信号
+    width = edges[1] - edges[0];
+    if(width < DHT11_RESP_MIN_US || width > DHT11_RESP_MAX_US)
+    {
+        return DHT11_ERR_TIMING;
+    }
+
+    // 2. 40个数据位, 高位在前
+    for(i = 0; i < 5; i++)
+    {
+        data[i] = 0;
+    }
+    for(i = 0; i < 40; i++)
+    {
+        width = edges[i + 2] - edges[i + 1];
+        if(width < DHT11_BIT_MIN_US || width > DHT11_BIT_MAX_US)
+        {
+            return DHT11_ERR_TIMING;
+        }
+        data[i / 8] <<= 1;
+        if(width > DHT11_BIT_ONE_US)
+        {
+            data[i / 8] |= 1;
+        }
+    }
+
+    // 3. 校验和为前4字节之和的低8位
+    if((uint8_t)(data[0] + data[1] + data[2] + data[3]) != data[4])
+    {
+        return DHT11_ERR_CHECKSUM;
+    }
+    return DHT11_OK;
+}
@@ -0,0 +1,53 @@
+/*********************************************************************
+ * @file      dht11_decode.h
+ * @author    Gemini
+ * @brief     DHT11单总线帧解码模块的头文件.
+ * @version   1.0
+ * @date      2026-10-16
+ *
+ * @copyright Copyright (c) 2025
+ *
+ * @note      解码器只处理下降沿时间戳, 不访问任何硬件, 可在PC上用
+ *            录制的边沿序列测试. 相邻下降沿的间隔:
+ *            - 响应信号: 80us低 + 80us高, 约160us.
+ *            - 数据'0': 50us低 + 26~28us高, 约78us.
+ *            - 数据'1': 50us低 + 70us高, 约120us.
+ *            一帧共42个下降沿 (响应1个 + 数据位起始41个).
+ *
+ *********************************************************************/
+#ifndef __DHT11_DECODE_H
+#define __DHT11_DECODE_H
+
+#include <stdint.h>
+
+#define DHT11_FRAME_EDGES       42      // 一帧的下降沿个数
+#define DHT11_RESP_MIN_US       120     // 响应信号间隔下限
+#define DHT11_RESP_MAX_US       220     // 响应信号间隔上限
+#define DHT11_BIT_MIN_US        50      // 数据位间隔下限
+#define DHT11_BIT_MAX_US        160     // 数据位间隔上限
+#define DHT11_BIT_ONE_US        100     // 超过此间隔判为'1'
+
+/**
+ * @brief  解码结果.
+ */
+typedef enum
+{
+    DHT11_OK = 0,
+    DHT11_ERR_NO_RESPONSE,  // 未捕获到任何边沿 (传感器未连接)
+    DHT11_ERR_SHORT,        // 边沿不足一帧
+    DHT11_ERR_TIMING,       // 脉宽超出范围
+    DHT11_ERR_CHECKSUM      // 校验和错误
+} DHT11_Status_t;
+
+/**
+ * @brief  将下降沿时间戳序列解码为5字节数据.
+ * @note   边沿多于一帧时使用最后 DHT11_FRAME_EDGES 个, 以忽略切换引脚
+ *         方向时产生的毛刺. 时间戳允许回绕.
+ * @param  edges - 下降沿时间戳 (us), 按捕获顺序排列.
+ * @param  count - 时间戳个数.
+ * @param  data  - 输出: 湿度整数、湿度小数、温度整数、温度小数、校验和.
+ * @return DHT11_Status_t - 解码结果.
+ */
+DHT11_Status_t DHT11_Decode(const uint32_t *edges, uint8_t count, uint8_t data[5]);
+
+#endif
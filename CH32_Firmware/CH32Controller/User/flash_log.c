@@ -0,0 +1,122 @@
+/*********************************************************************
+ * @file      flash_log.c
+ * @author    Gemini
+ * @brief     掉电安全的Flash单值日志 (双页轮换) 的实现文件.
+ * @version   1.0
+ * @date      2026-10-16
+ *
+ * @copyright Copyright (c) 2025
+ *
+ *********************************************************************/
+#include "flash_log.h"
+
+/**
+ * @brief  编程一个字并回读校验.
+ * @return uint8_t - 1: 成功, 0: 失败.
+ */
+static uint8_t Flash_Log_Program(Flash_Log_t *log, uint32_t addr, uint32_t word)
+{
+    return log->Ops->Program(addr, word) && log->Ops->Read(addr) == word;
+}
+
+/**
+ * @brief  扫描一页的记录.
+ * @param  next  - 输出: 第一条空记录的偏移.
+ * @param  value - 输出: 最后一条有效记录的值.
+ * @return uint8_t - 1: 找到有效记录, 0: 没有.
+ */
+static uint8_t Flash_Log_Scan(const Flash_Log_t *log, uint32_t page, uint32_t *next, uint32_t *value)
+{
+    uint8_t found = 0;
+    uint32_t off;
+
+    for(off = FLASH_LOG_HEADER; off + FLASH_LOG_RECORD <= log->Page_Size; off += FLASH_LOG_RECORD)
+    {
+        uint32_t v = log->Ops->Read(page + off);
+        uint32_t check = log->Ops->Read(page + off + 4);
+
+        if(v == FLASH_LOG_ERASED && check == FLASH_LOG_ERASED)
+        {
+            break;
+        }
+        if(check == ~v)
+        {
+            *value = v;
+            found = 1;
+        }
+    }
+    *next = off;
+    return found;
+}
+
+/**
+ * @brief  打开日志并读出最新值.
+ * @return uint8_t - 1: 读到有效值, 0: 日志为空.
+ */
+uint8_t Flash_Log_Open(Flash_Log_t *log, const Flash_Log_Ops_t *ops, uint32_t page0, uint32_t page1,
+                       uint32_t page_size, uint32_t *value)
+{
+    uint8_t i;
+
+    log->Ops = ops;
+    log->Page[0] = page0;
+    log->Page[1] = page1;
+    log->Page_Size = page_size;
+    log->Active = -1;
+    log->Generation = 0;
+    log->Next = page_size;
+
+    for(i = 0; i < 2; i++)
+    {
+        uint32_t generation = ops->Read(log->Page[i]);
+
+        if(ops->Read(log->Page[i] + 4) != FLASH_LOG_MAGIC)
+        {
+            continue;
+        }
+        if(log->Active < 0 || (int32_t)(generation - log->Generation) > 0)
+        {
+            log->Active = (int8_t)i;
+            log->Generation = generation;
+        }
+    }
+    if(log->Active < 0)
+    {
+        return 0;
+    }
+    return Flash_Log_Scan(log, log->Page[log->Active], &log->Next, value);
+}
+
+/**
+ * @brief  追加一个新值.
+ * @return uint8_t - 1: 成功, 0: 擦除或编程失败.
+ */
+uint8_t Flash_Log_Write(Flash_Log_t *log, uint32_t value)
+{
+    uint32_t page, addr;
+    uint8_t other;
+
+    if(log->Active >= 0 && log->Next + FLASH_LOG_RECORD <= log->Page_Size)
+    {
+        addr = log->Page[log->Active] + log->Next;
+        // 失败的记录可能已部分写入, 无论成败都不再使用该位置
+        log->Next += FLASH_LOG_RECORD;
+        return Flash_Log_Program(log, addr, value) && Flash_Log_Program(log, addr + 4, ~value);
+    }
+
+    // 当前页已满 (或尚无有效页): 在另一页写入记录, 最后写MAGIC使其生效
+    other = log->Active == 0 ? 1 : 0;
+    page = log->Page[other];
+    if(!log->Ops->Erase(page) ||
+       !Flash_Log_Program(log, page + FLASH_LOG_HEADER, value) ||
+       !Flash_Log_Program(log, page + FLASH_LOG_HEADER + 4, ~value) ||
+       !Flash_Log_Program(log, page, log->Generation + 1) ||
+       !Flash_Log_Program(log, page + 4, FLASH_LOG_MAGIC))
+    {
+        return 0;
+    }
+    log->Active = (int8_t)other;
+    log->Generation++;
+    log->Next = FLASH_LOG_HEADER + FLASH_LOG_RECORD;
+    return 1;
+}
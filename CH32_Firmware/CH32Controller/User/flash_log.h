@@ -0,0 +1,77 @@
+/*********************************************************************
+ * @file      flash_log.h
+ * @author    Gemini
+ * @brief     掉电安全的Flash单值日志 (双页轮换) 的头文件.
+ * @version   1.0
+ * @date      2026-10-16
+ *
+ * @copyright Copyright (c) 2025
+ *
+ * @note      保存一个随时间更新的32位值 (如控制通道的序号上限), 每次写入
+ *            只追加一条记录, 页写满后才擦除另一页并切换, 以分摊擦写寿命.
+ *            页格式 (字):
+ *            | GENERATION | MAGIC | VALUE0 | ~VALUE0 | VALUE1 | ~VALUE1 | ...
+ *            - 切换页时先写记录和 GENERATION, 最后写 MAGIC, 写入中途掉电
+ *              时旧页仍然有效.
+ *            - VALUE与其反码不匹配的记录 (写入中途掉电) 被跳过.
+ *            - 两页都有效时取 GENERATION 较新的一页.
+ *            本模块只依赖标准C头文件, Flash操作由调用方传入, 可在PC上
+ *            用RAM模拟的Flash测试. 硬件实现见 bsp_flash.h.
+ *
+ *********************************************************************/
+#ifndef __FLASH_LOG_H
+#define __FLASH_LOG_H
+
+#include <stdint.h>
+
+#define FLASH_LOG_MAGIC     0x474C5346u     // "FSLG"
+#define FLASH_LOG_ERASED    0xFFFFFFFFu
+#define FLASH_LOG_HEADER    8               // GENERATION + MAGIC
+#define FLASH_LOG_RECORD    8               // VALUE + ~VALUE
+
+/**
+ * @brief  Flash操作. 擦除后各字为 FLASH_LOG_ERASED, 编程只能将位由1变0.
+ */
+typedef struct
+{
+    uint32_t (*Read)(uint32_t addr);
+    uint8_t (*Erase)(uint32_t page_addr);           // 1: 成功
+    uint8_t (*Program)(uint32_t addr, uint32_t word); // 1: 成功
+} Flash_Log_Ops_t;
+
+/**
+ * @brief  日志状态.
+ */
+typedef struct
+{
+    const Flash_Log_Ops_t *Ops;
+    uint32_t Page[2];       // 两页的起始地址
+    uint32_t Page_Size;     // 页大小, 即擦除单位
+    int8_t Active;          // 当前页, -1 表示尚无有效页
+    uint32_t Generation;    // 当前页的代数
+    uint32_t Next;          // 当前页中下一条记录的偏移
+} Flash_Log_t;
+
+/**
+ * @brief  打开日志并读出最新值.
+ * @param  log       - 日志.
+ * @param  ops       - Flash操作.
+ * @param  page0     - 第一页的地址.
+ * @param  page1     - 第二页的地址.
+ * @param  page_size - 页大小.
+ * @param  value     - 输出: 最新值.
+ * @return uint8_t - 1: 读到有效值, 0: 日志为空.
+ */
+uint8_t Flash_Log_Open(Flash_Log_t *log, const Flash_Log_Ops_t *ops, uint32_t page0, uint32_t page1,
+                       uint32_t page_size, uint32_t *value);
+
+/**
+ * @brief  追加一个新值, 返回时已写入Flash.
+ * @note   当前页写满时会擦除另一页, 耗时为一次页擦除.
+ * @param  log   - 日志.
+ * @param  value - 新值.
+ * @return uint8_t - 1: 成功, 0: 擦除或编程失败.
+ */
+uint8_t Flash_Log_Write(Flash_Log_t *log, uint32_t value);
+
+#endif
@@ -2,7 +2,7 @@
  * @file      main.c
  * @author    Gemini
  * @brief     智能家居外设控制器主程序.
- * @version   3.0 (Modular Zigbee)
+ * @version   3.1 (Cooperative Scheduler)
  * @date      2025-06-08
  *
  * @copyright Copyright (c) 2025
@@ -17,25 +17,38 @@
  *              打包和发送。
  *            - Handler层 (uart_handler.c/.h, zigbee_handler.c/.h): 负责解析和处理
  *              来自特定接口（如串口1、Zigbee模块）的指令和数据。
- *            - App层 (main.c): 作为顶层应用，负责初始化所有模块，并在主循环中
- *              调度各个任务，实现核心业务逻辑。
+ *            - App层 (main.c): 作为顶层应用，负责初始化所有模块，并向协作式
+ *              调度器 (scheduler.c/.h) 注册各个任务，实现核心业务逻辑。
  *
  * @par       核心逻辑 (Core Logic):
  *            1. 系统初始化: 调用 System_Init() 初始化所有硬件和模块。
  *            2. 网络初始化: 调用 UDP_Client_Init() 初始化以太网和UDP协议栈。
- *            3. 主循环 (while(1)):
- *               - WCHNET_MainTask(): WCH-NET协议栈的核心轮询任务。
- *               - UDP数据上报: 定期读取DHT11温湿度，并通过UDP发送。
- *               - 本地光感任务: 定期巡检光敏传感器，并根据阈值自动控制LED1。
- *               - Zigbee报警任务: 监听并处理来自远程Zigbee节点的报警信息，
+ *            3. 主循环 (while(1)): 调用 Sched_Run_Once() 运行到期的任务,
+ *               每个任务记录执行时间、启动抖动和超时次数:
+ *               - net (轮询): WCH-NET协议栈的核心轮询任务。
+ *               - uart (轮询): 执行USART1中断放入无锁队列的ESP32命令。
+ *               UDP控制端口 (CTRL_PORT) 的命令在 net 任务中认证后直接执行,
+ *               与串口命令共用 UART_Handler_Execute()。控制端口只在编译时
+ *               提供了密钥 (CTRL_KEY) 时打开, 其序号上限保存在Flash数据页。
+ *               - zigbee (5ms): 监听并处理来自远程Zigbee节点的报警信息，
  *                 实现持续鸣叫报警及按键消警功能。
+ *               - actuator (10ms): 推进蜂鸣器定时鸣叫和门锁定时关锁的非阻塞状态机。
+ *               - dht11 (5ms): 推进DHT11非阻塞采样状态机。
+ *               - sensor (200ms): 巡检光敏传感器，并根据阈值自动控制LED1。
+ *               - telemetry (50ms): 每500ms采集一次全部传感器, 编码为二进制
+ *                 记录并按5s窗口批量通过UDP发送; 报警状态变化时立即发送。
+ *               - stats (10s): 通过UDP上报各任务的调度统计及串口接收统计。
  *
  * @par       中断服务 (Interrupt Services in ch32v30x_it.c):
  *            - EXTI0_IRQHandler: 按键(KEY)中断，用于手动翻转LED1及清除Zigbee报警。
- *            - USART1_IRQHandler: 串口1接收中断，用于处理来自ESP32的远程控制指令。
- *            - USART2_IRQHandler: 串口2接收中断，用于接收来自Zigbee协调器的数据。
+ *            - EXTI1_IRQHandler: DHT11数据线下降沿中断，记录时间戳用于解码。
+ *            - USART1_IRQHandler / DMA1_Channel5_IRQHandler: 串口1 DMA接收的空闲与
+ *              半传输/完成中断，解码来自ESP32的指令帧并入队、回复确认。
+ *            - USART2_IRQHandler / DMA1_Channel6_IRQHandler: 串口2 DMA接收的空闲与
+ *              半传输/完成中断，用于接收来自Zigbee协调器的数据。
  *            - SysTick_Handler: 系统滴答定时器，为非阻塞延时提供时基。
  *            - TIM2_IRQHandler: 通用定时器2，为WCH-NET协议栈提供时基。
+ *            - TIM4_IRQHandler: 通用定时器4溢出，为调度器提供微秒时基。
  *
  ********************************************************************************/
 #include "debug.h"
@@ -51,6 +64,12 @@
 #include "bsp_sensors.h"
 #include "uart_handler.h"
 #include "zigbee_handler.h"
+#include "bsp_usart2.h"
+#include "bsp_timebase.h"
+#include "scheduler.h"
+#include "telemetry.h"
+#include "ctrl_channel.h"
+#include "bsp_flash.h"
 
 /* 为WCHNET库中定义的全局变量提供外部声明 */
 extern u8 IPAddr[4];
@@ -58,6 +77,25 @@ extern u8 IPAddr[4];
 // 光敏电阻阈值，低于此值认为天黑
 #define PHOTORES_THRESHOLD  1000
 
+// 任务周期与时限
+#define ZIGBEE_PERIOD_MS    5
+#define ACTUATOR_PERIOD_MS  10
+#define DHT11_TASK_MS       5
+#define SENSOR_PERIOD_MS    200
+#define TELEM_TASK_MS       50      // 报警状态变化的检测周期
+#define TELEM_SAMPLE_MS     500     // 采样周期
+#define TELEM_WINDOW_MS     5000    // 批量发送窗口, 不超过65s
+#define STATS_PERIOD_MS     10000
+#define NET_DEADLINE_MS     5       // 两次协议栈轮询的最大间隔目标
+#define DHT11_STALE_MS      10000   // 超过此时间未更新则视为传感器离线
+
+// UDP控制通道
+#define CTRL_PORT           1001
+// 共享密钥没有默认值, 每台设备部署时在编译选项中提供, 与运行 udp_server.py
+// 时的环境变量 CTRL_KEY 相同, 例如:
+//   -DCTRL_KEY="{0x3a,0x91,...}" (16字节)
+// 未提供时控制端口不打开.
+
 /**
  * @brief  Socket事件回调函数 (当前未使用).
  * @param  sockeid - socket id.
@@ -85,9 +123,28 @@ static void System_Init(void)
     Zigbee_Handler_Init();
     Servo_Init();
     DHT11_Init();
+    Timebase_Init();
+    /* Servo_Init() 已将舵机转到关锁位置(0度) */
+}
+
+/**
+ * @brief  网络核心任务: WCH-NET协议栈轮询.
+ * @return none
+ */
+static void Net_Task(void)
+{
+    WCHNET_MainTask();
+    UDP_Client_Handle_GlobalInt();
+}
 
-    /* 初始化舵机到关锁位置(0度) */
-    Servo_SetAngle(0);
+/**
+ * @brief  执行器任务: 推进蜂鸣器与门锁状态机.
+ * @return none
+ */
+static void Actuator_Task(void)
+{
+    Buzzer_Task();
+    Servo_Task();
 }
 
 /**
@@ -96,15 +153,6 @@ static void System_Init(void)
  */
 static void Sensor_Task(void)
 {
-    static u32 last_run_time = 0;
-
-    // 每200ms检测一次
-    if(SysTick_Get_Ms() - last_run_time < 200)
-    {
-        return;
-    }
-    last_run_time = SysTick_Get_Ms();
-
     // 1. 光敏传感器 -> LED1
     if(Photoresistor_Get_Val() < PHOTORES_THRESHOLD)
     {
@@ -116,6 +164,157 @@ static void Sensor_Task(void)
     }
 }
 
+static Telem_Batch_t Telem_Batch;
+static Ctrl_Channel_t Ctrl_Channel;
+
+#ifdef CTRL_KEY
+static const u8 Ctrl_Key[CTRL_KEY_SIZE] = CTRL_KEY;
+static Flash_Log_t Ctrl_Seq_Log;
+
+/**
+ * @brief  保存控制通道的序号上限, 在执行命令前调用.
+ * @return u8 - 1: 成功, 0: 失败.
+ */
+static u8 Ctrl_Persist(u32 seq_limit)
+{
+    return Flash_Log_Write(&Ctrl_Seq_Log, seq_limit);
+}
+
+/**
+ * @brief  UDP控制端口接收回调: 认证、执行并回复应答.
+ * @return none
+ */
+static void Ctrl_Recv_Callback(const u8 *ip, u16 port, const u8 *data, u16 len)
+{
+    u8 ack[CTRL_ACK_SIZE];
+    u16 ack_len = Ctrl_Handle(&Ctrl_Channel, SysTick_Get_Ms(), data, len, ack);
+
+    if(ack_len > 0)
+    {
+        UDP_Client_Send_To(ip, port, ack, ack_len);
+    }
+}
+#endif
+
+/**
+ * @brief  发送当前批次.
+ * @param  flags - TELEM_FLAG_*.
+ * @return none
+ */
+static void Telemetry_Flush(u8 flags)
+{
+    u16 len = Telem_Batch_Finish(&Telem_Batch, flags);
+
+    if(len > 0)
+    {
+        UDP_Client_Send(Telem_Batch.Buf, len);
+    }
+}
+
+/**
+ * @brief  采集一次全部传感器并追加到当前批次, 批次已满时先发送.
+ * @param  now   - 当前时间 (ms).
+ * @param  state - 已读取的开关量状态 (TELEM_STATE_*).
+ * @return none
+ */
+static void Telemetry_Sample(u32 now, u8 state)
+{
+    Telem_Sample_t sample = {0};
+    u8 dht_temp, dht_humi;
+    u32 age_ms;
+
+    sample.Time_Ms = now;
+    sample.Light = Photoresistor_Get_Val();
+    sample.State = state;
+    if(DHT11_Get_Last(&dht_temp, &dht_humi, &age_ms) == 0 && age_ms <= DHT11_STALE_MS)
+    {
+        sample.Temp = (s8)dht_temp;
+        sample.Humi = dht_humi;
+        sample.Dht_Age_S = (u8)(age_ms / 1000);
+        sample.State |= TELEM_STATE_DHT_VALID;
+    }
+
+    if(!Telem_Batch_Add(&Telem_Batch, &sample))
+    {
+        Telemetry_Flush(0);
+        Telem_Batch_Add(&Telem_Batch, &sample);
+    }
+}
+
+/**
+ * @brief  遥测任务: 周期采样、按窗口批量发送, 报警状态变化时立即发送.
+ * @return none
+ */
+static void Telemetry_Task(void)
+{
+    static u32 last_sample_ms = 0;
+    static u8 last_state = 0;
+    u32 now = SysTick_Get_Ms();
+    u8 state = 0;
+
+    if(PIR_Is_Triggered())
+    {
+        state |= TELEM_STATE_PIR;
+    }
+    if(Smoke_Is_Triggered())
+    {
+        state |= TELEM_STATE_SMOKE;
+    }
+    if(Zigbee_Alarm_Active())
+    {
+        state |= TELEM_STATE_ALARM;
+    }
+
+    if((state ^ last_state) & TELEM_STATE_EVENT_MASK)
+    {
+        Telemetry_Sample(now, state);
+        Telemetry_Flush(TELEM_FLAG_EVENT);
+        last_sample_ms = now;
+    }
+    else if(now - last_sample_ms >= TELEM_SAMPLE_MS)
+    {
+        Telemetry_Sample(now, state);
+        last_sample_ms = now;
+    }
+    last_state = state;
+
+    if(Telem_Batch.Count > 0 && now - Telem_Batch.Base_Ms >= TELEM_WINDOW_MS)
+    {
+        Telemetry_Flush(0);
+    }
+}
+
+/**
+ * @brief  调度统计上报任务: 通过UDP发送本统计窗口内各任务的统计信息.
+ * @note   任务行格式: "name runs avg_us max_us jitter_us overruns skipped".
+ * @return none
+ */
+static void Stats_Task(void)
+{
+    static char stats_buf[1024];
+    UART_Link_Stats_t link;
+    Rx_Ring_Stats_t zigbee;
+    int len;
+
+    len = sprintf(stats_buf, "SCHED\n");
+    len += Sched_Format_Stats(stats_buf + len, sizeof(stats_buf) - len);
+
+    // 控制通道: 执行 重传 重放 认证失败 格式错误 限速丢弃 序号保存失败
+    len += snprintf(stats_buf + len, sizeof(stats_buf) - len, "ctrl %lu %lu %lu %lu %lu %lu %lu\n",
+                    Ctrl_Channel.Stats.Accepted, Ctrl_Channel.Stats.Duplicates, Ctrl_Channel.Stats.Replays,
+                    Ctrl_Channel.Stats.Bad_Tag, Ctrl_Channel.Stats.Malformed, Ctrl_Channel.Stats.Rate_Limited,
+                    Ctrl_Channel.Stats.Persist_Errors);
+
+    // 串口接收: 字节数 溢出次数 丢弃字节 线路错误
+    UART_Handler_Get_Stats(&link);
+    USART2_Get_Rx_Stats(&zigbee);
+    len += snprintf(stats_buf + len, sizeof(stats_buf) - len, "rx1 %lu %lu %lu %lu\nrx2 %lu %lu %lu %lu\n",
+                   link.Rx.Bytes, link.Rx.Overflows, link.Rx.Dropped, link.Rx.Errors,
+                   zigbee.Bytes, zigbee.Overflows, zigbee.Dropped, zigbee.Errors);
+    UDP_Client_Send((u8*)stats_buf, len);
+    Sched_Reset_Stats();
+}
+
 /*********************************************************************
  * @fn      main
  *
@@ -125,9 +324,6 @@ static void Sensor_Task(void)
  */
 int main(void)
 {
-    u8 dht_temp, dht_humi;
-    char udp_buf[50];
-
     System_Init();
     printf("Welcome to CH32Controller V3.0\r\n");
 
@@ -139,28 +335,42 @@ int main(void)
     }
     printf("WCHNET init success. IP: %d.%d.%d.%d\r\n", IPAddr[0], IPAddr[1], IPAddr[2], IPAddr[3]);
 
+    Telem_Batch_Init(&Telem_Batch);
 
-    while(1)
+    /* 打开UDP控制端口, 复位前保存的序号上限之前的命令不会再被执行 */
+#ifdef CTRL_KEY
     {
-        /* 网络核心任务 */
-        WCHNET_MainTask();
-        UDP_Client_Handle_GlobalInt();
+        u32 seq_limit;
+        u8 has_limit = Flash_Log_Open(&Ctrl_Seq_Log, &BSP_Flash_Ops, BSP_FLASH_DATA_PAGE0, BSP_FLASH_DATA_PAGE1,
+                                      BSP_FLASH_PAGE_SIZE, &seq_limit);
 
-        /* 传感器数据上报任务 (UDP) */
-        if(UDP_Client_Can_Send())
+        if (!Ctrl_Init(&Ctrl_Channel, Ctrl_Key, UART_Handler_Execute, Ctrl_Persist, has_limit ? &seq_limit : NULL,
+                       SysTick_Get_Ms()))
         {
-            if(DHT11_Read_Data(&dht_temp, &dht_humi) == 0)
-            {
-                sprintf(udp_buf, "Hello PC, Temp: %dC, Humi: %d%%", dht_temp, dht_humi);
-                UDP_Client_Send((u8*)udp_buf, strlen(udp_buf));
-            }
+            printf("UDP control port disabled: CTRL_KEY is a default or weak key.\r\n");
         }
+        else if (UDP_Client_Open_Control(CTRL_PORT, Ctrl_Recv_Callback) != 0)
+        {
+            printf("UDP control port disabled.\r\n");
+        }
+    }
+#else
+    printf("UDP control port disabled: no CTRL_KEY provisioned.\r\n");
+#endif
 
-        /* 本地传感器逻辑任务 */
-        Sensor_Task();
+    /* 注册任务, 轮询任务每轮都运行, 其余按周期运行 */
+    Sched_Init(Timebase_Get_Us);
+    Sched_Add("net", Net_Task, 0, SCHED_MS(NET_DEADLINE_MS));
+    Sched_Add("uart", UART_Handler_Task, 0, 0);
+    Sched_Add("zigbee", Zigbee_Handler_Task, SCHED_MS(ZIGBEE_PERIOD_MS), SCHED_MS(ZIGBEE_PERIOD_MS));
+    Sched_Add("actuator", Actuator_Task, SCHED_MS(ACTUATOR_PERIOD_MS), SCHED_MS(ACTUATOR_PERIOD_MS));
+    Sched_Add("dht11", DHT11_Task, SCHED_MS(DHT11_TASK_MS), SCHED_MS(DHT11_TASK_MS));
+    Sched_Add("sensor", Sensor_Task, SCHED_MS(SENSOR_PERIOD_MS), SCHED_MS(SENSOR_PERIOD_MS));
+    Sched_Add("telemetry", Telemetry_Task, SCHED_MS(TELEM_TASK_MS), SCHED_MS(TELEM_TASK_MS));
+    Sched_Add("stats", Stats_Task, SCHED_MS(STATS_PERIOD_MS), 0);
 
-        /* Zigbee报警应用逻辑任务 */
-        Zigbee_Handler_Task();
+    while(1)
+    {
+        Sched_Run_Once();
     }
 }
-
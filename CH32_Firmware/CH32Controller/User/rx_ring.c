@@ -0,0 +1,90 @@
+/*********************************************************************
+ * @file      rx_ring.c
+ * @author    Gemini
+ * @brief     DMA循环接收缓冲区的环形队列实现文件.
+ * @version   1.0
+ * @date      2026-10-16
+ *
+ * @copyright Copyright (c) 2025
+ *
+ *********************************************************************/
+#include "rx_ring.h"
+
+/**
+ * @brief  初始化环形队列.
+ * @return none.
+ */
+void Rx_Ring_Init(Rx_Ring_t *ring, const volatile uint8_t *buf, uint32_t size)
+{
+    ring->Buf = buf;
+    ring->Size = size;
+    ring->Head = 0;
+    ring->Tail = 0;
+    ring->Overflows = 0;
+    ring->Dropped = 0;
+    ring->Errors = 0;
+}
+
+/**
+ * @brief  根据DMA当前写位置推进 Head.
+ * @return none.
+ */
+void Rx_Ring_Update(Rx_Ring_t *ring, uint32_t dma_pos)
+{
+    uint32_t mask = ring->Size - 1;
+    uint32_t head = ring->Head;
+
+    // DMA计数器回绕后写位置为 Size, 与0等价
+    head += (dma_pos - head) & mask;
+    ring->Head = head;
+}
+
+/**
+ * @brief  读取数据.
+ * @return uint32_t - 实际读取的字节数.
+ */
+uint32_t Rx_Ring_Read(Rx_Ring_t *ring, uint8_t *out, uint32_t max)
+{
+    uint32_t mask = ring->Size - 1;
+    uint32_t avail = ring->Head - ring->Tail;
+    uint32_t i;
+
+    if(avail > ring->Size)
+    {
+        ring->Overflows++;
+        ring->Dropped += avail;
+        ring->Tail += avail;
+        return 0;
+    }
+    if(avail > max)
+    {
+        avail = max;
+    }
+    for(i = 0; i < avail; i++)
+    {
+        out[i] = ring->Buf[(ring->Tail + i) & mask];
+    }
+    ring->Tail += avail;
+    return avail;
+}
+
+/**
+ * @brief  记录一次串口接收错误.
+ * @return none.
+ */
+void Rx_Ring_Error(Rx_Ring_t *ring)
+{
+    ring->Errors++;
+}
+
+/**
+ * @brief  获取接收统计.
+ * @return none.
+ */
+void Rx_Ring_Get_Stats(const Rx_Ring_t *ring, Rx_Ring_Stats_t *stats)
+{
+    stats->Bytes = ring->Head;
+    stats->Overflows = ring->Overflows;
+    stats->Dropped = ring->Dropped;
+    stats->Errors = ring->Errors;
+}
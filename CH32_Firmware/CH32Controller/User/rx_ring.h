@@ -0,0 +1,92 @@
+/*********************************************************************
+ * @file      rx_ring.h
+ * @author    Gemini
+ * @brief     DMA循环接收缓冲区的环形队列头文件.
+ * @version   1.0
+ * @date      2026-10-16
+ *
+ * @copyright Copyright (c) 2025
+ *
+ * @note      DMA以循环模式写缓冲区, 中断中根据DMA写位置推进 Head, 主循环
+ *            (或中断下半部) 推进 Tail. Head/Tail 为自由递增的32位计数,
+ *            下标用 & (Size - 1) 计算, 因此 Size 必须为2的幂.
+ *            Head 只由生产者写, Tail 及溢出统计只由消费者写, 无需关中断.
+ *            本模块只依赖标准C头文件, 可在PC上测试.
+ *
+ *********************************************************************/
+#ifndef __RX_RING_H
+#define __RX_RING_H
+
+#include <stdint.h>
+
+/**
+ * @brief  环形队列控制块.
+ */
+typedef struct
+{
+    const volatile uint8_t *Buf;    // DMA目标缓冲区
+    uint32_t Size;                  // 缓冲区大小, 2的幂
+    volatile uint32_t Head;         // 已写入的总字节数 (生产者)
+    uint32_t Tail;                  // 已读出的总字节数 (消费者)
+    uint32_t Overflows;             // 检测到溢出的次数 (消费者)
+    uint32_t Dropped;               // 因溢出丢弃的字节数 (消费者)
+    volatile uint32_t Errors;       // 串口噪声/帧/过载错误次数 (生产者)
+} Rx_Ring_t;
+
+/**
+ * @brief  接收统计.
+ */
+typedef struct
+{
+    uint32_t Bytes;         // 累计接收字节数
+    uint32_t Overflows;
+    uint32_t Dropped;
+    uint32_t Errors;
+} Rx_Ring_Stats_t;
+
+/**
+ * @brief  初始化环形队列.
+ * @param  ring - 控制块.
+ * @param  buf  - DMA目标缓冲区.
+ * @param  size - 缓冲区大小, 必须为2的幂.
+ * @return none.
+ */
+void Rx_Ring_Init(Rx_Ring_t *ring, const volatile uint8_t *buf, uint32_t size);
+
+/**
+ * @brief  根据DMA当前写位置推进 Head (生产者, 通常在中断中调用).
+ * @note   两次调用之间DMA写入的字节数必须小于 Size, 即至少在每半圈
+ *         (DMA半传输/传输完成中断) 和每次总线空闲 (IDLE中断) 时调用.
+ * @param  ring    - 控制块.
+ * @param  dma_pos - DMA下一次写入的下标, 即 Size - 剩余传输计数.
+ * @return none.
+ */
+void Rx_Ring_Update(Rx_Ring_t *ring, uint32_t dma_pos);
+
+/**
+ * @brief  读取数据 (消费者).
+ * @note   若未读数据超过 Size, 说明DMA已覆盖未读数据, 此时丢弃全部未读
+ *         数据并计一次溢出, 由上层的帧解析重新同步.
+ * @param  ring - 控制块.
+ * @param  out  - 输出缓冲区.
+ * @param  max  - 最多读取的字节数.
+ * @return uint32_t - 实际读取的字节数.
+ */
+uint32_t Rx_Ring_Read(Rx_Ring_t *ring, uint8_t *out, uint32_t max);
+
+/**
+ * @brief  记录一次串口接收错误 (生产者).
+ * @param  ring - 控制块.
+ * @return none.
+ */
+void Rx_Ring_Error(Rx_Ring_t *ring);
+
+/**
+ * @brief  获取接收统计.
+ * @param  ring  - 控制块.
+ * @param  stats - 用于存储统计信息的指针.
+ * @return none.
+ */
+void Rx_Ring_Get_Stats(const Rx_Ring_t *ring, Rx_Ring_Stats_t *stats);
+
+#endif
@@ -0,0 +1,176 @@
+/*********************************************************************
+ * @file      scheduler.c
+ * @author    Gemini
+ * @brief     协作式任务调度器的实现文件.
+ * @version   1.0
+ * @date      2026-10-16
+ *
+ * @copyright Copyright (c) 2025
+ *
+ *********************************************************************/
+#include "scheduler.h"
+#include <stdio.h>
+#include <string.h>
+
+static Sched_Task_t Sched_Tasks[SCHED_MAX_TASKS];
+static int Sched_Count = 0;
+static Sched_Clock_t Sched_Clock = 0;
+
+/**
+ * @brief  判断时刻 t 是否已到达, 时钟回绕时依然正确.
+ */
+static uint8_t Time_Reached(uint32_t now, uint32_t t)
+{
+    return (int32_t)(now - t) >= 0;
+}
+
+/**
+ * @brief  运行一个任务并更新统计信息.
+ * @param  release - 本次运行的到期时刻.
+ */
+static void Sched_Run_Task(Sched_Task_t *task, uint32_t release)
+{
+    uint32_t start = Sched_Clock();
+    uint32_t end, run, jitter;
+
+    task->Func();
+    end = Sched_Clock();
+
+    run = end - start;
+    jitter = task->Period_Us ? start - release : start - task->Last_Start_Us;
+    if(task->Runs == 0 && task->Period_Us == 0)
+    {
+        jitter = 0;
+    }
+
+    task->Runs++;
+    task->Run_Last_Us = run;
+    task->Run_Total_Us += run;
+    if(run > task->Run_Max_Us)
+    {
+        task->Run_Max_Us = run;
+    }
+    if(jitter > task->Jitter_Max_Us)
+    {
+        task->Jitter_Max_Us = jitter;
+    }
+    if(task->Deadline_Us && end - release > task->Deadline_Us)
+    {
+        task->Overruns++;
+    }
+    task->Last_Start_Us = start;
+}
+
+void Sched_Init(Sched_Clock_t clock)
+{
+    Sched_Clock = clock;
+    Sched_Count = 0;
+    memset(Sched_Tasks, 0, sizeof(Sched_Tasks));
+}
+
+int Sched_Add(const char *name, Sched_Func_t func, uint32_t period_us, uint32_t deadline_us)
+{
+    Sched_Task_t *task;
+
+    if(Sched_Count >= SCHED_MAX_TASKS || func == 0)
+    {
+        return -1;
+    }
+    task = &Sched_Tasks[Sched_Count];
+    memset(task, 0, sizeof(Sched_Task_t));
+    task->Name = name;
+    task->Func = func;
+    task->Period_Us = period_us;
+    task->Deadline_Us = deadline_us;
+    task->Next_Us = Sched_Clock();
+    return Sched_Count++;
+}
+
+void Sched_Run_Once(void)
+{
+    for(int i = 0; i < Sched_Count; i++)
+    {
+        Sched_Task_t *task = &Sched_Tasks[i];
+        uint32_t now = Sched_Clock();
+        uint32_t release;
+
+        if(task->Period_Us == 0)
+        {
+            Sched_Run_Task(task, now);
+            continue;
+        }
+        if(!Time_Reached(now, task->Next_Us))
+        {
+            continue;
+        }
+
+        release = task->Next_Us;
+        task->Next_Us += task->Period_Us;
+        if(Time_Reached(now, task->Next_Us))
+        {
+            // 已错过整周期, 不补跑, 从当前时刻重新对齐
+            task->Skipped += (now - release) / task->Period_Us;
+            task->Next_Us = now + task->Period_Us;
+        }
+        Sched_Run_Task(task, release);
+    }
+}
+
+int Sched_Task_Count(void)
+{
+    return Sched_Count;
+}
+
+const Sched_Task_t *Sched_Get_Task(int id)
+{
+    if(id < 0 || id >= Sched_Count)
+    {
+        return 0;
+    }
+    return &Sched_Tasks[id];
+}
+
+void Sched_Reset_Stats(void)
+{
+    for(int i = 0; i < Sched_Count; i++)
+    {
+        Sched_Task_t *task = &Sched_Tasks[i];
+        task->Runs = 0;
+        task->Run_Last_Us = 0;
+        task->Run_Max_Us = 0;
+        task->Run_Total_Us = 0;
+        task->Jitter_Max_Us = 0;
+        task->Overruns = 0;
+        task->Skipped = 0;
+    }
+}
+
+int Sched_Format_Stats(char *buf, int size)
+{
+    int len = 0;
+
+    if(size <= 0)
+    {
+        return 0;
+    }
+    buf[0] = '\0';
+    for(int i = 0; i < Sched_Count && len < size; i++)
+    {
+        const Sched_Task_t *task = &Sched_Tasks[i];
+        uint32_t avg = task->Runs ? (uint32_t)(task->Run_Total_Us / task->Runs) : 0;
+        int n = snprintf(buf + len, size - len, "%s %lu %lu %lu %lu %lu %lu\n",
+                         task->Name,
+                         (unsigned long)task->Runs,
+                         (unsigned long)avg,
+                         (unsigned long)task->Run_Max_Us,
+                         (unsigned long)task->Jitter_Max_Us,
+                         (unsigned long)task->Overruns,
+                         (unsigned long)task->Skipped);
+        if(n < 0)
+        {
+            break;
+        }
+        len += n;
+    }
+    return len < size ? len : size - 1;
+}
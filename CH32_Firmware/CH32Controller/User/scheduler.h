@@ -0,0 +1,107 @@
+/*********************************************************************
+ * @file      scheduler.h
+ * @author    Gemini
+ * @brief     协作式任务调度器的头文件.
+ * @version   1.0
+ * @date      2026-10-16
+ *
+ * @copyright Copyright (c) 2025
+ *
+ * @note      主循环反复调用 Sched_Run_Once(), 按注册顺序运行到期的任务.
+ *            每个任务记录执行时间 (最大/平均)、启动抖动和超时次数, 用于
+ *            发现并约束阻塞代码对 WCHNET 轮询的影响.
+ *            本模块只依赖标准C头文件, 时钟由初始化时传入的回调提供,
+ *            可在PC上用模拟时钟测试.
+ *
+ *********************************************************************/
+#ifndef __SCHEDULER_H
+#define __SCHEDULER_H
+
+#include <stdint.h>
+
+#define SCHED_MAX_TASKS     12
+#define SCHED_MS(ms)        ((uint32_t)(ms) * 1000)    // 毫秒转换为微秒
+
+/**
+ * @brief  微秒时钟回调, 允许回绕.
+ */
+typedef uint32_t (*Sched_Clock_t)(void);
+
+/**
+ * @brief  任务函数.
+ */
+typedef void (*Sched_Func_t)(void);
+
+/**
+ * @brief  任务控制块及其统计信息.
+ */
+typedef struct
+{
+    const char *Name;
+    Sched_Func_t Func;
+    uint32_t Period_Us;     // 运行周期, 0 表示每次循环都运行 (轮询任务)
+    uint32_t Deadline_Us;   // 从到期到执行完毕的时限, 0 表示不检查
+    uint32_t Next_Us;       // 下一次到期时刻
+
+    uint32_t Runs;          // 运行次数
+    uint32_t Run_Last_Us;   // 最近一次执行时间
+    uint32_t Run_Max_Us;    // 最大执行时间
+    uint64_t Run_Total_Us;  // 累计执行时间, 用于计算平均值
+    uint32_t Jitter_Max_Us; // 周期任务: 最大启动延迟; 轮询任务: 最大启动间隔
+    uint32_t Overruns;      // 超过时限的次数
+    uint32_t Skipped;       // 因严重延迟而跳过的周期数
+    uint32_t Last_Start_Us;
+} Sched_Task_t;
+
+/**
+ * @brief  初始化调度器, 清空任务表.
+ * @param  clock - 微秒时钟回调.
+ * @return none.
+ */
+void Sched_Init(Sched_Clock_t clock);
+
+/**
+ * @brief  注册任务. 首次到期时刻为注册时刻.
+ * @param  name - 任务名 (需为静态字符串).
+ * @param  func - 任务函数.
+ * @param  period_us - 运行周期 (us), 0 表示轮询任务.
+ * @param  deadline_us - 时限 (us), 0 表示不检查.
+ * @return 任务编号, -1 表示任务表已满.
+ */
+int Sched_Add(const char *name, Sched_Func_t func, uint32_t period_us, uint32_t deadline_us);
+
+/**
+ * @brief  运行一轮: 依次执行所有到期的任务.
+ * @return none.
+ */
+void Sched_Run_Once(void);
+
+/**
+ * @brief  获取已注册的任务数.
+ * @return 任务数.
+ */
+int Sched_Task_Count(void);
+
+/**
+ * @brief  获取任务控制块 (只读).
+ * @param  id - 任务编号.
+ * @return 任务控制块指针, 编号无效时返回NULL.
+ */
+const Sched_Task_t *Sched_Get_Task(int id);
+
+/**
+ * @brief  清零所有任务的统计信息, 开始新的统计窗口.
+ * @return none.
+ */
+void Sched_Reset_Stats(void);
+
+/**
+ * @brief  将统计信息格式化为文本, 每个任务一行:
+ *         "name runs avg_us max_us jitter_us overruns skipped".
+ * @param  buf - 输出缓冲区.
+ * @param  size - 缓冲区大小.
+ * @return 写入的字符数 (不含结束符).
+ */
+int Sched_Format_Stats(char *buf, int size);
+
+#endif
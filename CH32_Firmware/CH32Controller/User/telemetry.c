@@ -0,0 +1,106 @@
+/*********************************************************************
+ * @file      telemetry.c
+ * @author    Gemini
+ * @brief     二进制遥测数据批量编码模块的实现文件.
+ * @version   1.0
+ * @date      2026-10-16
+ *
+ * @copyright Copyright (c) 2025
+ *
+ *********************************************************************/
+#include "telemetry.h"
+
+/**
+ * @brief  按小端写入16位数.
+ * @return none.
+ */
+static void Put_U16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+/**
+ * @brief  按小端写入32位数.
+ * @return none.
+ */
+static void Put_U32(uint8_t *p, uint32_t v)
+{
+    Put_U16(p, (uint16_t)v);
+    Put_U16(p + 2, (uint16_t)(v >> 16));
+}
+
+/**
+ * @brief  初始化批次.
+ * @return none.
+ */
+void Telem_Batch_Init(Telem_Batch_t *batch)
+{
+    batch->Count = 0;
+    batch->Seq = 0;
+    batch->Sample_Seq = 0;
+    batch->Base_Ms = 0;
+}
+
+/**
+ * @brief  追加一条采样.
+ * @return uint8_t - 1: 成功, 0: 需先发送.
+ */
+uint8_t Telem_Batch_Add(Telem_Batch_t *batch, const Telem_Sample_t *sample)
+{
+    uint8_t *rec;
+    uint32_t dt;
+
+    if(batch->Count >= TELEM_MAX_SAMPLES)
+    {
+        return 0;
+    }
+    if(batch->Count == 0)
+    {
+        batch->Base_Ms = sample->Time_Ms;
+    }
+    dt = sample->Time_Ms - batch->Base_Ms;
+    if(dt > 0xFFFF)
+    {
+        return 0;
+    }
+
+    rec = batch->Buf + TELEM_HEADER_SIZE + batch->Count * TELEM_RECORD_SIZE;
+    Put_U16(rec, (uint16_t)dt);
+    rec[2] = (uint8_t)sample->Temp;
+    rec[3] = sample->Humi;
+    Put_U16(rec + 4, sample->Light);
+    rec[6] = sample->State;
+    rec[7] = sample->Dht_Age_S;
+    batch->Count++;
+    return 1;
+}
+
+/**
+ * @brief  写入头部并开始下一批.
+ * @return uint16_t - 数据报长度.
+ */
+uint16_t Telem_Batch_Finish(Telem_Batch_t *batch, uint8_t flags)
+{
+    uint8_t *h = batch->Buf;
+    uint8_t count = batch->Count;
+
+    if(count == 0)
+    {
+        return 0;
+    }
+    h[0] = TELEM_MAGIC0;
+    h[1] = TELEM_MAGIC1;
+    h[2] = TELEM_VERSION;
+    h[3] = flags;
+    Put_U16(h + 4, batch->Seq);
+    h[6] = count;
+    h[7] = TELEM_RECORD_SIZE;
+    Put_U32(h + 8, batch->Sample_Seq);
+    Put_U32(h + 12, batch->Base_Ms);
+
+    batch->Seq++;
+    batch->Sample_Seq += count;
+    batch->Count = 0;
+    return TELEM_HEADER_SIZE + count * TELEM_RECORD_SIZE;
+}
@@ -0,0 +1,97 @@
+/*********************************************************************
+ * @file      telemetry.h
+ * @author    Gemini
+ * @brief     二进制遥测数据批量编码模块的头文件.
+ * @version   1.0
+ * @date      2026-10-16
+ *
+ * @copyright Copyright (c) 2025
+ *
+ * @par       数据报格式 (版本1, 多字节字段均为小端):
+ *            头部 16 字节:
+ *            | MAGIC u16 'T','M' | VER u8 | FLAGS u8 | SEQ u16 | COUNT u8 |
+ *            | REC_SIZE u8 | FIRST_SAMPLE u32 | BASE_MS u32 |
+ *            随后为 COUNT 条定长记录, 每条 REC_SIZE 字节:
+ *            | DT_MS u16 | TEMP i8 | HUMI u8 | LIGHT u16 | STATE u8 | DHT_AGE_S u8 |
+ *            - SEQ: 数据报序号, 接收端据此统计丢包.
+ *            - FIRST_SAMPLE: 第一条记录的采样序号, 后续记录依次加1.
+ *            - BASE_MS: 第一条记录的上电时间 (ms), DT_MS 为相对它的偏移.
+ *            - REC_SIZE: 新版本只在记录末尾追加字段, 旧解码器按此跳过.
+ *            解码器见仓库根目录的 udp_server.py, 修改格式时两边需同步.
+ *
+ *            本模块只依赖标准C头文件, 可在PC上测试.
+ *
+ *********************************************************************/
+#ifndef __TELEMETRY_H
+#define __TELEMETRY_H
+
+#include <stdint.h>
+
+#define TELEM_MAGIC0            'T'
+#define TELEM_MAGIC1            'M'
+#define TELEM_VERSION           1
+#define TELEM_HEADER_SIZE       16
+#define TELEM_RECORD_SIZE       8
+#define TELEM_MAX_SAMPLES       32
+#define TELEM_MAX_DATAGRAM      (TELEM_HEADER_SIZE + TELEM_MAX_SAMPLES * TELEM_RECORD_SIZE)
+
+// FLAGS
+#define TELEM_FLAG_EVENT        0x01    // 报警状态变化触发的立即发送
+
+// STATE
+#define TELEM_STATE_PIR         0x01    // 人体红外触发
+#define TELEM_STATE_SMOKE       0x02    // 烟雾传感器触发
+#define TELEM_STATE_ALARM       0x04    // Zigbee远程报警未清除
+#define TELEM_STATE_DHT_VALID   0x08    // TEMP/HUMI 有效
+#define TELEM_STATE_EVENT_MASK  (TELEM_STATE_PIR | TELEM_STATE_SMOKE | TELEM_STATE_ALARM)
+
+/**
+ * @brief  一次采样.
+ */
+typedef struct
+{
+    uint32_t Time_Ms;       // 上电时间
+    int8_t Temp;            // 温度 (C)
+    uint8_t Humi;           // 湿度 (%)
+    uint16_t Light;         // 光敏ADC原始值
+    uint8_t State;          // TELEM_STATE_*
+    uint8_t Dht_Age_S;      // DHT11数据年龄 (s), 最大255
+} Telem_Sample_t;
+
+/**
+ * @brief  正在累积的一批采样.
+ */
+typedef struct
+{
+    uint8_t Buf[TELEM_MAX_DATAGRAM];
+    uint8_t Count;          // 已累积的记录数
+    uint16_t Seq;           // 下一个数据报序号
+    uint32_t Sample_Seq;    // 下一条采样序号
+    uint32_t Base_Ms;       // 第一条记录的时间
+} Telem_Batch_t;
+
+/**
+ * @brief  初始化批次, 序号从0开始.
+ * @param  batch - 批次.
+ * @return none.
+ */
+void Telem_Batch_Init(Telem_Batch_t *batch);
+
+/**
+ * @brief  追加一条采样.
+ * @param  batch  - 批次.
+ * @param  sample - 采样.
+ * @return uint8_t - 1: 成功, 0: 批次已满或时间偏移超出 DT_MS 范围, 需先发送.
+ */
+uint8_t Telem_Batch_Add(Telem_Batch_t *batch, const Telem_Sample_t *sample);
+
+/**
+ * @brief  写入头部, 得到可发送的数据报, 并开始下一批.
+ * @note   返回后 batch->Buf 中的数据报在下一次 Telem_Batch_Add() 前保持有效.
+ * @param  batch - 批次.
+ * @param  flags - TELEM_FLAG_*.
+ * @return uint16_t - 数据报长度, 批次为空时返回0.
+ */
+uint16_t Telem_Batch_Finish(Telem_Batch_t *batch, uint8_t flags);
+
+#endif
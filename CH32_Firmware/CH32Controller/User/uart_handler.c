@@ -2,47 +2,207 @@
  * @file      uart_handler.c
  * @author    Gemini
  * @brief     串口命令处理模块的实现文件.
- * @version   1.0
- * @date      2025-06-07
+ * @version   2.2
+ * @date      2026-10-16
  *
  * @copyright Copyright (c) 2025
  *
+ * @par       通信协议:
+ *            ESP32-S3 通过二进制帧下发命令, 帧格式定义于共享头文件
+ *            link_protocol.h (同时被ESP32-S3固件使用):
+ *            | 0xA5 | 0x5A | LEN | SEQ | OP | PAYLOAD | CRC16 |
+ *            每个校验通过的数据帧回复 ACK, 校验失败回复 NACK, 由主机负责重传.
+ *            重传的重复帧 (SEQ与上一帧相同) 只确认不执行, 噪声字节不会触发任何动作.
+ *            主机启动后先发送 SYNC 帧, 从机以其SEQ作为最近序号, 主机重启后的
+ *            第一条命令不会因序号碰巧相同而被误判为重传.
+ *
+ * @par       执行模型:
+ *            接收由 DMA1_Channel5 循环搬运到环形缓冲区, USART1 IDLE中断和
+ *            DMA半传输/完成中断中批量解码、入队和回复确认, ACK/NACK 通过TXE
+ *            中断发送, 中断内不等待任何外设. 命令由主循环的 UART_Handler_Task()
+ *            从无锁队列取出执行, 蜂鸣器和门锁均为非阻塞状态机.
+ *
  *********************************************************************/
 #include "uart_handler.h"
 #include "string.h"
 #include "bsp_led.h"
 #include "bsp_buzzer.h"
 #include "bsp_servo.h"
+#include "cmd_queue.h"
+#include "bsp_uart_dma.h"
+
+#define DENIED_BEEP_MS  1000    // 识别失败时的鸣叫时长
 
-// 串口接收缓冲区
-#define RX_BUF_SIZE 64
-u8 RxBuffer[RX_BUF_SIZE];
-u8 RxCounter = 0;
+// ACK/NACK 发送缓冲区, 由接收中断写入、TXE中断取出, 大小必须为2的幂
+#define TX_BUF_SIZE 64
+static u8 TxBuffer[TX_BUF_SIZE];
+static u32 TxWrite = 0;
+static u32 TxRead = 0;
+
+// DMA接收缓冲区, 大小必须为2的幂, 至少容纳两个最长帧
+#define RX_BUF_SIZE 256
+static volatile u8 RxBuffer[RX_BUF_SIZE];
+static Uart_Dma_Rx_t Link_Rx;
+
+static link_decoder_t Link_Decoder;
+static Cmd_Queue_t Cmd_Queue;
+static u8 Link_LastSeq = 0;     // 最近入队的数据帧序号, 0 表示尚未收到
+static u32 Link_Commands = 0;
+static u32 Link_Duplicates = 0;
+static u32 Link_Malformed = 0;
+static u32 Link_Busy = 0;
 
 /**
- * @brief  解析并执行接收到的命令.
- * @param  cmd - 指向命令字符串的指针.
+ * @brief  将一帧写入发送缓冲区并开启TXE中断 (仅在USART1中断中调用).
  * @return none.
  */
-static void Parse_Command(const char *cmd)
+static void Link_Send_Frame(u8 seq, u8 op, const u8 *payload, u8 len)
 {
-    if (strcmp(cmd, "LED2ON") == 0)
+    u8 buf[LINK_HEADER_SIZE + 1 + LINK_CRC_SIZE];
+    size_t n = link_encode(buf, sizeof(buf), seq, op, payload, len);
+
+    // 缓冲区不足时放弃本帧, 主机会超时重传
+    if(n == 0 || TX_BUF_SIZE - (TxWrite - TxRead) < n)
     {
-        LED_On(LED2);
+        return;
     }
-    else if (strcmp(cmd, "LED2OFF") == 0)
+    for(size_t i = 0; i < n; i++)
     {
+        TxBuffer[TxWrite++ & (TX_BUF_SIZE - 1)] = buf[i];
+    }
+    USART_ITConfig(USART1, USART_IT_TXE, ENABLE);
+}
+
+/**
+ * @brief  回复 NACK.
+ * @return none.
+ */
+static void Link_Send_Nack(u8 seq, u8 reason)
+{
+    Link_Send_Frame(seq, LINK_OP_NACK, &reason, 1);
+}
+
+/**
+ * @brief  执行一条命令 (在主循环中调用).
+ * @note   串口命令与UDP控制通道的命令共用此函数.
+ * @return none.
+ */
+void UART_Handler_Execute(u8 op, const u8 *data, u8 len)
+{
+    // 兼容透传的文本命令 (如来自MQTT的 "LED2ON")
+    if(op == LINK_OP_TEXT)
+    {
+        op = link_opcode_from_text((const char *)data, len);
+    }
+
+    switch(op)
+    {
+    case LINK_OP_LED2_ON:
+        LED_On(LED2);
+        break;
+    case LINK_OP_LED2_OFF:
         LED_Off(LED2);
+        break;
+    case LINK_OP_ACCESS_GRANTED:
+        Servo_Unlock(SERVO_UNLOCK_HOLD_MS); // 开锁, 到时自动关锁
+        break;
+    case LINK_OP_ACCESS_DENIED:
+        Buzzer_Beep(1, DENIED_BEEP_MS, 0);  // 鸣叫1秒
+        break;
+    default:
+        // COLLECT / FACE_ENROLLED / VOICE_READY 以及未知文本命令: 仅确认
+        break;
+    }
+}
+
+/**
+ * @brief  处理一个校验通过的帧 (在USART1中断中调用).
+ * @note   只做检查、入队和确认, 耗时与帧长成正比且有上界.
+ * @return none.
+ */
+static void Handle_Frame(const link_frame_t *frame)
+{
+    u8 offset = 0;
+    u8 count = 0;
+    link_cmd_t cmd;
+
+    if(frame->op == LINK_OP_ACK || frame->op == LINK_OP_NACK || frame->seq == 0)
+    {
+        return;
+    }
+    if(frame->op == LINK_OP_SYNC)
+    {
+        // 主机开始新的会话, 重复的SYNC结果相同
+        Link_LastSeq = frame->seq;
+        Link_Send_Frame(frame->seq, LINK_OP_ACK, NULL, 0);
+        return;
+    }
+    if(frame->seq == Link_LastSeq)
+    {
+        // 主机未收到上次的ACK而重传, 只确认不执行
+        Link_Duplicates++;
+        Link_Send_Frame(frame->seq, LINK_OP_ACK, NULL, 0);
+        return;
+    }
+    if(!link_frame_is_well_formed(frame))
+    {
+        Link_Malformed++;
+        Link_Send_Nack(frame->seq, LINK_NACK_MALFORMED);
+        return;
+    }
+
+    // 整帧入队或整帧拒绝, 保证批量命令不会只执行一部分
+    while(link_frame_next_cmd(frame, &offset, &cmd))
+    {
+        if(cmd.len > CMD_QUEUE_DATA_MAX)
+        {
+            Link_Malformed++;
+            Link_Send_Nack(frame->seq, LINK_NACK_MALFORMED);
+            return;
+        }
+        count++;
     }
-    else if (strcmp(cmd, "RecSuccess") == 0) // 根据您的描述，这里假设是 RecSuccess
+    if(Cmd_Queue_Free(&Cmd_Queue) < count)
     {
-        Servo_SetAngle(90); // 开锁
+        Link_Busy++;
+        Link_Send_Nack(frame->seq, LINK_NACK_BUSY);
+        return;
     }
-    else if (strcmp(cmd, "ReFail") == 0)
+
+    offset = 0;
+    while(link_frame_next_cmd(frame, &offset, &cmd))
     {
-        Buzzer_On();
-        Delay_Ms(1000); // 鸣叫1秒
-        Buzzer_Off();
+        Cmd_Queue_Push(&Cmd_Queue, cmd.op, cmd.data, cmd.len);
+    }
+    Link_LastSeq = frame->seq;
+    Link_Send_Frame(frame->seq, LINK_OP_ACK, NULL, 0);
+}
+
+/**
+ * @brief  将DMA新收到的字节送入帧解码器 (在USART1或DMA中断中调用).
+ * @return none.
+ */
+static void Link_Rx_Process(void)
+{
+    u8 buf[16];
+    u32 n, i;
+
+    while((n = Rx_Ring_Read(&Link_Rx.Ring, buf, sizeof(buf))) > 0)
+    {
+        for(i = 0; i < n; i++)
+        {
+            switch(link_decoder_feed(&Link_Decoder, buf[i]))
+            {
+            case LINK_DEC_FRAME:
+                Handle_Frame(&Link_Decoder.frame);
+                break;
+            case LINK_DEC_CRC_ERROR:
+                Link_Send_Nack(Link_Decoder.frame.seq, LINK_NACK_CRC);
+                break;
+            default:
+                break;
+            }
+        }
     }
 }
 
@@ -56,6 +216,9 @@ void UART_Handler_Init(void)
     USART_InitTypeDef USART_InitStructure = {0};
     NVIC_InitTypeDef NVIC_InitStructure = {0};
 
+    link_decoder_init(&Link_Decoder);
+    Cmd_Queue_Init(&Cmd_Queue);
+
     // 1. 使能时钟
     RCC_APB2PeriphClockCmd(RCC_APB2Periph_USART1 | RCC_APB2Periph_GPIOA, ENABLE);
 
@@ -70,7 +233,7 @@ void UART_Handler_Init(void)
     GPIO_Init(GPIOA, &GPIO_InitStructure);
 
     // 3. 配置USART1
-    USART_InitStructure.USART_BaudRate = 115200;
+    USART_InitStructure.USART_BaudRate = LINK_BAUD_RATE;
     USART_InitStructure.USART_WordLength = USART_WordLength_8b;
     USART_InitStructure.USART_StopBits = USART_StopBits_1;
     USART_InitStructure.USART_Parity = USART_Parity_No;
@@ -78,19 +241,57 @@ void UART_Handler_Init(void)
     USART_InitStructure.USART_Mode = USART_Mode_Rx | USART_Mode_Tx;
     USART_Init(USART1, &USART_InitStructure);
 
-    // 4. 配置并使能接收中断
-    USART_ITConfig(USART1, USART_IT_RXNE, ENABLE);
+    // 4. 配置DMA循环接收 (USART1_RX -> DMA1_Channel5), TXE中断在有待发送数据时开启
+    Uart_Dma_Rx_Init(&Link_Rx, USART1, DMA1_Channel5, DMA1_IT_GL5, RxBuffer, RX_BUF_SIZE);
 
+    // 串口与DMA中断使用相同的抢占优先级, 解码器不会被重入
     NVIC_InitStructure.NVIC_IRQChannel = USART1_IRQn;
     NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = 1;
     NVIC_InitStructure.NVIC_IRQChannelSubPriority = 1;
     NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
     NVIC_Init(&NVIC_InitStructure);
 
+    NVIC_InitStructure.NVIC_IRQChannel = DMA1_Channel5_IRQn;
+    NVIC_Init(&NVIC_InitStructure);
+
     // 5. 使能USART1
     USART_Cmd(USART1, ENABLE);
 }
 
+/**
+ * @brief  串口命令处理任务.
+ * @return none.
+ */
+void UART_Handler_Task(void)
+{
+    Cmd_t cmd;
+
+    while(Cmd_Queue_Pop(&Cmd_Queue, &cmd))
+    {
+        UART_Handler_Execute(cmd.Op, cmd.Data, cmd.Len);
+        Link_Commands++;
+    }
+}
+
+/**
+ * @brief  获取UART1链路统计信息.
+ * @return none.
+ */
+void UART_Handler_Get_Stats(UART_Link_Stats_t *stats)
+{
+    NVIC_DisableIRQ(USART1_IRQn);
+    NVIC_DisableIRQ(DMA1_Channel5_IRQn);
+    Rx_Ring_Get_Stats(&Link_Rx.Ring, &stats->Rx);
+    stats->Frames = Link_Decoder.frames;
+    stats->Commands = Link_Commands;
+    stats->Busy = Link_Busy;
+    stats->Duplicates = Link_Duplicates;
+    stats->CRC_Errors = Link_Decoder.crc_errors;
+    stats->Len_Errors = Link_Decoder.len_errors + Link_Malformed;
+    stats->Junk_Bytes = Link_Decoder.junk_bytes;
+    NVIC_EnableIRQ(DMA1_Channel5_IRQn);
+    NVIC_EnableIRQ(USART1_IRQn);
+}
 
 /**
  * @brief  USART1中断服务函数.
@@ -99,30 +300,29 @@ void UART_Handler_Init(void)
  */
 void USART1_IRQHandler_Callback(void)
 {
-    if(USART_GetITStatus(USART1, USART_IT_RXNE) != RESET)
-    {
-        u8 res = USART_ReceiveData(USART1);
+    Uart_Dma_Rx_Usart_Isr(&Link_Rx);
+    Link_Rx_Process();
 
-        if(RxCounter < RX_BUF_SIZE)
+    if(USART_GetITStatus(USART1, USART_IT_TXE) != RESET)
+    {
+        if(TxRead != TxWrite)
         {
-            // 使用\r\n作为结束符
-            if(res == '\n' || res == '\r')
-            {
-                if(RxCounter > 0)
-                {
-                    RxBuffer[RxCounter] = '\0'; // 添加字符串结束符
-                    Parse_Command((const char*)RxBuffer);
-                    RxCounter = 0; // 重置计数器
-                }
-            }
-            else
-            {
-                RxBuffer[RxCounter++] = res;
-            }
+            USART_SendData(USART1, TxBuffer[TxRead++ & (TX_BUF_SIZE - 1)]);
         }
         else
         {
-            RxCounter = 0; // 缓冲区溢出，重置
+            USART_ITConfig(USART1, USART_IT_TXE, DISABLE);
         }
     }
-} 
\ No newline at end of file
+}
+
+/**
+ * @brief  DMA1通道5中断服务函数的回调.
+ * @note   此函数需要在 ch32v30x_it.c 中被调用.
+ * @return none.
+ */
+void DMA1_Channel5_IRQHandler_Callback(void)
+{
+    Uart_Dma_Rx_Dma_Isr(&Link_Rx);
+    Link_Rx_Process();
+}
@@ -2,8 +2,8 @@
  * @file      uart_handler.h
  * @author    Gemini
  * @brief     串口命令处理模块的头文件.
- * @version   1.0
- * @date      2025-06-07
+ * @version   2.0
+ * @date      2026-10-16
  *
  * @copyright Copyright (c) 2025
  *
@@ -12,11 +12,53 @@
 #define __UART_HANDLER_H
 
 #include "ch32v30x.h"
+#include "link_protocol.h"
+#include "rx_ring.h"
 
 /**
- * @brief  初始化UART1及其中断.
+ * @brief  UART1 链路统计信息, 用于衡量命令吞吐量和送达情况.
+ */
+typedef struct
+{
+    u32 Frames;      // 校验通过的数据帧
+    u32 Commands;    // 已执行的命令 (批量帧中的每条命令分别计数)
+    u32 Busy;        // 命令队列空间不足而回复 NACK 的帧
+    u32 Duplicates;  // 重传导致的重复帧, 仅确认不执行
+    u32 CRC_Errors;  // 校验失败并回复 NACK 的帧
+    u32 Len_Errors;  // 长度非法或批量格式错误的帧
+    u32 Junk_Bytes;  // 帧外被丢弃的字节
+    Rx_Ring_Stats_t Rx; // DMA接收缓冲区的溢出和线路错误统计
+} UART_Link_Stats_t;
+
+/**
+ * @brief  初始化UART1及其DMA接收.
+ * @note   波特率由共享协议头中的 LINK_BAUD_RATE 决定, 需与ESP32-S3侧保持一致.
  * @return none.
  */
 void UART_Handler_Init(void);
 
-#endif 
\ No newline at end of file
+/**
+ * @brief  串口命令处理任务, 需在主循环中周期调用.
+ * @note   中断只负责解码、确认和入队, 命令在此处执行.
+ * @return none.
+ */
+void UART_Handler_Task(void);
+
+/**
+ * @brief  执行一条命令, 需在主循环上下文中调用.
+ * @note   串口链路与UDP控制通道共用同一套命令处理.
+ * @param  op   - 操作码 (LINK_OP_*).
+ * @param  data - 命令负载.
+ * @param  len  - 负载长度.
+ * @return none.
+ */
+void UART_Handler_Execute(u8 op, const u8 *data, u8 len);
+
+/**
+ * @brief  获取UART1链路统计信息.
+ * @param  stats - 用于存储统计信息的指针.
+ * @return none.
+ */
+void UART_Handler_Get_Stats(UART_Link_Stats_t *stats);
+
+#endif
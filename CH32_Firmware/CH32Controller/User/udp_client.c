@@ -2,8 +2,8 @@
  * @file      udp_client.c
  * @author    Gemini
  * @brief     UDP客户端模块的实现文件 (兼容旧版API).
- * @version   2.4
- * @date      2025-06-08
+ * @version   2.5
+ * @date      2026-10-16
  *
  * @copyright Copyright (c) 2025
  *
@@ -21,11 +21,16 @@
  */
 #define UDP_CLIENT_PORT     1000
 #define UDP_SERVER_PORT     2000
+#define UDP_CTRL_BUF_LEN    512     // 控制数据报很短, 无需 RECE_BUF_LEN 大小的缓冲区
 
 u8 DestIP[4] = {192, 168, 1, 10};
 static u8 SocketId;
 static void (*p_app_socket_callback)(u8 sockeid, u8 intstat) = NULL;
 
+static u8 CtrlSocketId;
+static u8 CtrlRecvBuf[UDP_CTRL_BUF_LEN];
+static UDP_Client_Recv_t p_ctrl_recv_callback = NULL;
+
 /*
  *********************************************************************************
  *                                  内部函数
@@ -47,6 +52,26 @@ static void WCHNET_HandleSockInt_Private(u8 socketid, u8 intstat)
     }
 }
 
+/**
+ * @brief  控制socket的接收回调 (由WCHNET协议栈在主循环中调用).
+ * @note   此为模块内部函数. ipaddr 的最低字节为IP地址的第一段.
+ * @return none.
+ */
+static void WCHNET_CtrlRecv_Private(struct _SOCK_INF *socinf, u32 ipaddr, u16 port, u8 *buf, u32 len)
+{
+    u8 ip[4];
+    u8 i;
+
+    for(i = 0; i < 4; i++)
+    {
+        ip[i] = (u8)(ipaddr >> (i << 3));
+    }
+    if(p_ctrl_recv_callback && len <= 0xFFFF)
+    {
+        p_ctrl_recv_callback(ip, port, buf, (u16)len);
+    }
+}
+
 /*
  *********************************************************************************
  *                                  公共函数
@@ -122,19 +147,44 @@ u8 UDP_Client_Send(const u8 *p_data, u16 len)
     return WCHNET_SocketSend(SocketId, (u8 *)p_data, &send_len);
 }
 
-
 /**
- * @brief  检查是否可以发送UDP数据 (2秒间隔).
- * @return u8 - 1: 可以发送, 0: 时间未到.
+ * @brief  打开UDP控制端口, 接收任意主机发来的数据报.
+ * @param  port     - 本地监听端口.
+ * @param  callback - 数据报接收回调.
+ * @return u8 - WCHNET_ERR_SUCCESS (0) 表示成功, 其他表示失败.
  */
-u8 UDP_Client_Can_Send(void)
+u8 UDP_Client_Open_Control(u16 port, UDP_Client_Recv_t callback)
 {
-    static u32 last_send_time = 0;
+    u8 i;
+    SOCK_INF TmpSocketInf;
 
-    if (SysTick_Get_Ms() - last_send_time >= 2000)
-    {
-        last_send_time = SysTick_Get_Ms();
-        return 1;
+    p_ctrl_recv_callback = callback;
+
+    memset(&TmpSocketInf, 0, sizeof(SOCK_INF));
+    memset(TmpSocketInf.IPAddr, 0xFF, 4);   // 接收任意来源
+    TmpSocketInf.SourPort = port;
+    TmpSocketInf.ProtoType = PROTO_TYPE_UDP;
+    TmpSocketInf.RecvStartPoint = (u32)CtrlRecvBuf;
+    TmpSocketInf.RecvBufLen = UDP_CTRL_BUF_LEN;
+    TmpSocketInf.AppCallBack = WCHNET_CtrlRecv_Private;
+
+    i = WCHNET_SocketCreat(&CtrlSocketId, &TmpSocketInf);
+    if (i != WCHNET_ERR_SUCCESS) {
+        printf("UDP Control Socket Create Failed: %02X\r\n", i);
     }
-    return 0;
-} 
\ No newline at end of file
+    return i;
+}
+
+/**
+ * @brief  通过控制端口向指定主机发送数据 (如应答).
+ * @param  ip     - 目标IP.
+ * @param  port   - 目标端口.
+ * @param  p_data - 指向要发送数据的指针.
+ * @param  len    - 要发送的数据长度.
+ * @return u8     - WCHNET库的发送结果.
+ */
+u8 UDP_Client_Send_To(const u8 *ip, u16 port, const u8 *p_data, u16 len)
+{
+    u32 send_len = len;
+    return WCHNET_SocketUdpSendTo(CtrlSocketId, (u8 *)p_data, &send_len, (u8 *)ip, port);
+}
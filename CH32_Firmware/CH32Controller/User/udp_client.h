@@ -2,8 +2,8 @@
  * @file      udp_client.h
  * @author    Gemini
  * @brief     UDP客户端应用模块的头文件.
- * @version   1.0
- * @date      2025-06-07
+ * @version   1.1
+ * @date      2026-10-16
  *
  * @copyright Copyright (c) 2025
  *
@@ -14,6 +14,15 @@
 #include "wchnet.h"
 #include "eth_driver.h"
 
+/**
+ * @brief  控制端口数据报接收回调.
+ * @param  ip   - 发送方IP.
+ * @param  port - 发送方端口.
+ * @param  data - 数据报.
+ * @param  len  - 数据报长度.
+ */
+typedef void (*UDP_Client_Recv_t)(const u8 *ip, u16 port, const u8 *data, u16 len);
+
 /**
  * @brief  初始化UDP客户端, 并注册socket中断回调函数.
  * @param  p_socket_callback - 指向socket中断回调函数的指针.
@@ -36,9 +45,22 @@ u8 UDP_Client_Send(const u8 *p_data, u16 len);
 void UDP_Client_Handle_GlobalInt(void);
 
 /**
- * @brief  检查是否可以发送UDP数据 (2秒间隔).
- * @return u8 - 1: 可以发送, 0: 时间未到.
+ * @brief  打开UDP控制端口, 接收任意主机发来的数据报.
+ * @note   回调在 WCHNET_MainTask() 中被调用, 即运行在主循环上下文.
+ * @param  port     - 本地监听端口.
+ * @param  callback - 数据报接收回调.
+ * @return u8 - ERR_SUCCESS (0) 表示成功, 其他表示失败.
+ */
+u8 UDP_Client_Open_Control(u16 port, UDP_Client_Recv_t callback);
+
+/**
+ * @brief  通过控制端口向指定主机发送数据 (如应答).
+ * @param  ip     - 目标IP.
+ * @param  port   - 目标端口.
+ * @param  p_data - 指向要发送数据的指针.
+ * @param  len    - 要发送的数据长度.
+ * @return u8     - WCHNET库的发送结果.
  */
-u8 UDP_Client_Can_Send(void);
+u8 UDP_Client_Send_To(const u8 *ip, u16 port, const u8 *p_data, u16 len);
 
 #endif 
\ No newline at end of file
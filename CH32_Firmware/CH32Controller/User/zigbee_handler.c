@@ -2,8 +2,8 @@
  * @file      zigbee_handler.c
  * @author    Gemini
  * @brief     Zigbee应用逻辑处理模块的实现文件.
- * @version   1.0
- * @date      2025-06-08
+ * @version   1.1
+ * @date      2026-10-16
  *
  * @copyright Copyright (c) 2025
  *
@@ -30,8 +30,8 @@ void Zigbee_Handler_Task(void)
 {
     u8 zigbee_cmd;
 
-    // 1. 检查是否有新的报警命令
-    if(USART2_GetData(&zigbee_cmd))
+    // 1. 取出所有新的报警命令 (每条命令为单字节)
+    while(USART2_GetData(&zigbee_cmd))
     {
         if(zigbee_cmd == INFRARED_ALARM_CMD || zigbee_cmd == SMOKE_ALARM_CMD)
         {
@@ -39,15 +39,8 @@ void Zigbee_Handler_Task(void)
         }
     }
 
-    // 2. 根据报警标志控制蜂鸣器
-    if(g_alarm_active)
-    {
-        Buzzer_On();
-    }
-    else
-    {
-        Buzzer_Off();
-    }
+    // 2. 根据报警标志控制蜂鸣器 (与定时鸣叫共用蜂鸣器状态机)
+    Buzzer_Set_Alarm(g_alarm_active);
 }
 
 /**
@@ -56,4 +49,12 @@ void Zigbee_Handler_Task(void)
 void Zigbee_Clear_Alarm(void)
 {
     g_alarm_active = 0;
-} 
\ No newline at end of file
+} 
+
+/**
+ * @brief  查询报警状态.
+ */
+u8 Zigbee_Alarm_Active(void)
+{
+    return g_alarm_active;
+}
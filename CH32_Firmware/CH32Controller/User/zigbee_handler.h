@@ -32,5 +32,11 @@ void Zigbee_Handler_Task(void);
  */
 void Zigbee_Clear_Alarm(void);
 
+/**
+ * @brief  查询报警状态.
+ * @return u8 - 1: 报警中, 0: 无报警.
+ */
+u8 Zigbee_Alarm_Active(void);
+
 
 #endif // __ZIGBEE_HANDLER_H 
\ No newline at end of file
@@ -2080,7 +2080,8 @@ std::vector<ArgsType<feature_t>> get_activation_args(TensorBase *output,
     args.input_stride_x_offset = input->shape[3];
 
     args.output_element = (feature_t *)output->get_element_ptr();
-    args.output_height = output->shape[1];
+    // the rows of all the items of a batch are contiguous
+    args.output_height = output->shape[0] * output->shape[1];
     args.output_width = output->shape[2];
     args.output_channel = output->shape[3];
     // args.output_y_offset = output->shape[2] * output->shape[3];
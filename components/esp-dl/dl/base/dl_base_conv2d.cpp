@@ -613,8 +613,8 @@ inline void load_conv2d_33cn_s16(ImplFunc_t<int16_t, int16_t> &i_impl_func,
     return;
 
 #else // C/C++ implementation
-    c_impl_func_sp = conv2d_33cn<int16_t, int16_t, DL_S16_BUFFER_TYPE>;
-    c_impl_func = conv2d_hwcn<int16_t, int16_t, DL_S16_BUFFER_TYPE>;
+    c_impl_func_sp = conv2d_33cn<int16_t, DL_S16_BUFFER_TYPE>;
+    c_impl_func = conv2d_hwcn<int16_t, DL_S16_BUFFER_TYPE>;
     if (args.bias_element) {
         switch (args.activation_type) {
         case Linear:
@@ -837,7 +837,7 @@ inline void load_conv2d_hwcn_s16(ImplFunc_t<int16_t, int16_t> &i_impl_func,
     return;
 
 #else // C/C++ implement
-    c_impl_func_sp = conv2d_hwcn<int16_t, int16_t, DL_S16_BUFFER_TYPE>;
+    c_impl_func_sp = conv2d_hwcn<int16_t, DL_S16_BUFFER_TYPE>;
     c_impl_func = c_impl_func_sp;
     if (args.bias_element) {
         switch (args.activation_type) {
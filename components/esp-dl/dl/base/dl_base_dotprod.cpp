@@ -0,0 +1,67 @@
+#include "dl_base_dotprod.hpp"
+#include "dl_base_isa.hpp"
+
+namespace dl {
+namespace base {
+
+template <typename T>
+static int32_t c_impl_dotprod(const T *input0, const T *input1, const int length)
+{
+    int32_t sum0 = 0, sum1 = 0, sum2 = 0, sum3 = 0;
+    int i = 0;
+    for (; i + 4 <= length; i += 4) {
+        sum0 += input0[i] * input1[i];
+        sum1 += input0[i + 1] * input1[i + 1];
+        sum2 += input0[i + 2] * input1[i + 2];
+        sum3 += input0[i + 3] * input1[i + 3];
+    }
+    for (; i < length; i++) {
+        sum0 += input0[i] * input1[i];
+    }
+    return sum0 + sum1 + sum2 + sum3;
+}
+
+static inline bool simd_friendly(const void *input0, const void *input1, const int bytes)
+{
+    return (((uintptr_t)input0 | (uintptr_t)input1) & 0xf) == 0 && (bytes & 0xf) == 0 && bytes > 0;
+}
+
+int32_t dotprod(const int8_t *input0, const int8_t *input1, const int length)
+{
+#if CONFIG_TIE728_BOOST
+    if (simd_friendly(input0, input1, length)) {
+        return dl_tie728_s8_dotprod(input0, input1, length);
+    }
+#endif
+    return c_impl_dotprod(input0, input1, length);
+}
+
+int32_t dotprod(const int16_t *input0, const int16_t *input1, const int length)
+{
+#if CONFIG_TIE728_BOOST
+    if (simd_friendly(input0, input1, length * sizeof(int16_t))) {
+        return dl_tie728_s16_dotprod(input0, input1, length);
+    }
+#endif
+    return c_impl_dotprod(input0, input1, length);
+}
+
+float dotprod(const float *input0, const float *input1, const int length)
+{
+    // Four independent accumulators let the FPU pipeline the multiply-adds.
+    float sum0 = 0, sum1 = 0, sum2 = 0, sum3 = 0;
+    int i = 0;
+    for (; i + 4 <= length; i += 4) {
+        sum0 += input0[i] * input1[i];
+        sum1 += input0[i + 1] * input1[i + 1];
+        sum2 += input0[i + 2] * input1[i + 2];
+        sum3 += input0[i + 3] * input1[i + 3];
+    }
+    for (; i < length; i++) {
+        sum0 += input0[i] * input1[i];
+    }
+    return (sum0 + sum1) + (sum2 + sum3);
+}
+
+} // namespace base
+} // namespace dl
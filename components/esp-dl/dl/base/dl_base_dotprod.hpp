@@ -0,0 +1,24 @@
+#pragma once
+
+#include "dl_base.hpp"
+
+namespace dl {
+namespace base {
+/**
+ * @brief Dot product of two vectors.
+ *
+ * @note The ISA path is taken when both pointers are 16-byte aligned and the vectors are a multiple of 16 bytes
+ *       long, otherwise the C implementation is used. Integer results are accumulated in 32 bits, the caller is
+ *       responsible for choosing exponents that can not overflow.
+ *
+ * @tparam T        int8_t, int16_t or float
+ * @param input0    first vector
+ * @param input1    second vector
+ * @param length    number of elements
+ * @return int32_t for integer inputs, float for float inputs
+ */
+int32_t dotprod(const int8_t *input0, const int8_t *input1, const int length);
+int32_t dotprod(const int16_t *input0, const int16_t *input1, const int length);
+float dotprod(const float *input0, const float *input1, const int length);
+} // namespace base
+} // namespace dl
@@ -35,6 +35,25 @@ int calculate_elemwise_stride(std::vector<int> shape, int dim)
     return offset;
 }
 
+// Strides of a strided view in the convention of elemwise_loop_4d: d1 is added after each row, d2 and d3 after each
+// loop of the inner dims. Broadcast dims have a stride of 0.
+void calculate_elemwise_view_stride(TensorBase *input, const std::vector<int> &output_shape, int &d0, int strides[3])
+{
+    int dims = output_shape.size();
+    std::vector<int> shape(dims, 1);
+    std::vector<int> stride(dims, 0);
+    int offset = dims - input->shape.size();
+    for (int i = 0; i < input->shape.size(); i++) {
+        shape[offset + i] = input->shape[i];
+        stride[offset + i] = input->shape[i] == 1 ? 0 : input->axis_offset[i];
+    }
+    assert(shape[3] == 1 || stride[3] == 1);
+    d0 = shape[3];
+    strides[0] = stride[2];
+    strides[1] = stride[1] - output_shape[2] * stride[2];
+    strides[2] = stride[0] - output_shape[1] * stride[1];
+}
+
 template <typename in_feature_t, typename out_feature_t>
 std::vector<elemwiseArgsType<in_feature_t, out_feature_t>> get_elemwise_operation_args(
     TensorBase *output, TensorBase *input0, TensorBase *input1, const runtime_mode_t runtime_mode)
@@ -56,12 +75,38 @@ std::vector<elemwiseArgsType<in_feature_t, out_feature_t>> get_elemwise_operatio
         input1_shape.insert(input1_shape.begin(), dims - input1_dims, 1);
     }
 
+    int merged_dims = dims;
+    if (!input0->is_contiguous() || !input1->is_contiguous()) {
+        // strided views, see TensorBase::set_view(). The dims are not merged, the rows are walked with the axis
+        // offsets. GraphOptimizer only keeps views whose rows are contiguous and 16-byte aligned.
+        assert(dims <= 4);
+        output_shape.insert(output_shape.begin(), 4 - dims, 1);
+        int input0_strides[3];
+        int input1_strides[3];
+        calculate_elemwise_view_stride(input0, output_shape, args.input0_d0, input0_strides);
+        calculate_elemwise_view_stride(input1, output_shape, args.input1_d0, input1_strides);
+        args.output_element = output->get_element_ptr<out_feature_t>();
+        args.input0_element = input0->get_element_ptr<in_feature_t>();
+        args.input1_element = input1->get_element_ptr<in_feature_t>();
+        args.dims = 4;
+        args.output_d0 = output_shape[3];
+        args.output_d1 = output_shape[2];
+        args.output_d2 = output_shape[1];
+        args.output_d3 = output_shape[0];
+        args.input0_d1_stride = input0_strides[0];
+        args.input1_d1_stride = input1_strides[0];
+        args.input0_d2_stride = input0_strides[1];
+        args.input1_d2_stride = input1_strides[1];
+        args.input0_d3_stride = input0_strides[2];
+        args.input1_d3_stride = input1_strides[2];
+        merged_dims = 0;
+    }
+
     // Merge input0 and input1 shape
     // case1: (m,n) + (m,n) -> (m*n) + (m*n)
     // case2: (m,1) + (n,1) -> (m*n) + (1)
     // case3: (1,m) + (1,n) -> (1) + (m*n)
-    int merged_dims = dims;
-    for (int i = 0; i < dims; i++) {
+    for (int i = 0; merged_dims > 0 && i < dims; i++) {
         int j = i + 1;
         for (; j < dims; j++) {
             if (input0_shape[i] == input1_shape[i] && input0_shape[j] == input1_shape[j]) {
@@ -105,6 +150,8 @@ std::vector<elemwiseArgsType<in_feature_t, out_feature_t>> get_elemwise_operatio
     args.input0_element = input0->get_element_ptr<in_feature_t>();
     args.input1_element = input1->get_element_ptr<in_feature_t>();
     switch (merged_dims) {
+    case 0:
+        break; // strided views, assigned above
     case 1:
         args.dims = 1;
         args.output_d0 = output_shape[0];
@@ -157,7 +157,7 @@ std::vector<PoolArgsType<feature_t>> get_pool_args(TensorBase *output,
 #endif
     int c_div_x = args.input_channel / u;
     if (args.c_remainder != 0 && args.input_x_offset % u == 0 && args.output_x_offset % u == 0 &&
-        !((unsigned)&args.input_element[0] & 15) && !((unsigned)&args.output_element[0] & 15)) {
+        !((uintptr_t)&args.input_element[0] & 15) && !((uintptr_t)&args.output_element[0] & 15)) {
         c_div_x += 1;
     }
     args.c_div_x_1 = c_div_x - 1;
@@ -463,6 +463,9 @@ void dl_tie728_s16_lessorequal_w1_1_w2_8_unaligned(bool *output_ptr,
                                                    int16_t *input1_ptr,
                                                    void *args_ptr);
 
+int32_t dl_tie728_s8_dotprod(const int8_t *input0_ptr, const int8_t *input1_ptr, const int length);
+int32_t dl_tie728_s16_dotprod(const int16_t *input0_ptr, const int16_t *input1_ptr, const int length);
+
 #endif
 
 #if CONFIG_IDF_TARGET_ESP32P4
@@ -12,6 +12,16 @@
                                /*!< - 0: mute */
 #define DL_LOG_CACHE_COUNT 0   /*!< - 1: print the cache hit/miss count only for esp32p4 */
                                /*!< - 0: mute */
+#define DL_MODEL_PARALLEL_SCHEDULE 1 /*!< - 1: run independent branches of the model on both cores */
+                                     /*!< - 0: run the modules in topological order */
+#define DL_MEMORY_PLAN_CACHE 1       /*!< - 1: cache the memory plan in NVS and replay it on the next build */
+                                     /*!< - 0: run the memory manager on every build */
+#define DL_PARAM_PRELOAD_SIZE 4096  /*!< Bytes of the next module's flash parameters preloaded into the data cache */
+#define DL_GRAPH_OPTIMIZE 1          /*!< - 1: alias shape-only ops, write Concat inputs in place, fold exact requantize */
+                                     /*!< - 0: run the graph as exported */
+#define DL_GRAPH_FOLD_REQUANTIZE 0   /*!< - 1: also fold requantize with an exponent change into Conv/Gemm, rounds once */
+                                     /*!<      instead of twice, outputs may differ by 1 LSB from the test values */
+                                     /*!< - 0: only fold requantize that keeps the exponent */
 
 #if CONFIG_SPIRAM_SUPPORT || CONFIG_ESP32_SPIRAM_SUPPORT || CONFIG_ESP32S2_SPIRAM_SUPPORT || \
     CONFIG_ESP32S3_SPIRAM_SUPPORT || CONFIG_SPIRAM
@@ -179,4 +189,15 @@ typedef struct {
     std::string type; /*!< module type */
     uint32_t latency; /*!< module latency */
 } module_info;        /*!< module info */
+
+/**
+ * @brief module benchmark, latency statistics of repeated runs
+ *
+ */
+typedef struct {
+    std::string type; /*!< module type, empty for the whole model */
+    uint32_t min;     /*!< minimum latency */
+    uint32_t avg;     /*!< average latency */
+    uint32_t max;     /*!< maximum latency */
+} module_benchmark;   /*!< module benchmark */
 } // namespace dl
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "dl_model_context.hpp"
+#include "dl_model_graph_optimizer.hpp"
 #include "dl_module_base.hpp"
 #include "esp_heap_caps.h"
 #include "fbs_model.hpp"
@@ -13,20 +14,46 @@ namespace dl {
  */
 class MemoryManagerBase {
 public:
-    int alignment; /*!< The root pointer needs to be aligned must be a power of two */
+    int alignment;                   /*!< The root pointer needs to be aligned must be a power of two */
+    std::vector<int> schedule_order; /*!< Execution order as index into execution plan, empty for plan order */
+    std::vector<int> schedule_steps; /*!< Step of each module, modules of the same step may run concurrently */
+    bool pin_io;                     /*!< Place graph inputs and outputs in a private arena, see ModelArena */
+    int batch;                       /*!< Leading dimension of the graph inputs, see Model::set_batch_size() */
+    std::vector<graph_node_t> graph_nodes; /*!< Action of GraphOptimizer on each module, empty if not optimized */
 
     /**
      * @brief Construct a new Memory Manager Base object
      *
      * @param alignment Memory address alignment
      */
-    MemoryManagerBase(int alignment = 16) : alignment(alignment) {}
+    MemoryManagerBase(int alignment = 16) : alignment(alignment), pin_io(false), batch(1) {}
 
     /**
      * @brief Destroy the MemoryManager object. Return resource.
      */
     virtual ~MemoryManagerBase() {}
 
+    /**
+     * @brief Plan tensor lifetimes by step instead of by module. Tensors used by the modules of one step
+     * never share memory, and the modules of a step with several modules are not planned inplace.
+     *
+     * @param order  Execution order as index into execution plan
+     * @param steps  Step of each module, non-decreasing along order
+     */
+    void set_schedule(const std::vector<int> &order, const std::vector<int> &steps)
+    {
+        schedule_order = order;
+        schedule_steps = steps;
+    }
+
+    /**
+     * @brief Plan the modules removed by GraphOptimizer: the output of a removed shape-only op is a view of its
+     * input, the inputs of a removed Concat are slices of its output.
+     *
+     * @param nodes  Action of GraphOptimizer on each module, indexed as the execution plan
+     */
+    void set_graph_nodes(const std::vector<graph_node_t> &nodes) { graph_nodes = nodes; }
+
     /**
      * @brief Allocate memory for each tensor, include all input and output tensors
      *
@@ -56,7 +83,10 @@ private:
     uint32_t call_times;
     uint32_t offset;          // PSRAM offset
     uint32_t internal_offset; // Internal ram offset, used to allocate tensor on both PSRAM and internal ram
+    uint32_t pinned_offset;   // Offset in the private arena of graph inputs and outputs
+    uint32_t view_offset;     // Offset in the leader tensor, non-zero for the slices of an in-place Concat
     bool is_internal;
+    bool is_pinned;
     TensorInfo *m_leader_tensor;
     TensorInfo
         *m_follower_dirty_tensor; // Only reference the follower tensor which will modify the data of leader tensor.
@@ -90,9 +120,17 @@ public:
     /**
      * @brief Set the inplace leader tensor object
      *
-     * @param tensor Inplace leader tensor
+     * @param tensor       Inplace leader tensor
+     * @param view_offset  Offset of this tensor in the leader tensor, in bytes
      */
-    void set_inplace_leader_tensor(TensorInfo *tensor);
+    void set_inplace_leader_tensor(TensorInfo *tensor, uint32_t view_offset = 0);
+
+    /**
+     * @brief Get the tensor which owns the memory, following the inplace leaders
+     *
+     * @return TensorInfo* This tensor if it is not inplaced
+     */
+    TensorInfo *get_root_tensor() { return m_leader_tensor ? m_leader_tensor->get_root_tensor() : this; }
 
     /**
      * @brief Set the inplace follower tensor object
@@ -120,9 +158,10 @@ public:
      *
      * @param internal_root Internal RAM root pointer
      * @param psram_root    PSRAM root pointer
+     * @param pinned_root   Root pointer of the pinned tensors
      * @return TensorBase*
      */
-    TensorBase *create_tensor(void *internal_root, void *psram_root);
+    TensorBase *create_tensor(void *internal_root, void *psram_root, void *pinned_root = nullptr);
 
     /**
      * @brief Is inplaced or not
@@ -139,7 +178,7 @@ public:
     uint32_t get_offset()
     {
         if (m_leader_tensor) {
-            return m_leader_tensor->get_offset();
+            return m_leader_tensor->get_offset() + this->view_offset;
         }
         return this->offset;
     }
@@ -152,7 +191,7 @@ public:
     void set_offset(uint32_t offset)
     {
         if (m_leader_tensor) {
-            m_leader_tensor->set_offset(offset);
+            m_leader_tensor->set_offset(offset - this->view_offset);
         }
         this->offset = offset;
     }
@@ -165,7 +204,7 @@ public:
     uint32_t get_internal_offset()
     {
         if (m_leader_tensor) {
-            return m_leader_tensor->get_internal_offset();
+            return m_leader_tensor->get_internal_offset() + this->view_offset;
         }
         return this->internal_offset;
     }
@@ -204,13 +243,53 @@ public:
     void set_internal_offset(uint32_t offset)
     {
         if (m_leader_tensor) {
-            m_leader_tensor->set_internal_offset(offset);
+            m_leader_tensor->set_internal_offset(offset - this->view_offset);
             m_leader_tensor->set_internal_state(true);
         }
         this->is_internal = true;
         this->internal_offset = offset;
     }
 
+    /**
+     * @brief Get the pinned state
+     *
+     * @return true if the tensor is in the pinned arena else false
+     */
+    bool get_pinned_state()
+    {
+        if (m_leader_tensor) {
+            return m_leader_tensor->get_pinned_state();
+        }
+        return this->is_pinned;
+    }
+
+    /**
+     * @brief Get the offset in the pinned arena
+     *
+     * @return uint32_t
+     */
+    uint32_t get_pinned_offset()
+    {
+        if (m_leader_tensor) {
+            return m_leader_tensor->get_pinned_offset() + this->view_offset;
+        }
+        return this->pinned_offset;
+    }
+
+    /**
+     * @brief Place the tensor in the pinned arena
+     *
+     * @param offset
+     */
+    void set_pinned_offset(uint32_t offset)
+    {
+        if (m_leader_tensor) {
+            m_leader_tensor->set_pinned_offset(offset - this->view_offset);
+        }
+        this->is_pinned = true;
+        this->pinned_offset = offset;
+    }
+
     /**
      * @brief Get the liftetime end
      *
@@ -244,6 +323,13 @@ public:
      */
     size_t get_size() { return this->size; }
 
+    /**
+     * @brief Get the number of modules reading the tensor
+     *
+     * @return uint32_t
+     */
+    uint32_t get_call_times() { return this->call_times; }
+
     /**
      * @brief Get the tensor name
      *
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "dl_memory_manager_greedy.hpp"
+
+namespace dl {
+
+/**
+ * @brief Memory manager that solves tensor placement as an offset assignment over tensor lifetimes.
+ *
+ * Tensors are placed one by one at the smallest gap left between the tensors whose lifetime overlaps
+ * theirs (best fit), largest tensors first. Internal RAM is filled first with the tensors read by the
+ * most modules, the remaining tensors go to PSRAM. The arena sizes of the greedy planner are computed
+ * too and reported next to the best-fit ones.
+ */
+class MemoryManagerBestFit : public MemoryManagerGreedy {
+private:
+    size_t greedy_internal_size; /*!< Internal RAM arena size the greedy planner would use */
+    size_t greedy_psram_size;    /*!< PSRAM arena size the greedy planner would use */
+    size_t internal_size;        /*!< Internal RAM arena size of the best-fit plan */
+    size_t psram_size;           /*!< PSRAM arena size of the best-fit plan */
+
+    /**
+     * @brief Places tensors in the given order at the best fitting offset
+     * @param tensors Tensors to place, not inplaced
+     * @param step_num Number of lifetime steps
+     * @param capacity Arena capacity in bytes, tensors which don't fit are appended to rejected
+     * @param internal Write the offsets as internal RAM offsets
+     * @param rejected Tensors which don't fit in capacity
+     * @return size_t Arena size in bytes
+     */
+    size_t place(std::vector<TensorInfo *> &tensors,
+                 int step_num,
+                 size_t capacity,
+                 bool internal,
+                 std::vector<TensorInfo *> &rejected);
+
+public:
+    /**
+     * @brief Constructs a best-fit memory manager
+     * @param max_internal_size Maximum allowed internal RAM usage in bytes
+     * @param alignment Memory address alignment requirement (default: 16 bytes)
+     */
+    MemoryManagerBestFit(int max_internal_size, int alignment = 16) :
+        MemoryManagerGreedy(max_internal_size, alignment),
+        greedy_internal_size(0),
+        greedy_psram_size(0),
+        internal_size(0),
+        psram_size(0)
+    {
+    }
+
+    /**
+     * @brief Allocates memory for all network tensors following the best-fit strategy
+     * @param fbs_model FlatBuffer model containing network architecture
+     * @param execution_plan Execution graph ordered by computation dependencies
+     * @param context Device-specific runtime configuration
+     * @return bool True if successful allocation, false if memory insufficient
+     */
+    bool alloc(fbs::FbsModel *fbs_model, std::vector<dl::module::Module *> &execution_plan, ModelContext *context);
+
+    /**
+     * @brief Gets the arena sizes of the last plan
+     * @param internal Internal RAM arena size of the best-fit plan
+     * @param psram PSRAM arena size of the best-fit plan
+     * @param greedy_internal Internal RAM arena size the greedy planner would use
+     * @param greedy_psram PSRAM arena size the greedy planner would use
+     */
+    void get_plan_size(size_t &internal, size_t &psram, size_t &greedy_internal, size_t &greedy_psram)
+    {
+        internal = this->internal_size;
+        psram = this->psram_size;
+        greedy_internal = this->greedy_internal_size;
+        greedy_psram = this->greedy_psram_size;
+    }
+};
+} // namespace dl
@@ -9,7 +9,7 @@ namespace dl {
  * prioritizing internal RAM allocation first.
  */
 class MemoryManagerGreedy : public MemoryManagerBase {
-private:
+protected:
     size_t max_internal_size;                      /*!< Maximum allowed internal RAM usage in bytes.
                                                       Effective only when PSRAM is available */
     std::list<MemoryChunk *> psram_memory_list;    /*!< List of allocated PSRAM memory blocks */
@@ -76,6 +76,50 @@ private:
      */
     void free_memory_list();
 
+    /**
+     * @brief Gets the number of lifetime steps, one per module unless a schedule has been set
+     * @param execution_plan Topologically sorted list of computation modules
+     * @return int Number of steps
+     */
+    int get_step_num(std::vector<dl::module::Module *> &execution_plan);
+
+    /**
+     * @brief Places all tensors with the greedy strategy and releases the simulation memory lists
+     * @param tensor_info Vector containing metadata for all tensors, offsets are written back into it
+     * @param step_num Number of lifetime steps
+     * @param internal_size Output internal RAM arena size in bytes
+     * @param psram_size Output PSRAM arena size in bytes
+     */
+    void plan(std::vector<TensorInfo *> &tensor_info, int step_num, int &internal_size, int &psram_size);
+
+    /**
+     * @brief Places the graph inputs and outputs one after another in the pinned arena if pin_io is set
+     * @param fbs_model FlatBuffer model containing network architecture
+     * @param context Model context
+     * @param tensor_info Vector containing metadata for all tensors
+     * @param planned Output vector of the tensors left to plan in the internal RAM and PSRAM arenas
+     * @return size_t Pinned arena size in bytes
+     */
+    size_t pin_tensors(fbs::FbsModel *fbs_model,
+                       ModelContext *context,
+                       std::vector<TensorInfo *> &tensor_info,
+                       std::vector<TensorInfo *> &planned);
+
+    /**
+     * @brief Allocates the arenas, creates the tensors at their planned offsets and frees the TensorInfo objects
+     * @param context Model context receiving the tensors
+     * @param tensor_info Vector of planned tensors
+     * @param internal_size Internal RAM arena size in bytes
+     * @param psram_size PSRAM arena size in bytes
+     * @param pinned_size Pinned arena size in bytes
+     * @return bool True if successful allocation, false if memory insufficient
+     */
+    bool create_tensors(ModelContext *context,
+                        std::vector<TensorInfo *> &tensor_info,
+                        int internal_size,
+                        int psram_size,
+                        size_t pinned_size = 0);
+
 public:
     /**
      * @brief Constructs a greedy memory manager with specified constraints
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "dl_model_context.hpp"
+#include "dl_module_base.hpp"
+#include "esp_err.h"
+#include "fbs_model.hpp"
+
+namespace dl {
+
+/**
+ * @brief Memory plan cached in NVS.
+ *
+ * The planned offset, memory type, shape, dtype and exponent of every variable tensor and the arena sizes are
+ * stored after the first build, in one entry per model name. The entry carries a hash of the model graph with the
+ * shapes, dtypes and exponents of its values, the schedule, max_internal_size, the memory manager type, whether the
+ * graph inputs and outputs are pinned out of a shared arena and the batch size. The next build with the same hash
+ * creates the tensors straight from the cached plan instead of running the memory manager, a build with another hash
+ * plans again and replaces the entry. Every tensor of the entry is checked to lie within its arena before anything is
+ * allocated.
+ *
+ * The application must have called nvs_flash_init(), otherwise the cache is silently skipped.
+ */
+class MemoryPlanCache {
+public:
+    /**
+     * @brief Construct a memory plan cache entry.
+     *
+     * @param fbs_model          Flatbuffer's model, its map must be loaded
+     * @param execution_plan     Topological sorted module list
+     * @param steps              Step of each module, see ModelScheduler
+     * @param max_internal_size  max_internal_size passed to Model::build
+     * @param mm_type            Memory manager type passed to Model::build
+     * @param pin_io             Whether the graph inputs and outputs are pinned, see ModelArena
+     * @param batch              Batch size, see Model::set_batch_size()
+     */
+    MemoryPlanCache(fbs::FbsModel *fbs_model,
+                    std::vector<dl::module::Module *> &execution_plan,
+                    const std::vector<int> &steps,
+                    size_t max_internal_size,
+                    int mm_type,
+                    bool pin_io = false,
+                    int batch = 1);
+
+    /**
+     * @brief Create the variable tensors of the context from the cached plan.
+     *
+     * @param context    Model context
+     * @param alignment  Arena alignment
+     * @param plan_us    Time the memory manager took when the plan was cached, in microseconds
+     * @return
+     *      - ESP_OK                 The tensors have been created
+     *      - ESP_ERR_NOT_FOUND      No plan cached for this model and key, or the plan is corrupted
+     *      - ESP_ERR_NO_MEM         The arenas could not be allocated
+     */
+    esp_err_t replay(ModelContext *context, int alignment, uint32_t &plan_us);
+
+    /**
+     * @brief Store the plan of the context's variable tensors.
+     *
+     * @param context  Model context, built by a memory manager
+     * @param plan_us  Time the memory manager took, in microseconds
+     * @return esp_err_t
+     */
+    esp_err_t save(ModelContext *context, uint32_t plan_us);
+
+    /**
+     * @brief Erase all cached plans, e.g. after an OTA update of the models.
+     *
+     * @return esp_err_t
+     */
+    static esp_err_t clear();
+
+    /**
+     * @brief Get the key of this entry, the hash of the model and build configuration.
+     */
+    uint64_t get_key() { return m_key; }
+
+private:
+    uint64_t m_key;
+    char m_nvs_key[16];
+};
+
+} // namespace dl
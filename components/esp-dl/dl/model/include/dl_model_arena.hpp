@@ -0,0 +1,116 @@
+#pragma once
+
+#include "dl_model_context.hpp"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include <vector>
+
+namespace dl {
+
+/**
+ * @brief Activation memory shared by several models which run one after another.
+ *
+ * Every model planned in the arena places its intermediate tensors at the start of the same internal RAM and
+ * PSRAM buffers, so the arena only costs as much as the largest plan instead of the sum of all plans. The buffers
+ * grow when a bigger plan is registered, and the tensors of the models already registered are moved along.
+ *
+ * Graph inputs and outputs are pinned: each model keeps them in a private buffer. The preprocessor can fill the
+ * inputs and the postprocessor can read the outputs while another model of the arena runs.
+ *
+ * Model::run() holds the arena lock, so models sharing an arena never run at the same time, even from different
+ * tasks. The arena must outlive its models.
+ */
+class ModelArena {
+public:
+    /**
+     * @brief Construct an empty arena.
+     */
+    ModelArena();
+
+    /**
+     * @brief Destroy the arena. All models must have been destroyed or moved out of it.
+     */
+    ~ModelArena();
+
+    /**
+     * @brief Grow the arena to hold a memory plan and register the context using it.
+     *
+     * @param context        Model context, its tensors are moved when the arena grows later
+     * @param internal_size  Internal RAM size of the plan, in bytes
+     * @param psram_size     PSRAM size of the plan, in bytes
+     * @param alignment      Alignment of the plan
+     * @return True if the arena is large enough
+     */
+    bool reserve(ModelContext *context, size_t internal_size, size_t psram_size, int alignment);
+
+    /**
+     * @brief Unregister a context. The buffers are freed with the last context.
+     *
+     * @param context  Model context
+     */
+    void release(ModelContext *context);
+
+    /**
+     * @brief Take the arena, recursive. Hold it across several runs to keep the intermediate tensors of a model.
+     */
+    void lock() { xSemaphoreTakeRecursive(m_mutex, portMAX_DELAY); }
+
+    /**
+     * @brief Give the arena back.
+     */
+    void unlock() { xSemaphoreGiveRecursive(m_mutex); }
+
+    /**
+     * @brief Get the pointer to the internal RAM buffer.
+     */
+    void *get_internal_root() { return m_internal_root; }
+
+    /**
+     * @brief Get the pointer to the PSRAM buffer.
+     */
+    void *get_psram_root() { return m_psram_root; }
+
+    /**
+     * @brief Get the size of the buffers.
+     *
+     * @param mem_info  Size of the internal RAM and PSRAM buffers, in bytes
+     */
+    void get_memory_size(mem_info_t &mem_info);
+
+    /**
+     * @brief Get the number of models in the arena.
+     */
+    int get_model_count() { return m_contexts.size(); }
+
+private:
+    SemaphoreHandle_t m_mutex;
+    void *m_internal_root;
+    void *m_psram_root;
+    size_t m_internal_size;
+    size_t m_psram_size;
+    std::vector<ModelContext *> m_contexts;
+};
+
+/**
+ * @brief Holds the lock of an arena, if any, until it goes out of scope.
+ */
+class ModelArenaLock {
+public:
+    ModelArenaLock(ModelArena *arena) : m_arena(arena)
+    {
+        if (m_arena) {
+            m_arena->lock();
+        }
+    }
+    ~ModelArenaLock()
+    {
+        if (m_arena) {
+            m_arena->unlock();
+        }
+    }
+
+private:
+    ModelArena *m_arena;
+};
+
+} // namespace dl
@@ -1,7 +1,11 @@
 #pragma once
 
 #include "dl_memory_manager.hpp"
+#include "dl_model_arena.hpp"
 #include "dl_model_context.hpp"
+#include "dl_model_graph_optimizer.hpp"
+#include "dl_model_param_placement.hpp"
+#include "dl_model_scheduler.hpp"
 #include "dl_module_base.hpp"
 #include "esp_log.h"
 #include "fbs_loader.hpp"
@@ -37,8 +41,12 @@
 
 namespace dl {
 
-// currently only support MEMORY_MANAGER_GREEDY
-typedef enum { MEMORY_MANAGER_GREEDY = 0, LINEAR_MEMORY_MANAGER = 1 } memory_manager_t;
+// currently only support MEMORY_MANAGER_GREEDY and MEMORY_MANAGER_BEST_FIT
+typedef enum {
+    MEMORY_MANAGER_GREEDY = 0,
+    LINEAR_MEMORY_MANAGER = 1,
+    MEMORY_MANAGER_BEST_FIT = 2, ///< Best-fit offset assignment over tensor lifetimes, see MemoryManagerBestFit
+} memory_manager_t;
 
 /**
  * @brief Neural Network Model.
@@ -50,6 +58,9 @@ private:
     std::vector<dl::module::Module *>
         m_execution_plan; /*!< This represents a valid topological sort (dependency ordered) execution plan. */
     ModelContext *m_model_context = nullptr;       /*!< The pointer of model context */
+    ModelScheduler m_scheduler;                    /*!< Execution order and the steps run on both cores */
+    ParamPlacement m_param_placement;              /*!< Parameters read from memory-mapped flash */
+    GraphOptimizer m_graph_optimizer;              /*!< Modules removed from the execution plan at load time */
     std::map<std::string, TensorBase *> m_inputs;  /*!< The map of model input's name and TensorBase */
     std::map<std::string, TensorBase *> m_outputs; /*!< The map of model output's name and TensorBase */
     std::string m_name;                            /*!< The name of model */
@@ -57,6 +68,23 @@ private:
     std::string m_doc_string;                      /*!< doc string of model */
     size_t m_internal_size;                        /*!< Internal RAM usage */
     size_t m_psram_size;                           /*!< PSRAM usage */
+    uint32_t m_plan_us = 0;                        /*!< Time spent on the memory plan by the last build */
+    uint32_t m_plan_saved_us = 0;                  /*!< Build time saved by replaying a cached memory plan */
+    bool m_plan_cached = false;                    /*!< Whether the last build replayed a cached memory plan */
+    size_t m_max_internal_size = 0;                /*!< max_internal_size of the last build */
+    memory_manager_t m_mm_type = MEMORY_MANAGER_GREEDY; /*!< Memory manager type of the last build */
+    bool m_minimized = false;                      /*!< Whether minimize() has been called */
+    int m_batch_size = 1;                          /*!< Batch the memory is planned for */
+    int m_active_batch = 1;                        /*!< Batch the next run() computes */
+    std::vector<bool> m_batched;                   /*!< Whether each variable tensor has the batch as dimension 0 */
+
+    /**
+     * @brief Print the modules removed by the graph optimizer and the latency they would have cost.
+     *        The intermediate tensors are overwritten.
+     *
+     * @param latency  Latency of the optimized model, in the unit of DL_LOG_LATENCY_UNIT
+     */
+    void print_graph_optimization(uint32_t latency);
 
 public:
     Model() {}
@@ -252,7 +280,8 @@ public:
     /**
      * @brief Run the model module by module.
      *
-     * @param mode  Runtime mode.
+     * @param mode  Runtime mode. Except RUNTIME_MODE_SINGLE_CORE, independent branches of the model also run
+     *              concurrently on both cores, see ModelScheduler.
      */
     virtual void run(runtime_mode_t mode = RUNTIME_MODE_SINGLE_CORE);
 
@@ -314,7 +343,124 @@ public:
     void print_module_info(const std::map<std::string, module_info> &info, bool sort_module_by_latency = false);
 
     /**
-     * @brief Print model memory summary.
+     * @brief Run every module and the whole model repeatedly and collect latency statistics.
+     *
+     * @param iterations  Number of timed runs, after one warm-up run
+     * @param mode        Runtime mode of the modules and of the whole model
+     * @return Min, average and max latency of each module. The "total" entry is the latency of Model::run(mode),
+     *         which includes the modules running concurrently on both cores.
+     */
+    std::map<std::string, module_benchmark> get_module_benchmark(int iterations = 10,
+                                                                 runtime_mode_t mode = RUNTIME_MODE_SINGLE_CORE);
+
+    /**
+     * @brief Print the latency statistics obtained by get_module_benchmark function.
+     *
+     * Compare the output before and after a kernel or memory planner change to measure it on the device.
+     *
+     * @param iterations  Number of timed runs, after one warm-up run
+     * @param mode        Runtime mode of the modules and of the whole model
+     */
+    void benchmark(int iterations = 10, runtime_mode_t mode = RUNTIME_MODE_SINGLE_CORE);
+
+    /**
+     * @brief Share the activation memory of the model with other models which run one after another, e.g. a
+     *        detector and a feature extractor. The memory is planned again in the arena with the parameters of the
+     *        last build, the graph inputs and outputs are pinned in a private buffer, see ModelArena.
+     *
+     * Must be called before minimize(), and before the pre and postprocessors are created: the variable tensors are
+     * created again, so the pointers returned by get_inputs(), get_outputs() and get_intermediate() change.
+     *
+     * @param arena  Arena to join, it must outlive the model. nullptr to move back to private memory.
+     * @return
+     *      - ESP_OK                 The model has been planned in the arena
+     *      - ESP_ERR_INVALID_STATE  The model is not loaded or has been minimized
+     *      - ESP_FAIL               The memory could not be allocated, the model can't run
+     */
+    esp_err_t set_arena(ModelArena *arena);
+
+    /**
+     * @brief Plan the model for a batch of inputs, e.g. the aligned faces of one frame. The graph inputs get the
+     *        batch as leading dimension instead of the exported 1, the memory is planned again with the parameters
+     *        of the last build.
+     *
+     * The convolutions and poolings run one layer for the whole batch, so the parameters of a layer are read from
+     * flash or PSRAM once per run instead of once per input. The in-place Concats and the strided views made by the
+     * graph optimizer are undone, they only hold for a batch of 1.
+     *
+     * Only the modules which keep the leading dimension as the batch are supported: Conv, AveragePool, MaxPool,
+     * GlobalAveragePool, Gemm, Reshape, Flatten from an axis other than 0, the element-wise arithmetic and the
+     * activations. Resize, Pad, MatMul and the other modules compute their shapes or strides for a batch of 1.
+     *
+     * Same constraints as set_arena(): the pointers returned by get_inputs(), get_outputs() and get_intermediate()
+     * change.
+     *
+     * @param batch  Number of inputs per run
+     * @return
+     *      - ESP_OK                 The model has been planned for the batch, all the items are active
+     *      - ESP_ERR_INVALID_ARG    batch is less than 1
+     *      - ESP_ERR_INVALID_STATE  The model is not loaded or has been minimized
+     *      - ESP_ERR_NOT_SUPPORTED  A graph input has no leading dimension of 1, or a module does not support a batch
+     *      - ESP_FAIL               The memory could not be allocated, the model can't run
+     */
+    esp_err_t set_batch_size(int batch);
+
+    /**
+     * @brief Get the batch the model is planned for.
+     */
+    int get_batch_size() { return m_batch_size; }
+
+    /**
+     * @brief Run only the first items of the batch. The leading dimension of the batched tensors is set to batch,
+     *        no memory is planned again, so it can change between two runs.
+     *
+     * @param batch  Number of inputs of the next runs, 1 to get_batch_size()
+     * @return
+     *      - ESP_OK               The next runs compute batch items
+     *      - ESP_ERR_INVALID_ARG  batch is out of range
+     */
+    esp_err_t set_active_batch(int batch);
+
+    /**
+     * @brief Get the number of items computed by run().
+     */
+    int get_active_batch() { return m_active_batch; }
+
+    /**
+     * @brief Enable or disable the preload of the next module's flash parameters while a module runs.
+     *
+     * Only useful when the model is loaded with param_copy = false, so its parameters stay in memory-mapped flash.
+     * The data cache preload replaces the autoload for the whole application while it is enabled.
+     *
+     * @param enable  True to enable the preload
+     * @return True if the chip supports the preload
+     */
+    bool set_param_prefetch(bool enable);
+
+    /**
+     * @brief Copy the flash parameters of the modules that suffer most from reading them from flash into RAM.
+     *
+     * Every module with flash parameters is timed with its parameters in flash and in RAM, then the modules are
+     * pinned by latency saved per byte until the budget is used.
+     *
+     * @param budget      Maximum bytes of parameters copied to RAM
+     * @param caps        Memory to copy the parameters to
+     * @param iterations  Number of timed runs of each module and placement
+     * @return Bytes of parameters pinned in RAM
+     */
+    size_t pin_parameters(size_t budget, uint32_t caps = MALLOC_CAP_SPIRAM, int iterations = 3);
+
+    /**
+     * @brief Print the RAM saved by keeping the parameters in flash and the latency it costs, for each module
+     *        with flash parameters.
+     *
+     * @param iterations  Number of timed runs of each module and placement
+     * @param caps        Memory the parameters are copied to for the comparison
+     */
+    void profile_parameters(int iterations = 3, uint32_t caps = MALLOC_CAP_SPIRAM);
+
+    /**
+     * @brief Print model memory summary, and how long the memory plan took or how much time its cache saved.
      *
      */
     void profile_memory();
@@ -328,7 +474,9 @@ public:
     void profile_module(bool sort_module_by_latency = false);
 
     /**
-     * @brief Combination of profile_memory & profile_module.
+     * @brief Combination of profile_memory & profile_module, followed by the modules removed by the graph
+     *        optimizer and the latency saved, see GraphOptimizer, and the dual core dispatch counters, see
+     *        ModuleWorkerPool.
      *
      * @param sort_module_by_latency True The module is printed in latency decreasing sort.
      *                               False The module is printed in ONNX topological sort.
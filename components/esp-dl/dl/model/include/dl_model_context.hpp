@@ -7,6 +7,8 @@ namespace dl {
 
 #define CONTEXT_PARAMETER_OFFSET 10000000 /*!< Offset for parameter tensors */
 
+class ModelArena;
+
 /**
  * @brief Model Context class including variable tensors and parameters.
  */
@@ -20,6 +22,9 @@ private:
     void *m_internal_root;                   /*!< Internal root pointer */
     int m_psram_size;                        /*!< In bytes. PSRAM size usage. Only take effect when there's a PSRAM */
     int m_internal_size;                     /*!< In bytes. Internal size usage. */
+    void *m_pinned_root;                     /*!< Root pointer of the graph inputs and outputs pinned out of m_arena */
+    int m_pinned_size;                       /*!< In bytes. Pinned size usage. */
+    ModelArena *m_arena;                     /*!< Arena shared with other models, nullptr for private roots */
     std::map<std::string, int> m_name2index; /*!< Tensor name to index map
                                                >=0: variable tensor
                                                <0: parameter tensor */
@@ -50,6 +55,9 @@ public:
         m_internal_root = nullptr;
         m_psram_size = 0;
         m_internal_size = 0;
+        m_pinned_root = nullptr;
+        m_pinned_size = 0;
+        m_arena = nullptr;
     }
 
     /**
@@ -135,13 +143,70 @@ public:
 
     /**
      * @brief Allocates memory for PSRAM and internal roots.
+     * With an arena, the PSRAM and internal roots are taken from the arena and only the pinned root is allocated.
      *
      * @param internal_size The size of the internal memory in bytes.
      * @param psram_size The size of the PSRAM memory in bytes.
      * @param alignment The alignment of the memory in bytes.
+     * @param pinned_size The size of the pinned memory in bytes, in PSRAM if there's a PSRAM.
      * @return Bool Return true if the allocation is successful, false otherwise.
      */
-    bool root_alloc(size_t internal_size, size_t psram_size, int alignment = 16);
+    bool root_alloc(size_t internal_size, size_t psram_size, int alignment = 16, size_t pinned_size = 0);
+
+    /**
+     * @brief Moves the variable tensors to new PSRAM and internal roots, called by the arena when it grows.
+     *
+     * @param internal_root The new internal root.
+     * @param psram_root The new PSRAM root.
+     */
+    void rebase(void *internal_root, void *psram_root);
+
+    /**
+     * @brief Sets the arena the next root_alloc() takes the PSRAM and internal roots from.
+     *
+     * @param arena The arena, nullptr for private roots.
+     */
+    void set_arena(ModelArena *arena) { m_arena = arena; }
+
+    /**
+     * @brief Gets the arena of the context.
+     *
+     * @return ModelArena* Returns the arena, or nullptr if the roots are private.
+     */
+    ModelArena *get_arena() { return m_arena; }
+
+    /**
+     * @brief Gets the pointer to the pinned root.
+     *
+     * @return Void* Returns the pointer to the pinned root.
+     */
+    void *get_pinned_root() { return m_pinned_root; }
+
+    /**
+     * @brief Gets the size of the internal root, the pinned buffer excluded.
+     *
+     * @return Size in bytes.
+     */
+    size_t get_internal_size() { return m_internal_size; }
+
+    /**
+     * @brief Gets the size of the PSRAM root, the pinned buffer excluded.
+     *
+     * @return Size in bytes.
+     */
+    size_t get_psram_size() { return m_psram_size; }
+
+    /**
+     * @brief Gets the size of the pinned buffer.
+     *
+     * @return Size in bytes.
+     */
+    size_t get_pinned_size() { return m_pinned_size; }
+
+    /**
+     * @brief Deletes the variable tensors and frees the roots, so that the memory can be planned again.
+     */
+    void variables_free();
 
     /**
      * @brief Gets the pointer to the PSRAM root.
@@ -178,18 +243,7 @@ public:
      * @brief Frees the memory allocated for PSRAM and internal roots.
      * This function ensures proper cleanup of allocated memory.
      */
-    void root_free()
-    {
-        // In IDF, free(p) is equivalent to heap_caps_free(p).
-        if (m_internal_root) {
-            free(m_internal_root);
-            m_internal_root = nullptr;
-        }
-        if (m_psram_root) {
-            free(m_psram_root);
-            m_psram_root = nullptr;
-        }
-    }
+    void root_free();
 
     /**
      * @brief Minimizes the context by clearing the name-to-index map.
@@ -207,7 +261,7 @@ public:
      */
     void clear()
     {
-        if (m_internal_root || m_psram_root) {
+        if (m_internal_root || m_psram_root || m_pinned_root) {
             for (int i = 0; i < m_variables.size(); i++) {
                 delete m_variables[i];
             }
@@ -0,0 +1,112 @@
+#pragma once
+
+#include "dl_model_context.hpp"
+#include "dl_module_base.hpp"
+#include "fbs_model.hpp"
+
+namespace dl {
+
+/**
+ * @brief What the graph optimizer did with a module of the execution plan.
+ */
+typedef enum {
+    GRAPH_NODE_KEPT = 0,   ///< Runs as exported
+    GRAPH_NODE_FOLDED = 1, ///< RequantizeLinear folded into the output stage of its Conv/Gemm producer, no inputs or
+                           ///< outputs left
+    GRAPH_NODE_ALIAS = 2,  ///< Shape-only op, its output is planned as a view of its input
+    GRAPH_NODE_CONCAT = 3, ///< Concat whose inputs are planned as slices of its output, so the producers write there
+} graph_node_t;
+
+/**
+ * @brief Load-time optimization of the execution plan.
+ *
+ * The execution plan is a 1:1 image of the exported graph, every node costs at least one pass over its output.
+ * This pass removes the nodes whose work can be done by the memory plan or by the producer:
+ * - RequantizeLinear after a Conv or Gemm whose output is read only by it: the producer writes the requantized
+ *   output directly, with the exponent of the RequantizeLinear output.
+ * - Reshape, Squeeze, Unsqueeze, Flatten and Identity whose input is read only by them: the output is planned as a
+ *   view of the input, see TensorInfo::set_inplace_leader_tensor().
+ * - Concat whose inputs are contiguous slices of its output, i.e. all dimensions before the axis are 1: every input
+ *   is planned at its offset in the output, so the producers write their slice directly.
+ *
+ * Slice, Split and Transpose whose outputs are only read by Concat, RequantizeLinear or the quantized elementwise
+ * ops are kept but switched to MODULE_INPLACE_VIEW: their outputs become strided views of the input, which the
+ * readers consume without a copy. The elementwise kernels need contiguous 16-byte aligned rows, pooling and
+ * convolution need dense input, so those views are not made.
+ *
+ * The removed modules stay in the execution plan, so the indices into it and the node names still match. They are
+ * planned by the memory manager, see MemoryManagerBase::set_graph_nodes(), but never run, see ModelScheduler.
+ */
+class GraphOptimizer {
+public:
+    /**
+     * @brief Optimize the execution plan. The modules' input and output indices may be rewired.
+     *
+     * @param fbs_model       Flatbuffer's model, its map must be loaded
+     * @param execution_plan  Topological sorted module list, with inputs and outputs index assigned
+     * @param context         Model context holding the parameters
+     */
+    void optimize(fbs::FbsModel *fbs_model,
+                  std::vector<dl::module::Module *> &execution_plan,
+                  ModelContext *context);
+
+    /**
+     * @brief Forget the optimization, every module is kept.
+     */
+    void clear();
+
+    /**
+     * @brief Undo what only holds for a batch of 1. With a batch, the dimension before the Concat axis is no longer
+     *        1 and the strided views get a batch stride the kernels do not expect: the in-place Concats run again and
+     *        the views are copied again. They are not made again when the batch goes back to 1.
+     *
+     * @param execution_plan  The execution plan passed to optimize()
+     * @param batch           Batch size the model is planned for
+     */
+    void set_batch_size(std::vector<dl::module::Module *> &execution_plan, int batch);
+
+    /**
+     * @brief Get what has been done with each module.
+     *
+     * @return Action of each module, indexed as the execution plan, empty if optimize() has not been called
+     */
+    const std::vector<graph_node_t> &get_nodes() const { return m_nodes; }
+
+    /**
+     * @brief Get the number of removed modules.
+     *
+     * @param node  Count only this action, GRAPH_NODE_KEPT for all removed modules
+     * @return Number of modules
+     */
+    int get_removed_count(graph_node_t node = GRAPH_NODE_KEPT) const;
+
+    /**
+     * @brief Get the number of modules switched to MODULE_INPLACE_VIEW.
+     *
+     * @return Number of modules
+     */
+    int get_view_count() const { return m_views.size(); }
+
+    /**
+     * @brief Replay the work of the removed modules and the copies replaced by strided views from the planned
+     *        tensors into a scratch buffer, and measure it. The planned tensors are left untouched.
+     *
+     * @param execution_plan  The execution plan passed to optimize()
+     * @param context         Model context, with the variable tensors created
+     * @return Latency the removed work would have cost, in the unit of DL_LOG_LATENCY_UNIT, 0 if the scratch buffer
+     *         could not be allocated
+     */
+    uint32_t measure_removed(std::vector<dl::module::Module *> &execution_plan, ModelContext *context);
+
+private:
+    typedef struct {
+        int output;   ///< Tensor index of the RequantizeLinear output, now written by the producer
+        int exponent; ///< Exponent of the RequantizeLinear input before folding
+    } folded_t;
+
+    std::vector<graph_node_t> m_nodes;
+    std::vector<folded_t> m_folded;
+    std::vector<int> m_views; ///< Modules switched to MODULE_INPLACE_VIEW
+};
+
+} // namespace dl
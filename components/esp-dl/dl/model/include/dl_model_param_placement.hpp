@@ -0,0 +1,122 @@
+#pragma once
+
+#include "dl_model_context.hpp"
+#include "dl_module_base.hpp"
+
+namespace dl {
+
+/**
+ * @brief Placement of one module's parameters that are read from memory-mapped flash.
+ */
+typedef struct {
+    size_t bytes;      /*!< Bytes of the module's parameters in flash */
+    uint32_t flash_us; /*!< Average latency with the parameters read from flash, 0 if not profiled */
+    uint32_t ram_us;   /*!< Average latency with the parameters copied to RAM, 0 if not profiled */
+    bool pinned;       /*!< Whether the parameters have been copied to RAM */
+} param_placement_t;
+
+/**
+ * @brief Keeps model parameters in memory-mapped flash and decides which ones are worth a copy in RAM.
+ *
+ * When a model is loaded with param_copy = false, the parameters of a plaintext EDL2 model point into the
+ * memory-mapped flash instead of being copied to PSRAM. Reading them goes through the flash cache, which is
+ * slower than PSRAM for the layers that read their weights many times. This class tracks those parameters per
+ * module and can:
+ * - preload the beginning of the next module's parameters into the data cache while the current module runs,
+ * - measure the latency cost of every module reading its parameters from flash,
+ * - pin the parameters of the modules with the highest cost per byte into RAM, within a byte budget.
+ *
+ * Pinned tensors own their RAM copy (auto_free), so they are released with the model context.
+ */
+class ParamPlacement {
+public:
+    /**
+     * @brief Collect the parameters that are in flash, grouped by the first module reading them.
+     *        The parameters pinned before are moved back to flash first.
+     *
+     * @param execution_plan  Topological sorted module list, with inputs index assigned
+     * @param context         Model context holding the parameters
+     */
+    void build(std::vector<dl::module::Module *> &execution_plan, ModelContext *context);
+
+    /**
+     * @brief Unpin all parameters and forget them.
+     */
+    void clear();
+
+    /**
+     * @brief Enable or disable the preload of the next module's parameters.
+     *        Enabling it turns on the data cache preload, which turns off the autoload, see dl::tool::cache.
+     *
+     * @param enable  True to enable the preload
+     * @return True if the chip supports the preload
+     */
+    bool set_prefetch(bool enable);
+
+    /**
+     * @brief Start the preload of a module's parameters if they are in flash and the preload is enabled.
+     *
+     * @param module  Index into the execution plan
+     */
+    void prefetch(int module);
+
+    /**
+     * @brief Measure the latency of every module with flash parameters, with the parameters in flash and
+     *        copied to RAM. The model must have run once, so the inputs of every module are valid.
+     *
+     * @param execution_plan  The execution plan passed to build()
+     * @param context         Model context
+     * @param iterations      Number of runs of each module and placement
+     * @param caps            Memory to copy the parameters to
+     */
+    void profile(std::vector<dl::module::Module *> &execution_plan,
+                 ModelContext *context,
+                 int iterations,
+                 uint32_t caps);
+
+    /**
+     * @brief Pin the parameters of the modules with the highest latency cost per byte into RAM.
+     *        Modules not profiled are ranked by size, smallest first.
+     *
+     * @param budget  Maximum bytes copied to RAM, including the parameters already pinned
+     * @param caps    Memory to copy the parameters to
+     * @return Bytes pinned in RAM
+     */
+    size_t pin(size_t budget, uint32_t caps);
+
+    /**
+     * @brief Move all pinned parameters back to flash.
+     */
+    void unpin();
+
+    /**
+     * @brief Get the placement of each module.
+     *
+     * @return Placement of each module, indexed as the execution plan
+     */
+    const std::vector<param_placement_t> &get_placement() const { return m_placement; }
+
+    /**
+     * @brief Get the bytes of parameters read from flash and pinned in RAM.
+     *
+     * @param flash   Bytes of parameters read from flash
+     * @param pinned  Bytes of parameters pinned in RAM
+     */
+    void get_size(size_t &flash, size_t &pinned);
+
+private:
+    typedef struct {
+        TensorBase *tensor;
+        void *flash_data; ///< Element pointer into the memory-mapped flash
+    } flash_param_t;
+
+    bool move_to_ram(int module, uint32_t caps);
+    void move_to_flash(int module);
+    uint32_t measure(dl::module::Module *module, ModelContext *context, int iterations);
+
+    std::vector<std::vector<flash_param_t>> m_params; ///< Flash parameters of each module
+    std::vector<param_placement_t> m_placement;       ///< Placement of each module
+    bool m_prefetch = false;
+};
+
+} // namespace dl
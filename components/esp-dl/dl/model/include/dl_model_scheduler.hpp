@@ -0,0 +1,107 @@
+#pragma once
+
+#include "dl_model_context.hpp"
+#include "dl_model_graph_optimizer.hpp"
+#include "dl_model_param_placement.hpp"
+#include "dl_module_base.hpp"
+
+namespace dl {
+
+/**
+ * @brief Inter-layer scheduler of a model.
+ *
+ * The dependency graph of the execution plan is built from the modules' input and output tensor indices.
+ * Every module is assigned to a step, one more than the latest step of its producers, so the modules of one
+ * step never depend on each other. Steps run in order. The modules of a step with several independent
+ * branches, e.g. the heads of a detection model or the inputs of a Concat, are split into two groups of
+ * similar latency, one of them runs on the other core through ModuleWorkerPool.
+ *
+ * The memory manager plans tensor lifetimes by step instead of by module, see MemoryManagerBase::set_schedule(),
+ * so tensors used in the same step never share memory. Running the steps sequentially is always valid too.
+ *
+ * The modules removed by GraphOptimizer take the step of their producers. They are part of the plan order given to
+ * the memory manager, but not of the execution order.
+ *
+ * Every module run is recorded by dl::tool::Tracer when it is enabled.
+ */
+class ModelScheduler {
+public:
+    /**
+     * @brief Build the steps of an execution plan.
+     *
+     * @param execution_plan  Topological sorted module list, with inputs and outputs index assigned
+     * @param nodes           Action of GraphOptimizer on each module, empty if the graph is not optimized
+     */
+    void build(std::vector<dl::module::Module *> &execution_plan, const std::vector<graph_node_t> &nodes = {});
+
+    /**
+     * @brief Clear the schedule.
+     */
+    void clear();
+
+    /**
+     * @brief Get the execution order.
+     *
+     * @return Index into execution plan of each module that runs, sorted by step
+     */
+    const std::vector<int> &get_order() const { return m_order; }
+
+    /**
+     * @brief Get the order the memory is planned in, the execution order plus the modules removed by GraphOptimizer.
+     *
+     * @return Index into execution plan of each module, sorted by step
+     */
+    const std::vector<int> &get_plan_order() const { return m_plan_order; }
+
+    /**
+     * @brief Get the step of each module.
+     *
+     * @return Step of each module, indexed as the execution plan
+     */
+    const std::vector<int> &get_steps() const { return m_steps; }
+
+    /**
+     * @brief Run the execution plan step by step.
+     *
+     * @param execution_plan  The execution plan passed to build()
+     * @param context         Model context
+     * @param mode            RUNTIME_MODE_SINGLE_CORE runs the modules one after the other on the calling task.
+     *                        Otherwise the steps with several modules run on both cores.
+     * @param params          If not nullptr, the flash parameters of the next module are preloaded while a
+     *                        module runs alone
+     */
+    void run(std::vector<dl::module::Module *> &execution_plan,
+             ModelContext *context,
+             runtime_mode_t mode,
+             ParamPlacement *params = nullptr);
+
+    /**
+     * @brief Run one module, recorded by dl::tool::Tracer when it is enabled.
+     *
+     * @param module   Module to run
+     * @param index    Index of the module in the execution plan
+     * @param context  Model context
+     * @param mode     Runtime mode passed to forward()
+     */
+    static void forward(dl::module::Module *module, int index, ModelContext *context, runtime_mode_t mode);
+
+private:
+    typedef struct {
+        ModelScheduler *scheduler;
+        std::vector<dl::module::Module *> *execution_plan;
+        ModelContext *context;
+        std::vector<int> *modules; ///< Index into execution plan of the modules of the group
+    } group_job_t;
+
+    static void run_group(void *arg);
+    void split_step(int begin, int end);
+
+    std::vector<int> m_order;           ///< Index into execution plan of the modules that run, sorted by step
+    std::vector<int> m_plan_order;      ///< Index into execution plan of all modules, sorted by step
+    std::vector<int> m_steps;           ///< Step of each module
+    std::vector<int> m_step_begin;      ///< Offset of each step in m_order, plus the end offset
+    std::vector<uint32_t> m_latency_us; ///< Latency of each module measured by the last parallel run
+    std::vector<int> m_groups[2];       ///< Groups of the step that is running on both cores
+};
+
+} // namespace dl
@@ -16,6 +16,7 @@ TensorInfo::TensorInfo(std::string &name,
     dtype(dtype),
     exponent(exponent),
     is_internal(is_internal),
+    is_pinned(false),
     m_leader_tensor(nullptr),
     m_follower_dirty_tensor(nullptr)
 {
@@ -41,15 +42,23 @@ TensorInfo::TensorInfo(std::string &name,
     this->call_times = 0;
     this->offset = 0;
     this->internal_offset = 0;
+    this->pinned_offset = 0;
+    this->view_offset = 0;
 }
 
-void TensorInfo::set_inplace_leader_tensor(TensorInfo *tensor)
+void TensorInfo::set_inplace_leader_tensor(TensorInfo *tensor, uint32_t view_offset)
 {
     this->m_leader_tensor = tensor;
+    this->view_offset = tensor ? view_offset : 0;
     if (tensor) {
         if (tensor->time_end < this->time_end || this->time_end == -1) {
             tensor->update_time(this->time_end);
         }
+        // a slice written before its Concat runs, the whole buffer lives from the first write
+        TensorInfo *root = tensor->get_root_tensor();
+        if (this->time_begin < root->time_begin) {
+            root->time_begin = this->time_begin;
+        }
     }
 }
 
@@ -71,11 +80,15 @@ void TensorInfo::update_time(int new_time)
     this->call_times++;
 }
 
-TensorBase *TensorInfo::create_tensor(void *internal_root, void *psram_root)
+TensorBase *TensorInfo::create_tensor(void *internal_root, void *psram_root, void *pinned_root)
 {
     TensorBase *tensor = nullptr;
     uint8_t *element = nullptr;
 
+    if (this->get_pinned_state()) {
+        element = (uint8_t *)pinned_root + this->get_pinned_offset();
+        return new TensorBase(shape, element, exponent, dtype, false);
+    }
 #if CONFIG_SPIRAM
     if (this->is_internal) {
         element = (uint8_t *)internal_root + this->get_internal_offset();
@@ -0,0 +1,143 @@
+#include <stdint.h>
+#include <algorithm>
+
+#include "dl_memory_manager_best_fit.hpp"
+#include "esp_log.h"
+
+static const char *TAG = "MemoryManagerBestFit";
+
+namespace dl {
+
+typedef struct {
+    int time_begin;
+    int time_end;
+    size_t offset;
+    size_t size;
+} placed_tensor_t;
+
+bool MemoryManagerBestFit::alloc(fbs::FbsModel *fbs_model,
+                                 std::vector<dl::module::Module *> &execution_plan,
+                                 ModelContext *context)
+{
+    std::vector<TensorInfo *> tensor_info;
+    // get all tensor info from flatbuffers
+    get_tensor_info_from_fbs(fbs_model, execution_plan, context, tensor_info);
+    std::vector<TensorInfo *> planned;
+    size_t pinned_size = pin_tensors(fbs_model, context, tensor_info, planned);
+    int step_num = get_step_num(execution_plan);
+
+    // greedy plan, only kept for the report
+    int greedy_internal = 0;
+    int greedy_psram = 0;
+    plan(planned, step_num, greedy_internal, greedy_psram);
+    this->greedy_internal_size = greedy_internal;
+    this->greedy_psram_size = greedy_psram;
+
+    // inplaced tensors follow the offset of their leader
+    std::vector<TensorInfo *> tensors;
+    for (TensorInfo *tensor : planned) {
+        if (!tensor->is_inplaced()) {
+            tensor->set_internal_state(false);
+            tensors.push_back(tensor);
+        }
+    }
+
+    std::vector<TensorInfo *> rejected;
+    this->internal_size = 0;
+    this->psram_size = 0;
+#if CONFIG_SPIRAM
+    if (this->max_internal_size > this->alignment) {
+        // hot tensors first: every byte placed in internal RAM saves one PSRAM access per reader
+        std::stable_sort(tensors.begin(), tensors.end(), [](TensorInfo *a, TensorInfo *b) {
+            if (a->get_call_times() != b->get_call_times()) {
+                return a->get_call_times() > b->get_call_times();
+            }
+            return a->get_size() > b->get_size();
+        });
+        this->internal_size = place(tensors, step_num, this->max_internal_size, true, rejected);
+        tensors.swap(rejected);
+        rejected.clear();
+    }
+    std::stable_sort(
+        tensors.begin(), tensors.end(), [](TensorInfo *a, TensorInfo *b) { return a->get_size() > b->get_size(); });
+    this->psram_size = place(tensors, step_num, SIZE_MAX, false, rejected);
+#else
+    std::stable_sort(
+        tensors.begin(), tensors.end(), [](TensorInfo *a, TensorInfo *b) { return a->get_size() > b->get_size(); });
+    this->internal_size = place(tensors, step_num, SIZE_MAX, false, rejected);
+#endif
+
+    ESP_LOGI(TAG,
+             "internal RAM: %.2fKB (greedy %.2fKB), PSRAM: %.2fKB (greedy %.2fKB)",
+             this->internal_size / 1024.f,
+             this->greedy_internal_size / 1024.f,
+             this->psram_size / 1024.f,
+             this->greedy_psram_size / 1024.f);
+
+    return create_tensors(context, tensor_info, this->internal_size, this->psram_size, pinned_size);
+}
+
+size_t MemoryManagerBestFit::place(std::vector<TensorInfo *> &tensors,
+                                   int step_num,
+                                   size_t capacity,
+                                   bool internal,
+                                   std::vector<TensorInfo *> &rejected)
+{
+    MemoryChunk aligner(0, true, this->alignment);
+    std::vector<placed_tensor_t> placed;
+    std::vector<const placed_tensor_t *> live;
+    size_t arena_size = 0;
+
+    for (TensorInfo *tensor : tensors) {
+        int time_begin = std::max(tensor->get_time_begin(), 0);
+        int time_end = tensor->get_time_end();
+        if (time_end < 0 || time_end > step_num) {
+            time_end = step_num; // graph outputs are never freed
+        }
+        size_t size = aligner.get_aligned_size(tensor->get_size());
+
+        // tensors alive at the same time, by offset
+        live.clear();
+        for (const placed_tensor_t &other : placed) {
+            if (other.time_begin < time_end && time_begin < other.time_end) {
+                live.push_back(&other);
+            }
+        }
+        std::sort(live.begin(), live.end(), [](const placed_tensor_t *a, const placed_tensor_t *b) {
+            return a->offset < b->offset;
+        });
+
+        // smallest gap which fits, otherwise on top of the live tensors
+        size_t best_offset = SIZE_MAX;
+        size_t best_gap = SIZE_MAX;
+        size_t cursor = 0;
+        for (const placed_tensor_t *other : live) {
+            if (other->offset > cursor) {
+                size_t gap = other->offset - cursor;
+                if (gap >= size && gap < best_gap) {
+                    best_offset = cursor;
+                    best_gap = gap;
+                }
+            }
+            cursor = std::max(cursor, other->offset + other->size);
+        }
+        if (best_offset == SIZE_MAX) {
+            best_offset = cursor;
+        }
+        if (best_offset + size > capacity) {
+            rejected.push_back(tensor);
+            continue;
+        }
+
+        placed.push_back({time_begin, time_end, best_offset, size});
+        arena_size = std::max(arena_size, best_offset + size);
+        if (internal) {
+            tensor->set_internal_offset(best_offset);
+        } else {
+            tensor->set_offset(best_offset);
+        }
+    }
+    return arena_size;
+}
+
+} // namespace dl
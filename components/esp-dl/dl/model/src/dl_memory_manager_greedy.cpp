@@ -1,4 +1,5 @@
 #include <stdint.h>
+#include <algorithm>
 
 #include "dl_memory_manager_greedy.hpp"
 #include "esp_log.h"
@@ -14,22 +15,69 @@ bool MemoryManagerGreedy::alloc(fbs::FbsModel *fbs_model,
     std::vector<TensorInfo *> tensor_info;
     // get all tensor info from flatbuffers
     get_tensor_info_from_fbs(fbs_model, execution_plan, context, tensor_info);
+    std::vector<TensorInfo *> planned;
+    size_t pinned_size = pin_tensors(fbs_model, context, tensor_info, planned);
 
     // simulate the memory allocation
+    int internal_size = 0;
+    int psram_size = 0;
+    plan(planned, get_step_num(execution_plan), internal_size, psram_size);
+
+    return create_tensors(context, tensor_info, internal_size, psram_size, pinned_size);
+}
+
+size_t MemoryManagerGreedy::pin_tensors(fbs::FbsModel *fbs_model,
+                                        ModelContext *context,
+                                        std::vector<TensorInfo *> &tensor_info,
+                                        std::vector<TensorInfo *> &planned)
+{
+    size_t pinned_size = 0;
+    if (this->pin_io) {
+        MemoryChunk aligner(0, true, this->alignment);
+        std::vector<std::string> names = fbs_model->get_graph_inputs();
+        std::vector<std::string> outputs = fbs_model->get_graph_outputs();
+        names.insert(names.end(), outputs.begin(), outputs.end());
+        for (const std::string &name : names) {
+            int index = context->get_variable_index(name);
+            if (index < 0 || !tensor_info[index] || tensor_info[index]->get_pinned_state()) {
+                continue;
+            }
+            // an inplaced tensor pins its leader, the whole buffer moves out of the shared arena
+            tensor_info[index]->set_pinned_offset(pinned_size);
+            pinned_size += aligner.get_aligned_size(tensor_info[index]->get_size());
+        }
+    }
+
+    for (TensorInfo *tensor : tensor_info) {
+        if (tensor && !tensor->get_pinned_state()) {
+            planned.push_back(tensor);
+        }
+    }
+    return pinned_size;
+}
+
+int MemoryManagerGreedy::get_step_num(std::vector<dl::module::Module *> &execution_plan)
+{
+    if (!this->schedule_steps.empty()) {
+        return *std::max_element(this->schedule_steps.begin(), this->schedule_steps.end()) + 1;
+    }
+    return execution_plan.size();
+}
+
+void MemoryManagerGreedy::plan(std::vector<TensorInfo *> &tensor_info, int step_num, int &internal_size, int &psram_size)
+{
 #if CONFIG_SPIRAM
     if (this->max_internal_size > this->alignment) {
-        simulate_with_internal_memory(tensor_info, execution_plan.size());
+        simulate_with_internal_memory(tensor_info, step_num);
     } else {
-        simulate(tensor_info, execution_plan.size());
+        simulate(tensor_info, step_num);
     }
 #else
-    simulate(tensor_info, execution_plan.size());
+    simulate(tensor_info, step_num);
 #endif
 
-    void *psram_root = nullptr;
-    void *internal_root = nullptr;
-    int psram_size = 0;
-    int internal_size = 0;
+    psram_size = 0;
+    internal_size = 0;
 
     if (!this->psram_memory_list.empty()) {
         psram_size = psram_memory_list.back()->offset + psram_memory_list.back()->size;
@@ -39,14 +87,32 @@ bool MemoryManagerGreedy::alloc(fbs::FbsModel *fbs_model,
         internal_size = internal_memory_list.back()->offset + internal_memory_list.back()->size;
     }
 
+    // free memory list
+    this->free_memory_list();
+}
+
+bool MemoryManagerGreedy::create_tensors(ModelContext *context,
+                                         std::vector<TensorInfo *> &tensor_info,
+                                         int internal_size,
+                                         int psram_size,
+                                         size_t pinned_size)
+{
+    void *psram_root = nullptr;
+    void *internal_root = nullptr;
+    void *pinned_root = nullptr;
+
     // alloc memory for tensors
-    if (context->root_alloc(internal_size, psram_size, this->alignment)) {
+    if (context->root_alloc(internal_size, psram_size, this->alignment, pinned_size)) {
         psram_root = context->get_psram_root();
         internal_root = context->get_internal_root();
+        pinned_root = context->get_pinned_root();
 
         // start to allocate tensors
         for (int i = 0; i < tensor_info.size(); i++) {
-            context->update_tensor(i, tensor_info[i]->create_tensor(internal_root, psram_root));
+            // a tensor folded away by GraphOptimizer is neither written nor read
+            if (tensor_info[i]) {
+                context->update_tensor(i, tensor_info[i]->create_tensor(internal_root, psram_root, pinned_root));
+            }
         }
     } else {
         ESP_LOGE(TAG, "root_alloc failed");
@@ -57,10 +123,7 @@ bool MemoryManagerGreedy::alloc(fbs::FbsModel *fbs_model,
         delete tensor_info[i];
     }
 
-    // free memory list
-    this->free_memory_list();
-
-    if (psram_root || internal_root) {
+    if (psram_root || internal_root || pinned_root) {
         return true;
     }
 
@@ -82,16 +145,22 @@ void MemoryManagerGreedy::get_tensor_info_from_fbs(fbs::FbsModel *fbs_model,
     std::vector<std::string> graph_inputs = fbs_model->get_graph_inputs();
     int index = -1;
     std::string name;
+    std::vector<std::string> names(tensor_info.size());
 
     for (int i = 0; i < graph_inputs.size(); i++) {
         name = graph_inputs[i];
         index = context->get_variable_index(name);
 
         if (index >= 0) {
+            names[index] = name;
+            std::vector<int> shape = fbs_model->get_value_info_shape(name);
+            if (this->batch > 1) {
+                shape[0] = this->batch; // the other shapes follow through Module::get_output_shape()
+            }
             TensorInfo *info = new TensorInfo(name,
                                               0,
                                               -1,
-                                              fbs_model->get_value_info_shape(name),
+                                              shape,
                                               fbs_model->get_value_info_dtype(name),
                                               fbs_model->get_value_info_exponent(name));
             tensor_info[index] = info;
@@ -99,25 +168,53 @@ void MemoryManagerGreedy::get_tensor_info_from_fbs(fbs::FbsModel *fbs_model,
     }
 
     // 2. add tensor outputs and update time line of tensors
-    std::vector<std::string> graph_outputs = fbs_model->get_graph_outputs();
     std::vector<std::string> sorted_nodes = fbs_model->topological_sort();
     std::vector<std::string> op_inputs;
     std::vector<std::string> op_outputs;
-    for (int i = 0; i < execution_plan.size(); i++) {
+    // the modules' indices are followed instead of the node names, GraphOptimizer may have rewired them
+    for (int i = 0; i < sorted_nodes.size(); i++) {
+        fbs_model->get_operation_inputs_and_outputs(sorted_nodes[i], op_inputs, op_outputs);
+        for (int j = 0; j < op_outputs.size(); j++) {
+            index = context->get_variable_index(op_outputs[j]);
+            if (index >= 0) {
+                names[index] = op_outputs[j];
+            }
+        }
+    }
+    std::vector<bool> is_graph_output(tensor_info.size(), false);
+    for (const std::string &output : fbs_model->get_graph_outputs()) {
+        index = context->get_variable_index(output);
+        if (index >= 0) {
+            is_graph_output[index] = true;
+        }
+    }
+    std::vector<bool> is_view(tensor_info.size(), false);
+    auto node_of = [this](int i) { return this->graph_nodes.empty() ? GRAPH_NODE_KEPT : this->graph_nodes[i]; };
+    // modules per step, the modules of a shared step may run concurrently and must not be planned inplace
+    std::vector<int> step_size(execution_plan.size(), 1);
+    if (!this->schedule_steps.empty()) {
+        std::fill(step_size.begin(), step_size.end(), 0);
+        for (int i = 0; i < this->schedule_steps.size(); i++) {
+            if (node_of(i) == GRAPH_NODE_KEPT) {
+                step_size[this->schedule_steps[i]]++;
+            }
+        }
+    }
+    for (int k = 0; k < execution_plan.size(); k++) {
+        int i = this->schedule_order.empty() ? k : this->schedule_order[k];
+        int step = this->schedule_steps.empty() ? i : this->schedule_steps[i];
         dl::module::Module *module = execution_plan[i];
         if (!module) {
             ESP_LOGE(__FUNCTION__, "module %d is nullptr\n", i);
             break;
         }
+        graph_node_t node = node_of(i);
 
         // update the time of tensor by node's inputs
         std::vector<std::vector<int>> input_shapes;
-        fbs_model->get_operation_inputs_and_outputs(sorted_nodes[i], op_inputs, op_outputs);
-
-        for (int j = 0; j < op_inputs.size(); j++) {
-            name = op_inputs[j];
-            index = context->get_variable_index(name);
-            if (index >= 0) {
+        for (int j = 0; j < module->m_inputs_index.size(); j++) {
+            index = module->m_inputs_index[j];
+            if (index >= 0 && index < CONTEXT_PARAMETER_OFFSET) {
                 // The previously existing tensor will dirty the input. Must disconnect the inplace link.
                 TensorInfo *follower_tensor = tensor_info[index]->get_inplace_follower_tensor();
                 if (follower_tensor) {
@@ -125,12 +222,11 @@ void MemoryManagerGreedy::get_tensor_info_from_fbs(fbs::FbsModel *fbs_model,
                     follower_tensor->set_inplace_leader_tensor(nullptr);
                 }
 
-                auto out_iter = std::find(graph_outputs.begin(), graph_outputs.end(), name);
-                if (out_iter == graph_outputs.end())
-                    tensor_info[index]->update_time(i + 1); // free this tensor next step
+                if (!is_graph_output[index])
+                    tensor_info[index]->update_time(step + 1); // free this tensor next step
                 input_shapes.push_back(tensor_info[index]->get_shape());
             } else {
-                TensorBase *tensor = context->get_tensor(name);
+                TensorBase *tensor = context->get_tensor(index);
                 if (tensor) {
                     input_shapes.push_back(tensor->get_shape());
                 } else {
@@ -138,34 +234,82 @@ void MemoryManagerGreedy::get_tensor_info_from_fbs(fbs::FbsModel *fbs_model,
                 }
             }
         }
+        if (module->m_outputs_index.empty()) {
+            continue; // folded into its producer
+        }
 
         // add output tensors
         std::vector<std::vector<int>> output_shapes = module->get_output_shape(input_shapes);
-        if ((module->inplace == MODULE_INPLACE_UNCHANGED_BUFFER || module->inplace == MODULE_INPLACE_CHANGED_BUFFER) &&
-            op_outputs.size() == 1) {
-            name = op_outputs[0];
+        if (node == GRAPH_NODE_ALIAS) {
+            // removed shape-only op, the output is always a view of the input
+            index = module->m_outputs_index[0];
+            name = names[index];
+            TensorInfo *info = new TensorInfo(name,
+                                              step,
+                                              -1,
+                                              output_shapes[0],
+                                              fbs_model->get_value_info_dtype(name),
+                                              fbs_model->get_value_info_exponent(name));
+            tensor_info[index] = info;
+            info->set_inplace_leader_tensor(tensor_info[module->m_inputs_index[0]]);
+        } else if (node == GRAPH_NODE_CONCAT) {
+            // removed concat, the tensors written by the producers become slices of the output
+            index = module->m_outputs_index[0];
+            name = names[index];
+            TensorInfo *info = new TensorInfo(name,
+                                              step,
+                                              -1,
+                                              output_shapes[0],
+                                              fbs_model->get_value_info_dtype(name),
+                                              fbs_model->get_value_info_exponent(name));
+            tensor_info[index] = info;
+            uint32_t offset = 0;
+            for (int input : module->m_inputs_index) {
+                tensor_info[input]->get_root_tensor()->set_inplace_leader_tensor(info, offset);
+                offset += tensor_info[input]->get_size();
+            }
+            if (is_graph_output[index]) {
+                info->update_time(-1); // never freed
+            }
+        } else if (module->inplace == MODULE_INPLACE_VIEW) {
+            // strided views of the input, laid out by the module when it runs
+            for (int j = 0; j < module->m_outputs_index.size(); j++) {
+                index = module->m_outputs_index[j];
+                name = names[index];
+                TensorInfo *info = new TensorInfo(name,
+                                                  step,
+                                                  -1,
+                                                  output_shapes[j],
+                                                  fbs_model->get_value_info_dtype(name),
+                                                  fbs_model->get_value_info_exponent(name));
+                tensor_info[index] = info;
+                info->set_inplace_leader_tensor(tensor_info[module->m_inputs_index[0]]);
+                is_view[index] = true;
+            }
+        } else if ((module->inplace == MODULE_INPLACE_UNCHANGED_BUFFER ||
+                    module->inplace == MODULE_INPLACE_CHANGED_BUFFER) &&
+                   module->m_outputs_index.size() == 1 && step_size[step] == 1) {
+            index = module->m_outputs_index[0];
+            name = names[index];
             TensorInfo *inplace_tensor = nullptr;
             TensorInfo *info = new TensorInfo(name,
-                                              i,
+                                              step,
                                               -1,
                                               output_shapes[0],
                                               fbs_model->get_value_info_dtype(name),
                                               fbs_model->get_value_info_exponent(name));
-            index = context->get_variable_index(name);
             tensor_info[index] = info;
 
             // inplace, loop all inputs and find a suitable inplace tensor
-            for (int j = 0; j < op_inputs.size(); j++) {
-                name = op_inputs[j];
-                index = context->get_variable_index(name);
-                if (index >= 0) {
+            for (int j = 0; j < module->m_inputs_index.size(); j++) {
+                index = module->m_inputs_index[j];
+                if (index >= 0 && index < CONTEXT_PARAMETER_OFFSET) {
                     inplace_tensor = tensor_info[index];
                     if (inplace_tensor->get_size() >= info->get_size()) {
-                        auto out_iter = std::find(graph_outputs.begin(), graph_outputs.end(), name);
-                        if (out_iter == graph_outputs.end()) {
+                        if (!is_graph_output[index] && !is_view[index]) {
                             break;
                         } else {
-                            // If op_input is graph output. It can't be set inplace.
+                            // If op_input is graph output or a strided view. It can't be set inplace.
                             inplace_tensor = nullptr;
                         }
                     } else {
@@ -189,15 +333,15 @@ void MemoryManagerGreedy::get_tensor_info_from_fbs(fbs::FbsModel *fbs_model,
                 }
             }
         } else {
-            for (int j = 0; j < op_outputs.size(); j++) {
-                name = op_outputs[j];
+            for (int j = 0; j < module->m_outputs_index.size(); j++) {
+                index = module->m_outputs_index[j];
+                name = names[index];
                 TensorInfo *info = new TensorInfo(name,
-                                                  i,
+                                                  step,
                                                   -1,
                                                   output_shapes[j],
                                                   fbs_model->get_value_info_dtype(name),
                                                   fbs_model->get_value_info_exponent(name));
-                index = context->get_variable_index(name);
                 tensor_info[index] = info;
             }
         }
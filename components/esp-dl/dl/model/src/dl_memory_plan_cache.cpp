@@ -0,0 +1,330 @@
+#include <inttypes.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "dl_memory_plan_cache.hpp"
+#include "esp_log.h"
+#include "nvs.h"
+
+static const char *TAG = "dl::MemoryPlanCache";
+
+namespace dl {
+
+#define DL_MEMORY_PLAN_NAMESPACE "dl_mem_plan"
+#define DL_MEMORY_PLAN_MAGIC 0x504d4c44 // "DLMP"
+#define DL_MEMORY_PLAN_VERSION 4
+#define DL_MEMORY_PLAN_MAX_NDIM 8
+
+typedef enum {
+    PLAN_TENSOR_NONE = 0,
+    PLAN_TENSOR_INTERNAL = 1,
+    PLAN_TENSOR_PSRAM = 2,
+    PLAN_TENSOR_PINNED = 3
+} plan_tensor_state_t;
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t reserved;
+    uint64_t key;
+    uint32_t variable_count;
+    uint32_t internal_size;
+    uint32_t psram_size;
+    uint32_t pinned_size;
+    uint32_t plan_us;
+} plan_header_t;
+
+typedef struct {
+    uint8_t state;
+    uint8_t dtype;
+    int8_t exponent;
+    uint8_t ndim;
+    uint32_t offset;
+} plan_tensor_t; // followed by ndim int32_t dimensions
+
+static uint64_t fnv1a(uint64_t hash, const void *data, size_t size)
+{
+    const uint8_t *bytes = (const uint8_t *)data;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+static uint64_t fnv1a(uint64_t hash, const std::string &str)
+{
+    return fnv1a(hash, str.c_str(), str.size() + 1);
+}
+
+static uint64_t fnv1a(uint64_t hash, const std::vector<int> &values)
+{
+    int size = values.size();
+    hash = fnv1a(hash, &size, sizeof(size));
+    return values.empty() ? hash : fnv1a(hash, values.data(), values.size() * sizeof(int));
+}
+
+MemoryPlanCache::MemoryPlanCache(fbs::FbsModel *fbs_model,
+                                 std::vector<dl::module::Module *> &execution_plan,
+                                 const std::vector<int> &steps,
+                                 size_t max_internal_size,
+                                 int mm_type,
+                                 bool pin_io,
+                                 int batch)
+{
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    hash = fnv1a(hash, fbs_model->get_model_name());
+    int64_t version = fbs_model->get_model_version();
+    hash = fnv1a(hash, &version, sizeof(version));
+
+    std::vector<std::string> sorted_nodes = fbs_model->topological_sort();
+    std::vector<std::string> op_inputs;
+    std::vector<std::string> op_outputs;
+    for (int i = 0; i < sorted_nodes.size() && i < execution_plan.size(); i++) {
+        dl::module::Module *module = execution_plan[i];
+        hash = fnv1a(hash, sorted_nodes[i]);
+        hash = fnv1a(hash, module->m_inputs_index);
+        hash = fnv1a(hash, module->m_outputs_index);
+        hash = fnv1a(hash, &module->inplace, sizeof(module->inplace));
+        fbs_model->get_operation_inputs_and_outputs(sorted_nodes[i], op_inputs, op_outputs);
+        for (const std::string &name : op_outputs) {
+            // the cached tensors keep their exponent, a recalibrated model must not hit the entry
+            int32_t info[2] = {(int32_t)fbs_model->get_value_info_dtype(name),
+                               (int32_t)fbs_model->get_value_info_exponent(name)};
+            hash = fnv1a(hash, fbs_model->get_value_info_shape(name));
+            hash = fnv1a(hash, info, sizeof(info));
+        }
+    }
+    for (const std::string &name : fbs_model->get_graph_inputs()) {
+        int32_t exponent = fbs_model->get_value_info_exponent(name);
+        hash = fnv1a(hash, fbs_model->get_value_info_shape(name));
+        hash = fnv1a(hash, &exponent, sizeof(exponent));
+    }
+    hash = fnv1a(hash, steps);
+#if CONFIG_SPIRAM
+    uint32_t spiram = 1;
+#else
+    uint32_t spiram = 0;
+#endif
+    uint32_t config[7] = {(uint32_t)max_internal_size,
+                          (uint32_t)mm_type,
+                          spiram,
+                          pin_io,
+                          DL_GRAPH_OPTIMIZE,
+                          DL_GRAPH_FOLD_REQUANTIZE,
+                          (uint32_t)batch};
+    hash = fnv1a(hash, config, sizeof(config));
+
+    m_key = hash;
+    // One entry per model, a build with another configuration replaces it. NVS keys are at most 15 characters.
+    uint64_t name_hash = fnv1a(0xcbf29ce484222325ULL, fbs_model->get_model_name());
+    snprintf(m_nvs_key, sizeof(m_nvs_key), "p%014llx", (unsigned long long)(name_hash & 0x00ffffffffffffffULL));
+}
+
+/**
+ * @brief Check one cached tensor against the arena sizes of the header, so that a corrupted or forged entry can not
+ *        place a tensor outside of its arena.
+ */
+static bool check_tensor(const plan_header_t &header, const plan_tensor_t &tensor, const uint8_t *dims)
+{
+    if (tensor.state == PLAN_TENSOR_NONE) {
+        return tensor.ndim == 0;
+    }
+    uint32_t arena_size;
+    switch (tensor.state) {
+    case PLAN_TENSOR_INTERNAL:
+        arena_size = header.internal_size;
+        break;
+    case PLAN_TENSOR_PSRAM:
+        arena_size = header.psram_size;
+        break;
+    case PLAN_TENSOR_PINNED:
+        arena_size = header.pinned_size;
+        break;
+    default:
+        return false;
+    }
+    if (tensor.dtype > DATA_TYPE_MAX || tensor.ndim > DL_MEMORY_PLAN_MAX_NDIM) {
+        return false;
+    }
+    uint64_t bytes = dtype_sizeof((dtype_t)tensor.dtype);
+    if (bytes == 0) {
+        return false;
+    }
+    for (int d = 0; d < tensor.ndim; d++) {
+        int32_t dim;
+        memcpy(&dim, dims + d * sizeof(dim), sizeof(dim));
+        if (dim <= 0 || (uint32_t)dim > arena_size) {
+            return false;
+        }
+        bytes *= dim;
+        if (bytes > arena_size) {
+            return false;
+        }
+    }
+    return tensor.offset <= arena_size && bytes <= arena_size - tensor.offset;
+}
+
+esp_err_t MemoryPlanCache::replay(ModelContext *context, int alignment, uint32_t &plan_us)
+{
+    nvs_handle_t handle;
+    if (nvs_open(DL_MEMORY_PLAN_NAMESPACE, NVS_READONLY, &handle) != ESP_OK) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    size_t length = 0;
+    std::vector<uint8_t> blob;
+    esp_err_t ret = nvs_get_blob(handle, m_nvs_key, nullptr, &length);
+    if (ret == ESP_OK && length >= sizeof(plan_header_t)) {
+        blob.resize(length);
+        ret = nvs_get_blob(handle, m_nvs_key, blob.data(), &length);
+    }
+    nvs_close(handle);
+    if (ret != ESP_OK || blob.empty()) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    plan_header_t header;
+    memcpy(&header, blob.data(), sizeof(header));
+    if (header.magic != DL_MEMORY_PLAN_MAGIC || header.version != DL_MEMORY_PLAN_VERSION || header.key != m_key ||
+        header.variable_count != context->get_variable_count()) {
+        ESP_LOGW(TAG, "Ignore stale memory plan %s", m_nvs_key);
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    // check the whole plan before touching the context
+    size_t pos = sizeof(header);
+    for (uint32_t i = 0; i < header.variable_count; i++) {
+        plan_tensor_t tensor;
+        if (pos + sizeof(tensor) > blob.size()) {
+            return ESP_ERR_NOT_FOUND;
+        }
+        memcpy(&tensor, blob.data() + pos, sizeof(tensor));
+        pos += sizeof(tensor);
+        if (pos + tensor.ndim * sizeof(int32_t) > blob.size() || !check_tensor(header, tensor, blob.data() + pos)) {
+            ESP_LOGW(TAG, "Ignore corrupted memory plan %s", m_nvs_key);
+            return ESP_ERR_NOT_FOUND;
+        }
+        pos += tensor.ndim * sizeof(int32_t);
+    }
+    if (pos != blob.size()) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    if (!context->root_alloc(header.internal_size, header.psram_size, alignment, header.pinned_size)) {
+        return ESP_ERR_NO_MEM;
+    }
+    uint8_t *internal_root = (uint8_t *)context->get_internal_root();
+    uint8_t *psram_root = (uint8_t *)context->get_psram_root();
+    uint8_t *pinned_root = (uint8_t *)context->get_pinned_root();
+
+    pos = sizeof(header);
+    for (uint32_t i = 0; i < header.variable_count; i++) {
+        plan_tensor_t tensor;
+        memcpy(&tensor, blob.data() + pos, sizeof(tensor));
+        pos += sizeof(tensor);
+        std::vector<int> shape(tensor.ndim);
+        for (int d = 0; d < tensor.ndim; d++) {
+            int32_t dim;
+            memcpy(&dim, blob.data() + pos, sizeof(dim));
+            pos += sizeof(dim);
+            shape[d] = dim;
+        }
+        if (tensor.state == PLAN_TENSOR_NONE) {
+            continue;
+        }
+        uint8_t *root = tensor.state == PLAN_TENSOR_INTERNAL ? internal_root
+            : tensor.state == PLAN_TENSOR_PINNED                 ? pinned_root
+                                                                 : psram_root;
+        context->update_tensor(
+            i, new TensorBase(shape, root + tensor.offset, tensor.exponent, (dtype_t)tensor.dtype, false));
+    }
+    plan_us = header.plan_us;
+    return ESP_OK;
+}
+
+esp_err_t MemoryPlanCache::save(ModelContext *context, uint32_t plan_us)
+{
+    uint8_t *internal_root = (uint8_t *)context->get_internal_root();
+    uint8_t *psram_root = (uint8_t *)context->get_psram_root();
+    uint8_t *pinned_root = (uint8_t *)context->get_pinned_root();
+    size_t pinned_size = context->get_pinned_size();
+
+    plan_header_t header = {};
+    header.magic = DL_MEMORY_PLAN_MAGIC;
+    header.version = DL_MEMORY_PLAN_VERSION;
+    header.key = m_key;
+    header.variable_count = context->get_variable_count();
+    header.internal_size = context->get_internal_size();
+    header.psram_size = context->get_psram_size();
+    header.pinned_size = pinned_size;
+    header.plan_us = plan_us;
+
+    std::vector<uint8_t> blob(sizeof(header));
+    memcpy(blob.data(), &header, sizeof(header));
+    for (uint32_t i = 0; i < header.variable_count; i++) {
+        TensorBase *variable = context->m_variables[i];
+        plan_tensor_t tensor = {};
+        std::vector<int> shape;
+        if (variable) {
+            uint8_t *element = (uint8_t *)variable->get_element_ptr();
+            if (pinned_root && element >= pinned_root && element <= pinned_root + pinned_size) {
+                tensor.state = PLAN_TENSOR_PINNED;
+                tensor.offset = element - pinned_root;
+            } else if (internal_root && element >= internal_root && element <= internal_root + header.internal_size) {
+                tensor.state = PLAN_TENSOR_INTERNAL;
+                tensor.offset = element - internal_root;
+            } else if (psram_root && element >= psram_root && element <= psram_root + header.psram_size) {
+                tensor.state = PLAN_TENSOR_PSRAM;
+                tensor.offset = element - psram_root;
+            } else {
+                ESP_LOGW(TAG, "Variable %" PRIu32 " is outside of the arenas, memory plan not cached", i);
+                return ESP_ERR_INVALID_STATE;
+            }
+            shape = variable->get_shape();
+            tensor.dtype = variable->get_dtype();
+            tensor.exponent = variable->get_exponent();
+            tensor.ndim = shape.size();
+        }
+        size_t pos = blob.size();
+        blob.resize(pos + sizeof(tensor) + shape.size() * sizeof(int32_t));
+        memcpy(blob.data() + pos, &tensor, sizeof(tensor));
+        pos += sizeof(tensor);
+        for (int dim : shape) {
+            int32_t dim32 = dim;
+            memcpy(blob.data() + pos, &dim32, sizeof(dim32));
+            pos += sizeof(dim32);
+        }
+    }
+
+    nvs_handle_t handle;
+    esp_err_t ret = nvs_open(DL_MEMORY_PLAN_NAMESPACE, NVS_READWRITE, &handle);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    ret = nvs_set_blob(handle, m_nvs_key, blob.data(), blob.size());
+    if (ret == ESP_OK) {
+        ret = nvs_commit(handle);
+    }
+    nvs_close(handle);
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to cache memory plan %s: %s", m_nvs_key, esp_err_to_name(ret));
+    }
+    return ret;
+}
+
+esp_err_t MemoryPlanCache::clear()
+{
+    nvs_handle_t handle;
+    esp_err_t ret = nvs_open(DL_MEMORY_PLAN_NAMESPACE, NVS_READWRITE, &handle);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    ret = nvs_erase_all(handle);
+    if (ret == ESP_OK) {
+        ret = nvs_commit(handle);
+    }
+    nvs_close(handle);
+    return ret;
+}
+
+} // namespace dl
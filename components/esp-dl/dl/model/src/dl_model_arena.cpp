@@ -0,0 +1,101 @@
+#include "dl_model_arena.hpp"
+#include "dl_tool.hpp"
+#include <algorithm>
+
+static const char *TAG = "dl::ModelArena";
+
+namespace dl {
+
+ModelArena::ModelArena() :
+    m_internal_root(nullptr), m_psram_root(nullptr), m_internal_size(0), m_psram_size(0)
+{
+    m_mutex = xSemaphoreCreateRecursiveMutex();
+}
+
+ModelArena::~ModelArena()
+{
+    if (!m_contexts.empty()) {
+        ESP_LOGE(TAG, "%d models still use the arena", (int)m_contexts.size());
+    }
+    heap_caps_free(m_internal_root);
+    heap_caps_free(m_psram_root);
+    vSemaphoreDelete(m_mutex);
+}
+
+bool ModelArena::reserve(ModelContext *context, size_t internal_size, size_t psram_size, int alignment)
+{
+    ModelArenaLock lock(this);
+    void *internal_root = m_internal_root;
+    void *psram_root = m_psram_root;
+    if (internal_size > m_internal_size) {
+        internal_root = tool::calloc_aligned(alignment, internal_size, 1, MALLOC_CAP_INTERNAL);
+        if (!internal_root) {
+            ESP_LOGE(TAG,
+                     "Failed to grow the arena to %.2fKB internal RAM, largest available internal RAM block size "
+                     "%.2fKB",
+                     internal_size / 1024.f,
+                     heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL) / 1024.f);
+            return false;
+        }
+    }
+    if (psram_size > m_psram_size) {
+        psram_root = tool::calloc_aligned(alignment, psram_size, 1, MALLOC_CAP_SPIRAM);
+        if (!psram_root) {
+            ESP_LOGE(TAG,
+                     "Failed to grow the arena to %.2fKB PSRAM, largest available PSRAM block size %.2fKB",
+                     psram_size / 1024.f,
+                     heap_caps_get_largest_free_block(MALLOC_CAP_SPIRAM) / 1024.f);
+            if (internal_root != m_internal_root) {
+                heap_caps_free(internal_root);
+            }
+            return false;
+        }
+    }
+
+    if (internal_root != m_internal_root || psram_root != m_psram_root) {
+        // the intermediate tensors are scratch, only their pointers move
+        for (ModelContext *other : m_contexts) {
+            other->rebase(internal_root, psram_root);
+        }
+        if (internal_root != m_internal_root) {
+            heap_caps_free(m_internal_root);
+            m_internal_root = internal_root;
+            m_internal_size = internal_size;
+        }
+        if (psram_root != m_psram_root) {
+            heap_caps_free(m_psram_root);
+            m_psram_root = psram_root;
+            m_psram_size = psram_size;
+        }
+    }
+    if (std::find(m_contexts.begin(), m_contexts.end(), context) == m_contexts.end()) {
+        m_contexts.push_back(context);
+    }
+    return true;
+}
+
+void ModelArena::release(ModelContext *context)
+{
+    ModelArenaLock lock(this);
+    auto iter = std::find(m_contexts.begin(), m_contexts.end(), context);
+    if (iter != m_contexts.end()) {
+        m_contexts.erase(iter);
+    }
+    if (m_contexts.empty()) {
+        heap_caps_free(m_internal_root);
+        heap_caps_free(m_psram_root);
+        m_internal_root = nullptr;
+        m_psram_root = nullptr;
+        m_internal_size = 0;
+        m_psram_size = 0;
+    }
+}
+
+void ModelArena::get_memory_size(mem_info_t &mem_info)
+{
+    mem_info.flash = 0;
+    mem_info.internal = m_internal_size;
+    mem_info.psram = m_psram_size;
+}
+
+} // namespace dl
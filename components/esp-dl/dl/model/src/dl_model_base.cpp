@@ -1,15 +1,40 @@
 #include <stdint.h>
 
+#include "dl_memory_manager_best_fit.hpp"
 #include "dl_memory_manager_greedy.hpp"
+#include "dl_memory_plan_cache.hpp"
 #include "dl_model_base.hpp"
 #include "dl_module_creator.hpp"
+#include "dl_tool_trace.hpp"
+#include "esp_timer.h"
 #include "fbs_model.hpp"
 #include <format>
+#include <inttypes.h>
 
 static const char *TAG = "dl::Model";
 
 namespace dl {
 
+/**
+ * @brief Whether the module of a node keeps the leading dimension as the batch, see Model::set_batch_size(). The
+ *        other modules, e.g. Resize, Pad, MatMul or Concat, compute their shapes or strides for a batch of 1.
+ */
+static bool is_batch_capable(fbs::FbsModel *fbs_model, const std::string &node_name)
+{
+    std::string type = fbs_model->get_operation_type(node_name);
+    if (type == "Flatten") {
+        int axis = 1;
+        fbs_model->get_operation_attribute(node_name, "axis", axis);
+        return axis != 0;
+    }
+    return type == "Conv" || type == "AveragePool" || type == "MaxPool" || type == "GlobalAveragePool" ||
+        type == "Gemm" || type == "Reshape" || type == "Add" || type == "Sub" || type == "Mul" || type == "Div" ||
+        type == "Relu" || type == "LeakyRelu" || type == "PRelu" || type == "Sigmoid" || type == "Tanh" ||
+        type == "HardSigmoid" || type == "HardSwish" || type == "Gelu" || type == "Elu" || type == "Clip" ||
+        type == "Exp" || type == "Log" || type == "Sqrt" || type == "LUT" || type == "Identity" ||
+        type == "RequantizeLinear";
+}
+
 Model::Model(const char *rodata_address_or_partition_label_or_path,
              fbs::model_location_type_t location,
              int max_internal_size,
@@ -136,6 +161,7 @@ esp_err_t Model::load(fbs::FbsModel *fbs_model)
 
     // Construct the execution plan.
     m_execution_plan.clear();
+    m_graph_optimizer.clear();
     dl::module::ModuleCreator *module_creator = dl::module::ModuleCreator::get_instance();
     m_model_context->clear();
     std::vector<std::string> op_inputs;
@@ -158,6 +184,7 @@ esp_err_t Model::load(fbs::FbsModel *fbs_model)
             ret = ESP_FAIL;
             break;
         }
+        module->trace_name = tool::Tracer::intern(op_type);
         m_execution_plan.push_back(module);
 
         // Add inputs and outputs
@@ -180,6 +207,11 @@ esp_err_t Model::load(fbs::FbsModel *fbs_model)
         }
     }
 
+#if DL_GRAPH_OPTIMIZE
+    if (ret == ESP_OK) {
+        m_graph_optimizer.optimize(m_fbs_model, m_execution_plan, m_model_context);
+    }
+#endif
     return ret;
 }
 
@@ -191,11 +223,50 @@ void Model::build(size_t max_internal_size, memory_manager_t mm_type, bool prelo
 
     if (mm_type == MEMORY_MANAGER_GREEDY) {
         memory_manager = new MemoryManagerGreedy(max_internal_size);
+    } else if (mm_type == MEMORY_MANAGER_BEST_FIT) {
+        memory_manager = new MemoryManagerBestFit(max_internal_size);
     } else {
         ESP_LOGW(TAG, "Memory manager(%d) is not supported yet. Use MemoryManagerGreedy instead.", mm_type);
         memory_manager = new MemoryManagerGreedy(max_internal_size);
     }
-    memory_manager->alloc(m_fbs_model, m_execution_plan, m_model_context);
+    m_max_internal_size = max_internal_size;
+    m_mm_type = mm_type;
+    memory_manager->pin_io = m_model_context->get_arena() != nullptr;
+    memory_manager->batch = m_batch_size;
+    m_scheduler.build(m_execution_plan, m_graph_optimizer.get_nodes());
+    m_param_placement.build(m_execution_plan, m_model_context);
+
+    int64_t plan_start = esp_timer_get_time();
+    m_plan_cached = false;
+    m_plan_saved_us = 0;
+#if DL_MEMORY_PLAN_CACHE
+    MemoryPlanCache plan_cache(m_fbs_model,
+                               m_execution_plan,
+                               m_scheduler.get_steps(),
+                               max_internal_size,
+                               mm_type,
+                               memory_manager->pin_io,
+                               m_batch_size);
+    uint32_t cached_plan_us = 0;
+    m_plan_cached = plan_cache.replay(m_model_context, memory_manager->alignment, cached_plan_us) == ESP_OK;
+    if (m_plan_cached) {
+        m_plan_us = esp_timer_get_time() - plan_start;
+        m_plan_saved_us = cached_plan_us > m_plan_us ? cached_plan_us - m_plan_us : 0;
+    }
+#endif
+    if (!m_plan_cached) {
+        memory_manager->set_schedule(m_scheduler.get_plan_order(), m_scheduler.get_steps());
+        memory_manager->set_graph_nodes(m_graph_optimizer.get_nodes());
+        bool plan_valid = memory_manager->alloc(m_fbs_model, m_execution_plan, m_model_context);
+        m_plan_us = esp_timer_get_time() - plan_start;
+#if DL_MEMORY_PLAN_CACHE
+        if (plan_valid) {
+            plan_cache.save(m_model_context, m_plan_us);
+        }
+#else
+        (void)plan_valid;
+#endif
+    }
 
     // get the TensorBase* of inputs and outputs
     std::vector<std::string> inputs_tmp = m_fbs_model->get_graph_inputs();
@@ -211,21 +282,26 @@ void Model::build(size_t max_internal_size, memory_manager_t mm_type, bool prelo
         m_outputs.emplace(outputs_tmp[i], output_tensor);
     }
 
+    // the tensors are planned for the whole batch
+    m_active_batch = m_batch_size;
+    m_batched.assign(m_model_context->get_variable_count(), false);
+    if (m_batch_size > 1) {
+        for (int i = 0; i < m_batched.size(); i++) {
+            TensorBase *tensor = m_model_context->get_tensor(i);
+            m_batched[i] = tensor && tensor->shape.size() > 1 && tensor->shape[0] == m_batch_size;
+        }
+    }
+
     m_fbs_model->clear_map();
     delete memory_manager;
 }
 
 void Model::run(runtime_mode_t mode)
 {
-    // execute each module.
-    for (int i = 0; i < m_execution_plan.size(); i++) {
-        dl::module::Module *module = m_execution_plan[i];
-        if (module) {
-            module->forward(m_model_context, mode);
-        } else {
-            break;
-        }
-    }
+    ModelArenaLock lock(m_model_context->get_arena());
+    tool::TraceScope trace("run", "model");
+    // execute each module, in the order the memory has been planned for.
+    m_scheduler.run(m_execution_plan, m_model_context, mode, &m_param_placement);
 }
 
 void Model::run(TensorBase *input, runtime_mode_t mode)
@@ -272,10 +348,12 @@ void Model::run(std::map<std::string, TensorBase *> &user_inputs,
     }
 
     // execute each module.
-    for (int i = 0; i < m_execution_plan.size(); i++) {
-        dl::module::Module *module = m_execution_plan[i];
+    ModelArenaLock lock(m_model_context->get_arena());
+    const std::vector<int> &order = m_scheduler.get_order();
+    for (int k = 0; k < order.size(); k++) {
+        dl::module::Module *module = m_execution_plan[order[k]];
         if (module) {
-            module->forward(m_model_context, mode);
+            ModelScheduler::forward(module, order[k], m_model_context, mode);
             // get the intermediate tensor for debug.
             if (!user_outputs.empty()) {
                 for (auto user_outputs_iter = user_outputs.begin(); user_outputs_iter != user_outputs.end();
@@ -389,6 +467,7 @@ void Model::minimize()
              "or debug the model.");
 
     m_internal_size += heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
+    m_minimized = true;
     m_model_context->minimize();
     m_fbs_model->clear_map();
     m_internal_size -= heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
@@ -397,6 +476,7 @@ void Model::minimize()
 
 esp_err_t Model::test()
 {
+    ModelArenaLock lock(m_model_context->get_arena());
     printf("\n");
     std::vector<TensorBase *> test_tensors_cache;
     m_fbs_model->load_map();
@@ -431,7 +511,7 @@ esp_err_t Model::test()
         }
         test_outputs_index.emplace_back(index);
     }
-    for (int i = 0; i < m_execution_plan.size(); i++) {
+    for (int i : m_scheduler.get_order()) {
         dl::module::Module *module = m_execution_plan[i];
         module->forward(m_model_context, RUNTIME_MODE_SINGLE_CORE);
         std::vector<int> module_outputs_index = module->get_outputs_index();
@@ -508,13 +588,14 @@ std::map<std::string, mem_info_t> Model::get_memory_info()
 
 std::map<std::string, module_info> Model::get_module_info()
 {
+    ModelArenaLock lock(m_model_context->get_arena());
     std::map<std::string, module_info> module_info;
     std::vector<std::string> sorted_nodes = m_fbs_model->topological_sort();
     assert(sorted_nodes.size() == m_execution_plan.size());
     DL_LOG_LATENCY_INIT();
     uint32_t total_latency = 0;
     m_fbs_model->load_map();
-    for (int i = 0; i < sorted_nodes.size(); i++) {
+    for (int i : m_scheduler.get_order()) {
         std::string module_name = sorted_nodes[i];
         std::string module_type = m_fbs_model->get_operation_type(module_name);
         DL_LOG_LATENCY_START();
@@ -524,11 +605,62 @@ std::map<std::string, module_info> Model::get_module_info()
         total_latency += module_latency;
         module_info[module_name] = {module_type, module_latency};
     }
+    const std::vector<graph_node_t> &nodes = m_graph_optimizer.get_nodes();
+    for (int i = 0; i < nodes.size(); i++) {
+        if (nodes[i] != GRAPH_NODE_KEPT) {
+            module_info[sorted_nodes[i]] = {m_fbs_model->get_operation_type(sorted_nodes[i]), 0};
+        }
+    }
     m_fbs_model->clear_map();
     module_info["total"] = {"", total_latency};
     return module_info;
 }
 
+std::map<std::string, module_benchmark> Model::get_module_benchmark(int iterations, runtime_mode_t mode)
+{
+    ModelArenaLock lock(m_model_context->get_arena());
+    std::map<std::string, module_benchmark> benchmark;
+    std::vector<std::string> sorted_nodes = m_fbs_model->topological_sort();
+    assert(sorted_nodes.size() == m_execution_plan.size());
+    iterations = std::max(iterations, 1);
+    dl::tool::Latency latency;
+    auto record = [&latency](module_benchmark &bench, uint64_t &sum, int iteration) {
+        uint32_t period = latency.get_period();
+        bench.min = iteration ? std::min(bench.min, period) : period;
+        bench.max = iteration ? std::max(bench.max, period) : period;
+        sum += period;
+    };
+
+    // warm up caches and the worker pool
+    this->run(mode);
+
+    m_fbs_model->load_map();
+    for (int i : m_scheduler.get_order()) {
+        module_benchmark &bench = benchmark[sorted_nodes[i]];
+        bench.type = m_fbs_model->get_operation_type(sorted_nodes[i]);
+        uint64_t sum = 0;
+        for (int n = 0; n < iterations; n++) {
+            latency.start();
+            m_execution_plan[i]->forward(m_model_context, mode);
+            latency.end();
+            record(bench, sum, n);
+        }
+        bench.avg = sum / iterations;
+    }
+    m_fbs_model->clear_map();
+
+    module_benchmark &total = benchmark["total"];
+    uint64_t sum = 0;
+    for (int n = 0; n < iterations; n++) {
+        latency.start();
+        this->run(mode);
+        latency.end();
+        record(total, sum, n);
+    }
+    total.avg = sum / iterations;
+    return benchmark;
+}
+
 static std::string gen_sep_str(std::initializer_list<size_t> width_list)
 {
     std::string sep = "+-";
@@ -717,6 +849,14 @@ void Model::profile_memory()
         ESP_LOGI(TAG, "%s", m_fbs_loader->get_model_location_string());
     }
     print_memory_info(info);
+    if (m_plan_cached) {
+        ESP_LOGI(TAG,
+                 "memory plan: replayed from cache in %" PRIu32 "us, saved %" PRIu32 "us of build time",
+                 m_plan_us,
+                 m_plan_saved_us);
+    } else {
+        ESP_LOGI(TAG, "memory plan: planned in %" PRIu32 "us", m_plan_us);
+    }
     printf("\n");
 }
 
@@ -730,6 +870,7 @@ void Model::profile_module(bool sort_module_by_latency)
     }
     auto info = get_module_info();
     print_module_info(info);
+    print_graph_optimization(info["total"].latency);
     printf("\n");
 }
 
@@ -749,6 +890,339 @@ void Model::profile(bool sort_module_by_latency)
     printf("\n");
     auto module_info = get_module_info();
     print_module_info(module_info, sort_module_by_latency);
+    print_graph_optimization(module_info["total"].latency);
+    module::ModuleWorkerPool::get_instance().print_stats(m_execution_plan);
+    printf("\n");
+}
+
+void Model::print_graph_optimization(uint32_t latency)
+{
+    int removed = m_graph_optimizer.get_removed_count();
+    if (removed == 0 && m_graph_optimizer.get_view_count() == 0) {
+        return;
+    }
+    uint32_t removed_latency;
+    {
+        ModelArenaLock lock(m_model_context->get_arena());
+        removed_latency = m_graph_optimizer.measure_removed(m_execution_plan, m_model_context);
+    }
+#if DL_LOG_LATENCY_UNIT
+    const char *unit = "cycle";
+#else
+    const char *unit = "us";
+#endif
+    ESP_LOGI(TAG,
+             "graph optimization: %d of %d modules removed (%d requantize folded, %d shape ops aliased, %d concat in "
+             "place), %d strided views, latency %" PRIu32 "%s -> %" PRIu32 "%s",
+             removed,
+             (int)m_execution_plan.size(),
+             m_graph_optimizer.get_removed_count(GRAPH_NODE_FOLDED),
+             m_graph_optimizer.get_removed_count(GRAPH_NODE_ALIAS),
+             m_graph_optimizer.get_removed_count(GRAPH_NODE_CONCAT),
+             m_graph_optimizer.get_view_count(),
+             latency + removed_latency,
+             unit,
+             latency,
+             unit);
+}
+
+void Model::benchmark(int iterations, runtime_mode_t mode)
+{
+    auto info = get_module_benchmark(iterations, mode);
+    auto fmt_latency = [](uint32_t latency) -> std::string {
+#if DL_LOG_LATENCY_UNIT
+        return std::format("{}cycle", latency);
+#else
+        return std::format("{}us", latency);
+#endif
+    };
+
+    std::string table_name = std::format("benchmark summary ({} runs)", std::max(iterations, 1));
+    std::vector<std::string> col_headers = {"name", "type", "min", "avg", "max"};
+    size_t col0_width = col_headers[0].size();
+    size_t col1_width = col_headers[1].size();
+    for (const auto &bench : info) {
+        col0_width = std::max(col0_width, bench.first.size());
+        col1_width = std::max(col1_width, bench.second.type.size());
+    }
+    size_t col_latency_width = std::max(col_headers[2].size(), fmt_latency(info.at("total").max).size());
+    std::string sep = gen_sep_str({col0_width, col1_width, col_latency_width, col_latency_width, col_latency_width});
+    if (sep.size() - 2 < table_name.size()) {
+        col0_width += table_name.size() - (sep.size() - 2);
+        sep = gen_sep_str({col0_width, col1_width, col_latency_width, col_latency_width, col_latency_width});
+    }
+
+    printf("\n");
+    print_table_name(table_name, sep);
+    ESP_LOGI(TAG,
+             "| %-*s | %-*s | %-*s | %-*s | %-*s |",
+             col0_width,
+             col_headers[0].c_str(),
+             col1_width,
+             col_headers[1].c_str(),
+             col_latency_width,
+             col_headers[2].c_str(),
+             col_latency_width,
+             col_headers[3].c_str(),
+             col_latency_width,
+             col_headers[4].c_str());
+    ESP_LOGI(TAG, "%s", sep.c_str());
+
+    std::vector<std::string> sorted_nodes = m_fbs_model->topological_sort();
+    std::vector<std::string> keys;
+    for (int i : m_scheduler.get_order()) {
+        keys.push_back(sorted_nodes[i]);
+    }
+    keys.emplace_back("total");
+    for (const auto &key : keys) {
+        const module_benchmark &bench = info.at(key);
+        ESP_LOGI(TAG,
+                 "| %-*s | %-*s | %-*s | %-*s | %-*s |",
+                 col0_width,
+                 key.c_str(),
+                 col1_width,
+                 bench.type.c_str(),
+                 col_latency_width,
+                 fmt_latency(bench.min).c_str(),
+                 col_latency_width,
+                 fmt_latency(bench.avg).c_str(),
+                 col_latency_width,
+                 fmt_latency(bench.max).c_str());
+        ESP_LOGI(TAG, "%s", sep.c_str());
+    }
+    printf("\n");
+}
+
+esp_err_t Model::set_arena(ModelArena *arena)
+{
+    if (arena == m_model_context->get_arena()) {
+        return ESP_OK;
+    }
+    if (!m_fbs_model || m_execution_plan.empty() || m_minimized) {
+        ESP_LOGE(TAG, "The model must be loaded and not minimized to change its arena.");
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    mem_info_t before;
+    m_model_context->get_variable_memory_size(before);
+    {
+        // the old arena must not run a model while the tensors are rebuilt
+        ModelArenaLock lock(m_model_context->get_arena());
+        m_model_context->variables_free();
+    }
+    m_model_context->set_arena(arena);
+    this->build(m_max_internal_size, m_mm_type);
+    for (auto &input : m_inputs) {
+        if (!input.second) {
+            return ESP_FAIL;
+        }
+    }
+
+    if (arena) {
+        mem_info_t shared;
+        arena->get_memory_size(shared);
+        ESP_LOGI(TAG,
+                 "%s: activations %.2fKB internal RAM + %.2fKB PSRAM, now planned in an arena of %.2fKB internal RAM + "
+                 "%.2fKB PSRAM shared by %d models",
+                 m_name.c_str(),
+                 before.internal / 1024.f,
+                 before.psram / 1024.f,
+                 shared.internal / 1024.f,
+                 shared.psram / 1024.f,
+                 arena->get_model_count());
+    }
+    return ESP_OK;
+}
+
+esp_err_t Model::set_batch_size(int batch)
+{
+    if (batch < 1) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (batch == m_batch_size) {
+        return this->set_active_batch(batch);
+    }
+    if (!m_fbs_model || m_execution_plan.empty() || m_minimized) {
+        ESP_LOGE(TAG, "The model must be loaded and not minimized to change its batch size.");
+        return ESP_ERR_INVALID_STATE;
+    }
+    m_fbs_model->load_map();
+    for (const std::string &name : m_fbs_model->get_graph_inputs()) {
+        std::vector<int> shape = m_fbs_model->get_value_info_shape(name);
+        if (shape.size() < 2 || shape[0] != 1) {
+            ESP_LOGE(TAG, "%s: the input %s has no batch dimension.", m_name.c_str(), name.c_str());
+            m_fbs_model->clear_map();
+            return ESP_ERR_NOT_SUPPORTED;
+        }
+    }
+    for (const std::string &node_name : m_fbs_model->topological_sort()) {
+        if (!is_batch_capable(m_fbs_model, node_name)) {
+            ESP_LOGE(TAG,
+                     "%s: %s (%s) does not support a batch.",
+                     m_name.c_str(),
+                     node_name.c_str(),
+                     m_fbs_model->get_operation_type(node_name).c_str());
+            m_fbs_model->clear_map();
+            return ESP_ERR_NOT_SUPPORTED;
+        }
+    }
+    m_fbs_model->clear_map();
+
+    m_graph_optimizer.set_batch_size(m_execution_plan, batch);
+    for (dl::module::Module *module : m_execution_plan) {
+        module->set_batch_size(batch);
+    }
+    m_batch_size = batch;
+    mem_info_t before;
+    m_model_context->get_variable_memory_size(before);
+    {
+        // the arena must not run a model while the tensors are rebuilt
+        ModelArenaLock lock(m_model_context->get_arena());
+        m_model_context->variables_free();
+    }
+    this->build(m_max_internal_size, m_mm_type);
+    for (auto &input : m_inputs) {
+        if (!input.second) {
+            return ESP_FAIL;
+        }
+    }
+
+    mem_info_t after;
+    m_model_context->get_variable_memory_size(after);
+    ESP_LOGI(TAG,
+             "%s: batch %d, activations %.2fKB internal RAM + %.2fKB PSRAM, were %.2fKB + %.2fKB",
+             m_name.c_str(),
+             batch,
+             after.internal / 1024.f,
+             after.psram / 1024.f,
+             before.internal / 1024.f,
+             before.psram / 1024.f);
+    return ESP_OK;
+}
+
+esp_err_t Model::set_active_batch(int batch)
+{
+    if (batch < 1 || batch > m_batch_size) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (batch == m_active_batch) {
+        return ESP_OK;
+    }
+    for (int i = 0; i < m_batched.size(); i++) {
+        if (m_batched[i]) {
+            TensorBase *tensor = m_model_context->get_tensor(i);
+            std::vector<int> shape = tensor->shape;
+            shape[0] = batch;
+            tensor->set_shape(shape);
+        }
+    }
+    m_active_batch = batch;
+    return ESP_OK;
+}
+
+bool Model::set_param_prefetch(bool enable)
+{
+    return m_param_placement.set_prefetch(enable);
+}
+
+size_t Model::pin_parameters(size_t budget, uint32_t caps, int iterations)
+{
+    // run once, so every module has valid inputs and its one-time parameter layout changes are done
+    ModelArenaLock lock(m_model_context->get_arena());
+    this->run(RUNTIME_MODE_SINGLE_CORE);
+    m_param_placement.profile(m_execution_plan, m_model_context, iterations, caps);
+    m_param_placement.pin(budget, caps);
+    size_t flash = 0, pinned = 0;
+    m_param_placement.get_size(flash, pinned);
+    ESP_LOGI(TAG, "parameters pinned in RAM: %.2fKB, left in flash: %.2fKB", pinned / 1024.f, flash / 1024.f);
+    return pinned;
+}
+
+void Model::profile_parameters(int iterations, uint32_t caps)
+{
+    ModelArenaLock lock(m_model_context->get_arena());
+    this->run(RUNTIME_MODE_SINGLE_CORE);
+    m_param_placement.profile(m_execution_plan, m_model_context, iterations, caps);
+    const std::vector<param_placement_t> &placement = m_param_placement.get_placement();
+
+    std::vector<std::string> sorted_nodes = m_fbs_model->topological_sort();
+    std::vector<std::string> types(sorted_nodes.size());
+    m_fbs_model->load_map();
+    for (int i = 0; i < sorted_nodes.size(); i++) {
+        if (i < placement.size() && placement[i].bytes) {
+            types[i] = m_fbs_model->get_operation_type(sorted_nodes[i]);
+        }
+    }
+    m_fbs_model->clear_map();
+
+    std::string table_name = "flash parameters summary";
+    std::vector<std::string> col_headers = {"name", "type", "params", "flash", "RAM", "cost", "pinned"};
+    std::vector<size_t> width(col_headers.size());
+    for (int c = 0; c < col_headers.size(); c++) {
+        width[c] = std::max(col_headers[c].size(), (size_t)10);
+    }
+    for (int i = 0; i < placement.size(); i++) {
+        if (placement[i].bytes) {
+            width[0] = std::max(width[0], sorted_nodes[i].size());
+            width[1] = std::max(width[1], types[i].size());
+        }
+    }
+    std::string sep = gen_sep_str({width[0], width[1], width[2], width[3], width[4], width[5], width[6]});
+    if (sep.size() - 2 < table_name.size()) {
+        width[0] += table_name.size() - (sep.size() - 2);
+        sep = gen_sep_str({width[0], width[1], width[2], width[3], width[4], width[5], width[6]});
+    }
+    auto print_row = [&width](const std::vector<std::string> &row) {
+        ESP_LOGI(TAG,
+                 "| %-*s | %-*s | %-*s | %-*s | %-*s | %-*s | %-*s |",
+                 width[0],
+                 row[0].c_str(),
+                 width[1],
+                 row[1].c_str(),
+                 width[2],
+                 row[2].c_str(),
+                 width[3],
+                 row[3].c_str(),
+                 width[4],
+                 row[4].c_str(),
+                 width[5],
+                 row[5].c_str(),
+                 width[6],
+                 row[6].c_str());
+    };
+
+    printf("\n");
+    print_table_name(table_name, sep);
+    print_row(col_headers);
+    ESP_LOGI(TAG, "%s", sep.c_str());
+
+    uint32_t cost_us = 0;
+    for (int i : m_scheduler.get_order()) {
+        const param_placement_t &module = placement[i];
+        if (!module.bytes) {
+            continue;
+        }
+        uint32_t cost = module.flash_us > module.ram_us ? module.flash_us - module.ram_us : 0;
+        if (!module.pinned) {
+            cost_us += cost;
+        }
+        print_row({sorted_nodes[i],
+                   types[i],
+                   std::format("{:.2f}KB", module.bytes / 1024.f),
+                   std::format("{}us", module.flash_us),
+                   std::format("{}us", module.ram_us),
+                   std::format("{}us", cost),
+                   module.pinned ? "yes" : "no"});
+        ESP_LOGI(TAG, "%s", sep.c_str());
+    }
+
+    size_t flash = 0, pinned = 0;
+    m_param_placement.get_size(flash, pinned);
+    ESP_LOGI(TAG,
+             "RAM saved by flash parameters: %.2fKB (pinned %.2fKB), latency cost: %" PRIu32 "us per inference",
+             flash / 1024.f,
+             pinned / 1024.f,
+             cost_us);
     printf("\n");
 }
 
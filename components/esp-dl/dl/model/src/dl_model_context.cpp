@@ -1,6 +1,7 @@
 #include <stdint.h>
 
 #include "dl_model_context.hpp"
+#include "dl_model_arena.hpp"
 #include "dl_tool.hpp"
 static const char *TAG = "dl::ModelContext";
 
@@ -143,14 +144,41 @@ size_t ModelContext::get_variable_memory_size(mem_info_t &mem_info)
     mem_info.flash = 0;
     mem_info.internal = m_internal_size;
     mem_info.psram = m_psram_size;
-    size_t total_size = m_internal_size + m_psram_size;
+#if CONFIG_SPIRAM
+    mem_info.psram += m_pinned_size;
+#else
+    mem_info.internal += m_pinned_size;
+#endif
+    size_t total_size = m_internal_size + m_psram_size + m_pinned_size;
     return total_size;
 }
 
-bool ModelContext::root_alloc(size_t internal_size, size_t psram_size, int alignment)
+bool ModelContext::root_alloc(size_t internal_size, size_t psram_size, int alignment, size_t pinned_size)
 {
     m_internal_size = internal_size;
     m_psram_size = psram_size;
+    m_pinned_size = pinned_size;
+    if (m_pinned_size > 0) {
+#if CONFIG_SPIRAM
+        m_pinned_root = tool::calloc_aligned(alignment, m_pinned_size, 1, MALLOC_CAP_SPIRAM);
+#else
+        m_pinned_root = tool::calloc_aligned(alignment, m_pinned_size, 1, MALLOC_CAP_INTERNAL);
+#endif
+        if (!m_pinned_root) {
+            ESP_LOGE(TAG, "Failed to alloc %.2fKB for the pinned inputs and outputs", m_pinned_size / 1024.f);
+            return false;
+        }
+    }
+
+    if (m_arena) {
+        if (!m_arena->reserve(this, internal_size, psram_size, alignment)) {
+            return false;
+        }
+        m_internal_root = m_internal_size > 0 ? m_arena->get_internal_root() : nullptr;
+        m_psram_root = m_psram_size > 0 ? m_arena->get_psram_root() : nullptr;
+        return true;
+    }
+
     if (m_psram_size > 0) {
         m_psram_root = tool::calloc_aligned(alignment, m_psram_size, 1, MALLOC_CAP_SPIRAM);
         if (!m_psram_root) {
@@ -176,4 +204,61 @@ bool ModelContext::root_alloc(size_t internal_size, size_t psram_size, int align
     return true;
 }
 
+void ModelContext::rebase(void *internal_root, void *psram_root)
+{
+    uint8_t *old_internal = (uint8_t *)m_internal_root;
+    uint8_t *old_psram = (uint8_t *)m_psram_root;
+    for (TensorBase *tensor : m_variables) {
+        if (!tensor || tensor->auto_free) {
+            continue;
+        }
+        uint8_t *element = (uint8_t *)tensor->data;
+        if (old_internal && element >= old_internal && element <= old_internal + m_internal_size) {
+            tensor->data = (uint8_t *)internal_root + (element - old_internal);
+        } else if (old_psram && element >= old_psram && element <= old_psram + m_psram_size) {
+            tensor->data = (uint8_t *)psram_root + (element - old_psram);
+        }
+    }
+    if (m_internal_root) {
+        m_internal_root = internal_root;
+    }
+    if (m_psram_root) {
+        m_psram_root = psram_root;
+    }
+}
+
+void ModelContext::root_free()
+{
+    if (m_arena) {
+        m_arena->release(this);
+        m_internal_root = nullptr;
+        m_psram_root = nullptr;
+    }
+    // In IDF, free(p) is equivalent to heap_caps_free(p).
+    if (m_internal_root) {
+        free(m_internal_root);
+        m_internal_root = nullptr;
+    }
+    if (m_psram_root) {
+        free(m_psram_root);
+        m_psram_root = nullptr;
+    }
+    if (m_pinned_root) {
+        free(m_pinned_root);
+        m_pinned_root = nullptr;
+    }
+}
+
+void ModelContext::variables_free()
+{
+    for (int i = 0; i < m_variables.size(); i++) {
+        delete m_variables[i];
+        m_variables[i] = nullptr;
+    }
+    root_free();
+    m_internal_size = 0;
+    m_psram_size = 0;
+    m_pinned_size = 0;
+}
+
 } // namespace dl
@@ -0,0 +1,415 @@
+#include "dl_model_graph_optimizer.hpp"
+#include "dl_tool.hpp"
+
+static const char *TAG = "dl::GraphOptimizer";
+
+namespace dl {
+
+static inline bool is_variable(int index)
+{
+    return index >= 0 && index < CONTEXT_PARAMETER_OFFSET;
+}
+
+static inline bool is_elemwise(const std::string &type)
+{
+    return type == "Add" || type == "Sub" || type == "Mul" || type == "Max" || type == "Min" || type == "Equal" ||
+        type == "Greater" || type == "GreaterOrEqual" || type == "Less" || type == "LessOrEqual" || type == "And" ||
+        type == "Or" || type == "Xor";
+}
+
+void GraphOptimizer::clear()
+{
+    m_nodes.clear();
+    m_folded.clear();
+    m_views.clear();
+}
+
+void GraphOptimizer::set_batch_size(std::vector<dl::module::Module *> &execution_plan, int batch)
+{
+    if (batch <= 1) {
+        return;
+    }
+    int concats = 0;
+    for (graph_node_t &node : m_nodes) {
+        if (node == GRAPH_NODE_CONCAT) {
+            node = GRAPH_NODE_KEPT;
+            concats++;
+        }
+    }
+    for (int i : m_views) {
+        execution_plan[i]->inplace = MODULE_NON_INPLACE;
+    }
+    if (concats || !m_views.empty()) {
+        ESP_LOGD(TAG, "batch %d: %d concat and %d strided views undone", batch, concats, get_view_count());
+    }
+    m_views.clear();
+}
+
+void GraphOptimizer::optimize(fbs::FbsModel *fbs_model,
+                              std::vector<dl::module::Module *> &execution_plan,
+                              ModelContext *context)
+{
+    clear();
+    int module_num = execution_plan.size();
+    int variable_num = context->get_variable_count();
+    std::vector<std::string> sorted_nodes = fbs_model->topological_sort();
+    if (sorted_nodes.size() != module_num) {
+        return;
+    }
+    m_nodes.assign(module_num, GRAPH_NODE_KEPT);
+
+    // producer, readers and name of every variable tensor
+    std::vector<std::string> types(module_num);
+    std::vector<std::string> names(variable_num);
+    std::vector<int> producer(variable_num, -1);
+    std::vector<int> readers(variable_num, 0);
+    std::vector<bool> is_input(variable_num, false);
+    std::vector<bool> is_output(variable_num, false);
+    std::vector<std::string> op_inputs;
+    std::vector<std::string> op_outputs;
+    for (int i = 0; i < module_num; i++) {
+        dl::module::Module *module = execution_plan[i];
+        types[i] = fbs_model->get_operation_type(sorted_nodes[i]);
+        fbs_model->get_operation_inputs_and_outputs(sorted_nodes[i], op_inputs, op_outputs);
+        for (int j = 0; j < module->m_outputs_index.size() && j < op_outputs.size(); j++) {
+            int index = module->m_outputs_index[j];
+            if (is_variable(index)) {
+                producer[index] = i;
+                names[index] = op_outputs[j];
+            }
+        }
+        for (int index : module->m_inputs_index) {
+            if (is_variable(index)) {
+                readers[index]++;
+            }
+        }
+    }
+    for (const std::string &name : fbs_model->get_graph_inputs()) {
+        int index = context->get_variable_index(name);
+        if (index >= 0) {
+            is_input[index] = true;
+            names[index] = name;
+        }
+    }
+    for (const std::string &name : fbs_model->get_graph_outputs()) {
+        int index = context->get_variable_index(name);
+        if (index >= 0) {
+            is_output[index] = true;
+        }
+    }
+
+    // 1. requantize folded into the output stage of Conv and Gemm
+    for (int i = 0; i < module_num; i++) {
+        dl::module::Module *module = execution_plan[i];
+        if (types[i] != "RequantizeLinear" || module->m_inputs_index.empty() || module->m_outputs_index.size() != 1) {
+            continue;
+        }
+        int input = module->m_inputs_index[0];
+        int output = module->m_outputs_index[0];
+        if (!is_variable(input) || !is_variable(output) || readers[input] != 1 || is_input[input] ||
+            is_output[input]) {
+            continue;
+        }
+        int p = producer[input];
+        if (p < 0 || (types[p] != "Conv" && types[p] != "Gemm") || execution_plan[p]->m_outputs_index.size() != 1) {
+            continue;
+        }
+        dl::module::Module *conv = execution_plan[p];
+        if (conv->quant_type != module->quant_type || module->quant_type == QUANT_TYPE_NONE ||
+            fbs_model->get_value_info_dtype(names[input]) != fbs_model->get_value_info_dtype(names[output])) {
+            continue;
+        }
+        int input_exponent = fbs_model->get_value_info_exponent(names[input]);
+        int output_exponent = fbs_model->get_value_info_exponent(names[output]);
+        if (input_exponent != output_exponent) {
+#if DL_GRAPH_FOLD_REQUANTIZE
+            // the kernels only shift the accumulator to the right
+            int feature = conv->m_inputs_index[0];
+            TensorBase *filter = conv->m_inputs_index.size() > 1 ? context->get_tensor(conv->m_inputs_index[1]) : nullptr;
+            if (!filter || !is_variable(feature) ||
+                output_exponent - filter->exponent - fbs_model->get_value_info_exponent(names[feature]) < 0) {
+                continue;
+            }
+#else
+            continue;
+#endif
+        }
+
+        conv->m_outputs_index[0] = output;
+        producer[output] = p;
+        producer[input] = -1;
+        readers[input] = 0;
+        module->m_inputs_index.clear();
+        module->m_outputs_index.clear();
+        m_nodes[i] = GRAPH_NODE_FOLDED;
+        m_folded.push_back({output, input_exponent});
+    }
+
+    // 2. shape-only ops become views of their input
+    for (int i = 0; i < module_num; i++) {
+        dl::module::Module *module = execution_plan[i];
+        if (types[i] != "Reshape" && types[i] != "Squeeze" && types[i] != "Unsqueeze" && types[i] != "Flatten" &&
+            types[i] != "Identity") {
+            continue;
+        }
+        if (module->inplace != MODULE_INPLACE_UNCHANGED_BUFFER || module->m_inputs_index.empty() ||
+            module->m_outputs_index.size() != 1) {
+            continue;
+        }
+        int input = module->m_inputs_index[0];
+        int output = module->m_outputs_index[0];
+        // an inplace op on the output must not dirty a tensor read by someone else
+        if (!is_variable(input) || !is_variable(output) || readers[input] != 1 || is_output[input]) {
+            continue;
+        }
+        m_nodes[i] = GRAPH_NODE_ALIAS;
+    }
+
+    // 3. concat whose inputs are contiguous slices of the output
+    for (int i = 0; i < module_num; i++) {
+        dl::module::Module *module = execution_plan[i];
+        if (types[i] != "Concat" || module->m_inputs_index.size() < 2 || module->m_outputs_index.size() != 1) {
+            continue;
+        }
+        int output = module->m_outputs_index[0];
+        if (!is_variable(output) || is_input[output]) {
+            continue;
+        }
+        std::vector<int> shape = fbs_model->get_value_info_shape(names[output]);
+        int axis = 0;
+        fbs_model->get_operation_attribute(sorted_nodes[i], "axis", axis);
+        if (axis < 0) {
+            axis += shape.size();
+        }
+        if (axis < 0 || axis >= (int)shape.size()) {
+            continue;
+        }
+        int outer = 1;
+        for (int d = 0; d < axis; d++) {
+            outer *= shape[d];
+        }
+        if (outer != 1) {
+            continue;
+        }
+
+        dtype_t dtype = fbs_model->get_value_info_dtype(names[output]);
+        size_t offset = 0;
+        bool in_place = true;
+        for (int input : module->m_inputs_index) {
+            if (!is_variable(input) || readers[input] != 1 || is_input[input] || is_output[input] ||
+                fbs_model->get_value_info_dtype(names[input]) != dtype) {
+                in_place = false;
+                break;
+            }
+            // the tensor actually written, through the shape-only ops removed above
+            int root = input;
+            while (producer[root] >= 0 && m_nodes[producer[root]] == GRAPH_NODE_ALIAS) {
+                root = execution_plan[producer[root]]->m_inputs_index[0];
+            }
+            int p = producer[root];
+            if (p < 0 || m_nodes[p] != GRAPH_NODE_KEPT || execution_plan[p]->inplace != MODULE_NON_INPLACE ||
+                readers[root] != 1 || is_input[root] || is_output[root]) {
+                in_place = false;
+                break;
+            }
+            // every slice keeps the 16-byte alignment the SIMD kernels need
+            if (offset % 16) {
+                in_place = false;
+                break;
+            }
+            size_t bytes = dtype_sizeof(dtype);
+            for (int dim : fbs_model->get_value_info_shape(names[input])) {
+                bytes *= dim;
+            }
+            offset += bytes;
+        }
+        if (in_place) {
+            m_nodes[i] = GRAPH_NODE_CONCAT;
+        }
+    }
+
+    // 4. Slice, Split and Transpose whose readers all accept strided views
+    std::vector<std::vector<int>> consumers(variable_num);
+    for (int i = 0; i < module_num; i++) {
+        for (int index : execution_plan[i]->m_inputs_index) {
+            if (is_variable(index)) {
+                consumers[index].push_back(i);
+            }
+        }
+    }
+    for (int i = 0; i < module_num; i++) {
+        dl::module::Module *module = execution_plan[i];
+        if (types[i] != "Slice" && types[i] != "Split" && types[i] != "Transpose") {
+            continue;
+        }
+        if (m_nodes[i] != GRAPH_NODE_KEPT || module->inplace != MODULE_NON_INPLACE || module->m_inputs_index.empty()) {
+            continue;
+        }
+        int input = module->m_inputs_index[0];
+        if (!is_variable(input) || readers[input] != 1 || is_output[input]) {
+            continue;
+        }
+        std::vector<int> shape = fbs_model->get_value_info_shape(names[input]);
+        tensor_view_t dense = {0, shape, std::vector<int>(shape.size(), 1)};
+        for (int d = (int)shape.size() - 2; d >= 0; d--) {
+            dense.axis_offset[d] = dense.axis_offset[d + 1] * shape[d + 1];
+        }
+        std::vector<tensor_view_t> views = module->get_output_views(dense);
+        if (views.empty() || views.size() != module->m_outputs_index.size()) {
+            continue;
+        }
+
+        size_t bytes = dtype_sizeof(fbs_model->get_value_info_dtype(names[input]));
+        bool viewable = true;
+        for (int j = 0; j < views.size() && viewable; j++) {
+            int output = module->m_outputs_index[j];
+            if (!is_variable(output) || is_output[output] || consumers[output].empty()) {
+                viewable = false;
+                break;
+            }
+            const tensor_view_t &view = views[j];
+            int last = view.shape.size() - 1;
+            // the kernels of the elementwise ops load 16-byte aligned rows
+            bool aligned = view.shape.size() <= 4 && (view.shape[last] == 1 || view.axis_offset[last] == 1) &&
+                (view.offset * bytes) % 16 == 0;
+            for (int d = 0; d < last; d++) {
+                aligned = aligned && (view.shape[d] == 1 || (view.axis_offset[d] * bytes) % 16 == 0);
+            }
+            for (int c : consumers[output]) {
+                dl::module::Module *consumer = execution_plan[c];
+                if (m_nodes[c] != GRAPH_NODE_KEPT || consumer->m_outputs_index.empty()) {
+                    viewable = false;
+                } else if (types[c] == "Concat") {
+                    // gathered straight into the output
+                } else if (types[c] == "RequantizeLinear") {
+                    int requantized = consumer->m_outputs_index[0];
+                    viewable = is_variable(requantized) &&
+                        fbs_model->get_value_info_dtype(names[requantized]) ==
+                            fbs_model->get_value_info_dtype(names[output]);
+                } else if (is_elemwise(types[c])) {
+                    viewable = aligned && consumer->quant_type != QUANT_TYPE_NONE;
+                } else {
+                    // pooling, convolution and the others need dense input
+                    viewable = false;
+                }
+                if (!viewable) {
+                    break;
+                }
+            }
+        }
+        if (viewable) {
+            module->inplace = MODULE_INPLACE_VIEW;
+            m_views.push_back(i);
+        }
+    }
+
+    ESP_LOGD(TAG,
+             "%d of %d modules removed: %d requantize folded, %d shape ops aliased, %d concat in place, %d strided "
+             "views",
+             get_removed_count(),
+             module_num,
+             get_removed_count(GRAPH_NODE_FOLDED),
+             get_removed_count(GRAPH_NODE_ALIAS),
+             get_removed_count(GRAPH_NODE_CONCAT),
+             get_view_count());
+}
+
+int GraphOptimizer::get_removed_count(graph_node_t node) const
+{
+    int count = 0;
+    for (graph_node_t n : m_nodes) {
+        if (n != GRAPH_NODE_KEPT && (node == GRAPH_NODE_KEPT || n == node)) {
+            count++;
+        }
+    }
+    return count;
+}
+
+uint32_t GraphOptimizer::measure_removed(std::vector<dl::module::Module *> &execution_plan, ModelContext *context)
+{
+    // The work is replayed from the planned tensors into a scratch buffer, so that no planned tensor is written and no
+    // copy reads and writes the same memory.
+    size_t scratch_bytes = 0;
+    for (const folded_t &folded : m_folded) {
+        TensorBase *output = context->get_tensor(folded.output);
+        if (output) {
+            scratch_bytes = DL_MAX(scratch_bytes, output->get_bytes());
+        }
+    }
+    for (int i = 0; i < m_nodes.size(); i++) {
+        if (m_nodes[i] == GRAPH_NODE_KEPT) {
+            continue;
+        }
+        size_t bytes = 0;
+        for (int index : m_nodes[i] == GRAPH_NODE_CONCAT ? execution_plan[i]->m_inputs_index
+                                                          : execution_plan[i]->m_outputs_index) {
+            TensorBase *tensor = context->get_tensor(index);
+            bytes += tensor ? tensor->get_bytes() : 0;
+        }
+        scratch_bytes = DL_MAX(scratch_bytes, bytes);
+    }
+    for (int i : m_views) {
+        for (int index : execution_plan[i]->m_outputs_index) {
+            TensorBase *output = context->get_tensor(index);
+            if (output) {
+                scratch_bytes = DL_MAX(scratch_bytes, output->get_bytes());
+            }
+        }
+    }
+    if (scratch_bytes == 0) {
+        return 0;
+    }
+    uint8_t *scratch = (uint8_t *)tool::malloc_aligned(16, scratch_bytes, MALLOC_CAP_DEFAULT);
+    if (!scratch) {
+        ESP_LOGW(TAG, "No %d bytes of scratch memory to measure the removed modules", (int)scratch_bytes);
+        return 0;
+    }
+
+    dl::tool::Latency latency;
+    latency.start();
+    // a RequantizeLinear pass over the output
+    for (const folded_t &folded : m_folded) {
+        TensorBase *output = context->get_tensor(folded.output);
+        if (output) {
+            TensorBase input(output->get_shape(), output->get_element_ptr(), folded.exponent, output->get_dtype(), false);
+            TensorBase requantized(output->get_shape(), scratch, output->get_exponent(), output->get_dtype(), false);
+            requantized.assign(&input);
+        }
+    }
+    for (int i = 0; i < m_nodes.size(); i++) {
+        if (m_nodes[i] == GRAPH_NODE_ALIAS) {
+            // the copy of the input into the output that a shape op does when it is not aliased
+            for (int index : execution_plan[i]->m_outputs_index) {
+                TensorBase *output = context->get_tensor(index);
+                if (output) {
+                    tool::copy_memory(scratch, output->get_element_ptr(), output->get_bytes());
+                }
+            }
+        } else if (m_nodes[i] == GRAPH_NODE_CONCAT) {
+            // the copy of every input into the output
+            uint8_t *dst = scratch;
+            for (int index : execution_plan[i]->m_inputs_index) {
+                TensorBase *input = context->get_tensor(index);
+                if (input) {
+                    tool::copy_memory(dst, input->get_element_ptr(), input->get_bytes());
+                    dst += input->get_bytes();
+                }
+            }
+        }
+    }
+    // the gather of every strided view
+    for (int i : m_views) {
+        for (int index : execution_plan[i]->m_outputs_index) {
+            TensorBase *output = context->get_tensor(index);
+            if (output) {
+                TensorBase gathered(output->get_shape(), scratch, output->get_exponent(), output->get_dtype(), false);
+                TensorBase::copy_view(&gathered, output);
+            }
+        }
+    }
+    latency.end();
+    heap_caps_free(scratch);
+    return latency.get_period();
+}
+
+} // namespace dl
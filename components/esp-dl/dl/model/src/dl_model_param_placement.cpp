@@ -0,0 +1,217 @@
+#include "dl_model_param_placement.hpp"
+#include "dl_tool.hpp"
+#include "dl_tool_cache.hpp"
+#include "esp_timer.h"
+#include <algorithm>
+#include <string.h>
+
+static const char *TAG = "dl::ParamPlacement";
+
+namespace dl {
+
+void ParamPlacement::build(std::vector<dl::module::Module *> &execution_plan, ModelContext *context)
+{
+    clear();
+    int module_num = execution_plan.size();
+    m_params.resize(module_num);
+    m_placement.assign(module_num, {0, 0, 0, false});
+
+    std::vector<bool> visited(context->get_parameter_count(), false);
+    for (int i = 0; i < module_num; i++) {
+        for (int index : execution_plan[i]->m_inputs_index) {
+            if (index < CONTEXT_PARAMETER_OFFSET) {
+                continue;
+            }
+            // a parameter shared by several modules belongs to the first one
+            int param_index = index - CONTEXT_PARAMETER_OFFSET;
+            if (param_index >= (int)visited.size() || visited[param_index]) {
+                continue;
+            }
+            visited[param_index] = true;
+            TensorBase *tensor = context->get_tensor(index);
+            if (!tensor || !tensor->data || tensor->auto_free ||
+                dl::tool::memory_addr_type(tensor->data) != MEMORY_ADDR_FLASH) {
+                continue;
+            }
+            m_params[i].push_back({tensor, tensor->data});
+            m_placement[i].bytes += tensor->get_aligned_bytes();
+        }
+    }
+}
+
+void ParamPlacement::clear()
+{
+    unpin();
+    m_params.clear();
+    m_placement.clear();
+}
+
+bool ParamPlacement::set_prefetch(bool enable)
+{
+    if (enable) {
+        m_prefetch = dl::tool::cache::preload_init(1) >= 0;
+        return m_prefetch;
+    }
+    if (m_prefetch) {
+        dl::tool::cache::preload_init(0);
+        dl::tool::cache::autoload_init(1);
+    }
+    m_prefetch = false;
+    return true;
+}
+
+void ParamPlacement::prefetch(int module)
+{
+    if (!m_prefetch || module < 0 || module >= (int)m_params.size() || m_placement[module].pinned) {
+        return;
+    }
+    // only the head of the parameters, the data cache is much smaller than most weights
+    size_t budget = DL_PARAM_PRELOAD_SIZE;
+    for (const flash_param_t &param : m_params[module]) {
+        size_t size = std::min((size_t)param.tensor->get_bytes(), budget);
+        dl::tool::cache::preload_func((uint32_t)(uintptr_t)param.flash_data, size);
+        budget -= size;
+        if (budget == 0) {
+            break;
+        }
+    }
+}
+
+bool ParamPlacement::move_to_ram(int module, uint32_t caps)
+{
+    if (m_placement[module].pinned) {
+        return true;
+    }
+    std::vector<flash_param_t> &params = m_params[module];
+    for (int k = 0; k < params.size(); k++) {
+        TensorBase *tensor = params[k].tensor;
+        void *data = dl::tool::malloc_aligned(16, tensor->get_aligned_bytes(), caps);
+        if (!data) {
+            // roll back the parameters already copied
+            for (int j = 0; j < k; j++) {
+                heap_caps_free(params[j].tensor->data);
+                params[j].tensor->data = params[j].flash_data;
+                params[j].tensor->auto_free = false;
+            }
+            return false;
+        }
+        memcpy(data, params[k].flash_data, tensor->get_bytes());
+        tensor->data = data;
+        tensor->auto_free = true;
+    }
+    m_placement[module].pinned = true;
+    return true;
+}
+
+void ParamPlacement::move_to_flash(int module)
+{
+    if (!m_placement[module].pinned) {
+        return;
+    }
+    for (flash_param_t &param : m_params[module]) {
+        heap_caps_free(param.tensor->data);
+        param.tensor->data = param.flash_data;
+        param.tensor->auto_free = false;
+    }
+    m_placement[module].pinned = false;
+}
+
+uint32_t ParamPlacement::measure(dl::module::Module *module, ModelContext *context, int iterations)
+{
+    int64_t start = esp_timer_get_time();
+    for (int n = 0; n < iterations; n++) {
+        module->forward(context, RUNTIME_MODE_SINGLE_CORE);
+    }
+    return (esp_timer_get_time() - start) / iterations;
+}
+
+void ParamPlacement::profile(std::vector<dl::module::Module *> &execution_plan,
+                             ModelContext *context,
+                             int iterations,
+                             uint32_t caps)
+{
+    iterations = std::max(iterations, 1);
+    for (int i = 0; i < m_params.size(); i++) {
+        param_placement_t &placement = m_placement[i];
+        if (m_params[i].empty()) {
+            continue;
+        }
+        bool pinned = placement.pinned;
+        move_to_flash(i);
+        placement.flash_us = measure(execution_plan[i], context, iterations);
+        if (move_to_ram(i, caps)) {
+            placement.ram_us = measure(execution_plan[i], context, iterations);
+            if (!pinned) {
+                move_to_flash(i);
+            }
+        } else {
+            ESP_LOGW(TAG, "Failed to copy %.2fKB of parameters to RAM, skip module %d", placement.bytes / 1024.f, i);
+            placement.ram_us = placement.flash_us;
+        }
+    }
+}
+
+size_t ParamPlacement::pin(size_t budget, uint32_t caps)
+{
+    std::vector<int> modules;
+    for (int i = 0; i < m_params.size(); i++) {
+        if (!m_params[i].empty()) {
+            modules.push_back(i);
+        }
+    }
+    // latency saved per byte, highest first
+    auto gain = [this](int i) -> float {
+        const param_placement_t &placement = m_placement[i];
+        float saved = placement.flash_us > placement.ram_us ? placement.flash_us - placement.ram_us : 0;
+        return saved / std::max(placement.bytes, (size_t)1);
+    };
+    std::stable_sort(modules.begin(), modules.end(), [this, &gain](int a, int b) {
+        float gain_a = gain(a), gain_b = gain(b);
+        if (gain_a != gain_b) {
+            return gain_a > gain_b;
+        }
+        return m_placement[a].bytes < m_placement[b].bytes;
+    });
+
+    size_t used = 0;
+    for (int i : modules) {
+        if (m_placement[i].pinned) {
+            used += m_placement[i].bytes;
+        }
+    }
+    for (int i : modules) {
+        param_placement_t &placement = m_placement[i];
+        if (placement.pinned || used + placement.bytes > budget) {
+            continue;
+        }
+        if (placement.flash_us && placement.flash_us <= placement.ram_us) {
+            continue; // profiled and not slower in flash
+        }
+        if (move_to_ram(i, caps)) {
+            used += placement.bytes;
+        }
+    }
+    return used;
+}
+
+void ParamPlacement::unpin()
+{
+    for (int i = 0; i < m_params.size(); i++) {
+        move_to_flash(i);
+    }
+}
+
+void ParamPlacement::get_size(size_t &flash, size_t &pinned)
+{
+    flash = 0;
+    pinned = 0;
+    for (const param_placement_t &placement : m_placement) {
+        if (placement.pinned) {
+            pinned += placement.bytes;
+        } else {
+            flash += placement.bytes;
+        }
+    }
+}
+
+} // namespace dl
@@ -0,0 +1,172 @@
+#include "dl_model_scheduler.hpp"
+#include "dl_tool_trace.hpp"
+#include "esp_cpu.h"
+#include "esp_timer.h"
+#include <algorithm>
+
+namespace dl {
+
+void ModelScheduler::forward(dl::module::Module *module, int index, ModelContext *context, runtime_mode_t mode)
+{
+    tool::Tracer &tracer = tool::Tracer::get_instance();
+    if (!tracer.is_enabled()) {
+        module->forward(context, mode);
+        return;
+    }
+    int64_t start_us = esp_timer_get_time();
+    uint32_t start_cycle = esp_cpu_get_cycle_count();
+    module->forward(context, mode);
+
+    uint32_t bytes = 0;
+    for (int i : module->m_inputs_index) {
+        TensorBase *tensor = context->get_tensor(i);
+        bytes += tensor ? tensor->get_bytes() : 0;
+    }
+    for (int i : module->m_outputs_index) {
+        TensorBase *tensor = context->get_tensor(i);
+        bytes += tensor ? tensor->get_bytes() : 0;
+    }
+    tracer.record(module->trace_name, "module", start_us, start_cycle, bytes, index);
+}
+
+void ModelScheduler::clear()
+{
+    m_order.clear();
+    m_plan_order.clear();
+    m_steps.clear();
+    m_step_begin.clear();
+    m_latency_us.clear();
+    m_groups[0].clear();
+    m_groups[1].clear();
+}
+
+void ModelScheduler::build(std::vector<dl::module::Module *> &execution_plan, const std::vector<graph_node_t> &nodes)
+{
+    clear();
+    int module_num = execution_plan.size();
+    m_steps.resize(module_num, 0);
+    m_latency_us.resize(module_num, 0);
+    auto removed = [&nodes](int i) { return !nodes.empty() && nodes[i] != GRAPH_NODE_KEPT; };
+
+#if DL_MODEL_PARALLEL_SCHEDULE && portNUM_PROCESSORS > 1
+    // step of the module that produces each tensor, -1 for graph inputs and parameters
+    std::vector<int> tensor_step;
+    int step_num = 0;
+    for (int i = 0; i < module_num; i++) {
+        dl::module::Module *module = execution_plan[i];
+        // a removed module does not run, its outputs are ready with its inputs
+        int latency = removed(i) ? 0 : 1;
+        int step = 0;
+        for (int index : module->m_inputs_index) {
+            if (index >= 0 && index < (int)tensor_step.size() && tensor_step[index] >= 0) {
+                step = std::max(step, tensor_step[index] + latency);
+            }
+        }
+        for (int index : module->m_outputs_index) {
+            if (index >= (int)tensor_step.size()) {
+                tensor_step.resize(index + 1, -1);
+            }
+            tensor_step[index] = step;
+        }
+        m_steps[i] = step;
+        step_num = std::max(step_num, step + 1);
+    }
+
+    // counting sort by step, stable so the topological order is kept inside a step
+    std::vector<int> offset(step_num + 1, 0);
+    for (int i = 0; i < module_num; i++) {
+        offset[m_steps[i] + 1]++;
+    }
+    for (int s = 0; s < step_num; s++) {
+        offset[s + 1] += offset[s];
+    }
+    m_plan_order.resize(module_num);
+    for (int i = 0; i < module_num; i++) {
+        m_plan_order[offset[m_steps[i]]++] = i;
+    }
+#else
+    m_plan_order.resize(module_num);
+    for (int i = 0; i < module_num; i++) {
+        m_steps[i] = i;
+        m_plan_order[i] = i;
+    }
+#endif
+
+    // the removed modules are planned but never run, a step left without modules disappears
+    for (int i : m_plan_order) {
+        if (!removed(i)) {
+            if (m_order.empty() || m_steps[i] != m_steps[m_order.back()]) {
+                m_step_begin.push_back(m_order.size());
+            }
+            m_order.push_back(i);
+        }
+    }
+    m_step_begin.push_back(m_order.size());
+}
+
+void ModelScheduler::split_step(int begin, int end)
+{
+    // Longest processing time first. Modules never measured count as 1us, so they alternate.
+    std::vector<int> &group0 = m_groups[0];
+    std::vector<int> &group1 = m_groups[1];
+    group0.assign(m_order.begin() + begin, m_order.begin() + end);
+    std::stable_sort(group0.begin(), group0.end(), [this](int a, int b) { return m_latency_us[a] > m_latency_us[b]; });
+    group1.clear();
+    uint32_t load0 = 0, load1 = 0;
+    int kept = 0;
+    for (int k = 0; k < (int)group0.size(); k++) {
+        int i = group0[k];
+        uint32_t latency = std::max(m_latency_us[i], (uint32_t)1);
+        if (load0 <= load1) {
+            group0[kept++] = i;
+            load0 += latency;
+        } else {
+            group1.push_back(i);
+            load1 += latency;
+        }
+    }
+    group0.resize(kept);
+}
+
+void ModelScheduler::run_group(void *arg)
+{
+    group_job_t *job = (group_job_t *)arg;
+    for (int i : *job->modules) {
+        int64_t start = esp_timer_get_time();
+        // One module per core already, do not split the module again
+        forward((*job->execution_plan)[i], i, job->context, RUNTIME_MODE_SINGLE_CORE);
+        job->scheduler->m_latency_us[i] = esp_timer_get_time() - start;
+    }
+}
+
+void ModelScheduler::run(std::vector<dl::module::Module *> &execution_plan,
+                         ModelContext *context,
+                         runtime_mode_t mode,
+                         ParamPlacement *params)
+{
+    int step_num = (int)m_step_begin.size() - 1;
+    int module_num = m_order.size();
+    if (params && module_num > 0) {
+        params->prefetch(m_order[0]);
+    }
+    for (int s = 0; s < step_num; s++) {
+        int begin = m_step_begin[s];
+        int end = m_step_begin[s + 1];
+        if (end - begin == 1 || mode == RUNTIME_MODE_SINGLE_CORE) {
+            for (int k = begin; k < end; k++) {
+                if (params && k + 1 < module_num) {
+                    params->prefetch(m_order[k + 1]);
+                }
+                forward(execution_plan[m_order[k]], m_order[k], context, mode);
+            }
+            continue;
+        }
+
+        split_step(begin, end);
+        group_job_t remote = {this, &execution_plan, context, &m_groups[0]};
+        group_job_t local = {this, &execution_plan, context, &m_groups[1]};
+        module::ModuleWorkerPool::get_instance().run_jobs(run_group, &remote, run_group, &local);
+    }
+}
+
+} // namespace dl
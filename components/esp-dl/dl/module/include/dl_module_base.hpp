@@ -2,6 +2,7 @@
 #include "dl_base.hpp"
 #include "dl_define.hpp"
 #include "dl_model_context.hpp"
+#include "dl_module_worker_pool.hpp"
 #include "dl_tensor_base.hpp"
 #include "dl_tool.hpp"
 #include "dl_tool_cache.hpp"
@@ -15,7 +16,9 @@ typedef enum {
     MODULE_NON_INPLACE = 0, ///< Non inplace operation. the output will store to a separate memory
     MODULE_INPLACE_UNCHANGED_BUFFER =
         1,                            ///< Inplace operation which don't change the buffer data, like Reshape, Squeeze
-    MODULE_INPLACE_CHANGED_BUFFER = 2 ///< Inplace operation which will change the buffer data, like Add, Sub
+    MODULE_INPLACE_CHANGED_BUFFER = 2, ///< Inplace operation which will change the buffer data, like Add, Sub
+    MODULE_INPLACE_VIEW = 3 ///< The outputs are strided views of the input, like Slice, Split and Transpose. Only set
+                            ///< by GraphOptimizer, see Module::get_output_views()
 } module_inplace_t;
 
 namespace module {
@@ -24,11 +27,13 @@ namespace module {
  */
 class Module {
 public:
-    char *name;                       ///< Name of module
-    module_inplace_t inplace;         ///< Inplace type
-    quant_type_t quant_type;          ///< Quantization type
-    std::vector<int> m_inputs_index;  ///< Tensor index of model's tensors that used for inputs
-    std::vector<int> m_outputs_index; ///< Tensor index of model's tensors that used for outputs
+    char *name;                             ///< Name of module
+    const char *trace_name;                 ///< Op type set by Model, lives until the end of the program, see Tracer
+    module_inplace_t inplace;               ///< Inplace type
+    quant_type_t quant_type;                ///< Quantization type
+    module_dispatch_stats_t dispatch_stats; ///< Dual core dispatch counters, see ModuleWorkerPool
+    std::vector<int> m_inputs_index;        ///< Tensor index of model's tensors that used for inputs
+    std::vector<int> m_outputs_index;       ///< Tensor index of model's tensors that used for outputs
 
     /**
      * @brief Construct a new Module object.
@@ -62,6 +67,24 @@ public:
      */
     virtual std::vector<std::vector<int>> get_output_shape(std::vector<std::vector<int>> &input_shapes) = 0;
 
+    /**
+     * @brief Get the layout of the outputs as strided views of the first input, for the modules which only move data.
+     * With MODULE_INPLACE_VIEW, forward() lays the outputs out this way instead of copying.
+     *
+     * @param input  Layout of the first input
+     *
+     * @return Layout of each output, empty if the outputs can not be views
+     */
+    virtual std::vector<tensor_view_t> get_output_views(const tensor_view_t &input) { return {}; }
+
+    /**
+     * @brief Set the batch size the output shapes are planned for, see Model::set_batch_size(). Only the modules
+     * whose output shape is fixed by a parameter, like Reshape, need to know it.
+     *
+     * @param batch  Leading dimension of the graph inputs
+     */
+    virtual void set_batch_size(int batch) {}
+
     /**
      * @brief Build the module, high-level inferface for Module layer
      *
@@ -137,65 +160,54 @@ public:
                      runtime_mode_t mode = RUNTIME_MODE_SINGLE_CORE);
 };
 
-/**
- * @brief The data struct of module task. Pack all necessary information as the input for module task.
- */
-typedef struct {
-    Module *op;                   ///< Module instance pointer
-    void *args;                   ///< ArgsType, arithArgsType, resizeArgsType and so on
-    SemaphoreHandle_t &semaphore; ///< recommend xSemaphoreCreateCounting
-} module_task_data_t;
-
-/**
- * @brief The function of module task.
- * @param args The data of module task.
- */
-static void module_forward_task(void *args)
-{
-    module_task_data_t *task = (module_task_data_t *)args;
-    task->op->forward_args(task->args);
-    xSemaphoreGive(task->semaphore);
-    vTaskSuspend(NULL);
-}
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wunused-function"
 /**
- * @brief Run the module with dual core and use semaphores to keep tasks in sync
+ * @brief Run the module with dual core on the persistent workers of ModuleWorkerPool
  *
  * @param op            Module instance
- * @param args1         Task1 args: ArgsType, arithArgsType, resizeArgsType and so on
- * @param args2         Task2 args: ArgsType, arithArgsType, resizeArgsType and so on
+ * @param args1         Task1 args: ArgsType, arithArgsType, resizeArgsType and so on, run on the other core
+ * @param args2         Task2 args: ArgsType, arithArgsType, resizeArgsType and so on, run on the calling task
  */
 static void module_forward_dual_core(Module *op, void *args1, void *args2)
 {
-    BaseType_t current_core_id = xPortGetCoreID();
-    UBaseType_t current_priority = uxTaskPriorityGet(xTaskGetCurrentTaskHandle());
-    SemaphoreHandle_t semaphore = xSemaphoreCreateCounting(2, 0);
-    TaskHandle_t xHandleTask1, xHandleTask2;
-
-    module_task_data_t task_data1 = {
-        .op = op,
-        .args = args1,
-        .semaphore = semaphore,
-    };
-    xTaskCreatePinnedToCore(
-        module_forward_task, NULL, 2048, &task_data1, current_priority, &xHandleTask1, (current_core_id + 1) % 2);
-
-    module_task_data_t task_data2 = {
-        .op = op,
-        .args = args2,
-        .semaphore = semaphore,
-    };
-    xTaskCreatePinnedToCore(
-        module_forward_task, NULL, 2048, &task_data2, current_priority, &xHandleTask2, current_core_id);
-
-    xSemaphoreTake(semaphore, portMAX_DELAY);
-    xSemaphoreTake(semaphore, portMAX_DELAY);
-    vSemaphoreDelete(semaphore);
-    vTaskDelete(xHandleTask1);
-    vTaskDelete(xHandleTask2);
+    ModuleWorkerPool::get_instance().run(op, args1, args2);
 }
 #pragma GCC diagnostic pop
 
+/**
+ * @brief Run the tasks of the first item of a batch for every item, one layer over the whole batch, so the
+ * parameters of the layer are still in the data cache for the next items.
+ *
+ * The tasks are copied for each item, the kernels may modify them.
+ *
+ * @param op             Module instance
+ * @param args           Tasks of the first item, one or two: ArgsType or PoolArgsType
+ * @param batch          Number of items
+ * @param input_stride   Elements between two items of the input
+ * @param output_stride  Elements between two items of the output
+ */
+template <typename args_t>
+void module_forward_batch(Module *op, std::vector<args_t> &args, int batch, int input_stride, int output_stride)
+{
+    if (args.empty() || args.size() > 2) {
+        ESP_LOGE(op->name, "Only support task size is 1 or 2, currently task size is %d", (int)args.size());
+        return;
+    }
+    for (int b = 0; b < batch; b++) {
+        args_t task0 = args[0];
+        task0.input_element += b * input_stride;
+        task0.output_element += b * output_stride;
+        if (args.size() == 1) {
+            op->forward_args((void *)&task0);
+        } else {
+            args_t task1 = args[1];
+            task1.input_element += b * input_stride;
+            task1.output_element += b * output_stride;
+            module_forward_dual_core(op, (void *)&task0, (void *)&task1);
+        }
+    }
+}
+
 } // namespace module
 } // namespace dl
@@ -90,9 +90,25 @@ public:
         int n_inputs = m_inputs_index.size();
 
         std::vector<T *> inputs_ptr(n_inputs);
+        bool contiguous = true;
         for (size_t i = 0; i < n_inputs; i++) {
             TensorBase *input = context->get_tensor(m_inputs_index[i]);
             inputs_ptr[i] = (T *)input->get_element_ptr();
+            contiguous = contiguous && input->is_contiguous();
+        }
+
+        if (!contiguous) {
+            // strided views of Slice, Split or Transpose, gathered straight into their slice of the output
+            int start = 0;
+            for (size_t i = 0; i < n_inputs; i++) {
+                TensorBase *input = context->get_tensor(m_inputs_index[i]);
+                int end = start + input->shape[this->axis];
+                TensorBase slice(input->get_shape(), output_ptr, output->exponent, output->dtype, false);
+                slice.set_view(output, TensorBase::get_slice_view(output->get_view(), {start}, {end}, {this->axis}));
+                TensorBase::copy_view(&slice, input);
+                start = end;
+            }
+            return;
         }
 
         for (size_t i = 0; i < this->loop_times; i++) {
@@ -27,6 +27,7 @@ public:
         assert(input_shapes[0].size() == 3 || input_shapes[0].size() == 4);
         std::vector<int> input_shape = input_shapes[0];
         std::vector<int> output_shape(input_shape.size(), 1);
+        output_shape[0] = input_shape[0];
         if (input_shape.size() == 3) {
             output_shape[2] = input_shape[2];
         } else if (input_shape.size() == 4) {
@@ -67,14 +68,8 @@ public:
             m_args =
                 base::get_pool_args<T>(output, input, {0, 0, 0, 0}, {input->shape[1], input->shape[2]}, {1, 1}, mode);
         }
-        int task_size = m_args.size();
-        if (task_size == 1) { // single task
-            forward_args((void *)&m_args[0]);
-        } else if (task_size == 2) { // multi task, use semaphore to maintain synchronization.
-            module_forward_dual_core(this, (void *)&m_args[0], (void *)&m_args[1]);
-        } else {
-            ESP_LOGE("GlobalAveragePool", "Only support task size is 1 or 2, currently task size is %d", task_size);
-        }
+        int batch = input->shape[0];
+        module_forward_batch(this, m_args, batch, input->get_size() / batch, output->get_size() / batch);
     }
 
     /**
@@ -79,14 +79,8 @@ public:
 
         std::vector<base::PoolArgsType<T>> m_args =
             base::get_pool_args<T>(output, input, m_padding, m_filter_shape, m_strides, mode);
-        int task_size = m_args.size();
-        if (task_size == 1) { // single task
-            forward_args((void *)&m_args[0]);
-        } else if (task_size == 2) { // multi task, use semaphore to maintain synchronization.
-            module_forward_dual_core(this, (void *)&m_args[0], (void *)&m_args[1]);
-        } else {
-            ESP_LOGE("MaxPool", "Only support task size is 1 or 2, currently task size is %d", task_size);
-        }
+        int batch = input->shape[0];
+        module_forward_batch(this, m_args, batch, input->get_size() / batch, output->get_size() / batch);
     }
 
     /**
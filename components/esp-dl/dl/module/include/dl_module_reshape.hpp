@@ -9,6 +9,7 @@ namespace module {
 class Reshape : public Module {
 private:
     TensorBase *m_shape; /*!< Specified shape for output */
+    int m_batch;         /*!< Batch size the model is planned for, see set_batch_size() */
 
 public:
     /**
@@ -21,7 +22,7 @@ public:
             const char *name = NULL,
             module_inplace_t inplace = MODULE_NON_INPLACE,
             quant_type_t quant_type = QUANT_TYPE_NONE) :
-        Module(name, inplace, quant_type), m_shape(shape)
+        Module(name, inplace, quant_type), m_shape(shape), m_batch(1)
     {
     }
 
@@ -51,6 +52,13 @@ public:
             }
         }
 
+        // the leading 1 of the exported shape is the batch, it follows the input when the model is batched
+        int batch = 1;
+        if (m_batch > 1 && m_shape->get_size() > 1 && shape_param[0] == 1 && input_shapes[0][0] == m_batch) {
+            batch = m_batch;
+            input_size /= batch;
+        }
+
         std::vector<int> output(m_shape->get_size());
         if (negative_index == -1) {
             assert(shape_param_size == input_size);
@@ -67,10 +75,13 @@ public:
                 }
             }
         }
+        output[0] *= batch;
         std::vector<std::vector<int>> output_shapes(1, output);
         return output_shapes;
     }
 
+    void set_batch_size(int batch) { m_batch = batch; }
+
     void forward(ModelContext *context, runtime_mode_t mode)
     {
         TensorBase *input = context->get_tensor(m_inputs_index[0]);
@@ -48,11 +48,24 @@ public:
         return {output_shape};
     }
 
+    std::vector<tensor_view_t> get_output_views(const tensor_view_t &input)
+    {
+        tensor_view_t view = TensorBase::get_slice_view(input, m_start, m_end, m_axes, m_step);
+        if (view.shape.empty()) {
+            return {};
+        }
+        return {view};
+    }
+
     void forward(ModelContext *context, runtime_mode_t mode)
     {
         TensorBase *input = context->get_tensor(m_inputs_index[0]);
         TensorBase *output = context->get_tensor(m_outputs_index[0]);
 
+        if (inplace == MODULE_INPLACE_VIEW) {
+            output->set_view(input, get_output_views(input->get_view())[0]);
+            return;
+        }
         TensorBase::slice(input, output, m_start, m_end, m_axes, m_step);
     }
 
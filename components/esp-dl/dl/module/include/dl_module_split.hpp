@@ -68,6 +68,19 @@ public:
         }
     }
 
+    std::vector<tensor_view_t> get_output_views(const tensor_view_t &input)
+    {
+        std::vector<std::vector<int>> input_shapes = {input.shape};
+        std::vector<std::vector<int>> output_shapes = get_output_shape(input_shapes);
+        std::vector<tensor_view_t> views;
+        int start = 0;
+        for (const std::vector<int> &shape : output_shapes) {
+            views.push_back(TensorBase::get_slice_view(input, {start}, {start + shape[m_axis]}, {m_axis}));
+            start += shape[m_axis];
+        }
+        return views;
+    }
+
     template <typename T>
     void forward_template(
         T *output, T *input, int slice_index, int num_slices, int slice_size, int in_axis_slice, int out_axis_slice)
@@ -92,6 +105,14 @@ public:
         int output_num = m_outputs_index.size();
         int slice_index = 0;
 
+        if (inplace == MODULE_INPLACE_VIEW) {
+            std::vector<tensor_view_t> views = get_output_views(input->get_view());
+            for (int i = 0; i < output_num; i++) {
+                context->get_tensor(m_outputs_index[i])->set_view(input, views[i]);
+            }
+            return;
+        }
+
         for (int i = 0; i < output_num; i++) {
             TensorBase *output = context->get_tensor(m_outputs_index[i]);
 
@@ -51,10 +51,19 @@ public:
         return output_shapes;
     }
 
+    std::vector<tensor_view_t> get_output_views(const tensor_view_t &input)
+    {
+        return {TensorBase::get_transpose_view(input, m_perm)};
+    }
+
     void forward(ModelContext *context, runtime_mode_t mode)
     {
         TensorBase *input = context->get_tensor(m_inputs_index[0]);
         TensorBase *output = context->get_tensor(m_outputs_index[0]);
+        if (inplace == MODULE_INPLACE_VIEW) {
+            output->set_view(input, TensorBase::get_transpose_view(input->get_view(), m_perm));
+            return;
+        }
         output->transpose(input, m_perm);
     }
 
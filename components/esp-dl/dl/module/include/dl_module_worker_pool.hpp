@@ -0,0 +1,135 @@
+#pragma once
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include <atomic>
+#include <stdint.h>
+#include <vector>
+
+namespace dl {
+namespace module {
+class Module;
+
+/**
+ * @brief Dispatch counters of one module, collected by ModuleWorkerPool into Module::dispatch_stats.
+ *
+ * Only the task running the module writes them, without a lock, so a reader on another task may see a
+ * partially updated set.
+ */
+typedef struct {
+    uint32_t calls;          ///< Number of dual-core dispatch requests
+    uint32_t parallel_calls; ///< Requests that actually ran on both cores
+    uint32_t last_chunk_us;  ///< Latest measured run time of one chunk
+    uint64_t total_us;       ///< Accumulated wall time of all requests
+    uint64_t overhead_us;    ///< Accumulated wall time not covered by the longer chunk
+} module_dispatch_stats_t;
+
+/**
+ * @brief Persistent worker tasks used to run the two halves of a module on both cores.
+ *
+ * One worker task is created per core on first use and never deleted. A dispatch hands one
+ * half of the work to the worker of the other core through a task notification, runs the
+ * other half on the calling task and waits for the worker's completion semaphore, so no
+ * task or semaphore is created per layer.
+ *
+ * The split granularity is the minimum chunk run time worth a cross-core dispatch. A module
+ * whose last measured chunk was shorter runs both halves on the calling task instead, so
+ * RUNTIME_MODE_MULTI_CORE never makes small layers slower than a single core.
+ *
+ * A dispatch takes no shared lock: the worker of the other core is claimed with its own lock,
+ * without waiting, and the counters are kept in the module.
+ */
+class ModuleWorkerPool {
+public:
+    typedef void (*job_t)(void *arg); ///< Job run by a worker or by the calling task
+
+    /**
+     * @brief Get the pool shared by all models.
+     */
+    static ModuleWorkerPool &get_instance();
+
+    /**
+     * @brief Run two jobs, the first one on the worker of the other core.
+     *
+     * @param remote      Job handed to the other core
+     * @param remote_arg  Argument of remote
+     * @param local       Job run on the calling task
+     * @param local_arg   Argument of local
+     * @return true if the jobs ran on both cores, false if the worker was unavailable and
+     *         both jobs ran one after the other on the calling task.
+     */
+    bool run_jobs(job_t remote, void *remote_arg, job_t local, void *local_arg);
+
+    /**
+     * @brief Run op->forward_args(args1) and op->forward_args(args2), on both cores if worthwhile.
+     *
+     * @param op     Module instance
+     * @param args1  Args of the half that goes to the other core
+     * @param args2  Args of the half that runs on the calling task
+     */
+    void run(Module *op, void *args1, void *args2);
+
+    /**
+     * @brief Set the split granularity.
+     *
+     * @param min_chunk_us  Minimum chunk run time in microseconds for a module to be dispatched
+     *                      to both cores. 0 always dispatches.
+     */
+    void set_min_chunk_us(uint32_t min_chunk_us) { m_min_chunk_us = min_chunk_us; }
+
+    /**
+     * @brief Get the split granularity, see set_min_chunk_us().
+     */
+    uint32_t get_min_chunk_us() const { return m_min_chunk_us; }
+
+    /**
+     * @brief Get the dispatch counters of one module.
+     *
+     * @return false if the module has never been dispatched.
+     */
+    static bool get_stats(const Module *op, module_dispatch_stats_t &stats);
+
+    /**
+     * @brief Print the dispatch counters of the modules that have been dispatched.
+     *
+     * @param modules  Modules to report, e.g. the execution plan of a model
+     */
+    void print_stats(const std::vector<Module *> &modules);
+
+    /**
+     * @brief Clear the dispatch counters and the measured chunk times of the modules. Call it while the modules are
+     *        not running.
+     *
+     * @param modules  Modules to reset, e.g. the execution plan of a model
+     */
+    static void reset_stats(const std::vector<Module *> &modules);
+
+private:
+    typedef struct {
+        TaskHandle_t task;       ///< Worker task pinned to the core
+        SemaphoreHandle_t lock;  ///< Held by the task that owns the worker during a dispatch
+        SemaphoreHandle_t done;  ///< Given by the worker when its chunk is finished
+        job_t job;               ///< Job handed to the worker
+        void *arg;               ///< Argument of the job
+        int64_t run_us;          ///< Run time of the last job
+        std::atomic<bool> ready; ///< Set once task, lock and done have been created
+    } worker_t;
+
+    ModuleWorkerPool();
+    ModuleWorkerPool(const ModuleWorkerPool &) = delete;
+    ModuleWorkerPool &operator=(const ModuleWorkerPool &) = delete;
+
+    static void worker_loop(void *arg);
+    worker_t *acquire_worker(BaseType_t core_id);
+    bool create_worker(worker_t *worker, BaseType_t core_id);
+    void start(worker_t *worker, job_t job, void *arg);
+    int64_t wait(worker_t *worker);
+    static void record(Module *op, bool parallel, int64_t total_us, int64_t chunk_us);
+
+    worker_t m_workers[portNUM_PROCESSORS] = {};
+    SemaphoreHandle_t m_mutex; ///< Serializes the creation of the workers
+    uint32_t m_min_chunk_us;
+};
+
+} // namespace module
+} // namespace dl
@@ -6,7 +6,7 @@ using namespace dl;
 namespace dl {
 namespace module {
 Module::Module(const char *name, module_inplace_t inplace, quant_type_t quant_type) :
-    inplace(inplace), quant_type(quant_type)
+    trace_name(nullptr), inplace(inplace), quant_type(quant_type), dispatch_stats()
 {
 #if DL_LOG_MODULE_NAME
     if (name) {
@@ -0,0 +1,210 @@
+#include "dl_module_worker_pool.hpp"
+#include "dl_module_base.hpp"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include <inttypes.h>
+
+static const char *TAG = "dl::ModuleWorkerPool";
+
+namespace dl {
+namespace module {
+
+// Workers run forward_args() of a module half or forward() of whole modules for ModelScheduler
+#define DL_MODULE_WORKER_STACK_SIZE 4096
+// Dispatch plus wake-up of a notified task costs a few tens of microseconds on ESP32-S3,
+// chunks shorter than this run faster on one core.
+#define DL_MODULE_WORKER_DEFAULT_MIN_CHUNK_US 40
+
+ModuleWorkerPool &ModuleWorkerPool::get_instance()
+{
+    static ModuleWorkerPool pool;
+    return pool;
+}
+
+ModuleWorkerPool::ModuleWorkerPool() : m_min_chunk_us(DL_MODULE_WORKER_DEFAULT_MIN_CHUNK_US)
+{
+    m_mutex = xSemaphoreCreateMutex();
+}
+
+void ModuleWorkerPool::worker_loop(void *arg)
+{
+    worker_t *worker = (worker_t *)arg;
+    while (true) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        int64_t start = esp_timer_get_time();
+        worker->job(worker->arg);
+        worker->run_us = esp_timer_get_time() - start;
+        xSemaphoreGive(worker->done);
+    }
+}
+
+ModuleWorkerPool::worker_t *ModuleWorkerPool::acquire_worker(BaseType_t core_id)
+{
+    worker_t *worker = &m_workers[core_id];
+    if (!worker->ready.load(std::memory_order_acquire)) {
+        xSemaphoreTake(m_mutex, portMAX_DELAY);
+        if (!worker->ready.load(std::memory_order_relaxed) && !create_worker(worker, core_id)) {
+            xSemaphoreGive(m_mutex);
+            return nullptr;
+        }
+        xSemaphoreGive(m_mutex);
+    }
+    // Another model running on the other core may own the worker, do not wait for it
+    if (xSemaphoreTake(worker->lock, 0) != pdTRUE) {
+        return nullptr;
+    }
+    return worker;
+}
+
+bool ModuleWorkerPool::create_worker(worker_t *worker, BaseType_t core_id)
+{
+    if (!worker->lock) {
+        worker->lock = xSemaphoreCreateMutex();
+    }
+    if (!worker->done) {
+        worker->done = xSemaphoreCreateBinary();
+    }
+    if (!worker->lock || !worker->done ||
+        xTaskCreatePinnedToCore(worker_loop,
+                                "dl_worker",
+                                DL_MODULE_WORKER_STACK_SIZE,
+                                worker,
+                                uxTaskPriorityGet(NULL),
+                                &worker->task,
+                                core_id) != pdPASS) {
+        ESP_LOGE(TAG, "Fail to start the worker on core %d, running single core", (int)core_id);
+        worker->task = NULL;
+        return false;
+    }
+    worker->ready.store(true, std::memory_order_release);
+    return true;
+}
+
+void ModuleWorkerPool::start(worker_t *worker, job_t job, void *arg)
+{
+    UBaseType_t priority = uxTaskPriorityGet(NULL);
+    if (uxTaskPriorityGet(worker->task) != priority) {
+        vTaskPrioritySet(worker->task, priority);
+    }
+    worker->job = job;
+    worker->arg = arg;
+    xTaskNotifyGive(worker->task);
+}
+
+int64_t ModuleWorkerPool::wait(worker_t *worker)
+{
+    xSemaphoreTake(worker->done, portMAX_DELAY);
+    int64_t run_us = worker->run_us;
+    xSemaphoreGive(worker->lock);
+    return run_us;
+}
+
+bool ModuleWorkerPool::run_jobs(job_t remote, void *remote_arg, job_t local, void *local_arg)
+{
+    worker_t *worker = nullptr;
+#if portNUM_PROCESSORS > 1
+    worker = acquire_worker((xPortGetCoreID() + 1) % portNUM_PROCESSORS);
+#endif
+    if (!worker) {
+        remote(remote_arg);
+        local(local_arg);
+        return false;
+    }
+    start(worker, remote, remote_arg);
+    local(local_arg);
+    wait(worker);
+    return true;
+}
+
+typedef struct {
+    Module *op;
+    void *args;
+} forward_args_job_t;
+
+static void forward_args_job(void *arg)
+{
+    forward_args_job_t *job = (forward_args_job_t *)arg;
+    job->op->forward_args(job->args);
+}
+
+void ModuleWorkerPool::run(Module *op, void *args1, void *args2)
+{
+    int64_t start_us = esp_timer_get_time();
+    worker_t *worker = nullptr;
+
+#if portNUM_PROCESSORS > 1
+    if (op->dispatch_stats.calls == 0 || op->dispatch_stats.last_chunk_us >= m_min_chunk_us) {
+        worker = acquire_worker((xPortGetCoreID() + 1) % portNUM_PROCESSORS);
+    }
+#endif
+
+    if (worker) {
+        forward_args_job_t job = {op, args1};
+        start(worker, forward_args_job, &job);
+
+        int64_t local_start = esp_timer_get_time();
+        op->forward_args(args2);
+        int64_t local_us = esp_timer_get_time() - local_start;
+
+        int64_t remote_us = wait(worker);
+        int64_t chunk_us = remote_us > local_us ? remote_us : local_us;
+        record(op, true, esp_timer_get_time() - start_us, chunk_us);
+    } else {
+        op->forward_args(args1);
+        op->forward_args(args2);
+        int64_t total_us = esp_timer_get_time() - start_us;
+        record(op, false, total_us, total_us / 2);
+    }
+}
+
+void ModuleWorkerPool::record(Module *op, bool parallel, int64_t total_us, int64_t chunk_us)
+{
+    module_dispatch_stats_t &stats = op->dispatch_stats;
+    stats.calls++;
+    stats.last_chunk_us = (uint32_t)chunk_us;
+    stats.total_us += total_us;
+    if (parallel) {
+        stats.parallel_calls++;
+        stats.overhead_us += total_us - chunk_us;
+    }
+}
+
+bool ModuleWorkerPool::get_stats(const Module *op, module_dispatch_stats_t &stats)
+{
+    stats = op->dispatch_stats;
+    return stats.calls > 0;
+}
+
+void ModuleWorkerPool::print_stats(const std::vector<Module *> &modules)
+{
+    bool header = false;
+    for (Module *op : modules) {
+        module_dispatch_stats_t stats = op->dispatch_stats;
+        if (stats.calls == 0) {
+            continue;
+        }
+        if (!header) {
+            ESP_LOGI(TAG, "split granularity: %" PRIu32 " us per chunk", m_min_chunk_us);
+            header = true;
+        }
+        ESP_LOGI(TAG,
+                 "%-24s calls: %" PRIu32 ", dual core: %" PRIu32 ", avg: %" PRIu32 " us, chunk: %" PRIu32
+                 " us, dispatch overhead: %" PRIu32 " us",
+                 op->name ? op->name : "(unnamed)",
+                 stats.calls,
+                 stats.parallel_calls,
+                 (uint32_t)(stats.total_us / stats.calls),
+                 stats.last_chunk_us,
+                 stats.parallel_calls ? (uint32_t)(stats.overhead_us / stats.parallel_calls) : 0);
+    }
+}
+
+void ModuleWorkerPool::reset_stats(const std::vector<Module *> &modules)
+{
+    for (Module *op : modules) {
+        op->dispatch_stats = {};
+    }
+}
+
+} // namespace module
+} // namespace dl
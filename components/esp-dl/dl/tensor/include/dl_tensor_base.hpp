@@ -89,6 +89,15 @@ std::string vector_to_string(std::vector<T> shape)
     return str;
 }
 
+/**
+ * @brief Layout of a strided view into the memory of a tensor, see TensorBase::set_view().
+ */
+typedef struct {
+    int offset;                   ///< element offset of the view from the first element of the viewed tensor
+    std::vector<int> shape;       ///< shape of the view
+    std::vector<int> axis_offset; ///< element offset of each axis of the view, i.e. its strides
+} tensor_view_t;
+
 /**
  * @brief This class is designed according to PyTorch Tensor.
  * TensorBase is required to ensure that the first address are aligned to 16 bytes and the memory size should be a
@@ -320,6 +329,66 @@ public:
                           std::vector<int> &input_axis_offset,
                           std::vector<int> &perm);
 
+    /**
+     * @brief Check whether the elements are stored densely in row-major order, i.e. the tensor is not a strided view.
+     *
+     * @return true if axis_offset matches the shape
+     */
+    bool is_contiguous();
+
+    /**
+     * @brief Get the layout of this tensor as a view of itself.
+     *
+     * @return tensor_view_t with offset 0, the shape and the axis offset of this tensor
+     */
+    tensor_view_t get_view() { return {0, this->shape, this->axis_offset}; }
+
+    /**
+     * @brief Make this tensor a non-owning strided view into the memory of input. No data is moved, the exponent and
+     * dtype of this tensor are kept.
+     *
+     * @param input  Tensor owning the memory, may be a view itself
+     * @param view   Layout of the view relative to input, see get_slice_view() and get_transpose_view()
+     * @return TensorBase&  self
+     */
+    TensorBase &set_view(TensorBase *input, const tensor_view_t &view);
+
+    /**
+     * @brief Get the layout of a slice of a view. Only positive steps are supported.
+     *
+     * @param input  Layout of the sliced tensor
+     * @param start  Starting indices
+     * @param end    Ending indices
+     * @param axes   Axes that starts and ends apply to
+     * @param step   Slice step, step = 1 if step is not specified
+     * @return Layout of the slice, with an empty shape if a step is not positive
+     */
+    static tensor_view_t get_slice_view(const tensor_view_t &input,
+                                        const std::vector<int> &start,
+                                        const std::vector<int> &end,
+                                        const std::vector<int> &axes = {},
+                                        const std::vector<int> &step = {});
+
+    /**
+     * @brief Get the layout of a transposed view, the axes are permuted without moving the data.
+     *
+     * @param input  Layout of the transposed tensor
+     * @param perm   The new arangement of the dims. if perm == {}, the dims arangement will be reversed.
+     * @return Layout of the transposed view
+     */
+    static tensor_view_t get_transpose_view(const tensor_view_t &input, std::vector<int> perm = {});
+
+    /**
+     * @brief Copy the elements of input to output in row-major order, following the axis offset of both. The rows
+     * are copied with copy_memory() where both are contiguous along the last axis.
+     *
+     * @warning The dtypes must have the same size. The shapes must be the same unless output is contiguous.
+     *
+     * @param output  Output tensor, may be a strided view
+     * @param input   Input tensor, may be a strided view
+     */
+    static void copy_view(TensorBase *output, TensorBase *input);
+
     /**
      * @brief Check the shape is the same as the shape of input.
      *
@@ -173,6 +173,19 @@ bool TensorBase::assign(TensorBase *tensor)
         return false;
     }
 
+    if (!tensor->is_contiguous()) {
+        // gather the strided view, then convert in place
+        if (this->dtype != tensor->dtype) {
+            return false;
+        }
+        copy_view(this, tensor);
+        if (this->exponent == tensor->exponent) {
+            return true;
+        }
+        TensorBase gathered(this->shape, this->data, tensor->exponent, this->dtype, false);
+        return this->assign(&gathered);
+    }
+
     if (this->exponent == tensor->exponent && this->dtype == tensor->dtype) {
         tool::copy_memory(this->data, tensor->data, this->get_bytes());
     } else if (tensor->dtype == DATA_TYPE_FLOAT) {
@@ -1091,6 +1104,149 @@ void TensorBase::slice(TensorBase *input,
     }
 }
 
+bool TensorBase::is_contiguous()
+{
+    int offset = 1;
+    for (int i = this->shape.size() - 1; i >= 0; i--) {
+        if (this->shape[i] != 1 && this->axis_offset[i] != offset) {
+            return false;
+        }
+        offset *= this->shape[i];
+    }
+    return true;
+}
+
+TensorBase &TensorBase::set_view(TensorBase *input, const tensor_view_t &view)
+{
+    assert(!this->auto_free);
+    assert(view.shape.size() == view.axis_offset.size());
+    this->data = (uint8_t *)input->get_element_ptr() + (size_t)view.offset * input->get_dtype_bytes();
+    this->cache = nullptr;
+    this->shape = view.shape;
+    this->axis_offset = view.axis_offset;
+    this->size = 1;
+    for (int dim : view.shape) {
+        this->size *= dim;
+    }
+    return *this;
+}
+
+tensor_view_t TensorBase::get_slice_view(const tensor_view_t &input,
+                                         const std::vector<int> &start,
+                                         const std::vector<int> &end,
+                                         const std::vector<int> &axes,
+                                         const std::vector<int> &step)
+{
+    tensor_view_t view = input;
+    int dims = input.shape.size();
+    for (int i = 0; i < start.size(); i++) {
+        int axis = i;
+        if (!axes.empty()) {
+            axis = (axes[i] < 0) ? (axes[i] + dims) : axes[i];
+        }
+        int step_i = step.empty() ? 1 : step[i];
+        if (step_i <= 0) {
+            // flipped slices are copied, see _slice()
+            return {0, {}, {}};
+        }
+        int dim = input.shape[axis];
+        int end_i = end[i] > dim ? dim : end[i];
+        int start_i = start[i] < 0 ? (start[i] + dim) : (start[i] % (dim + 1));
+        end_i = end_i < 0 ? (end_i + dim) : (end_i % (dim + 1));
+        assert(start_i < end_i);
+
+        view.offset += start_i * input.axis_offset[axis];
+        view.shape[axis] = 1 + (end_i - start_i - 1) / step_i;
+        view.axis_offset[axis] = input.axis_offset[axis] * step_i;
+    }
+    return view;
+}
+
+tensor_view_t TensorBase::get_transpose_view(const tensor_view_t &input, std::vector<int> perm)
+{
+    int dims = input.shape.size();
+    if (perm.empty()) {
+        for (int i = dims - 1; i >= 0; i--) {
+            perm.push_back(i);
+        }
+    }
+    tensor_view_t view = input;
+    for (int i = 0; i < dims; i++) {
+        int axis = perm[i] < 0 ? perm[i] + dims : perm[i];
+        view.shape[i] = input.shape[axis];
+        view.axis_offset[i] = input.axis_offset[axis];
+    }
+    return view;
+}
+
+template <typename T>
+static void _copy_view(T *output_element, int output_stride, T *input_element, int input_stride, int n)
+{
+    for (int i = 0; i < n; i++) {
+        *output_element = *input_element;
+        output_element += output_stride;
+        input_element += input_stride;
+    }
+}
+
+void TensorBase::copy_view(TensorBase *output, TensorBase *input)
+{
+    assert(output->get_size() == input->get_size());
+    assert(output->get_dtype_bytes() == input->get_dtype_bytes());
+    bool output_dense = output->is_contiguous();
+    if (output_dense && input->is_contiguous()) {
+        tool::copy_memory(output->get_element_ptr(), input->get_element_ptr(), input->get_bytes());
+        return;
+    }
+    assert(output_dense || output->shape == input->shape);
+
+    // walk the rows of the last axis in row-major order
+    size_t bytes = input->get_dtype_bytes();
+    int dims = input->shape.size();
+    int last = dims - 1;
+    int n = input->shape[last];
+    int rows = input->get_size() / n;
+    int input_stride = n == 1 ? 1 : input->axis_offset[last];
+    int output_stride = output_dense || n == 1 ? 1 : output->axis_offset[last];
+    uint8_t *input_element = (uint8_t *)input->get_element_ptr();
+    uint8_t *output_element = (uint8_t *)output->get_element_ptr();
+    std::vector<int> index(dims, 0);
+    for (int r = 0; r < rows; r++) {
+        int input_offset = 0;
+        int output_offset = r * n;
+        if (!output_dense) {
+            output_offset = 0;
+            for (int i = 0; i < last; i++) {
+                output_offset += index[i] * output->axis_offset[i];
+            }
+        }
+        for (int i = 0; i < last; i++) {
+            input_offset += index[i] * input->axis_offset[i];
+        }
+        uint8_t *src = input_element + input_offset * bytes;
+        uint8_t *dst = output_element + output_offset * bytes;
+
+        if (input_stride == 1 && output_stride == 1) {
+            tool::copy_memory(dst, src, n * bytes);
+        } else if (bytes == 1) {
+            _copy_view((int8_t *)dst, output_stride, (int8_t *)src, input_stride, n);
+        } else if (bytes == 2) {
+            _copy_view((int16_t *)dst, output_stride, (int16_t *)src, input_stride, n);
+        } else if (bytes == 4) {
+            _copy_view((int32_t *)dst, output_stride, (int32_t *)src, input_stride, n);
+        } else {
+            _copy_view((int64_t *)dst, output_stride, (int64_t *)src, input_stride, n);
+        }
+
+        for (int i = last - 1; i >= 0; i--) {
+            if (++index[i] < input->shape[i]) {
+                break;
+            }
+            index[i] = 0;
+        }
+    }
+}
+
 template <typename T>
 TensorBase *TensorBase::pad(T *input_element,
                             const std::vector<int> &input_shape,
@@ -0,0 +1,188 @@
+#pragma once
+
+#include <atomic>
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+
+#include "esp_err.h"
+
+namespace dl {
+namespace tool {
+
+/**
+ * @brief One traced span.
+ */
+typedef struct {
+    const char *name;     ///< Op type of the module or zone name, must outlive the export
+    const char *category; ///< "module" for the modules of Model::run, otherwise the pipeline stage
+    int64_t start_us;     ///< esp_timer_get_time() at the start, shared by both cores
+    uint32_t cycles;      ///< CPU cycles spent, counted on the core that ran the span
+    uint32_t bytes;       ///< Bytes of the tensors read and written, 0 if unknown
+    int16_t index;        ///< Index of the module in the execution plan, -1 for zones
+    uint8_t core;         ///< Core that ran the span
+} trace_event_t;
+
+/**
+ * @brief Runtime inference tracer.
+ *
+ * Once enabled, Model::run() records every module it runs, on both cores, and the pipelines record their
+ * pre-processing, model and post-processing stages, so production frames can be profiled without a special build or
+ * the extra loop of Model::profile_module(). While disabled a span costs one load and one branch.
+ *
+ * The events go to a ring buffer of fixed capacity, the oldest ones are overwritten. Slots are claimed with an
+ * atomic increment masked by the power-of-two capacity, so both cores record without a lock and the slots stay in
+ * order when the counter wraps. The buffer is allocated by the first enable() and kept until the end of the program,
+ * a span still being recorded on the other core never sees it freed. An event is only torn if the other core laps the
+ * whole buffer while it is written, keep the capacity well above the number of modules. Export or clear the buffer
+ * between frames, not while a model is running.
+ *
+ * The export is the Chrome trace-event JSON format, to open in chrome://tracing or https://ui.perfetto.dev. Each
+ * core is a thread, the cycles and bytes of a span are in its args. Module spans are named after their op type, the
+ * index in the execution plan is in the args, modules built outside of Model are named "module_<index>".
+ */
+class Tracer {
+public:
+    /**
+     * @brief Get the tracer shared by all models.
+     */
+    static Tracer &get_instance();
+
+    /**
+     * @brief Allocate the ring buffer on the first call and start recording.
+     *
+     * @param capacity  Number of events kept, a power of two, the ring buffer takes capacity * sizeof(trace_event_t)
+     *                  bytes
+     * @return
+     *      - ESP_OK                 Recording
+     *      - ESP_ERR_INVALID_ARG    capacity is not a power of two
+     *      - ESP_ERR_INVALID_STATE  The ring buffer was already allocated with another capacity
+     *      - ESP_ERR_NO_MEM         The ring buffer could not be allocated
+     */
+    esp_err_t enable(uint32_t capacity = 1024);
+
+    /**
+     * @brief Stop recording. The recorded events are kept until clear().
+     */
+    void disable() { m_enabled.store(false, std::memory_order_relaxed); }
+
+    /**
+     * @brief Whether spans are recorded.
+     */
+    bool is_enabled() const { return m_enabled.load(std::memory_order_acquire); }
+
+    /**
+     * @brief Drop the recorded events.
+     */
+    void clear()
+    {
+        m_head.store(0, std::memory_order_relaxed);
+        m_full.store(false, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Get a copy of a span name which is kept until the end of the program, e.g. for the op type of a module
+     *        whose own strings may be freed before the export. Equal names share one copy.
+     *
+     * @param name  Name of the span
+     * @return The copy, never freed
+     */
+    static const char *intern(const std::string &name);
+
+    /**
+     * @brief Record a span which started at start_us and start_cycle on the calling core and ends now.
+     *
+     * @param name         Name of the span, must outlive the export
+     * @param category     Category of the span, must outlive the export
+     * @param start_us     esp_timer_get_time() at the start
+     * @param start_cycle  CPU cycle count at the start
+     * @param bytes        Bytes touched
+     * @param index        Index of the module in the execution plan, -1 if not a module
+     */
+    void record(const char *name,
+                const char *category,
+                int64_t start_us,
+                uint32_t start_cycle,
+                uint32_t bytes = 0,
+                int index = -1);
+
+    /**
+     * @brief Get the number of events in the ring buffer.
+     */
+    uint32_t get_event_count() const;
+
+    /**
+     * @brief Get the number of events overwritten since the last clear(), modulo 2^32.
+     */
+    uint32_t get_dropped_count() const;
+
+    /**
+     * @brief Write the recorded events as Chrome trace-event JSON.
+     *
+     * @param file  Destination, e.g. stdout for the UART console or a file opened on SPIFFS or on the host through
+     *              semihosting
+     * @return
+     *      - ESP_OK            Written
+     *      - ESP_ERR_INVALID_ARG  file is null
+     *      - ESP_FAIL          A write failed
+     */
+    esp_err_t export_chrome_trace(FILE *file) const;
+
+    /**
+     * @brief Write the recorded events as Chrome trace-event JSON into a file.
+     *
+     * @param path  Path of the file, e.g. "/spiffs/trace.json" or "/host/trace.json", overwritten
+     * @return
+     *      - ESP_OK         Written
+     *      - ESP_ERR_NOT_FOUND  The file could not be opened
+     *      - ESP_FAIL       A write failed
+     */
+    esp_err_t export_chrome_trace(const char *path) const;
+
+private:
+    Tracer() : m_events(nullptr), m_capacity(0), m_mask(0), m_head(0), m_full(false), m_enabled(false) {}
+    ~Tracer();
+
+    trace_event_t *m_events;      ///< Set once by the first enable(), freed by the destructor only
+    uint32_t m_capacity;          ///< Number of slots, a power of two
+    uint32_t m_mask;              ///< m_capacity - 1
+    std::atomic<uint32_t> m_head; ///< Number of events claimed since the last clear(), modulo 2^32
+    std::atomic<bool> m_full;     ///< The ring buffer has wrapped since the last clear()
+    std::atomic<bool> m_enabled;  ///< Released after m_events is set, acquired before it is read
+};
+
+/**
+ * @brief Record the lifetime of this object as a span when the tracer is enabled.
+ */
+class TraceScope {
+public:
+    /**
+     * @brief Start a span.
+     *
+     * @param name      Name of the span, must outlive the export
+     * @param category  Category of the span, must outlive the export
+     * @param bytes     Bytes touched, if known
+     */
+    TraceScope(const char *name, const char *category, uint32_t bytes = 0);
+
+    /**
+     * @brief End the span, if end() has not been called.
+     */
+    ~TraceScope() { end(); }
+
+    /**
+     * @brief End the span before the end of the scope.
+     */
+    void end();
+
+private:
+    const char *m_name;
+    const char *m_category;
+    uint32_t m_bytes;
+    int64_t m_start_us;
+    uint32_t m_start_cycle;
+    bool m_enabled;
+};
+
+} // namespace tool
+} // namespace dl
@@ -0,0 +1,193 @@
+#include <inttypes.h>
+#include <set>
+
+#include "dl_tool_trace.hpp"
+#include "esp_cpu.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_rom_sys.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+static const char *TAG = "dl::Tracer";
+
+namespace dl {
+namespace tool {
+
+Tracer &Tracer::get_instance()
+{
+    static Tracer tracer;
+    return tracer;
+}
+
+const char *Tracer::intern(const std::string &name)
+{
+    static SemaphoreHandle_t mutex = xSemaphoreCreateMutex();
+    static std::set<std::string> names;
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    // the nodes of a std::set never move
+    const char *copy = names.insert(name).first->c_str();
+    xSemaphoreGive(mutex);
+    return copy;
+}
+
+Tracer::~Tracer()
+{
+    if (m_events) {
+        heap_caps_free(m_events);
+    }
+}
+
+esp_err_t Tracer::enable(uint32_t capacity)
+{
+    if (capacity == 0 || (capacity & (capacity - 1)) != 0) {
+        ESP_LOGE(TAG, "The capacity must be a power of two, got %" PRIu32, capacity);
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (m_events && capacity != m_capacity) {
+        // The other core may still be recording into the buffer, it is never freed or resized.
+        ESP_LOGE(TAG, "Already enabled with a capacity of %" PRIu32, m_capacity);
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (!m_events) {
+        size_t size = capacity * sizeof(trace_event_t);
+        // keep the internal RAM for the models
+        trace_event_t *events = (trace_event_t *)heap_caps_malloc(size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+        if (!events) {
+            events = (trace_event_t *)heap_caps_malloc(size, MALLOC_CAP_DEFAULT);
+        }
+        if (!events) {
+            ESP_LOGE(TAG, "Failed to allocate %" PRIu32 " trace events", capacity);
+            return ESP_ERR_NO_MEM;
+        }
+        m_capacity = capacity;
+        m_mask = capacity - 1;
+        m_events = events;
+        clear();
+    }
+    m_enabled.store(true, std::memory_order_release);
+    return ESP_OK;
+}
+
+void Tracer::record(
+    const char *name, const char *category, int64_t start_us, uint32_t start_cycle, uint32_t bytes, int index)
+{
+    uint32_t cycles = esp_cpu_get_cycle_count() - start_cycle;
+    if (!is_enabled()) {
+        return;
+    }
+    uint32_t head = m_head.fetch_add(1, std::memory_order_relaxed);
+    if (head >= m_capacity && !m_full.load(std::memory_order_relaxed)) {
+        m_full.store(true, std::memory_order_relaxed);
+    }
+    trace_event_t &event = m_events[head & m_mask];
+    event.name = name;
+    event.category = category;
+    event.start_us = start_us;
+    event.cycles = cycles;
+    event.bytes = bytes;
+    event.index = index;
+    event.core = esp_cpu_get_core_id();
+}
+
+uint32_t Tracer::get_event_count() const
+{
+    uint32_t head = m_head.load(std::memory_order_relaxed);
+    return m_full.load(std::memory_order_relaxed) || head > m_capacity ? m_capacity : head;
+}
+
+uint32_t Tracer::get_dropped_count() const
+{
+    uint32_t head = m_head.load(std::memory_order_relaxed);
+    return m_full.load(std::memory_order_relaxed) || head > m_capacity ? head - m_capacity : 0;
+}
+
+static void write_json_string(FILE *file, const char *str)
+{
+    fputc('"', file);
+    for (const char *c = str ? str : ""; *c; c++) {
+        if (*c == '"' || *c == '\\') {
+            fputc('\\', file);
+        }
+        fputc((unsigned char)*c < 0x20 ? ' ' : *c, file);
+    }
+    fputc('"', file);
+}
+
+esp_err_t Tracer::export_chrome_trace(FILE *file) const
+{
+    if (!file) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    uint32_t head = m_head.load(std::memory_order_relaxed);
+    uint32_t count = get_event_count();
+    uint32_t ticks_per_us = esp_rom_get_cpu_ticks_per_us();
+    if (ticks_per_us == 0) {
+        ticks_per_us = 1;
+    }
+
+    fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+    // oldest first
+    for (uint32_t i = 0; i < count; i++) {
+        const trace_event_t &event = m_events[(head - count + i) & m_mask];
+        fprintf(file, "%s\n{\"name\":", i ? "," : "");
+        if (event.name || event.index < 0) {
+            write_json_string(file, event.name);
+        } else {
+            fprintf(file, "\"module_%d\"", event.index);
+        }
+        fprintf(file, ",\"cat\":");
+        write_json_string(file, event.category);
+        fprintf(file,
+                ",\"ph\":\"X\",\"pid\":0,\"tid\":%d,\"ts\":%" PRId64 ",\"dur\":%" PRIu32 ".%03" PRIu32
+                ",\"args\":{\"cycles\":%" PRIu32 ",\"bytes\":%" PRIu32 ",\"index\":%d}}",
+                event.core,
+                event.start_us,
+                event.cycles / ticks_per_us,
+                (event.cycles % ticks_per_us) * 1000 / ticks_per_us,
+                event.cycles,
+                event.bytes,
+                event.index);
+    }
+    fprintf(file, "\n]}\n");
+    if (ferror(file)) {
+        return ESP_FAIL;
+    }
+    ESP_LOGI(TAG, "Exported %" PRIu32 " events, %" PRIu32 " dropped", count, get_dropped_count());
+    return ESP_OK;
+}
+
+esp_err_t Tracer::export_chrome_trace(const char *path) const
+{
+    FILE *file = fopen(path, "w");
+    if (!file) {
+        ESP_LOGE(TAG, "Failed to open %s", path);
+        return ESP_ERR_NOT_FOUND;
+    }
+    esp_err_t ret = export_chrome_trace(file);
+    if (fclose(file) != 0 && ret == ESP_OK) {
+        ret = ESP_FAIL;
+    }
+    return ret;
+}
+
+TraceScope::TraceScope(const char *name, const char *category, uint32_t bytes) :
+    m_name(name), m_category(category), m_bytes(bytes), m_enabled(Tracer::get_instance().is_enabled())
+{
+    if (m_enabled) {
+        m_start_us = esp_timer_get_time();
+        m_start_cycle = esp_cpu_get_cycle_count();
+    }
+}
+
+void TraceScope::end()
+{
+    if (m_enabled) {
+        Tracer::get_instance().record(m_name, m_category, m_start_us, m_start_cycle, m_bytes);
+        m_enabled = false;
+    }
+}
+
+} // namespace tool
+} // namespace dl
@@ -42,7 +42,8 @@ public:
      *                      Only set this param to false when your PSRAM resource is very tight. This saves PSRAM and
      *                      sacrifices the performance of model inference because the frequency of PSRAM is higher than
      * FLASH. Only takes effect when MODEL_LOCATION_IN_FLASH_RODATA(CONFIG_SPIRAM_RODATA not set) or
-     * MODEL_LOCATION_IN_FLASH_PARTITION.
+     * MODEL_LOCATION_IN_FLASH_PARTITION. The parameters of a plaintext EDL2 model are then read from the
+     * memory-mapped flash without any copy, see Model::pin_parameters() to copy only the hottest ones to RAM.
      *
      * @return  Return nullptr if loading fails. Otherwise return the pointer of FbsModel.
      */
@@ -58,7 +59,8 @@ public:
      *                      Only set this param to false when your PSRAM resource is very tight. This saves PSRAM and
      *                      sacrifices the performance of model inference because the frequency of PSRAM is higher than
      * FLASH. Only takes effect when MODEL_LOCATION_IN_FLASH_RODATA(CONFIG_SPIRAM_RODATA not set) or
-     * MODEL_LOCATION_IN_FLASH_PARTITION.
+     * MODEL_LOCATION_IN_FLASH_PARTITION. The parameters of a plaintext EDL2 model are then read from the
+     * memory-mapped flash without any copy, see Model::pin_parameters() to copy only the hottest ones to RAM.
      *
      * @return  Return nullptr if loading fails. Otherwise return the pointer of FbsModel.
      */
@@ -74,7 +76,8 @@ public:
      *                      Only set this param to false when your PSRAM resource is very tight. This saves PSRAM and
      *                      sacrifices the performance of model inference because the frequency of PSRAM is higher than
      * FLASH. Only takes effect when MODEL_LOCATION_IN_FLASH_RODATA(CONFIG_SPIRAM_RODATA not set) or
-     * MODEL_LOCATION_IN_FLASH_PARTITION.
+     * MODEL_LOCATION_IN_FLASH_PARTITION. The parameters of a plaintext EDL2 model are then read from the
+     * memory-mapped flash without any copy, see Model::pin_parameters() to copy only the hottest ones to RAM.
      *
      * @return  Return nullptr if loading fails. Otherwise return the pointer of FbsModel.
      */
@@ -1,32 +1,87 @@
 #include "fbs_loader.hpp"
 #include "mbedtls/aes.h"
+#include <algorithm>
 
 static const char *TAG = "FbsLoader";
 
 namespace fbs {
 
+#define FBS_AES_CHUNK_SIZE (16 * 1024) // Bytes decrypted at a time
+
 /**
- * @brief This function is used to decrypt the AES 128-bit CTR mode encrypted data.
+ * @brief AES 128-bit CTR mode decryption of Fbs data.
  * AES (Advanced Encryption Standard) is a widely-used symmetric encryption algorithm that provides strong security for
  * data protection CTR mode converts the block cipher into a stream cipher, allowing it to encrypt data of any length
- * without the need for padding
+ * without the need for padding.
+ *
+ * The counter block of byte n is nonce + n / 16, so the stream is seekable: any chunk can be decrypted on its own,
+ * straight into its final location. The key schedule is computed once. mbedtls uses the AES peripheral when
+ * CONFIG_MBEDTLS_HARDWARE_AES is set and its software implementation otherwise.
+ */
+class FbsAesCtr {
+public:
+    /**
+     * @param key  128-bit AES key
+     */
+    FbsAesCtr(const uint8_t *key)
+    {
+        mbedtls_aes_init(&m_ctx);
+        mbedtls_aes_setkey_enc(&m_ctx, key, 128); // 128-bit key
+    }
+
+    ~FbsAesCtr() { mbedtls_aes_free(&m_ctx); }
+
+    /**
+     * @brief Decrypt a chunk of the stream. Input and output may be the same buffer.
+     *
+     * @param ciphertext     Input Fbs data encrypted by AES 128-bit CTR mode
+     * @param plaintext      Decrypted data
+     * @param size           Size of the chunk
+     * @param stream_offset  Offset of the chunk from the beginning of the encrypted data
+     */
+    void crypt(const uint8_t *ciphertext, uint8_t *plaintext, size_t size, size_t stream_offset)
+    {
+        uint8_t nonce[16] = {
+            0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x1A, 0x1B, 0x1C, 0x1D, 0x1E, 0x1F};
+        uint8_t stream_block[16];
+        add_counter(nonce, stream_offset / 16);
+        size_t offset = stream_offset % 16;
+        if (offset) {
+            // continue in the middle of a block
+            mbedtls_aes_crypt_ecb(&m_ctx, MBEDTLS_AES_ENCRYPT, nonce, stream_block);
+            add_counter(nonce, 1);
+        }
+        mbedtls_aes_crypt_ctr(&m_ctx, size, &offset, nonce, stream_block, ciphertext, plaintext);
+    }
+
+private:
+    static void add_counter(uint8_t *counter, size_t value)
+    {
+        // 128-bit big-endian addition, like the increment of mbedtls_aes_crypt_ctr
+        for (int i = 15; i >= 0 && value; i--) {
+            value += counter[i];
+            counter[i] = value & 0xff;
+            value >>= 8;
+        }
+    }
+
+    mbedtls_aes_context m_ctx;
+};
+
+/**
+ * @brief This function is used to decrypt the AES 128-bit CTR mode encrypted data, chunk by chunk.
  *
  * @param ciphertext   Input Fbs data encrypted by AES 128-bit CTR mode
- * @param plaintext    Decrypted data
+ * @param plaintext    Decrypted data, may be the same buffer as ciphertext
  * @param size         Size of input data
  * @param key          128-bit AES key
  */
 void fbs_aes_crypt_ctr(const uint8_t *ciphertext, uint8_t *plaintext, size_t size, const uint8_t *key)
 {
-    mbedtls_aes_context aes_ctx;
-    size_t offset = 0;
-    uint8_t nonce[16] = {
-        0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x1A, 0x1B, 0x1C, 0x1D, 0x1E, 0x1F};
-    uint8_t stream_block[16];
-    mbedtls_aes_init(&aes_ctx);
-    mbedtls_aes_setkey_enc(&aes_ctx, key, 128); // 128-bit key
-    mbedtls_aes_crypt_ctr(&aes_ctx, size, &offset, nonce, stream_block, ciphertext, plaintext);
-    mbedtls_aes_free(&aes_ctx);
+    FbsAesCtr aes(key);
+    for (size_t offset = 0; offset < size; offset += FBS_AES_CHUNK_SIZE) {
+        aes.crypt(ciphertext + offset, plaintext + offset, std::min(size - offset, (size_t)FBS_AES_CHUNK_SIZE), offset);
+    }
 }
 
 /**
@@ -251,17 +306,33 @@ FbsModel *create_fbs_model(const char *fbs_buf,
                 size / 1024.f,
                 heap_caps_get_largest_free_block(MALLOC_CAP_SPIRAM) / 1024.f,
                 heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL) / 1024.f);
+            fclose(f);
             return nullptr;
         }
         if (format == FBS_FILE_FORMAT_EDL2 || format == FBS_FILE_FORMAT_PDL2) {
             fseek(f, 4, SEEK_CUR);
         }
-        fread(model_buf, size, 1, f);
+        if (mode != 0 && key != NULL) {
+            // decrypt each chunk in place right after reading it, while it is still in the data cache
+            FbsAesCtr aes(key);
+            for (size_t pos = 0; pos < size; pos += FBS_AES_CHUNK_SIZE) {
+                size_t chunk = std::min(size - pos, (size_t)FBS_AES_CHUNK_SIZE);
+                uint8_t *chunk_buf = (uint8_t *)model_buf + pos;
+                fread(chunk_buf, chunk, 1, f);
+                aes.crypt(chunk_buf, chunk_buf, chunk, pos);
+            }
+        } else {
+            fread(model_buf, size, 1, f);
+        }
+        fclose(f);
     }
 
     assert(mode == 0 || mode == 1);
     if (mode != 0 && key == NULL) {
         ESP_LOGE(TAG, "This is a cryptographic model, please enter the secret key!");
+        if (model_location == MODEL_LOCATION_IN_SDCARD) {
+            heap_caps_free(model_buf);
+        }
         return nullptr;
     }
 
@@ -292,10 +363,9 @@ FbsModel *create_fbs_model(const char *fbs_buf,
     } else { // 128-bit AES encryption
         auto_free = true;
         param_copy = (format == FBS_FILE_FORMAT_EDL1 || format == FBS_FILE_FORMAT_PDL1) ? true : false;
-        uint8_t *model_buf_decrypt;
-        if (model_location == MODEL_LOCATION_IN_SDCARD) {
-            model_buf_decrypt = (uint8_t *)model_buf;
-        } else {
+        // the sdcard model has been decrypted while reading
+        if (model_location != MODEL_LOCATION_IN_SDCARD) {
+            uint8_t *model_buf_decrypt;
             model_buf_decrypt = (uint8_t *)dl::tool::malloc_aligned(16, size, MALLOC_CAP_DEFAULT);
             if (!model_buf_decrypt) {
                 ESP_LOGE(TAG,
@@ -306,9 +376,9 @@ FbsModel *create_fbs_model(const char *fbs_buf,
                          heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL) / 1024.f);
                 return nullptr;
             }
+            fbs_aes_crypt_ctr((const uint8_t *)model_buf, model_buf_decrypt, size, key);
+            model_buf = (char *)model_buf_decrypt;
         }
-        fbs_aes_crypt_ctr((const uint8_t *)model_buf, model_buf_decrypt, size, key);
-        model_buf = (char *)model_buf_decrypt;
     }
 
     return new FbsModel(model_buf, size, model_location, mode, rodata_move, auto_free, param_copy);
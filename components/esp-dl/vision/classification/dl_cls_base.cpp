@@ -1,4 +1,5 @@
 #include "dl_cls_base.hpp"
+#include "dl_tool_trace.hpp"
 
 namespace dl {
 namespace cls {
@@ -14,15 +15,21 @@ std::vector<dl::cls::result_t> &ClsImpl::run(const dl::image::img_t &img)
 {
     DL_LOG_INFER_LATENCY_INIT();
     DL_LOG_INFER_LATENCY_START();
+    tool::TraceScope pre_trace("pre", "cls");
     m_image_preprocessor->preprocess(img);
+    pre_trace.end();
     DL_LOG_INFER_LATENCY_END_PRINT("cls", "pre");
 
     DL_LOG_INFER_LATENCY_START();
+    tool::TraceScope model_trace("model", "cls");
     m_model->run();
+    model_trace.end();
     DL_LOG_INFER_LATENCY_END_PRINT("cls", "model");
 
     DL_LOG_INFER_LATENCY_START();
+    tool::TraceScope post_trace("post", "cls");
     std::vector<dl::cls::result_t> &result = m_postprocessor->postprocess();
+    post_trace.end();
     DL_LOG_INFER_LATENCY_END_PRINT("cls", "post");
 
     return result;
@@ -1,4 +1,5 @@
 #include "dl_detect_base.hpp"
+#include "dl_tool_trace.hpp"
 
 namespace dl {
 namespace detect {
@@ -14,19 +15,25 @@ std::list<dl::detect::result_t> &DetectImpl::run(const dl::image::img_t &img)
 {
     DL_LOG_INFER_LATENCY_INIT();
     DL_LOG_INFER_LATENCY_START();
+    tool::TraceScope pre_trace("pre", "detect");
     m_image_preprocessor->preprocess(img);
+    pre_trace.end();
     DL_LOG_INFER_LATENCY_END_PRINT("detect", "pre");
 
     DL_LOG_INFER_LATENCY_START();
+    tool::TraceScope model_trace("model", "detect");
     m_model->run();
+    model_trace.end();
     DL_LOG_INFER_LATENCY_END_PRINT("detect", "model");
 
     DL_LOG_INFER_LATENCY_START();
+    tool::TraceScope post_trace("post", "detect");
     m_postprocessor->clear_result();
     m_postprocessor->set_resize_scale_x(m_image_preprocessor->get_resize_scale_x());
     m_postprocessor->set_resize_scale_y(m_image_preprocessor->get_resize_scale_y());
     m_postprocessor->postprocess();
     std::list<dl::detect::result_t> &result = m_postprocessor->get_result(img.width, img.height);
+    post_trace.end();
     DL_LOG_INFER_LATENCY_END_PRINT("detect", "post");
 
     return result;
@@ -35,6 +35,14 @@ inline bool greater_box(result_t a, result_t b)
     return a.score > b.score;
 }
 
+typedef struct {
+    float score;         /*!< score of box */
+    int category;        /*!< category index */
+    int box[4];          /*!< [left_up_x, left_up_y, right_down_x, right_down_y] */
+    int keypoint_offset; /*!< offset of the keypoints in the postprocessor's keypoint pool */
+    int keypoint_num;    /*!< number of keypoint coordinates, 0 if none */
+} box_candidate_t;
+
 typedef struct {
     int stride_y;
     int stride_x;
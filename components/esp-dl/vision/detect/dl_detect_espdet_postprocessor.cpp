@@ -38,16 +38,12 @@ void ESPDetPostProcessor::parse_stage(TensorBase *score, TensorBase *box, const
                         box_data[i] = dequantize(box_ptr[i], box_exp);
                     }
 
-                    result_t new_box = {(int)c,
-                                        dl::math::sigmoid(dequantize(*score_ptr, score_exp)),
-                                        {(int)((center_x - box_data[0] * stride_x) * inv_resize_scale_x),
-                                         (int)((center_y - box_data[1] * stride_y) * inv_resize_scale_y),
-                                         (int)((center_x + box_data[2] * stride_x) * inv_resize_scale_x),
-                                         (int)((center_y + box_data[3] * stride_y) * inv_resize_scale_y)},
-                                        {}};
-
-                    m_box_list.insert(std::upper_bound(m_box_list.begin(), m_box_list.end(), new_box, greater_box),
-                                      new_box);
+                    add_candidate((int)c,
+                                  dl::math::sigmoid(dequantize(*score_ptr, score_exp)),
+                                  (int)((center_x - box_data[0] * stride_x) * inv_resize_scale_x),
+                                  (int)((center_y - box_data[1] * stride_y) * inv_resize_scale_y),
+                                  (int)((center_x + box_data[2] * stride_x) * inv_resize_scale_x),
+                                  (int)((center_y + box_data[3] * stride_y) * inv_resize_scale_y));
                 }
                 score_ptr++;
             }
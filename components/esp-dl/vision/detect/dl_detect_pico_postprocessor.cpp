@@ -41,17 +41,13 @@ void PicoPostprocessor::parse_stage(TensorBase *score, TensorBase *box, const in
                         box_data[i] = dequantize(box_ptr[i], box_exp);
                     }
 
-                    result_t new_box = {
+                    add_candidate(
                         (int)c,
                         sqrtf(dequantize(*score_ptr, score_exp)),
-                        {(int)((center_x - dl::math::dfl_integral(box_data, 7) * stride_x) * inv_resize_scale_x),
-                         (int)((center_y - dl::math::dfl_integral(box_data + 8, 7) * stride_y) * inv_resize_scale_y),
-                         (int)((center_x + dl::math::dfl_integral(box_data + 16, 7) * stride_x) * inv_resize_scale_x),
-                         (int)((center_y + dl::math::dfl_integral(box_data + 24, 7) * stride_y) * inv_resize_scale_y)},
-                        {}};
-
-                    m_box_list.insert(std::upper_bound(m_box_list.begin(), m_box_list.end(), new_box, greater_box),
-                                      new_box);
+                        (int)((center_x - dl::math::dfl_integral(box_data, 7) * stride_x) * inv_resize_scale_x),
+                        (int)((center_y - dl::math::dfl_integral(box_data + 8, 7) * stride_y) * inv_resize_scale_y),
+                        (int)((center_x + dl::math::dfl_integral(box_data + 16, 7) * stride_x) * inv_resize_scale_x),
+                        (int)((center_y + dl::math::dfl_integral(box_data + 24, 7) * stride_y) * inv_resize_scale_y));
                 }
                 score_ptr++;
             }
@@ -1,47 +1,106 @@
 #include "dl_detect_postprocessor.hpp"
+#include <algorithm>
 
 namespace dl {
 namespace detect {
+void DetectPostprocessor::push_result(int index)
+{
+    const box_candidate_t &candidate = m_candidates[index];
+    m_box_list.push_back(
+        {candidate.category,
+         candidate.score,
+         {candidate.box[0], candidate.box[1], candidate.box[2], candidate.box[3]},
+         std::vector<int>(m_candidate_keypoints.begin() + candidate.keypoint_offset,
+                          m_candidate_keypoints.begin() + candidate.keypoint_offset + candidate.keypoint_num)});
+}
+
 void DetectPostprocessor::nms()
 {
-    int kept_number = 0;
-    for (std::list<result_t>::iterator kept = m_box_list.begin(); kept != m_box_list.end(); kept++) {
-        kept_number++;
+    int candidate_num = m_candidates.size();
+    m_order.resize(candidate_num);
+    for (int i = 0; i < candidate_num; i++) {
+        m_order[i] = i;
+    }
+    // higher score first, equal scores in parse order
+    auto higher = [this](int a, int b) {
+        float score_a = m_candidates[a].score, score_b = m_candidates[b].score;
+        return score_a != score_b ? score_a > score_b : a < b;
+    };
 
-        if (kept_number >= m_top_k) {
-            m_box_list.erase(++kept, m_box_list.end());
-            break;
+    int top_k = DL_MAX(m_top_k, 1);
+    int sort_chunk = DL_MAX(4 * top_k, 32);
+    int *kept_x1 = nullptr, *kept_y1 = nullptr, *kept_x2 = nullptr, *kept_y2 = nullptr, *kept_area = nullptr;
+    if (candidate_num > 0) {
+        for (std::vector<int> &kept_box : m_kept_box) {
+            kept_box.resize(top_k);
         }
+        kept_x1 = m_kept_box[0].data();
+        kept_y1 = m_kept_box[1].data();
+        kept_x2 = m_kept_box[2].data();
+        kept_y2 = m_kept_box[3].data();
+        kept_area = m_kept_box[4].data();
+    }
+    m_kept.clear();
 
-        int kept_area = (kept->box[2] - kept->box[0] + 1) * (kept->box[3] - kept->box[1] + 1);
-
-        std::list<result_t>::iterator other = kept;
-        other++;
-        for (; other != m_box_list.end();) {
-            int inter_lt_x = DL_MAX(kept->box[0], other->box[0]);
-            int inter_lt_y = DL_MAX(kept->box[1], other->box[1]);
-            int inter_rb_x = DL_MIN(kept->box[2], other->box[2]);
-            int inter_rb_y = DL_MIN(kept->box[3], other->box[3]);
-
-            int inter_height = inter_rb_y - inter_lt_y + 1;
-            int inter_width = inter_rb_x - inter_lt_x + 1;
+    int kept_num = 0;
+    int sorted_num = 0;
+    for (int i = 0; i < candidate_num && kept_num < top_k; i++) {
+        if (i == sorted_num) {
+            // sort the next chunk only, most frames are done within the first one
+            sorted_num = DL_MIN(candidate_num, sorted_num + sort_chunk);
+            std::partial_sort(m_order.begin() + i, m_order.begin() + sorted_num, m_order.end(), higher);
+        }
 
+        const int *box = m_candidates[m_order[i]].box;
+        int area = (box[2] - box[0] + 1) * (box[3] - box[1] + 1);
+        bool suppressed = false;
+        for (int k = 0; k < kept_num; k++) {
+            int inter_width = DL_MIN(box[2], kept_x2[k]) - DL_MAX(box[0], kept_x1[k]) + 1;
+            int inter_height = DL_MIN(box[3], kept_y2[k]) - DL_MAX(box[1], kept_y1[k]) + 1;
             if (inter_height > 0 && inter_width > 0) {
-                int other_area = (other->box[2] - other->box[0] + 1) * (other->box[3] - other->box[1] + 1);
                 int inter_area = inter_height * inter_width;
-                float iou = (float)inter_area / (kept_area + other_area - inter_area);
+                float iou = (float)inter_area / (kept_area[k] + area - inter_area);
                 if (iou > m_nms_thr) {
-                    other = m_box_list.erase(other);
-                    continue;
+                    suppressed = true;
+                    break;
                 }
             }
-            other++;
         }
+        if (!suppressed) {
+            kept_x1[kept_num] = box[0];
+            kept_y1[kept_num] = box[1];
+            kept_x2[kept_num] = box[2];
+            kept_y2[kept_num] = box[3];
+            kept_area[kept_num] = area;
+            kept_num++;
+            m_kept.push_back(m_order[i]);
+        }
+    }
+
+    for (int index : m_kept) {
+        push_result(index);
     }
+    m_candidates.clear();
+    m_candidate_keypoints.clear();
 }
 
 std::list<result_t> &DetectPostprocessor::get_result(int width, int height)
 {
+    if (!m_candidates.empty()) {
+        // candidates of a postprocessor without nms(), sorted by score
+        m_order.resize(m_candidates.size());
+        for (int i = 0; i < m_order.size(); i++) {
+            m_order[i] = i;
+        }
+        std::stable_sort(m_order.begin(), m_order.end(), [this](int a, int b) {
+            return m_candidates[a].score > m_candidates[b].score;
+        });
+        for (int index : m_order) {
+            push_result(index);
+        }
+        m_candidates.clear();
+        m_candidate_keypoints.clear();
+    }
     for (result_t &res : m_box_list) {
         res.limit_box(width, height);
         res.limit_keypoint(width, height);
@@ -18,18 +18,48 @@ protected:
     float m_top_left_x;
     float m_top_left_y;
     std::list<result_t> m_box_list; /*!< Detected box list */
+    std::vector<box_candidate_t> m_candidates; /*!< Boxes above score_thr in parse order, waiting for nms() */
+    std::vector<int> m_candidate_keypoints;    /*!< Keypoint pool of the candidates */
+    std::vector<int> m_order;                  /*!< Candidate indices, sorted by score chunk by chunk in nms() */
+    std::vector<int> m_kept;                   /*!< Candidate indices kept by nms() */
+    std::vector<int> m_kept_box[5];            /*!< x1, y1, x2, y2 and area of the kept boxes */
+
+    void add_candidate(int category, float score, int x1, int y1, int x2, int y2)
+    {
+        m_candidates.push_back({score, category, {x1, y1, x2, y2}, 0, 0});
+    }
+    void add_candidate(
+        int category, float score, int x1, int y1, int x2, int y2, const int *keypoint, int keypoint_num)
+    {
+        m_candidates.push_back({score, category, {x1, y1, x2, y2}, (int)m_candidate_keypoints.size(), keypoint_num});
+        m_candidate_keypoints.insert(m_candidate_keypoints.end(), keypoint, keypoint + keypoint_num);
+    }
+    void push_result(int index);
 
 public:
     DetectPostprocessor(Model *model, const float score_thr, const float nms_thr, const int top_k) :
         m_model(model), m_score_thr(score_thr), m_nms_thr(nms_thr), m_top_k(top_k) {};
     virtual ~DetectPostprocessor() {};
     virtual void postprocess() = 0;
+    /**
+     * @brief Keep the top_k highest-scoring candidates that do not overlap a higher-scoring kept one by more than
+     *        nms_thr, and append them to the box list, highest score first.
+     *
+     * The candidates are kept in a flat array whose capacity is reused across frames. They are sorted by chunks
+     * only as far as needed, and each candidate is only compared with the boxes kept so far, so the cost is
+     * bounded by candidates * top_k instead of candidates^2.
+     */
     void nms();
     void set_resize_scale_x(float resize_scale_x) { m_resize_scale_x = resize_scale_x; };
     void set_resize_scale_y(float resize_scale_y) { m_resize_scale_y = resize_scale_y; };
     void set_top_left_x(float top_left_x) { m_top_left_x = top_left_x; };
     void set_top_left_y(float top_left_y) { m_top_left_y = top_left_y; };
-    void clear_result() { m_box_list.clear(); };
+    void clear_result()
+    {
+        m_box_list.clear();
+        m_candidates.clear();
+        m_candidate_keypoints.clear();
+    };
     std::list<result_t> &get_result(int width, int height);
 };
 
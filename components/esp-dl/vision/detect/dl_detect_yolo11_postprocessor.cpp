@@ -40,21 +40,17 @@ void yolo11PostProcessor::parse_stage(TensorBase *score, TensorBase *box, const
                         box_data[i] = dequantize(box_ptr[i], box_exp);
                     }
 
-                    result_t new_box = {
+                    add_candidate(
                         (int)c,
                         dl::math::sigmoid(dequantize(*score_ptr, score_exp)),
-                        {(int)((center_x - dl::math::dfl_integral(box_data, reg_max - 1) * stride_x) *
-                               inv_resize_scale_x),
-                         (int)((center_y - dl::math::dfl_integral(box_data + reg_max, reg_max - 1) * stride_y) *
-                               inv_resize_scale_y),
-                         (int)((center_x + dl::math::dfl_integral(box_data + 2 * reg_max, reg_max - 1) * stride_x) *
-                               inv_resize_scale_x),
-                         (int)((center_y + dl::math::dfl_integral(box_data + 3 * reg_max, reg_max - 1) * stride_y) *
-                               inv_resize_scale_y)},
-                        {}};
-
-                    m_box_list.insert(std::upper_bound(m_box_list.begin(), m_box_list.end(), new_box, greater_box),
-                                      new_box);
+                        (int)((center_x - dl::math::dfl_integral(box_data, reg_max - 1) * stride_x) *
+                              inv_resize_scale_x),
+                        (int)((center_y - dl::math::dfl_integral(box_data + reg_max, reg_max - 1) * stride_y) *
+                              inv_resize_scale_y),
+                        (int)((center_x + dl::math::dfl_integral(box_data + 2 * reg_max, reg_max - 1) * stride_x) *
+                              inv_resize_scale_x),
+                        (int)((center_y + dl::math::dfl_integral(box_data + 3 * reg_max, reg_max - 1) * stride_y) *
+                              inv_resize_scale_y));
                 }
                 score_ptr++;
             }
@@ -18,10 +18,10 @@ void yolo11posePostProcessor::parse_stage(TensorBase *score, TensorBase *box, Te
     int W = score->shape[2];
     int C = score->shape[3];
 
-    int coco_kpt_num = 17;
-    int coco_kpt_ch = 3; //(x, y, visibility)
-    int coco_kpt_total = coco_kpt_num * coco_kpt_ch;
-    int coco_kpt_res_total = coco_kpt_num * 2; //(x, y)
+    constexpr int coco_kpt_num = 17;
+    constexpr int coco_kpt_ch = 3; //(x, y, visibility)
+    constexpr int coco_kpt_total = coco_kpt_num * coco_kpt_ch;
+    constexpr int coco_kpt_res_total = coco_kpt_num * 2; //(x, y)
     float coco_kpt_conf_th = 0.5;
 
     T *score_ptr = (T *)score->data;
@@ -50,7 +50,7 @@ void yolo11posePostProcessor::parse_stage(TensorBase *score, TensorBase *box, Te
                         box_data[i] = dequantize(box_ptr[i], box_exp);
                     }
 
-                    std::vector<int> keypoints_vec(coco_kpt_res_total);
+                    int keypoints[coco_kpt_res_total];
                     for (int k = 0; k < coco_kpt_num; k++) {
                         int idx = k * coco_kpt_ch;
                         float kpt_x = dequantize(kpt_ptr[idx], kpt_exp);
@@ -58,32 +58,29 @@ void yolo11posePostProcessor::parse_stage(TensorBase *score, TensorBase *box, Te
                         float kpt_conf = dequantize(kpt_ptr[idx + 2], kpt_exp);
 
                         if (kpt_conf >= coco_kpt_conf_th) {
-                            keypoints_vec[2 * k] =
+                            keypoints[2 * k] =
                                 static_cast<int>((kpt_x * 2.0 * stride_x + (center_x - offset_x)) * inv_resize_scale_x);
-                            keypoints_vec[2 * k + 1] =
+                            keypoints[2 * k + 1] =
                                 static_cast<int>((kpt_y * 2.0 * stride_y + (center_y - offset_y)) * inv_resize_scale_y);
                         } else {
-                            keypoints_vec[2 * k] = 0;
-                            keypoints_vec[2 * k + 1] = 0;
+                            keypoints[2 * k] = 0;
+                            keypoints[2 * k + 1] = 0;
                         }
                     }
 
-                    result_t new_box = {
+                    add_candidate(
                         (int)c,
                         dl::math::sigmoid(dequantize(*score_ptr, score_exp)),
-                        {(int)((center_x - dl::math::dfl_integral(box_data, reg_max - 1) * stride_x) *
-                               inv_resize_scale_x),
-                         (int)((center_y - dl::math::dfl_integral(box_data + reg_max, reg_max - 1) * stride_y) *
-                               inv_resize_scale_y),
-                         (int)((center_x + dl::math::dfl_integral(box_data + 2 * reg_max, reg_max - 1) * stride_x) *
-                               inv_resize_scale_x),
-                         (int)((center_y + dl::math::dfl_integral(box_data + 3 * reg_max, reg_max - 1) * stride_y) *
-                               inv_resize_scale_y)},
-                        keypoints_vec,
-                    };
-
-                    m_box_list.insert(std::upper_bound(m_box_list.begin(), m_box_list.end(), new_box, greater_box),
-                                      new_box);
+                        (int)((center_x - dl::math::dfl_integral(box_data, reg_max - 1) * stride_x) *
+                              inv_resize_scale_x),
+                        (int)((center_y - dl::math::dfl_integral(box_data + reg_max, reg_max - 1) * stride_y) *
+                              inv_resize_scale_y),
+                        (int)((center_x + dl::math::dfl_integral(box_data + 2 * reg_max, reg_max - 1) * stride_x) *
+                              inv_resize_scale_x),
+                        (int)((center_y + dl::math::dfl_integral(box_data + 3 * reg_max, reg_max - 1) * stride_y) *
+                              inv_resize_scale_y),
+                        keypoints,
+                        coco_kpt_res_total);
                 }
                 score_ptr++;
             }
@@ -11,6 +11,7 @@
 #define DL_IMAGE_CAP_RGB565_BYTE_SWAP (1 << 1)
 #define DL_IMAGE_CAP_RGB565_BIG_ENDIAN (1 << 2)
 #define DL_IMAGE_CAP_PPA (1 << 3)
+#define DL_IMAGE_CAP_FLOAT_WARP (1 << 4) // warp_affine with float coordinates instead of fixed-point
 
 // gggbbbbb rrrrrggg
 #define DL_IMAGE_LITTLE_ENDIAN_RGB565_BIT1(x) ((uint8_t)(((x) & 0xF800) >> 8))
@@ -8,7 +8,7 @@ ImagePreprocessor::ImagePreprocessor(Model *model,
                                      const std::vector<float> &std,
                                      uint32_t caps,
                                      const std::string &input_name) :
-    m_mean(mean), m_std(std), m_caps(caps)
+    m_mean(mean), m_std(std), m_caps(caps), m_input_name(input_name)
 {
     m_model_input = model->get_input(input_name);
     assert(m_model_input->dtype == DATA_TYPE_INT8 || m_model_input->dtype == DATA_TYPE_INT16);
@@ -106,10 +106,19 @@ void ImagePreprocessor::preprocess(const img_t &img, const std::vector<int> &cro
 #endif
 }
 
-void ImagePreprocessor::preprocess(const img_t &img, dl::math::Matrix<float> *M_inv)
+void ImagePreprocessor::preprocess(const img_t &img, dl::math::Matrix<float> *M_inv, int batch_index)
 {
     assert(get_img_channel(img) == m_mean.size());
-    warp_affine(img, m_output, DL_IMAGE_INTERPOLATE_NEAREST, M_inv, m_caps, m_norm_lut);
+    assert(batch_index >= 0 && batch_index < m_model_input->shape[0]);
+    img_t output = m_output;
+    output.data = (uint8_t *)m_model_input->data + batch_index * get_img_byte_size(m_output);
+    warp_affine(img, output, DL_IMAGE_INTERPOLATE_NEAREST, M_inv, m_caps, m_norm_lut);
+}
+
+void ImagePreprocessor::rebind(Model *model)
+{
+    m_model_input = model->get_input(m_input_name);
+    m_output.data = m_model_input->data;
 }
 } // namespace image
 } // namespace dl
@@ -22,6 +22,7 @@ private:
     const std::vector<float> m_mean;
     const std::vector<float> m_std;
     uint32_t m_caps;
+    std::string m_input_name;
     void *m_norm_lut;
     std::vector<int> m_crop_area;
     float m_resize_scale_x;
@@ -51,7 +52,22 @@ public:
 
     void preprocess(const img_t &img, const std::vector<int> &crop_area = {});
     void preprocess(const img_t &img, uint16_t rescaled_w, uint16_t rescaled_h, const std::vector<int> &crop_area = {});
-    void preprocess(const img_t &img, dl::math::Matrix<float> *M_inv);
+    /**
+     * @brief Warp the image into one item of the model input.
+     *
+     * @param img          Source image
+     * @param M_inv        Inverse affine transform, from the model input to the image
+     * @param batch_index  Item of the model input written, see Model::set_batch_size()
+     */
+    void preprocess(const img_t &img, dl::math::Matrix<float> *M_inv, int batch_index = 0);
+
+    /**
+     * @brief Follow the model input after the model tensors have been created again, e.g. by
+     *        Model::set_batch_size().
+     *
+     * @param model  The model passed to the constructor
+     */
+    void rebind(Model *model);
 };
 
 } // namespace image
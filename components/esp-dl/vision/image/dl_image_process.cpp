@@ -321,6 +321,225 @@ template void resize_loop<uint16_t>(const img_t &src_img,
                                     float scale_x,
                                     float scale_y);
 
+typedef struct {
+    int p1;   // first source pixel, column or row index
+    int p2;   // second source pixel of bilinear, clamped into the image. Its weight is 0 when clamped.
+    float w1; // x - x1, weight of p2
+    float w2; // x2 - x, weight of p1
+} interp_coord_t;
+
+/**
+ * @brief Source pixel and weights of each output column or row.
+ * The same float expressions as the per pixel interpolation are used, so the fused kernels are bit-exact with
+ * resize_loop, but they are evaluated once per column and row instead of once per pixel.
+ */
+static void get_interp_coords(int dst_size,
+                              float scale_inv,
+                              int begin,
+                              int end,
+                              interpolate_type_t interpolate_type,
+                              std::vector<interp_coord_t> &coords)
+{
+    coords.resize(dst_size);
+    for (int i = 0; i < dst_size; i++) {
+        float x = (i + 0.5f) * scale_inv - 0.5f;
+        x = std::max(std::min(x + begin, (float)(end - 1)), (float)begin);
+        interp_coord_t &coord = coords[i];
+        if (interpolate_type == DL_IMAGE_INTERPOLATE_BILINEAR) {
+            int x1 = (int)x;
+            int x2 = x1 + 1;
+            coord.p1 = x1;
+            coord.p2 = std::min(x2, end - 1);
+            coord.w1 = x - x1;
+            coord.w2 = x2 - x;
+        } else {
+            coord.p1 = (int)(x + 0.5f);
+        }
+    }
+}
+
+template <pix_type_t SRC>
+inline void load_pixel(const uint8_t *row, int x, uint32_t caps, uint8_t *pix)
+{
+    if constexpr (SRC == DL_IMAGE_PIX_TYPE_RGB888) {
+        const uint8_t *ptr = row + 3 * x;
+        pix[0] = ptr[0];
+        pix[1] = ptr[1];
+        pix[2] = ptr[2];
+    } else if constexpr (SRC == DL_IMAGE_PIX_TYPE_RGB565) {
+        convert_pixel_from_rgb565_to_rgb888((uint16_t *)row + x, pix, caps);
+    } else {
+        pix[0] = row[x];
+    }
+}
+
+/**
+ * @brief Normalization table and output position of each source channel.
+ * The channels are swapped when written, the same way convert_pixel does. Only the nearest rgb565 path normalizes
+ * each channel with its own table, the other ones convert through rgb888 with the first table.
+ */
+template <typename T, pix_type_t SRC, interpolate_type_t INTERP>
+inline void get_fused_channels(uint32_t caps, T *norm_lut, T *lut[3], int out[3])
+{
+    lut[0] = lut[1] = lut[2] = norm_lut;
+    if (SRC == DL_IMAGE_PIX_TYPE_RGB565 && INTERP == DL_IMAGE_INTERPOLATE_NEAREST) {
+        lut[1] = norm_lut + 256;
+        lut[2] = norm_lut + 512;
+    }
+    bool swap = (SRC != DL_IMAGE_PIX_TYPE_GRAY) && (caps & DL_IMAGE_CAP_RGB_SWAP);
+    out[0] = swap ? 2 : 0;
+    out[1] = 1;
+    out[2] = swap ? 0 : 2;
+}
+
+/**
+ * @brief Crop, resize, color convert, normalize and quantize in one pass.
+ *
+ * @tparam T       Quantized output type, int8_t or int16_t
+ * @tparam SRC     Source pixel type, DL_IMAGE_PIX_TYPE_RGB888, DL_IMAGE_PIX_TYPE_RGB565 or DL_IMAGE_PIX_TYPE_GRAY
+ * @tparam INTERP  Interpolation type
+ */
+template <typename T, pix_type_t SRC, interpolate_type_t INTERP>
+static void resize_fused_loop(const img_t &src_img,
+                              img_t &dst_img,
+                              uint32_t caps,
+                              T *norm_lut,
+                              const std::vector<interp_coord_t> &cols,
+                              const std::vector<interp_coord_t> &rows)
+{
+    constexpr int channel = (SRC == DL_IMAGE_PIX_TYPE_GRAY) ? 1 : 3;
+    constexpr int src_bytes = (SRC == DL_IMAGE_PIX_TYPE_RGB888) ? 3 : ((SRC == DL_IMAGE_PIX_TYPE_RGB565) ? 2 : 1);
+    uint32_t load_caps = caps & ~DL_IMAGE_CAP_RGB_SWAP;
+    T *lut[3];
+    int out[3];
+    get_fused_channels<T, SRC, INTERP>(caps, norm_lut, lut, out);
+
+    const uint8_t *src = (const uint8_t *)src_img.data;
+    int src_stride = src_img.width * src_bytes;
+    T *dst = (T *)dst_img.data;
+    uint8_t pix[4][3];
+    for (const interp_coord_t &row : rows) {
+        const uint8_t *row1 = src + row.p1 * src_stride;
+        if constexpr (INTERP == DL_IMAGE_INTERPOLATE_NEAREST) {
+            for (const interp_coord_t &col : cols) {
+                load_pixel<SRC>(row1, col.p1, load_caps, pix[0]);
+                for (int c = 0; c < channel; c++) {
+                    dst[out[c]] = lut[c][pix[0][c]];
+                }
+                dst += channel;
+            }
+        } else {
+            const uint8_t *row2 = src + row.p2 * src_stride;
+            for (const interp_coord_t &col : cols) {
+                load_pixel<SRC>(row1, col.p1, load_caps, pix[0]);
+                load_pixel<SRC>(row1, col.p2, load_caps, pix[1]);
+                load_pixel<SRC>(row2, col.p1, load_caps, pix[2]);
+                load_pixel<SRC>(row2, col.p2, load_caps, pix[3]);
+                float A = col.w2 * row.w2;
+                float B = col.w1 * row.w2;
+                float C = col.w2 * row.w1;
+                float D = col.w1 * row.w1;
+                for (int c = 0; c < channel; c++) {
+                    uint8_t value = (uint8_t)(A * pix[0][c] + B * pix[1][c] + C * pix[2][c] + D * pix[3][c] + 0.5f);
+                    dst[out[c]] = lut[c][value];
+                }
+                dst += channel;
+            }
+        }
+    }
+}
+
+template <typename T>
+static void resize_fused_dispatch(const img_t &src_img,
+                                  img_t &dst_img,
+                                  interpolate_type_t interpolate_type,
+                                  uint32_t caps,
+                                  T *norm_lut,
+                                  const std::vector<interp_coord_t> &cols,
+                                  const std::vector<interp_coord_t> &rows)
+{
+    if (interpolate_type == DL_IMAGE_INTERPOLATE_NEAREST) {
+        switch (src_img.pix_type) {
+        case DL_IMAGE_PIX_TYPE_RGB888:
+            resize_fused_loop<T, DL_IMAGE_PIX_TYPE_RGB888, DL_IMAGE_INTERPOLATE_NEAREST>(
+                src_img, dst_img, caps, norm_lut, cols, rows);
+            break;
+        case DL_IMAGE_PIX_TYPE_RGB565:
+            resize_fused_loop<T, DL_IMAGE_PIX_TYPE_RGB565, DL_IMAGE_INTERPOLATE_NEAREST>(
+                src_img, dst_img, caps, norm_lut, cols, rows);
+            break;
+        default:
+            resize_fused_loop<T, DL_IMAGE_PIX_TYPE_GRAY, DL_IMAGE_INTERPOLATE_NEAREST>(
+                src_img, dst_img, caps, norm_lut, cols, rows);
+            break;
+        }
+    } else {
+        switch (src_img.pix_type) {
+        case DL_IMAGE_PIX_TYPE_RGB888:
+            resize_fused_loop<T, DL_IMAGE_PIX_TYPE_RGB888, DL_IMAGE_INTERPOLATE_BILINEAR>(
+                src_img, dst_img, caps, norm_lut, cols, rows);
+            break;
+        case DL_IMAGE_PIX_TYPE_RGB565:
+            resize_fused_loop<T, DL_IMAGE_PIX_TYPE_RGB565, DL_IMAGE_INTERPOLATE_BILINEAR>(
+                src_img, dst_img, caps, norm_lut, cols, rows);
+            break;
+        default:
+            resize_fused_loop<T, DL_IMAGE_PIX_TYPE_GRAY, DL_IMAGE_INTERPOLATE_BILINEAR>(
+                src_img, dst_img, caps, norm_lut, cols, rows);
+            break;
+        }
+    }
+}
+
+bool resize_fused(const img_t &src_img,
+                  img_t &dst_img,
+                  interpolate_type_t interpolate_type,
+                  uint32_t caps,
+                  void *norm_lut,
+                  const std::vector<int> &crop_area,
+                  float scale_x,
+                  float scale_y)
+{
+    if (!norm_lut) {
+        return false;
+    }
+    bool rgb_src = src_img.pix_type == DL_IMAGE_PIX_TYPE_RGB888 || src_img.pix_type == DL_IMAGE_PIX_TYPE_RGB565;
+    bool int8_dst;
+    switch (dst_img.pix_type) {
+    case DL_IMAGE_PIX_TYPE_RGB888_QINT8:
+    case DL_IMAGE_PIX_TYPE_RGB888_QINT16:
+        if (!rgb_src) {
+            return false;
+        }
+        int8_dst = dst_img.pix_type == DL_IMAGE_PIX_TYPE_RGB888_QINT8;
+        break;
+    case DL_IMAGE_PIX_TYPE_GRAY_QINT8:
+    case DL_IMAGE_PIX_TYPE_GRAY_QINT16:
+        if (src_img.pix_type != DL_IMAGE_PIX_TYPE_GRAY) {
+            return false;
+        }
+        int8_dst = dst_img.pix_type == DL_IMAGE_PIX_TYPE_GRAY_QINT8;
+        break;
+    default:
+        return false;
+    }
+
+    std::vector<interp_coord_t> cols, rows;
+    if (crop_area.empty()) {
+        get_interp_coords(dst_img.width, 1.f / scale_x, 0, src_img.width, interpolate_type, cols);
+        get_interp_coords(dst_img.height, 1.f / scale_y, 0, src_img.height, interpolate_type, rows);
+    } else {
+        get_interp_coords(dst_img.width, 1.f / scale_x, crop_area[0], crop_area[2], interpolate_type, cols);
+        get_interp_coords(dst_img.height, 1.f / scale_y, crop_area[1], crop_area[3], interpolate_type, rows);
+    }
+    if (int8_dst) {
+        resize_fused_dispatch<int8_t>(src_img, dst_img, interpolate_type, caps, (int8_t *)norm_lut, cols, rows);
+    } else {
+        resize_fused_dispatch<int16_t>(src_img, dst_img, interpolate_type, caps, (int16_t *)norm_lut, cols, rows);
+    }
+    return true;
+}
+
 void resize(const img_t &src_img,
             img_t &dst_img,
             interpolate_type_t interpolate_type,
@@ -360,6 +579,9 @@ void resize(const img_t &src_img,
         convert_img(src_img, dst_img, caps, norm_lut, crop_area);
         return;
     }
+    if (resize_fused(src_img, dst_img, interpolate_type, caps, norm_lut, crop_area, scale_x, scale_y)) {
+        return;
+    }
 
     switch (dst_img.pix_type) {
     case DL_IMAGE_PIX_TYPE_RGB888:
@@ -671,6 +893,171 @@ template void warp_affine_loop<uint16_t>(const img_t &src_img,
                                          uint32_t caps,
                                          void *norm_lut);
 
+#define DL_IMAGE_WARP_SHIFT 16       // fractional bits of the fixed-point source coordinates
+#define DL_IMAGE_WARP_WEIGHT_SHIFT 11 // fractional bits of the bilinear weights, 255 << 22 still fits in int32_t
+
+/**
+ * @brief Affine warp, color convert, normalize and quantize in one pass, with fixed-point coordinates.
+ * The source coordinates of the first pixel of each row are computed from the matrix, then advance by a constant
+ * fixed-point step along the row. Bilinear weights are truncated to DL_IMAGE_WARP_WEIGHT_SHIFT bits.
+ *
+ * @tparam T       Quantized output type, int8_t or int16_t
+ * @tparam SRC     Source pixel type, DL_IMAGE_PIX_TYPE_RGB888, DL_IMAGE_PIX_TYPE_RGB565 or DL_IMAGE_PIX_TYPE_GRAY
+ * @tparam INTERP  Interpolation type
+ */
+template <typename T, pix_type_t SRC, interpolate_type_t INTERP>
+static void warp_affine_fused_loop(
+    const img_t &src_img, img_t &dst_img, dl::math::Matrix<float> *M_inv, uint32_t caps, T *norm_lut)
+{
+    constexpr int channel = (SRC == DL_IMAGE_PIX_TYPE_GRAY) ? 1 : 3;
+    constexpr int src_bytes = (SRC == DL_IMAGE_PIX_TYPE_RGB888) ? 3 : ((SRC == DL_IMAGE_PIX_TYPE_RGB565) ? 2 : 1);
+    constexpr float one = 1 << DL_IMAGE_WARP_SHIFT;
+    constexpr int32_t half = 1 << (DL_IMAGE_WARP_SHIFT - 1);
+    constexpr int32_t weight_one = 1 << DL_IMAGE_WARP_WEIGHT_SHIFT;
+    constexpr int32_t weight_half = 1 << (2 * DL_IMAGE_WARP_WEIGHT_SHIFT - 1);
+    uint32_t load_caps = caps & ~DL_IMAGE_CAP_RGB_SWAP;
+    T *lut[3];
+    int out[3];
+    get_fused_channels<T, SRC, INTERP>(caps, norm_lut, lut, out);
+
+    const uint8_t *src = (const uint8_t *)src_img.data;
+    int src_stride = src_img.width * src_bytes;
+    int32_t x_max = (src_img.width - 1) << DL_IMAGE_WARP_SHIFT;
+    int32_t y_max = (src_img.height - 1) << DL_IMAGE_WARP_SHIFT;
+    int32_t dx = (int32_t)lroundf(M_inv->array[0][0] * one);
+    int32_t dy = (int32_t)lroundf(M_inv->array[1][0] * one);
+    T *dst = (T *)dst_img.data;
+    uint8_t pix[4][3];
+    for (int i = 0; i < dst_img.height; i++) {
+        int32_t x = (int32_t)lroundf((M_inv->array[0][1] * i + M_inv->array[0][2]) * one);
+        int32_t y = (int32_t)lroundf((M_inv->array[1][1] * i + M_inv->array[1][2]) * one);
+        for (int j = 0; j < dst_img.width; j++, x += dx, y += dy) {
+            int32_t xc = std::max(std::min(x, x_max), 0);
+            int32_t yc = std::max(std::min(y, y_max), 0);
+            if constexpr (INTERP == DL_IMAGE_INTERPOLATE_NEAREST) {
+                const uint8_t *row = src + ((yc + half) >> DL_IMAGE_WARP_SHIFT) * src_stride;
+                load_pixel<SRC>(row, (xc + half) >> DL_IMAGE_WARP_SHIFT, load_caps, pix[0]);
+                for (int c = 0; c < channel; c++) {
+                    dst[out[c]] = lut[c][pix[0][c]];
+                }
+            } else {
+                int x1 = xc >> DL_IMAGE_WARP_SHIFT;
+                int y1 = yc >> DL_IMAGE_WARP_SHIFT;
+                int x2 = std::min(x1 + 1, src_img.width - 1);
+                int y2 = std::min(y1 + 1, src_img.height - 1);
+                int32_t fx = (xc >> (DL_IMAGE_WARP_SHIFT - DL_IMAGE_WARP_WEIGHT_SHIFT)) & (weight_one - 1);
+                int32_t fy = (yc >> (DL_IMAGE_WARP_SHIFT - DL_IMAGE_WARP_WEIGHT_SHIFT)) & (weight_one - 1);
+                const uint8_t *row1 = src + y1 * src_stride;
+                const uint8_t *row2 = src + y2 * src_stride;
+                load_pixel<SRC>(row1, x1, load_caps, pix[0]);
+                load_pixel<SRC>(row1, x2, load_caps, pix[1]);
+                load_pixel<SRC>(row2, x1, load_caps, pix[2]);
+                load_pixel<SRC>(row2, x2, load_caps, pix[3]);
+                for (int c = 0; c < channel; c++) {
+                    int32_t top = pix[0][c] * (weight_one - fx) + pix[1][c] * fx;
+                    int32_t bottom = pix[2][c] * (weight_one - fx) + pix[3][c] * fx;
+                    dst[out[c]] = lut[c][(top * (weight_one - fy) + bottom * fy + weight_half) >>
+                                         (2 * DL_IMAGE_WARP_WEIGHT_SHIFT)];
+                }
+            }
+            dst += channel;
+        }
+    }
+}
+
+template <typename T>
+static void warp_affine_fused_dispatch(const img_t &src_img,
+                                       img_t &dst_img,
+                                       interpolate_type_t interpolate_type,
+                                       dl::math::Matrix<float> *M_inv,
+                                       uint32_t caps,
+                                       T *norm_lut)
+{
+    if (interpolate_type == DL_IMAGE_INTERPOLATE_NEAREST) {
+        switch (src_img.pix_type) {
+        case DL_IMAGE_PIX_TYPE_RGB888:
+            warp_affine_fused_loop<T, DL_IMAGE_PIX_TYPE_RGB888, DL_IMAGE_INTERPOLATE_NEAREST>(
+                src_img, dst_img, M_inv, caps, norm_lut);
+            break;
+        case DL_IMAGE_PIX_TYPE_RGB565:
+            warp_affine_fused_loop<T, DL_IMAGE_PIX_TYPE_RGB565, DL_IMAGE_INTERPOLATE_NEAREST>(
+                src_img, dst_img, M_inv, caps, norm_lut);
+            break;
+        default:
+            warp_affine_fused_loop<T, DL_IMAGE_PIX_TYPE_GRAY, DL_IMAGE_INTERPOLATE_NEAREST>(
+                src_img, dst_img, M_inv, caps, norm_lut);
+            break;
+        }
+    } else {
+        switch (src_img.pix_type) {
+        case DL_IMAGE_PIX_TYPE_RGB888:
+            warp_affine_fused_loop<T, DL_IMAGE_PIX_TYPE_RGB888, DL_IMAGE_INTERPOLATE_BILINEAR>(
+                src_img, dst_img, M_inv, caps, norm_lut);
+            break;
+        case DL_IMAGE_PIX_TYPE_RGB565:
+            warp_affine_fused_loop<T, DL_IMAGE_PIX_TYPE_RGB565, DL_IMAGE_INTERPOLATE_BILINEAR>(
+                src_img, dst_img, M_inv, caps, norm_lut);
+            break;
+        default:
+            warp_affine_fused_loop<T, DL_IMAGE_PIX_TYPE_GRAY, DL_IMAGE_INTERPOLATE_BILINEAR>(
+                src_img, dst_img, M_inv, caps, norm_lut);
+            break;
+        }
+    }
+}
+
+bool warp_affine_fused(const img_t &src_img,
+                       img_t &dst_img,
+                       interpolate_type_t interpolate_type,
+                       dl::math::Matrix<float> *M_inv,
+                       uint32_t caps,
+                       void *norm_lut)
+{
+    if (!norm_lut) {
+        return false;
+    }
+    bool rgb_src = src_img.pix_type == DL_IMAGE_PIX_TYPE_RGB888 || src_img.pix_type == DL_IMAGE_PIX_TYPE_RGB565;
+    bool int8_dst;
+    switch (dst_img.pix_type) {
+    case DL_IMAGE_PIX_TYPE_RGB888_QINT8:
+    case DL_IMAGE_PIX_TYPE_RGB888_QINT16:
+        if (!rgb_src) {
+            return false;
+        }
+        int8_dst = dst_img.pix_type == DL_IMAGE_PIX_TYPE_RGB888_QINT8;
+        break;
+    case DL_IMAGE_PIX_TYPE_GRAY_QINT8:
+    case DL_IMAGE_PIX_TYPE_GRAY_QINT16:
+        if (src_img.pix_type != DL_IMAGE_PIX_TYPE_GRAY) {
+            return false;
+        }
+        int8_dst = dst_img.pix_type == DL_IMAGE_PIX_TYPE_GRAY_QINT8;
+        break;
+    default:
+        return false;
+    }
+
+    // every source coordinate, before clamping, must fit in the fixed-point range
+    const float limit = (float)(1 << (30 - DL_IMAGE_WARP_SHIFT));
+    for (int corner = 0; corner < 4; corner++) {
+        float j = (corner & 1) ? dst_img.width : 0;
+        float i = (corner & 2) ? dst_img.height : 0;
+        for (int k = 0; k < 2; k++) {
+            float coord = M_inv->array[k][0] * j + M_inv->array[k][1] * i + M_inv->array[k][2];
+            if (!(fabsf(coord) < limit)) {
+                return false;
+            }
+        }
+    }
+
+    if (int8_dst) {
+        warp_affine_fused_dispatch<int8_t>(src_img, dst_img, interpolate_type, M_inv, caps, (int8_t *)norm_lut);
+    } else {
+        warp_affine_fused_dispatch<int16_t>(src_img, dst_img, interpolate_type, M_inv, caps, (int16_t *)norm_lut);
+    }
+    return true;
+}
+
 void warp_affine(const img_t &src_img,
                  img_t &dst_img,
                  interpolate_type_t interpolate_type,
@@ -683,6 +1070,11 @@ void warp_affine(const img_t &src_img,
     assert(src_img.height > 0 && src_img.width > 0);
     assert(dst_img.height > 0 && dst_img.width > 0);
 
+    if (!(caps & DL_IMAGE_CAP_FLOAT_WARP) &&
+        warp_affine_fused(src_img, dst_img, interpolate_type, M_inv, caps, norm_lut)) {
+        return;
+    }
+
     switch (dst_img.pix_type) {
     case DL_IMAGE_PIX_TYPE_RGB888:
     case DL_IMAGE_PIX_TYPE_GRAY:
@@ -54,6 +54,20 @@ void resize_loop(const img_t &src_img,
                  const std::vector<int> &crop_area,
                  float scale_x,
                  float scale_y);
+/**
+ * @brief Crop, resize, color convert, normalize and quantize in one pass, with the source pixel and interpolation
+ * weights of every output column and row computed once. Bit-exact with resize_loop. Called by resize().
+ *
+ * @return false if the pixel types are not supported, i.e. the output is not quantized, or gray from rgb.
+ */
+bool resize_fused(const img_t &src_img,
+                  img_t &dst_img,
+                  interpolate_type_t interpolate_type,
+                  uint32_t caps,
+                  void *norm_lut,
+                  const std::vector<int> &crop_area,
+                  float scale_x,
+                  float scale_y);
 void resize(const img_t &src_img,
             img_t &dst_img,
             interpolate_type_t interpolate_type,
@@ -77,6 +91,27 @@ esp_err_t resize_ppa(const img_t &src_img,
                      float *scale_y_ret = nullptr,
                      float ppa_error_thr = 0.3);
 #endif
+template <typename T>
+void warp_affine_loop(const img_t &src_img,
+                      img_t &dst_img,
+                      interpolate_type_t interpolate_type,
+                      dl::math::Matrix<float> *M_inv,
+                      uint32_t caps,
+                      void *norm_lut);
+/**
+ * @brief Affine warp, color convert, normalize and quantize in one pass, with fixed-point coordinates stepped along
+ * each row. Called by warp_affine() unless DL_IMAGE_CAP_FLOAT_WARP is set. The result may differ from
+ * warp_affine_loop where a source coordinate falls on a rounding boundary.
+ *
+ * @return false if the pixel types are not supported, i.e. the output is not quantized, or gray from rgb, or if the
+ *         source coordinates overflow the fixed-point range.
+ */
+bool warp_affine_fused(const img_t &src_img,
+                       img_t &dst_img,
+                       interpolate_type_t interpolate_type,
+                       dl::math::Matrix<float> *M_inv,
+                       uint32_t caps,
+                       void *norm_lut);
 void warp_affine(const img_t &src_img,
                  img_t &dst_img,
                  interpolate_type_t interpolate_type,
@@ -1,4 +1,6 @@
 #include "dl_feat_base.hpp"
+#include "dl_tool_trace.hpp"
+#include <algorithm>
 
 namespace dl {
 namespace feat {
@@ -12,21 +14,78 @@ FeatImpl::~FeatImpl()
 
 TensorBase *FeatImpl::run(const dl::image::img_t &img, const std::vector<int> &landmarks)
 {
+    // a single face must not pay for the whole batch
+    m_model->set_active_batch(1);
+
     DL_LOG_INFER_LATENCY_INIT();
     DL_LOG_INFER_LATENCY_START();
+    tool::TraceScope pre_trace("pre", "feat");
     m_image_preprocessor->preprocess(img, landmarks);
+    pre_trace.end();
     DL_LOG_INFER_LATENCY_END_PRINT("feat", "pre");
 
     DL_LOG_INFER_LATENCY_START();
+    tool::TraceScope model_trace("model", "feat");
     m_model->run();
+    model_trace.end();
     DL_LOG_INFER_LATENCY_END_PRINT("feat", "model");
 
     DL_LOG_INFER_LATENCY_START();
+    tool::TraceScope post_trace("post", "feat");
     dl::TensorBase *feat = m_postprocessor->postprocess();
+    post_trace.end();
     DL_LOG_INFER_LATENCY_END_PRINT("feat", "post");
 
     return feat;
 }
 
+std::vector<TensorBase *> FeatImpl::run_batch(const dl::image::img_t &img,
+                                              const std::vector<std::vector<int>> &landmarks)
+{
+    std::vector<TensorBase *> feats;
+    int n = std::min((int)landmarks.size(), m_model->get_batch_size());
+    if (n == 0) {
+        return feats;
+    }
+    m_model->set_active_batch(n);
+
+    DL_LOG_INFER_LATENCY_INIT();
+    DL_LOG_INFER_LATENCY_START();
+    tool::TraceScope pre_trace("pre", "feat");
+    for (int i = 0; i < n; i++) {
+        m_image_preprocessor->preprocess(img, landmarks[i], i);
+    }
+    pre_trace.end();
+    DL_LOG_INFER_LATENCY_END_PRINT("feat", "pre");
+
+    DL_LOG_INFER_LATENCY_START();
+    tool::TraceScope model_trace("model", "feat");
+    m_model->run();
+    model_trace.end();
+    DL_LOG_INFER_LATENCY_END_PRINT("feat", "model");
+
+    DL_LOG_INFER_LATENCY_START();
+    tool::TraceScope post_trace("post", "feat");
+    for (int i = 0; i < n; i++) {
+        feats.push_back(m_postprocessor->postprocess(i));
+    }
+    post_trace.end();
+    DL_LOG_INFER_LATENCY_END_PRINT("feat", "post");
+
+    return feats;
+}
+
+esp_err_t FeatImpl::set_batch_size(int batch)
+{
+    esp_err_t ret = m_model->set_batch_size(batch);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    // the model tensors have been created again
+    m_image_preprocessor->rebind(m_model);
+    m_postprocessor->rebind(m_model);
+    return ESP_OK;
+}
+
 } // namespace feat
 } // namespace dl
@@ -10,6 +10,29 @@ class Feat {
 public:
     virtual ~Feat() {};
     virtual TensorBase *run(const dl::image::img_t &img, const std::vector<int> &landmarks) = 0;
+
+    /**
+     * @brief Extract the features of several faces of the same image in one run of the model.
+     *
+     * @param img        Source image
+     * @param landmarks  The 5 keypoints of each face, only the first get_batch_size() faces are processed
+     * @return The feature of each processed face, valid until the next run() or run_batch()
+     */
+    virtual std::vector<TensorBase *> run_batch(const dl::image::img_t &img,
+                                                const std::vector<std::vector<int>> &landmarks) = 0;
+
+    /**
+     * @brief Set the maximum number of faces of run_batch(), see Model::set_batch_size().
+     *
+     * @param batch  Number of faces per run
+     * @return esp_err_t
+     */
+    virtual esp_err_t set_batch_size(int batch) = 0;
+
+    /**
+     * @brief Get the maximum number of faces of run_batch().
+     */
+    virtual int get_batch_size() = 0;
     int m_feat_len;
 };
 
@@ -23,6 +46,12 @@ public:
     {
         return m_model->run(img, landmarks);
     }
+    std::vector<TensorBase *> run_batch(const dl::image::img_t &img, const std::vector<std::vector<int>> &landmarks)
+    {
+        return m_model->run_batch(img, landmarks);
+    }
+    esp_err_t set_batch_size(int batch) { return m_model->set_batch_size(batch); }
+    int get_batch_size() { return m_model->get_batch_size(); }
 };
 
 class FeatImpl : public Feat {
@@ -34,6 +63,10 @@ protected:
 public:
     ~FeatImpl();
     TensorBase *run(const dl::image::img_t &img, const std::vector<int> &landmarks) override;
+    std::vector<TensorBase *> run_batch(const dl::image::img_t &img,
+                                        const std::vector<std::vector<int>> &landmarks) override;
+    esp_err_t set_batch_size(int batch) override;
+    int get_batch_size() override { return m_model->get_batch_size(); }
 };
 } // namespace feat
 } // namespace dl
@@ -10,21 +10,23 @@ FeatImagePreprocessor::~FeatImagePreprocessor()
     delete m_image_preprocessor;
 }
 
-void FeatImagePreprocessor::preprocess(const dl::image::img_t &img, const std::vector<int> &landmarks)
+void FeatImagePreprocessor::init_source_coord()
 {
-    assert(landmarks.size() == 10);
-    // align face
     float h_scale = (float)m_image_preprocessor->m_model_input->shape[1] / 112.0;
     float w_scale = (float)m_image_preprocessor->m_model_input->shape[2] / 112.0;
-    dl::math::Matrix<float> source_coord(5, 2);
-    dl::math::Matrix<float> dest_coord(5, 2);
-    dest_coord.set_value(landmarks);
-    for (int i = 0; i < source_coord.h; i++) {
-        source_coord.array[i][0] = w_scale * s_std_ldks_112[2 * i];
-        source_coord.array[i][1] = h_scale * s_std_ldks_112[2 * i + 1];
+    for (int i = 0; i < m_source_coord.h; i++) {
+        m_source_coord.array[i][0] = w_scale * s_std_ldks_112[2 * i];
+        m_source_coord.array[i][1] = h_scale * s_std_ldks_112[2 * i + 1];
     }
-    dl::math::Matrix<float> M_inv = dl::math::get_similarity_transform(source_coord, dest_coord);
-    m_image_preprocessor->preprocess(img, &M_inv);
+}
+
+void FeatImagePreprocessor::preprocess(const dl::image::img_t &img, const std::vector<int> &landmarks, int batch_index)
+{
+    assert(landmarks.size() == 10);
+    // align face
+    m_dest_coord.set_value(landmarks);
+    dl::math::Matrix<float> M_inv = dl::math::get_similarity_transform(m_source_coord, m_dest_coord);
+    m_image_preprocessor->preprocess(img, &M_inv, batch_index);
 }
 } // namespace image
 } // namespace dl
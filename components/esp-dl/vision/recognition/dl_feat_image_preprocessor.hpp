@@ -11,15 +11,38 @@ public:
                           const std::vector<float> &std,
                           uint32_t caps = 0,
                           const std::string &input_name = "") :
-        m_image_preprocessor(new dl::image::ImagePreprocessor(model, mean, std, caps, input_name)) {};
+        m_image_preprocessor(new dl::image::ImagePreprocessor(model, mean, std, caps, input_name)),
+        m_source_coord(5, 2),
+        m_dest_coord(5, 2)
+    {
+        init_source_coord();
+    };
 
     ~FeatImagePreprocessor();
 
-    void preprocess(const dl::image::img_t &img, const std::vector<int> &landmarks);
+    /**
+     * @brief Align a face into one item of the model input.
+     *
+     * @param img          Source image
+     * @param landmarks    The 5 keypoints of the face, x and y interleaved
+     * @param batch_index  Item of the model input written, see Model::set_batch_size()
+     */
+    void preprocess(const dl::image::img_t &img, const std::vector<int> &landmarks, int batch_index = 0);
+
+    /**
+     * @brief Follow the model input after the model tensors have been created again.
+     *
+     * @param model  The model passed to the constructor
+     */
+    void rebind(Model *model) { m_image_preprocessor->rebind(model); }
 
 private:
+    void init_source_coord();
+
     static std::vector<float> s_std_ldks_112;
     dl::image::ImagePreprocessor *m_image_preprocessor;
+    dl::math::Matrix<float> m_source_coord; ///< Standard landmarks scaled to the model input, fixed per model
+    dl::math::Matrix<float> m_dest_coord;
 };
 } // namespace image
 } // namespace dl
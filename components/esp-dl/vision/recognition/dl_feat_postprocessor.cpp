@@ -3,28 +3,65 @@
 namespace dl {
 namespace feat {
 
-FeatPostprocessor::FeatPostprocessor(Model *model, const std::string &output_name)
+FeatPostprocessor::FeatPostprocessor(Model *model, const std::string &output_name) : m_output_name(output_name)
 {
-    m_model_output = model->get_output(output_name);
-    m_feat = new TensorBase(m_model_output->shape, nullptr, 0, DATA_TYPE_FLOAT);
+    bind(model);
 }
 
-TensorBase *FeatPostprocessor::postprocess()
+void FeatPostprocessor::bind(Model *model)
 {
-    m_feat->assign(m_model_output);
-    l2_norm();
-    return m_feat;
+    TensorBase *model_output = model->get_output(m_output_name);
+    int batch = model_output->shape[0];
+    std::vector<int> item_shape = model_output->shape;
+    item_shape[0] = 1;
+    int item_bytes = model_output->get_bytes() / batch;
+    for (int i = 0; i < batch; i++) {
+        m_model_outputs.push_back(new TensorBase(item_shape,
+                                                 (uint8_t *)model_output->data + i * item_bytes,
+                                                 model_output->exponent,
+                                                 model_output->dtype,
+                                                 false,
+                                                 model_output->caps));
+        m_feats.push_back(new TensorBase(item_shape, nullptr, 0, DATA_TYPE_FLOAT));
+    }
+}
+
+void FeatPostprocessor::release()
+{
+    for (TensorBase *model_output : m_model_outputs) {
+        delete model_output;
+    }
+    for (TensorBase *feat : m_feats) {
+        delete feat;
+    }
+    m_model_outputs.clear();
+    m_feats.clear();
+}
+
+void FeatPostprocessor::rebind(Model *model)
+{
+    release();
+    bind(model);
+}
+
+TensorBase *FeatPostprocessor::postprocess(int batch_index)
+{
+    assert(batch_index >= 0 && batch_index < m_feats.size());
+    TensorBase *feat = m_feats[batch_index];
+    feat->assign(m_model_outputs[batch_index]);
+    l2_norm(feat);
+    return feat;
 }
 
-void FeatPostprocessor::l2_norm()
+void FeatPostprocessor::l2_norm(TensorBase *feat)
 {
     float norm = 0;
-    float *ptr = (float *)m_feat->data;
-    for (int i = 0; i < m_feat->get_size(); i++) {
+    float *ptr = (float *)feat->data;
+    for (int i = 0; i < feat->get_size(); i++) {
         norm += (ptr[i] * ptr[i]);
     }
     norm = dl::math::sqrt_newton(norm);
-    for (int i = 0; i < m_feat->get_size(); i++) {
+    for (int i = 0; i < feat->get_size(); i++) {
         ptr[i] /= norm;
     }
 }
@@ -8,14 +8,31 @@ namespace dl {
 namespace feat {
 class FeatPostprocessor {
 private:
-    TensorBase *m_model_output;
-    TensorBase *m_feat;
-    void l2_norm();
+    std::string m_output_name;
+    std::vector<TensorBase *> m_model_outputs; ///< View of each item of the model output
+    std::vector<TensorBase *> m_feats;         ///< Normalized feature of each item
+    void l2_norm(TensorBase *feat);
+    void bind(Model *model);
+    void release();
 
 public:
     FeatPostprocessor(Model *model, const std::string &output_name = "");
-    TensorBase *postprocess();
-    ~FeatPostprocessor() { delete m_feat; }
+
+    /**
+     * @brief Normalize the feature of one item of the model output.
+     *
+     * @param batch_index  Item of the model output, see Model::set_batch_size()
+     * @return The feature, valid until the next postprocess() of the same item
+     */
+    TensorBase *postprocess(int batch_index = 0);
+
+    /**
+     * @brief Follow the model output after the model tensors have been created again.
+     *
+     * @param model  The model passed to the constructor
+     */
+    void rebind(Model *model);
+    ~FeatPostprocessor() { release(); }
 };
 } // namespace feat
 } // namespace dl
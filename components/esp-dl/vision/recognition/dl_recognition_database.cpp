@@ -1,68 +1,171 @@
 #include "dl_recognition_database.hpp"
-#include <sys/stat.h>
+#include <cstddef>
 
 static const char *TAG = "dl::recognition::DataBase";
 
+// Compaction only copies records, the journal itself is read through the storage buffer or mapping.
+#define DL_RECOGNITION_DB_COMPACT_STACK_SIZE 4096
+
 namespace dl {
 namespace recognition {
-DataBase::DataBase(const char *db_path, int feat_len)
+namespace {
+struct storage_guard_t {
+    SemaphoreHandle_t lock;
+    storage_guard_t(SemaphoreHandle_t lock) : lock(lock) { xSemaphoreTake(lock, portMAX_DELAY); }
+    ~storage_guard_t() { xSemaphoreGive(lock); }
+};
+} // namespace
+
+static uint32_t crc32_update(uint32_t crc, const void *data, size_t len)
+{
+    static uint32_t table[256];
+    if (table[1] == 0) {
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t c = i;
+            for (int j = 0; j < 8; j++) {
+                c = (c & 1) ? (0xedb88320 ^ (c >> 1)) : (c >> 1);
+            }
+            table[i] = c;
+        }
+    }
+    const uint8_t *p = (const uint8_t *)data;
+    crc = ~crc;
+    for (size_t i = 0; i < len; i++) {
+        crc = table[(crc ^ p[i]) & 0xff] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+static size_t record_size(uint16_t type, int feat_len)
 {
-    assert(db_path);
-    int length = strlen(db_path) + 1;
-    m_db_path = (char *)malloc(sizeof(char) * length);
-    memcpy(m_db_path, db_path, length);
-    struct stat st;
-    if (stat(db_path, &st) == 0) {
-        load_database_from_storage(feat_len);
-    } else {
-        create_empty_database_in_storage(feat_len);
+    switch (type) {
+    case DB_RECORD_ENROLL:
+        return sizeof(database_record) + sizeof(float) * feat_len;
+    case DB_RECORD_DELETE:
+        return sizeof(database_record);
+    default:
+        return 0;
     }
 }
 
+static uint32_t record_crc(const database_record *record, size_t size)
+{
+    uint32_t crc = crc32_update(0, record, offsetof(database_record, crc));
+    return crc32_update(crc, record + 1, size - sizeof(database_record));
+}
+
+static bool header_is_journal(const uint8_t *data, size_t size)
+{
+    return size >= sizeof(database_header) && ((const database_header *)data)->magic == DL_RECOGNITION_DB_MAGIC;
+}
+
+static bool header_is_valid(const uint8_t *data, size_t size)
+{
+    const database_header *header = (const database_header *)data;
+    return header_is_journal(data, size) && header->version == DL_RECOGNITION_DB_VERSION &&
+        header->crc == crc32_update(0, header, offsetof(database_header, crc));
+}
+
+static bool compaction_due(int num_dead_records, int num_feats_valid)
+{
+    return num_dead_records > std::max(16, num_feats_valid);
+}
+
+/**
+ * @brief Calls fn for every intact record after the header.
+ *
+ * @return offset just past the last intact record
+ */
+template <typename Fn>
+static size_t walk_journal(const uint8_t *data, size_t size, int feat_len, Fn fn)
+{
+    size_t offset = sizeof(database_header);
+    while (offset + sizeof(database_record) <= size) {
+        const database_record *record = (const database_record *)(data + offset);
+        size_t rsize = record_size(record->type, feat_len);
+        if (rsize == 0 || offset + rsize > size || record->crc != record_crc(record, rsize)) {
+            break;
+        }
+        fn(record);
+        offset += rsize;
+    }
+    return offset;
+}
+
+DataBase::DataBase(const char *db_path, int feat_len, feat_store_type_t store_type) :
+    DataBase(new FileStorage(db_path), feat_len, store_type)
+{
+}
+
+DataBase::DataBase(DataBaseStorage *storage, int feat_len, feat_store_type_t store_type) :
+    m_storage(storage),
+    m_feats(feat_len, store_type),
+    m_num_dead_records(0),
+    m_writable(true),
+    m_compact_task(NULL),
+    m_compact_exit(NULL),
+    m_compact_stop(false),
+    m_compact_pending(false)
+{
+    assert(storage);
+    m_storage_lock = xSemaphoreCreateMutex();
+    assert(m_storage_lock);
+    m_meta.num_feats_total = 0;
+    m_meta.num_feats_valid = 0;
+    m_meta.feat_len = feat_len;
+    load_database_from_storage(feat_len);
+}
+
 DataBase::~DataBase()
 {
+    if (m_compact_task) {
+        // Lets a running compaction finish, the storage is deleted below.
+        m_compact_stop = true;
+        xTaskNotifyGive(m_compact_task);
+        xSemaphoreTake(m_compact_exit, portMAX_DELAY);
+    }
+    if (m_compact_exit) {
+        vSemaphoreDelete(m_compact_exit);
+    }
+    vSemaphoreDelete(m_storage_lock);
     clear_all_feats_in_memory();
-    free(m_db_path);
+    delete m_storage;
+}
+
+void DataBase::fill_header(database_header *header, uint16_t num_feats_total) const
+{
+    memset(header, 0, sizeof(database_header));
+    header->magic = DL_RECOGNITION_DB_MAGIC;
+    header->version = DL_RECOGNITION_DB_VERSION;
+    header->feat_len = m_meta.feat_len;
+    header->num_feats_total = num_feats_total;
+    header->crc = crc32_update(0, header, offsetof(database_header, crc));
 }
 
 esp_err_t DataBase::create_empty_database_in_storage(int feat_len)
 {
-    FILE *f = fopen(m_db_path, "wb");
-    size_t size = 0;
-    if (!f) {
-        ESP_LOGE(TAG, "Failed to open db.");
-        return ESP_FAIL;
-    }
     m_meta.num_feats_total = 0;
     m_meta.num_feats_valid = 0;
     m_meta.feat_len = feat_len;
-    size = fwrite(&m_meta, sizeof(database_meta), 1, f);
-    if (size != 1) {
-        ESP_LOGE(TAG, "Failed to write db meta data.");
-        fclose(f);
-        return ESP_FAIL;
-    }
-    fclose(f);
+    database_header header;
+    fill_header(&header, 0);
+    ESP_RETURN_ON_ERROR(m_storage->rewrite(&header, sizeof(header)), TAG, "Failed to write db header.");
+    m_num_dead_records = 0;
+    m_writable = true;
     return ESP_OK;
 }
 
 esp_err_t DataBase::clear_all_feats()
 {
-    if (remove(m_db_path) == -1) {
-        ESP_LOGE(TAG, "Failed to remove db.");
-        return ESP_FAIL;
-    }
+    clear_all_feats_in_memory();
+    storage_guard_t guard(m_storage_lock);
     ESP_RETURN_ON_ERROR(
         create_empty_database_in_storage(m_meta.feat_len), TAG, "Failed to create empty db in storage.");
-    clear_all_feats_in_memory();
     return ESP_OK;
 }
 
 void DataBase::clear_all_feats_in_memory()
 {
-    for (auto it = m_feats.begin(); it != m_feats.end(); it++) {
-        heap_caps_free(it->feat);
-    }
     m_feats.clear();
     m_meta.num_feats_total = 0;
     m_meta.num_feats_valid = 0;
@@ -71,158 +174,300 @@ void DataBase::clear_all_feats_in_memory()
 esp_err_t DataBase::load_database_from_storage(int feat_len)
 {
     clear_all_feats_in_memory();
-    FILE *f = fopen(m_db_path, "rb");
+    const uint8_t *data = nullptr;
     size_t size = 0;
-    if (!f) {
-        ESP_LOGE(TAG, "Failed to open db.");
+    ESP_RETURN_ON_ERROR(m_storage->open(&data, &size), TAG, "Failed to open db.");
+    if (size == 0) {
+        m_storage->close();
+        return create_empty_database_in_storage(feat_len);
+    }
+
+    if (header_is_journal(data, size) && !header_is_valid(data, size)) {
+        // Written by another version of the database, or the header itself is corrupt. Never overwrite it here.
+        ESP_LOGE(TAG,
+                 "Unsupported db version %d or corrupt header, clear the db to use it.",
+                 ((const database_header *)data)->version);
+        m_storage->close();
+        m_writable = false;
+        return ESP_ERR_INVALID_VERSION;
+    }
+    if (!header_is_valid(data, size)) {
+        // Databases written before the journal format are migrated once.
+        esp_err_t ret = load_legacy_database(data, size, feat_len);
+        m_storage->close();
+        return ret;
+    }
+    const database_header *header = (const database_header *)data;
+    if (header->feat_len != feat_len) {
+        ESP_LOGE(TAG, "Feature len in storage does not match feature len in db.");
+        m_storage->close();
+        m_writable = false;
         return ESP_FAIL;
     }
-    size = fread(&m_meta, sizeof(database_meta), 1, f);
-    if (size != 1) {
+
+    // Upper bound of the number of enrolled features, avoids growing the slab while replaying.
+    m_feats.reserve((size - sizeof(database_header)) / record_size(DB_RECORD_ENROLL, feat_len));
+    uint16_t num_feats_total = header->num_feats_total;
+    esp_err_t ret = ESP_OK;
+    size_t valid_size = walk_journal(data, size, feat_len, [&](const database_record *record) {
+        if (record->type == DB_RECORD_ENROLL) {
+            if (m_feats.push_back(record->id, (const float *)(record + 1)) != ESP_OK) {
+                ret = ESP_ERR_NO_MEM;
+            }
+            num_feats_total = std::max(num_feats_total, record->id);
+        } else {
+            int index = m_feats.find(record->id);
+            if (index >= 0) {
+                m_feats.erase(index);
+            }
+            // The delete record and the enroll record it cancels.
+            m_num_dead_records += 2;
+        }
+    });
+    bool torn = m_storage->seal(valid_size) != ESP_OK;
+    m_storage->close();
+    ESP_RETURN_ON_ERROR(ret, TAG, "Failed to load features.");
+
+    m_meta.num_feats_total = num_feats_total;
+    m_meta.num_feats_valid = m_feats.size();
+    if (torn) {
+        ESP_LOGW(TAG, "Dropping torn record at offset %u.", (unsigned)valid_size);
+        return compact();
+    }
+    if (compaction_due(m_num_dead_records, m_meta.num_feats_valid)) {
+        m_compact_pending = true;
+        request_compaction();
+    }
+    return ESP_OK;
+}
+
+esp_err_t DataBase::load_legacy_database(const uint8_t *data, size_t size, int feat_len)
+{
+    database_meta meta;
+    if (size < sizeof(database_meta)) {
         ESP_LOGE(TAG, "Failed to read database meta.");
-        fclose(f);
         return ESP_FAIL;
     }
-    if (feat_len != m_meta.feat_len) {
+    memcpy(&meta, data, sizeof(database_meta));
+    if (meta.feat_len != feat_len) {
         ESP_LOGE(TAG, "Feature len in storage does not match feature len in db.");
-        fclose(f);
+        m_writable = false;
         return ESP_FAIL;
     }
-    uint16_t id;
-    for (int i = 0; i < m_meta.num_feats_total; i++) {
-        size = fread(&id, sizeof(uint16_t), 1, f);
-        if (size != 1) {
-            ESP_LOGE(TAG, "Failed to read feature id.");
-            fclose(f);
-            return ESP_FAIL;
-        }
+    ESP_LOGI(TAG, "Migrating db to journal format.");
+
+    size_t legacy_size = sizeof(uint16_t) + sizeof(float) * feat_len;
+    size_t enroll_size = record_size(DB_RECORD_ENROLL, feat_len);
+    size_t num = std::min((size_t)meta.num_feats_total, (size - sizeof(database_meta)) / legacy_size);
+    uint8_t *buf = (uint8_t *)heap_caps_malloc(sizeof(database_header) + num * enroll_size, MALLOC_CAP_SPIRAM);
+    ESP_RETURN_ON_FALSE(buf, ESP_ERR_NO_MEM, TAG, "Failed to alloc journal buffer.");
+    m_feats.reserve(meta.num_feats_valid);
+
+    size_t offset = sizeof(database_header);
+    const uint8_t *src = data + sizeof(database_meta);
+    for (size_t i = 0; i < num; i++, src += legacy_size) {
+        uint16_t id;
+        memcpy(&id, src, sizeof(uint16_t));
         if (id == 0) {
-            if (fseek(f, sizeof(float) * m_meta.feat_len, SEEK_CUR) != 0) {
-                ESP_LOGE(TAG, "Failed to seek db file.");
-                fclose(f);
-                return ESP_FAIL;
-            }
             continue;
         }
-        float *feat = (float *)heap_caps_malloc(m_meta.feat_len * sizeof(float), MALLOC_CAP_SPIRAM);
-        size = fread(feat, sizeof(float), m_meta.feat_len, f);
-        if (size != m_meta.feat_len) {
-            ESP_LOGE(TAG, "Failed to read feature data.");
-            fclose(f);
-            return ESP_FAIL;
+        database_record *record = (database_record *)(buf + offset);
+        record->type = DB_RECORD_ENROLL;
+        record->id = id;
+        memcpy(record + 1, src + sizeof(uint16_t), sizeof(float) * feat_len);
+        record->crc = record_crc(record, enroll_size);
+        if (m_feats.push_back(id, (const float *)(record + 1)) != ESP_OK) {
+            heap_caps_free(buf);
+            return ESP_ERR_NO_MEM;
         }
-        m_feats.emplace_back(id, feat);
+        offset += enroll_size;
     }
-    if (m_feats.size() != m_meta.num_feats_valid) {
-        ESP_LOGE(TAG, "Incorrect valid feature num.");
-        fclose(f);
-        return ESP_FAIL;
-    }
-    fclose(f);
-    return ESP_OK;
+    m_meta.num_feats_total = meta.num_feats_total;
+    m_meta.num_feats_valid = m_feats.size();
+    fill_header((database_header *)buf, m_meta.num_feats_total);
+    esp_err_t ret = m_storage->rewrite(buf, offset);
+    heap_caps_free(buf);
+    return ret;
 }
 
-esp_err_t DataBase::enroll_feat(TensorBase *feat)
+esp_err_t DataBase::append_record(uint16_t type, uint16_t id, const float *feat)
 {
-    if (feat->dtype != DATA_TYPE_FLOAT) {
-        ESP_LOGE(TAG, "Only support float feature.");
-        return ESP_FAIL;
+    ESP_RETURN_ON_FALSE(m_writable, ESP_ERR_INVALID_STATE, TAG, "The db in storage was not loaded, not writing.");
+    size_t size = record_size(type, m_meta.feat_len);
+    uint8_t *buf = (uint8_t *)heap_caps_malloc(size, MALLOC_CAP_SPIRAM);
+    ESP_RETURN_ON_FALSE(buf, ESP_ERR_NO_MEM, TAG, "Failed to alloc record.");
+    database_record *record = (database_record *)buf;
+    record->type = type;
+    record->id = id;
+    if (type == DB_RECORD_ENROLL) {
+        memcpy(record + 1, feat, sizeof(float) * m_meta.feat_len);
     }
-    if (feat->size != m_meta.feat_len) {
-        ESP_LOGE(TAG, "Feature len to enroll does not match feature len in db.");
-        return ESP_FAIL;
+    record->crc = record_crc(record, size);
+
+    // One write per record, a power cut leaves at most this record torn.
+    storage_guard_t guard(m_storage_lock);
+    esp_err_t ret = m_storage->append(buf, size);
+    if (ret == ESP_ERR_NO_MEM && compact_locked() == ESP_OK) {
+        ret = m_storage->append(buf, size);
     }
-    float *feat_copy = (float *)heap_caps_malloc(m_meta.feat_len * sizeof(float), MALLOC_CAP_SPIRAM);
-    memcpy(feat_copy, feat->data, feat->get_bytes());
+    heap_caps_free(buf);
+    return ret;
+}
 
-    m_feats.emplace_back(m_meta.num_feats_total + 1, feat_copy);
-    m_meta.num_feats_total++;
-    m_meta.num_feats_valid++;
+esp_err_t DataBase::compact()
+{
+    storage_guard_t guard(m_storage_lock);
+    return compact_locked();
+}
 
+esp_err_t DataBase::compact_locked()
+{
+    ESP_RETURN_ON_FALSE(m_writable, ESP_ERR_INVALID_STATE, TAG, "The db in storage was not loaded, not writing.");
+    const uint8_t *data = nullptr;
     size_t size = 0;
-    FILE *f = fopen(m_db_path, "rb+");
-    if (!f) {
-        ESP_LOGE(TAG, "Failed to open db.");
-        return ESP_FAIL;
+    ESP_RETURN_ON_ERROR(m_storage->open(&data, &size), TAG, "Failed to open db.");
+    if (!header_is_valid(data, size)) {
+        m_storage->close();
+        ESP_LOGE(TAG, "Invalid db header, not compacting.");
+        return ESP_ERR_INVALID_STATE;
     }
-    size = fwrite(&m_meta, sizeof(database_meta), 1, f);
-    if (size != 1) {
-        ESP_LOGE(TAG, "Failed to write database meta.");
-        fclose(f);
-        return ESP_FAIL;
-    }
-    if (fseek(f, 0, SEEK_END) != 0) {
-        ESP_LOGE(TAG, "Failed to seek db file.");
-        fclose(f);
-        return ESP_FAIL;
+
+    // The live features are taken from the journal itself, not from memory, so that the compaction task does not
+    // touch the FeatStore used by the caller.
+    size_t enroll_size = record_size(DB_RECORD_ENROLL, m_meta.feat_len);
+    uint16_t num_feats_total = ((const database_header *)data)->num_feats_total;
+    std::vector<bool> deleted(UINT16_MAX + 1, false);
+    std::vector<const database_record *> enrolled;
+    walk_journal(data, size, m_meta.feat_len, [&](const database_record *record) {
+        if (record->type == DB_RECORD_ENROLL) {
+            enrolled.push_back(record);
+            num_feats_total = std::max(num_feats_total, record->id);
+        } else {
+            deleted[record->id] = true;
+        }
+    });
+    size_t new_size = sizeof(database_header);
+    for (const database_record *record : enrolled) {
+        new_size += deleted[record->id] ? 0 : enroll_size;
     }
-    size = fwrite(&m_feats.back().id, sizeof(uint16_t), 1, f);
-    if (size != 1) {
-        ESP_LOGE(TAG, "Failed to write feature id.");
-        fclose(f);
-        return ESP_FAIL;
+    uint8_t *buf = (uint8_t *)heap_caps_malloc(new_size, MALLOC_CAP_SPIRAM);
+    if (!buf) {
+        m_storage->close();
+        ESP_LOGE(TAG, "Failed to alloc %u bytes to compact db.", (unsigned)new_size);
+        return ESP_ERR_NO_MEM;
     }
-    size = fwrite(m_feats.back().feat, sizeof(float), m_meta.feat_len, f);
-    if (size != m_meta.feat_len) {
-        ESP_LOGE(TAG, "Failed to write feature.");
-        fclose(f);
-        return ESP_FAIL;
+
+    // Live enroll records are copied verbatim, so quantized stores never write back rounded features.
+    size_t offset = sizeof(database_header);
+    for (const database_record *record : enrolled) {
+        if (!deleted[record->id]) {
+            memcpy(buf + offset, record, enroll_size);
+            offset += enroll_size;
+        }
     }
-    fclose(f);
+    m_storage->close();
+    fill_header((database_header *)buf, num_feats_total);
+    esp_err_t ret = m_storage->rewrite(buf, new_size);
+    heap_caps_free(buf);
+    ESP_RETURN_ON_ERROR(ret, TAG, "Failed to write compacted db.");
+    m_num_dead_records = 0;
     return ESP_OK;
 }
 
-esp_err_t DataBase::delete_feat(uint16_t id)
+void DataBase::compact_task(void *arg)
 {
-    bool invalid_id = true;
-    for (auto it = m_feats.begin(); it != m_feats.end();) {
-        if (it->id != id) {
-            it++;
-        } else {
-            heap_caps_free(it->feat);
-            it = m_feats.erase(it);
-            m_meta.num_feats_valid--;
-            invalid_id = false;
+    DataBase *db = (DataBase *)arg;
+    while (true) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        if (db->m_compact_stop) {
             break;
         }
+        storage_guard_t guard(db->m_storage_lock);
+        if (db->m_compact_pending && db->compact_locked() != ESP_OK) {
+            // The delete records are durable, compaction is retried on the next delete or boot.
+            ESP_LOGW(TAG, "Failed to compact db.");
+        }
+        db->m_compact_pending = false;
     }
-    if (invalid_id) {
-        ESP_LOGW(TAG, "Invalid id to delete.");
-        return ESP_FAIL;
+    xSemaphoreGive(db->m_compact_exit);
+    vTaskDelete(NULL);
+}
+
+void DataBase::request_compaction()
+{
+    if (!m_compact_task) {
+        if (!m_compact_exit) {
+            m_compact_exit = xSemaphoreCreateBinary();
+        }
+        if (!m_compact_exit ||
+            xTaskCreate(compact_task,
+                        "dl_db_compact",
+                        DL_RECOGNITION_DB_COMPACT_STACK_SIZE,
+                        this,
+                        tskIDLE_PRIORITY + 1,
+                        &m_compact_task) != pdPASS) {
+            ESP_LOGW(TAG, "Failed to start the compaction task, compaction is retried on the next delete or boot.");
+            m_compact_task = NULL;
+            storage_guard_t guard(m_storage_lock);
+            m_compact_pending = false;
+            return;
+        }
     }
-    size_t size = 0;
-    FILE *f = fopen(m_db_path, "rb+");
-    if (!f) {
-        ESP_LOGE(TAG, "Failed to open db.");
-        return ESP_FAIL;
+    xTaskNotifyGive(m_compact_task);
+}
+
+void DataBase::wait_for_compaction()
+{
+    while (true) {
+        {
+            storage_guard_t guard(m_storage_lock);
+            if (!m_compact_pending) {
+                return;
+            }
+        }
+        vTaskDelay(pdMS_TO_TICKS(10));
     }
-    long int offset = sizeof(database_meta) + (sizeof(uint16_t) + sizeof(float) * m_meta.feat_len) * (id - 1);
-    uint16_t id_invalid = 0;
-    if (fseek(f, offset, SEEK_SET) != 0) {
-        ESP_LOGE(TAG, "Failed to seek db file.");
-        fclose(f);
+}
+
+esp_err_t DataBase::enroll_feat(TensorBase *feat)
+{
+    if (feat->dtype != DATA_TYPE_FLOAT) {
+        ESP_LOGE(TAG, "Only support float feature.");
         return ESP_FAIL;
     }
-    size = fwrite(&id_invalid, sizeof(uint16_t), 1, f);
-    if (size != 1) {
-        ESP_LOGE(TAG, "Failed to write feature id.");
-        fclose(f);
+    if (feat->size != m_meta.feat_len) {
+        ESP_LOGE(TAG, "Feature len to enroll does not match feature len in db.");
         return ESP_FAIL;
     }
+    uint16_t id = m_meta.num_feats_total + 1;
+    ESP_RETURN_ON_ERROR(append_record(DB_RECORD_ENROLL, id, (float *)feat->data), TAG, "Failed to write feature.");
+    ESP_RETURN_ON_ERROR(m_feats.push_back(id, (float *)feat->data), TAG, "Failed to store feature.");
+    m_meta.num_feats_total++;
+    m_meta.num_feats_valid++;
+    return ESP_OK;
+}
 
-    offset = sizeof(uint16_t);
-    if (fseek(f, offset, SEEK_SET) != 0) {
-        ESP_LOGE(TAG, "Failed to seek db file.");
-        fclose(f);
+esp_err_t DataBase::delete_feat(uint16_t id)
+{
+    int index = m_feats.find(id);
+    if (index < 0) {
+        ESP_LOGW(TAG, "Invalid id to delete.");
         return ESP_FAIL;
     }
-    size = fwrite(&m_meta.num_feats_valid, sizeof(uint16_t), 1, f);
-    if (size != 1) {
-        ESP_LOGE(TAG, "Failed to write valid feature num.");
-        fclose(f);
-        return ESP_FAIL;
+    ESP_RETURN_ON_ERROR(append_record(DB_RECORD_DELETE, id, nullptr), TAG, "Failed to write delete record.");
+    m_feats.erase(index);
+    m_meta.num_feats_valid--;
+
+    bool due;
+    {
+        storage_guard_t guard(m_storage_lock);
+        m_num_dead_records += 2;
+        due = !m_compact_pending && compaction_due(m_num_dead_records, m_meta.num_feats_valid);
+        m_compact_pending = m_compact_pending || due;
+    }
+    if (due) {
+        request_compaction();
     }
-    fclose(f);
     return ESP_OK;
 }
 
@@ -232,43 +477,21 @@ esp_err_t DataBase::delete_last_feat()
         ESP_LOGW(TAG, "Empty db, nothing to delete");
         return ESP_FAIL;
     }
-    uint16_t id = m_feats.back().id;
+    uint16_t id = m_feats.back_id();
     return delete_feat(id);
 }
 
-float DataBase::cal_similarity(float *feat1, float *feat2)
-{
-    float sum = 0;
-    for (int i = 0; i < m_meta.feat_len; i++) {
-        sum += feat1[i] * feat2[i];
-    }
-    return sum;
-}
-
 std::vector<result_t> DataBase::query_feat(TensorBase *feat, float thr, int top_k)
 {
     if (top_k < 1) {
         ESP_LOGW(TAG, "Top_k should be greater than 0.");
         return {};
     }
-    std::vector<result_t> results;
-    float sim;
-    int i = 1;
-    for (auto it = m_feats.begin(); it != m_feats.end(); it++, i++) {
-        sim = cal_similarity(it->feat, (float *)feat->data);
-        if (sim <= thr) {
-            continue;
-        }
-        // results.emplace_back(it->id, sim);
-        results.emplace_back(i, sim);
-    }
-    std::sort(results.begin(), results.end(), [](const result_t &a, const result_t &b) -> bool {
-        return a.similarity > b.similarity;
-    });
-    if (results.size() > top_k) {
-        results.resize(top_k);
+    if (feat->dtype != DATA_TYPE_FLOAT || feat->size != m_meta.feat_len) {
+        ESP_LOGE(TAG, "Query feature must be float with the feature len of the db.");
+        return {};
     }
-    return results;
+    return m_feats.query((float *)feat->data, thr, top_k);
 }
 
 void DataBase::print()
@@ -279,10 +502,12 @@ void DataBase::print()
            m_meta.num_feats_valid,
            m_meta.feat_len);
     printf("[feats]\n");
-    for (auto it : m_feats) {
-        printf("id: %d feat: ", it.id);
-        for (int i = 0; i < m_meta.feat_len; i++) {
-            printf("%f, ", it.feat[i]);
+    std::vector<float> feat(m_meta.feat_len);
+    for (int i = 0; i < m_feats.size(); i++) {
+        m_feats.get_feat(i, feat.data());
+        printf("id: %d feat: ", m_feats.get_id(i));
+        for (int j = 0; j < m_meta.feat_len; j++) {
+            printf("%f, ", feat[j]);
         }
         printf("\n");
     }
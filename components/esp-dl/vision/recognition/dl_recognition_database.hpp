@@ -1,34 +1,77 @@
 #pragma once
 #include "dl_recognition_define.hpp"
+#include "dl_recognition_feat_store.hpp"
+#include "dl_recognition_storage.hpp"
 #include "dl_tensor_base.hpp"
 #include "esp_check.h"
 #include "esp_system.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
 #include <algorithm>
-#include <list>
 
 namespace dl {
 namespace recognition {
+/**
+ * @brief Face feature database.
+ *
+ * Features live in memory in a FeatStore and are persisted as an append-only journal: a checksummed header followed
+ * by enroll and delete records. Every operation appends one record, a power cut can at most lose the record being
+ * written. Deleted features are dropped from the journal by compaction. Compaction rewrites the whole journal, so
+ * when deleted features outnumber the live ones it runs on a low priority background task and delete_feat() only
+ * appends the delete record. It runs synchronously when a torn tail is found at load time, because appends can not
+ * follow a torn record, and when the storage is full.
+ *
+ * A journal written by an unknown version of the database is left untouched and the database refuses to write until
+ * clear_all_feats() is called.
+ */
 class DataBase {
 public:
-    DataBase(const char *db_path, int feat_len);
+    DataBase(const char *db_path, int feat_len, feat_store_type_t store_type = FEAT_STORE_FLOAT);
+    /**
+     * @param storage    journal backend, the database takes ownership
+     */
+    DataBase(DataBaseStorage *storage, int feat_len, feat_store_type_t store_type = FEAT_STORE_FLOAT);
     virtual ~DataBase();
     esp_err_t clear_all_feats();
     esp_err_t enroll_feat(TensorBase *feat);
     esp_err_t delete_feat(uint16_t id);
     esp_err_t delete_last_feat();
+    /**
+     * @brief Rewrites the journal without the deleted features, on the calling task.
+     */
+    esp_err_t compact();
+    /**
+     * @brief Blocks until the background compaction requested by delete_feat(), if any, is finished.
+     */
+    void wait_for_compaction();
     std::vector<result_t> query_feat(TensorBase *feat, float thr, int top_k);
     void print();
     int get_num_feats() { return m_meta.num_feats_valid; }
+    FeatStore &get_feat_store() { return m_feats; }
 
 private:
-    char *m_db_path;
-    std::list<database_feat> m_feats;
+    DataBaseStorage *m_storage;
+    FeatStore m_feats;
     database_meta m_meta;
+    int m_num_dead_records; /*!< records in the journal that compaction would drop */
+    bool m_writable;        /*!< false if the journal in storage could not be loaded */
 
+    SemaphoreHandle_t m_storage_lock; /*!< serializes the storage and m_num_dead_records with the compaction task */
+    TaskHandle_t m_compact_task;      /*!< background compaction, created on first use */
+    SemaphoreHandle_t m_compact_exit; /*!< given by the compaction task when it stops */
+    volatile bool m_compact_stop;
+    bool m_compact_pending;
+
+    static void compact_task(void *arg);
+    void request_compaction();
+    esp_err_t compact_locked();
     esp_err_t create_empty_database_in_storage(int feat_len);
     esp_err_t load_database_from_storage(int feat_len);
+    esp_err_t load_legacy_database(const uint8_t *data, size_t size, int feat_len);
+    esp_err_t append_record(uint16_t type, uint16_t id, const float *feat);
+    void fill_header(database_header *header, uint16_t num_feats_total) const;
     void clear_all_feats_in_memory();
-    float cal_similarity(float *feat1, float *feat2);
 };
 } // namespace recognition
 } // namespace dl
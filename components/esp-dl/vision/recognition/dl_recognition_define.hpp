@@ -14,6 +14,35 @@ typedef struct {
     float *feat;
 } database_feat;
 
+#define DL_RECOGNITION_DB_MAGIC 0x4a424446 /*!< "FDBJ" */
+#define DL_RECOGNITION_DB_VERSION 2
+
+/**
+ * @brief Header of the database journal.
+ */
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t feat_len;
+    uint16_t num_feats_total; /*!< ids are never reused, the next enrolled id is num_feats_total + 1 */
+    uint16_t reserved;
+    uint32_t crc; /*!< crc32 of the fields above */
+} database_header;
+
+typedef enum {
+    DB_RECORD_ENROLL = 1, /*!< followed by feat_len floats */
+    DB_RECORD_DELETE = 2, /*!< no payload */
+} database_record_type_t;
+
+/**
+ * @brief Journal record. Records are only ever appended, a torn or corrupt record ends the journal.
+ */
+typedef struct {
+    uint16_t type;
+    uint16_t id;
+    uint32_t crc; /*!< crc32 of type, id and the payload */
+} database_record;
+
 typedef struct {
     uint16_t id;
     float similarity;
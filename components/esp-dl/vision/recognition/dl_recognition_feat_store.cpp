@@ -0,0 +1,183 @@
+#include "dl_recognition_feat_store.hpp"
+#include "dl_base_dotprod.hpp"
+#include "dl_tool.hpp"
+#include "esp_check.h"
+#include <algorithm>
+
+static const char *TAG = "dl::recognition::FeatStore";
+
+namespace dl {
+namespace recognition {
+static const int s_int16_exponent = -14;
+static const int s_int8_exponent = -7;
+
+static int element_bytes(feat_store_type_t type)
+{
+    switch (type) {
+    case FEAT_STORE_INT16:
+        return sizeof(int16_t);
+    case FEAT_STORE_INT8:
+        return sizeof(int8_t);
+    default:
+        return sizeof(float);
+    }
+}
+
+FeatStore::FeatStore(int feat_len, feat_store_type_t type, uint32_t caps) :
+    m_feat_len(feat_len), m_type(type), m_caps(caps), m_capacity(0), m_num(0), m_slab(nullptr), m_query(nullptr)
+{
+    int bytes = element_bytes(type);
+    m_row_bytes = (feat_len * bytes + 15) & ~15;
+    m_row_len = m_row_bytes / bytes;
+    m_query = tool::calloc_aligned(16, 1, m_row_bytes, caps);
+}
+
+FeatStore::~FeatStore()
+{
+    heap_caps_free(m_slab);
+    heap_caps_free(m_query);
+}
+
+esp_err_t FeatStore::reserve(int capacity)
+{
+    if (capacity <= m_capacity) {
+        return ESP_OK;
+    }
+    uint8_t *slab = (uint8_t *)tool::malloc_aligned(16, (size_t)capacity * m_row_bytes, m_caps);
+    if (!slab) {
+        ESP_LOGE(TAG, "Failed to alloc feature slab for %d features.", capacity);
+        return ESP_ERR_NO_MEM;
+    }
+    if (m_num) {
+        memcpy(slab, m_slab, (size_t)m_num * m_row_bytes);
+    }
+    heap_caps_free(m_slab);
+    m_slab = slab;
+    m_capacity = capacity;
+    m_ids.reserve(capacity);
+    m_candidates.reserve(capacity);
+    return ESP_OK;
+}
+
+void FeatStore::quantize(const float *feat, void *dst) const
+{
+    switch (m_type) {
+    case FEAT_STORE_INT16: {
+        int16_t *out = (int16_t *)dst;
+        float scale = DL_SCALE(-s_int16_exponent);
+        for (int i = 0; i < m_feat_len; i++) {
+            tool::truncate(out[i], tool::round(feat[i] * scale));
+        }
+        break;
+    }
+    case FEAT_STORE_INT8: {
+        int8_t *out = (int8_t *)dst;
+        float scale = DL_SCALE(-s_int8_exponent);
+        for (int i = 0; i < m_feat_len; i++) {
+            tool::truncate(out[i], tool::round(feat[i] * scale));
+        }
+        break;
+    }
+    default:
+        memcpy(dst, feat, m_feat_len * sizeof(float));
+        break;
+    }
+}
+
+float FeatStore::similarity(const void *row_ptr, const void *query_ptr) const
+{
+    // Padding is zero in both rows, so the kernels can always run over whole rows.
+    switch (m_type) {
+    case FEAT_STORE_INT16:
+        return base::dotprod((const int16_t *)row_ptr, (const int16_t *)query_ptr, m_row_len) *
+            DL_RESCALE(-2 * s_int16_exponent);
+    case FEAT_STORE_INT8:
+        return base::dotprod((const int8_t *)row_ptr, (const int8_t *)query_ptr, m_row_len) *
+            DL_RESCALE(-2 * s_int8_exponent);
+    default:
+        return base::dotprod((const float *)row_ptr, (const float *)query_ptr, m_row_len);
+    }
+}
+
+esp_err_t FeatStore::push_back(uint16_t id, const float *feat)
+{
+    if (m_num == m_capacity) {
+        ESP_RETURN_ON_ERROR(reserve(m_capacity ? m_capacity * 2 : 8), TAG, "Failed to grow feature store.");
+    }
+    uint8_t *dst = row(m_num);
+    memset(dst, 0, m_row_bytes);
+    quantize(feat, dst);
+    m_ids.push_back(id);
+    m_num++;
+    return ESP_OK;
+}
+
+void FeatStore::erase(int index)
+{
+    assert(index >= 0 && index < m_num);
+    // Keep rows in enrollment order, query results refer to row positions.
+    if (index < m_num - 1) {
+        memmove(row(index), row(index + 1), (size_t)(m_num - index - 1) * m_row_bytes);
+    }
+    m_ids.erase(m_ids.begin() + index);
+    m_num--;
+}
+
+void FeatStore::clear()
+{
+    m_ids.clear();
+    m_num = 0;
+}
+
+int FeatStore::find(uint16_t id) const
+{
+    auto it = std::find(m_ids.begin(), m_ids.end(), id);
+    return it == m_ids.end() ? -1 : (int)(it - m_ids.begin());
+}
+
+void FeatStore::get_feat(int index, float *feat) const
+{
+    const uint8_t *src = row(index);
+    switch (m_type) {
+    case FEAT_STORE_INT16:
+        for (int i = 0; i < m_feat_len; i++) {
+            feat[i] = ((const int16_t *)src)[i] * DL_RESCALE(-s_int16_exponent);
+        }
+        break;
+    case FEAT_STORE_INT8:
+        for (int i = 0; i < m_feat_len; i++) {
+            feat[i] = ((const int8_t *)src)[i] * DL_RESCALE(-s_int8_exponent);
+        }
+        break;
+    default:
+        memcpy(feat, src, m_feat_len * sizeof(float));
+        break;
+    }
+}
+
+std::vector<result_t> FeatStore::query(const float *feat, float thr, int top_k)
+{
+    if (top_k < 1 || m_num == 0) {
+        return {};
+    }
+    quantize(feat, m_query);
+
+    m_candidates.clear();
+    for (int i = 0; i < m_num; i++) {
+        float sim = similarity(row(i), m_query);
+        if (sim > thr) {
+            m_candidates.push_back({(uint16_t)(i + 1), sim});
+        }
+    }
+
+    // Only the top_k best candidates need to be ordered.
+    int k = std::min(top_k, (int)m_candidates.size());
+    std::partial_sort(m_candidates.begin(),
+                      m_candidates.begin() + k,
+                      m_candidates.end(),
+                      [](const result_t &a, const result_t &b) -> bool { return a.similarity > b.similarity; });
+    return std::vector<result_t>(m_candidates.begin(), m_candidates.begin() + k);
+}
+
+} // namespace recognition
+} // namespace dl
@@ -0,0 +1,71 @@
+#pragma once
+#include "dl_recognition_define.hpp"
+#include "esp_err.h"
+#include "esp_heap_caps.h"
+#include <vector>
+
+namespace dl {
+namespace recognition {
+typedef enum {
+    FEAT_STORE_FLOAT = 0, /*!< features are kept as float */
+    FEAT_STORE_INT16,     /*!< features are quantized to int16 with exponent -14 */
+    FEAT_STORE_INT8,      /*!< features are quantized to int8 with exponent -7 */
+} feat_store_type_t;
+
+/**
+ * @brief Structure-of-arrays store for enrolled features.
+ *
+ * All features live in one 16-byte aligned slab, each row zero padded to a multiple of 16 bytes so the SIMD dot
+ * product can run over whole rows. Ids are kept in a parallel array. The slab grows geometrically, so enrolling many
+ * identities costs a handful of allocations instead of one per feature.
+ *
+ * Features are expected to be L2 normalized. Under that assumption the quantized dot products can not overflow the
+ * 32-bit accumulator.
+ */
+class FeatStore {
+public:
+    FeatStore(int feat_len, feat_store_type_t type = FEAT_STORE_FLOAT, uint32_t caps = MALLOC_CAP_SPIRAM);
+    ~FeatStore();
+    FeatStore(const FeatStore &) = delete;
+    FeatStore &operator=(const FeatStore &) = delete;
+
+    esp_err_t reserve(int capacity);
+    esp_err_t push_back(uint16_t id, const float *feat);
+    void erase(int index);
+    void clear();
+    int find(uint16_t id) const;
+    int size() const { return m_num; }
+    bool empty() const { return m_num == 0; }
+    uint16_t get_id(int index) const { return m_ids[index]; }
+    uint16_t back_id() const { return m_ids[m_num - 1]; }
+    void get_feat(int index, float *feat) const;
+
+    /**
+     * @brief Finds the rows most similar to feat.
+     *
+     * @param feat  query feature, feat_len floats
+     * @param thr   only rows with similarity greater than thr are returned
+     * @param top_k maximum number of results
+     * @return results sorted by descending similarity, id is the 1-based row index
+     */
+    std::vector<result_t> query(const float *feat, float thr, int top_k);
+
+private:
+    int m_feat_len;
+    feat_store_type_t m_type;
+    uint32_t m_caps;
+    int m_row_len;   /*!< elements per row, padded so a row is a multiple of 16 bytes */
+    int m_row_bytes; /*!< bytes per row */
+    int m_capacity;
+    int m_num;
+    uint8_t *m_slab;
+    void *m_query; /*!< scratch row holding the quantized query */
+    std::vector<uint16_t> m_ids;
+    std::vector<result_t> m_candidates;
+
+    uint8_t *row(int index) const { return m_slab + (size_t)index * m_row_bytes; }
+    void quantize(const float *feat, void *dst) const;
+    float similarity(const void *row_ptr, const void *query_ptr) const;
+};
+} // namespace recognition
+} // namespace dl
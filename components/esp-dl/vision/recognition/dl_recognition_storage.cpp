@@ -0,0 +1,241 @@
+#include "dl_recognition_storage.hpp"
+#include "esp_check.h"
+#include "esp_heap_caps.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+
+static const char *TAG = "dl::recognition::Storage";
+
+namespace dl {
+namespace recognition {
+static const uint32_t s_slot_magic = 0x534c4244; // "DBLS"
+
+static char *dup_path(const char *path, const char *suffix)
+{
+    size_t len = strlen(path) + strlen(suffix) + 1;
+    char *ret = (char *)malloc(len);
+    snprintf(ret, len, "%s%s", path, suffix);
+    return ret;
+}
+
+static esp_err_t write_file(const char *path, const char *mode, const void *data, size_t size)
+{
+    FILE *f = fopen(path, mode);
+    if (!f) {
+        ESP_LOGE(TAG, "Failed to open %s.", path);
+        return ESP_FAIL;
+    }
+    if (size && fwrite(data, 1, size, f) != size) {
+        ESP_LOGE(TAG, "Failed to write %s.", path);
+        fclose(f);
+        return ESP_FAIL;
+    }
+    fflush(f);
+    fsync(fileno(f));
+    fclose(f);
+    return ESP_OK;
+}
+
+FileStorage::FileStorage(const char *path) : m_buf(nullptr), m_size(0)
+{
+    assert(path);
+    m_path = dup_path(path, "");
+    m_tmp_path = dup_path(path, ".tmp");
+}
+
+FileStorage::~FileStorage()
+{
+    close();
+    free(m_path);
+    free(m_tmp_path);
+}
+
+esp_err_t FileStorage::open(const uint8_t **data, size_t *size)
+{
+    close();
+    FILE *f = fopen(m_path, "rb");
+    if (!f) {
+        // A compaction finished writing the tmp file but lost power before the rename.
+        f = fopen(m_tmp_path, "rb");
+        if (f) {
+            fclose(f);
+            rename(m_tmp_path, m_path);
+            f = fopen(m_path, "rb");
+        }
+    }
+    *data = nullptr;
+    *size = 0;
+    if (!f) {
+        return ESP_OK;
+    }
+    fseek(f, 0, SEEK_END);
+    long file_size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    if (file_size > 0) {
+        m_buf = (uint8_t *)heap_caps_malloc(file_size, MALLOC_CAP_SPIRAM);
+        if (!m_buf) {
+            ESP_LOGE(TAG, "Failed to alloc %ld bytes to load %s.", file_size, m_path);
+            fclose(f);
+            return ESP_ERR_NO_MEM;
+        }
+        if (fread(m_buf, 1, file_size, f) != (size_t)file_size) {
+            ESP_LOGE(TAG, "Failed to read %s.", m_path);
+            fclose(f);
+            close();
+            return ESP_FAIL;
+        }
+        m_size = file_size;
+    }
+    fclose(f);
+    *data = m_buf;
+    *size = m_size;
+    return ESP_OK;
+}
+
+void FileStorage::close()
+{
+    heap_caps_free(m_buf);
+    m_buf = nullptr;
+}
+
+esp_err_t FileStorage::seal(size_t valid_size)
+{
+    return valid_size == m_size ? ESP_OK : ESP_ERR_INVALID_STATE;
+}
+
+esp_err_t FileStorage::append(const void *data, size_t size)
+{
+    ESP_RETURN_ON_ERROR(write_file(m_path, "ab", data, size), TAG, "Failed to append to journal.");
+    m_size += size;
+    return ESP_OK;
+}
+
+esp_err_t FileStorage::rewrite(const void *data, size_t size)
+{
+    ESP_RETURN_ON_ERROR(write_file(m_tmp_path, "wb", data, size), TAG, "Failed to write compacted journal.");
+    remove(m_path);
+    if (rename(m_tmp_path, m_path) != 0) {
+        ESP_LOGE(TAG, "Failed to rename %s.", m_tmp_path);
+        return ESP_FAIL;
+    }
+    m_size = size;
+    return ESP_OK;
+}
+
+PartitionStorage::PartitionStorage(const char *label) :
+    m_slot_size(0), m_slot(-1), m_generation(0), m_write_offset(0), m_map(nullptr), m_map_handle(0)
+{
+    m_partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, label);
+    if (!m_partition) {
+        ESP_LOGE(TAG, "Can not find %s in partition table", label);
+        return;
+    }
+    // Slots are erased independently, so they must be whole flash sectors.
+    m_slot_size = (m_partition->size / 2) & ~(size_t)(m_partition->erase_size - 1);
+}
+
+PartitionStorage::~PartitionStorage()
+{
+    close();
+}
+
+esp_err_t PartitionStorage::open(const uint8_t **data, size_t *size)
+{
+    ESP_RETURN_ON_FALSE(m_partition && m_slot_size > sizeof(slot_header_t), ESP_ERR_NOT_FOUND, TAG, "No partition.");
+    close();
+    *data = nullptr;
+    *size = 0;
+
+    m_slot = -1;
+    for (int i = 0; i < 2; i++) {
+        slot_header_t header;
+        ESP_RETURN_ON_ERROR(esp_partition_read(m_partition, slot_offset(i), &header, sizeof(header)),
+                            TAG,
+                            "Failed to read slot header.");
+        if (header.magic == s_slot_magic && (m_slot < 0 || header.generation > m_generation)) {
+            m_slot = i;
+            m_generation = header.generation;
+        }
+    }
+    if (m_slot < 0) {
+        m_generation = 0;
+        return ESP_OK;
+    }
+    ESP_RETURN_ON_ERROR(esp_partition_mmap(m_partition,
+                                           slot_offset(m_slot) + sizeof(slot_header_t),
+                                           capacity(),
+                                           ESP_PARTITION_MMAP_DATA,
+                                           &m_map,
+                                           &m_map_handle),
+                        TAG,
+                        "Failed to mmap slot %d.",
+                        m_slot);
+    *data = (const uint8_t *)m_map;
+    *size = capacity();
+    return ESP_OK;
+}
+
+void PartitionStorage::close()
+{
+    if (m_map) {
+        esp_partition_munmap(m_map_handle);
+        m_map = nullptr;
+    }
+}
+
+esp_err_t PartitionStorage::seal(size_t valid_size)
+{
+    m_write_offset = valid_size;
+    if (m_slot < 0 || !m_map) {
+        return ESP_OK;
+    }
+    // Everything past the last intact record must still be erased, otherwise it is a torn write.
+    const uint8_t *tail = (const uint8_t *)m_map;
+    for (size_t i = valid_size; i < capacity(); i++) {
+        if (tail[i] != 0xff) {
+            return ESP_ERR_INVALID_STATE;
+        }
+    }
+    return ESP_OK;
+}
+
+esp_err_t PartitionStorage::append(const void *data, size_t size)
+{
+    if (m_slot < 0) {
+        return rewrite(data, size);
+    }
+    ESP_RETURN_ON_FALSE(m_write_offset + size <= capacity(), ESP_ERR_NO_MEM, TAG, "Journal slot is full.");
+    ESP_RETURN_ON_ERROR(
+        esp_partition_write(m_partition, slot_offset(m_slot) + sizeof(slot_header_t) + m_write_offset, data, size),
+        TAG,
+        "Failed to append to journal.");
+    m_write_offset += size;
+    return ESP_OK;
+}
+
+esp_err_t PartitionStorage::rewrite(const void *data, size_t size)
+{
+    ESP_RETURN_ON_FALSE(m_partition, ESP_ERR_NOT_FOUND, TAG, "No partition.");
+    ESP_RETURN_ON_FALSE(size <= capacity(), ESP_ERR_NO_MEM, TAG, "Journal does not fit in a slot.");
+    close();
+    int slot = m_slot < 0 ? 0 : 1 - m_slot;
+    ESP_RETURN_ON_ERROR(
+        esp_partition_erase_range(m_partition, slot_offset(slot), m_slot_size), TAG, "Failed to erase slot.");
+    if (size) {
+        ESP_RETURN_ON_ERROR(esp_partition_write(m_partition, slot_offset(slot) + sizeof(slot_header_t), data, size),
+                            TAG,
+                            "Failed to write compacted journal.");
+    }
+    // The header is the commit point, the old slot stays valid until it is written.
+    slot_header_t header = {s_slot_magic, m_generation + 1};
+    ESP_RETURN_ON_ERROR(
+        esp_partition_write(m_partition, slot_offset(slot), &header, sizeof(header)), TAG, "Failed to commit slot.");
+    m_slot = slot;
+    m_generation = header.generation;
+    m_write_offset = size;
+    return ESP_OK;
+}
+} // namespace recognition
+} // namespace dl
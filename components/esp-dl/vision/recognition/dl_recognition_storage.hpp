@@ -0,0 +1,111 @@
+#pragma once
+#include "esp_err.h"
+#include "esp_partition.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace dl {
+namespace recognition {
+/**
+ * @brief Byte level backend of the face database journal.
+ *
+ * The database only ever appends to the journal, or replaces it as a whole when it is compacted. Backends make sure
+ * that a power cut during rewrite() leaves either the old or the new contents in place.
+ */
+class DataBaseStorage {
+public:
+    virtual ~DataBaseStorage() {}
+
+    /**
+     * @brief Makes the whole journal available at once.
+     *
+     * @param data  pointer to the journal, valid until close()
+     * @param size  journal size in bytes, 0 if the storage is empty
+     * @return esp_err_t
+     */
+    virtual esp_err_t open(const uint8_t **data, size_t *size) = 0;
+
+    /**
+     * @brief Releases the buffer or mapping returned by open().
+     */
+    virtual void close() = 0;
+
+    /**
+     * @brief Tells the backend where the last intact record ends.
+     *
+     * @param valid_size bytes of the journal that parsed correctly
+     * @return ESP_OK if appends can continue at valid_size, ESP_ERR_INVALID_STATE if a torn tail has to be dropped by
+     *         rewriting the journal.
+     */
+    virtual esp_err_t seal(size_t valid_size) = 0;
+
+    /**
+     * @brief Appends data to the journal and flushes it to the medium.
+     */
+    virtual esp_err_t append(const void *data, size_t size) = 0;
+
+    /**
+     * @brief Atomically replaces the whole journal.
+     */
+    virtual esp_err_t rewrite(const void *data, size_t size) = 0;
+};
+
+/**
+ * @brief Journal kept in a regular file, e.g. on SPIFFS, or on the host file system.
+ *
+ * open() loads the file with one fread. rewrite() writes "<path>.tmp" and renames it over the journal, open() picks
+ * up a finished tmp file if the rename was interrupted.
+ */
+class FileStorage : public DataBaseStorage {
+public:
+    FileStorage(const char *path);
+    ~FileStorage();
+    esp_err_t open(const uint8_t **data, size_t *size) override;
+    void close() override;
+    esp_err_t seal(size_t valid_size) override;
+    esp_err_t append(const void *data, size_t size) override;
+    esp_err_t rewrite(const void *data, size_t size) override;
+
+private:
+    char *m_path;
+    char *m_tmp_path;
+    uint8_t *m_buf;
+    size_t m_size;
+};
+
+/**
+ * @brief Journal kept in a raw data partition.
+ *
+ * The partition is split into two slots. Each slot starts with a small header carrying a generation counter, the
+ * slot with the newest valid header is active. open() memory maps the active slot instead of copying it, appends
+ * program the erased tail of the active slot, and rewrite() fills the other slot and writes its header last.
+ */
+class PartitionStorage : public DataBaseStorage {
+public:
+    PartitionStorage(const char *label);
+    ~PartitionStorage();
+    esp_err_t open(const uint8_t **data, size_t *size) override;
+    void close() override;
+    esp_err_t seal(size_t valid_size) override;
+    esp_err_t append(const void *data, size_t size) override;
+    esp_err_t rewrite(const void *data, size_t size) override;
+
+private:
+    typedef struct {
+        uint32_t magic;
+        uint32_t generation;
+    } slot_header_t;
+
+    const esp_partition_t *m_partition;
+    size_t m_slot_size;
+    int m_slot;
+    uint32_t m_generation;
+    size_t m_write_offset;
+    const void *m_map;
+    esp_partition_mmap_handle_t m_map_handle;
+
+    size_t slot_offset(int slot) const { return slot * m_slot_size; }
+    size_t capacity() const { return m_slot_size - sizeof(slot_header_t); }
+};
+} // namespace recognition
+} // namespace dl
@@ -0,0 +1,349 @@
+/**
+ * @file face_pipeline.hpp
+ * @brief Staged capture / detect / recognize pipeline used by the face recognition task.
+ * @details The pipeline is split into three stages connected by bounded frame queues.
+ *          When a downstream stage falls behind, the oldest queued frame is evicted
+ *          and handed back to the caller for release, so every stage always works on
+ *          the freshest frame instead of a growing backlog.
+ *
+ *          This header only depends on the C++ standard library. The FreeRTOS task
+ *          creation and core pinning live in face_recognition.cpp, while the same
+ *          stage loops can be driven by std::thread and a fake frame source on a
+ *          Linux host to benchmark the scheduling.
+ */
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+
+namespace facerec {
+
+/**
+ * @brief Monotonic timestamp in microseconds.
+ * @details Backed by esp_timer on ESP-IDF and by the host steady clock on Linux.
+ */
+inline int64_t now_us()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+/**
+ * @brief Latency and throughput counters of one pipeline stage.
+ */
+struct StageStats {
+    uint32_t frames = 0;   ///< Frames processed by the stage.
+    uint32_t dropped = 0;  ///< Stale frames evicted from the stage's input queue.
+    uint32_t last_us = 0;  ///< Processing time of the last frame.
+    uint32_t max_us = 0;   ///< Worst processing time seen.
+    uint64_t total_us = 0; ///< Accumulated processing time, used for the average.
+
+    void record(int64_t elapsed_us)
+    {
+        uint32_t us = elapsed_us < 0 ? 0 : (uint32_t)elapsed_us;
+        frames++;
+        last_us = us;
+        total_us += us;
+        if (us > max_us) {
+            max_us = us;
+        }
+    }
+    uint32_t avg_us() const { return frames ? (uint32_t)(total_us / frames) : 0; }
+};
+
+/**
+ * @brief Suppresses repeated verdicts sent by the pipeline stages.
+ * @details A verdict is let through when it differs from the last one sent, or when the
+ *          same verdict has not been repeated for the configured period. This keeps the
+ *          link quiet while nothing changes in front of the camera, whatever the frame rate.
+ *          Shared by the detection and recognition stages, so it is thread-safe.
+ */
+class VerdictLimiter {
+public:
+    /**
+     * @param repeat_us Minimum interval between two identical verdicts.
+     */
+    explicit VerdictLimiter(int64_t repeat_us) : m_repeat_us(repeat_us) {}
+
+    /**
+     * @brief Decides whether a verdict should be sent now, and records it if so.
+     * @param verdict Verdict code, e.g. the link opcode.
+     * @param t_us Current time, see now_us().
+     * @return true if the caller should send the verdict.
+     */
+    bool should_send(int verdict, int64_t t_us)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_has_last && verdict == m_last && t_us - m_last_us < m_repeat_us) {
+            return false;
+        }
+        m_has_last = true;
+        m_last = verdict;
+        m_last_us = t_us;
+        return true;
+    }
+
+private:
+    std::mutex m_mutex;
+    int64_t m_repeat_us;
+    int64_t m_last_us = 0;
+    int m_last = 0;
+    bool m_has_last = false;
+};
+
+/**
+ * @brief Bounded FIFO that drops its oldest element instead of blocking the producer.
+ * @tparam T Element type, moved in and out of the queue.
+ * @tparam N Capacity. A capacity of 1 turns the queue into a "latest frame" mailbox.
+ */
+template <typename T, size_t N>
+class DropOldestQueue {
+public:
+    /**
+     * @brief Pushes an element, evicting the oldest one if the queue is full.
+     * @param item Element to enqueue.
+     * @param evicted Receives the evicted element when the return value is true.
+     * @return true if an element was evicted and must be released by the caller.
+     */
+    bool push(T &&item, T &evicted)
+    {
+        bool dropped = false;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_count == N) {
+                evicted = std::move(m_items[m_head]);
+                m_head = (m_head + 1) % N;
+                m_count--;
+                dropped = true;
+            }
+            m_items[(m_head + m_count) % N] = std::move(item);
+            m_count++;
+        }
+        m_cond.notify_one();
+        return dropped;
+    }
+
+    /**
+     * @brief Pops the oldest element, waiting up to timeout for one to arrive.
+     * @return false on timeout or when the queue has been closed and drained.
+     */
+    bool pop(T &out, std::chrono::milliseconds timeout)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (!m_cond.wait_for(lock, timeout, [this] { return m_count > 0 || m_closed; })) {
+            return false;
+        }
+        if (m_count == 0) {
+            return false;
+        }
+        out = std::move(m_items[m_head]);
+        m_head = (m_head + 1) % N;
+        m_count--;
+        return true;
+    }
+
+    /**
+     * @brief Removes one queued element without waiting, used to drain on shutdown.
+     */
+    bool try_pop(T &out) { return pop(out, std::chrono::milliseconds(0)); }
+
+    /**
+     * @brief Tells whether close() has been called. Elements pushed before may still be queued.
+     */
+    bool is_closed()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_closed;
+    }
+
+    /**
+     * @brief Wakes up all waiters; further pops return false once the queue is empty.
+     */
+    void close()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_closed = true;
+        }
+        m_cond.notify_all();
+    }
+
+private:
+    std::mutex m_mutex;
+    std::condition_variable m_cond;
+    T m_items[N];
+    size_t m_head = 0;
+    size_t m_count = 0;
+    bool m_closed = false;
+};
+
+/**
+ * @brief Three stage frame pipeline: capture -> detect -> feature extraction and matching.
+ * @tparam Frame Frame record passed between the stages. It must be default constructible
+ *               and movable, and must expose an `int64_t t_capture_us` member.
+ * @tparam Depth Capacity of each inter-stage queue.
+ */
+template <typename Frame, size_t Depth = 1>
+class FacePipeline {
+public:
+    /// Fills a frame from the source. Returns false if no frame is available.
+    using CaptureFn = std::function<bool(Frame &)>;
+    /// Runs a stage on a frame. Returns false if the frame should not go downstream.
+    using StageFn = std::function<bool(Frame &)>;
+    /// Hands a frame's resources (e.g. the camera buffer) back to the source.
+    using ReleaseFn = std::function<void(Frame &)>;
+
+    enum stage_t { STAGE_CAPTURE = 0, STAGE_DETECT, STAGE_RECOGNIZE, STAGE_MAX };
+
+    FacePipeline(CaptureFn capture, StageFn detect, StageFn recognize, ReleaseFn release) :
+        m_capture(capture), m_detect(detect), m_recognize(recognize), m_release(release)
+    {
+    }
+
+    /**
+     * @brief Body of the capture stage. Runs until stop() is called.
+     */
+    void run_capture_stage()
+    {
+        while (m_running.load(std::memory_order_relaxed)) {
+            Frame frame;
+            int64_t start = now_us();
+            if (!m_capture(frame)) {
+                continue;
+            }
+            frame.t_capture_us = start;
+            record(STAGE_CAPTURE, now_us() - start);
+            forward(m_detect_queue, std::move(frame), STAGE_DETECT);
+        }
+        m_detect_queue.close();
+    }
+
+    /**
+     * @brief Body of the detection stage. Runs until the capture stage has stopped and closed its queue.
+     */
+    void run_detect_stage()
+    {
+        Frame frame;
+        while (next_frame(m_detect_queue, frame)) {
+            int64_t start = now_us();
+            bool keep = m_detect(frame);
+            record(STAGE_DETECT, now_us() - start);
+            if (keep) {
+                forward(m_recognize_queue, std::move(frame), STAGE_RECOGNIZE);
+            } else {
+                m_release(frame);
+            }
+            frame = Frame();
+        }
+        drain(m_detect_queue);
+        m_recognize_queue.close();
+    }
+
+    /**
+     * @brief Body of the feature extraction and matching stage. Runs until the detection stage has stopped.
+     */
+    void run_recognize_stage()
+    {
+        Frame frame;
+        while (next_frame(m_recognize_queue, frame)) {
+            int64_t start = now_us();
+            m_recognize(frame);
+            int64_t end = now_us();
+            record(STAGE_RECOGNIZE, end - start);
+            {
+                std::lock_guard<std::mutex> lock(m_stats_mutex);
+                m_end_to_end.record(end - frame.t_capture_us);
+            }
+            m_release(frame);
+            frame = Frame();
+        }
+        drain(m_recognize_queue);
+    }
+
+    /**
+     * @brief Asks all stages to finish. The capture stage stops first, then each stage stops once
+     *        its upstream stage is done, so no frame is pushed to a stage that has already left and
+     *        every queued frame is released on the way out.
+     */
+    void stop() { m_running.store(false); }
+
+    /**
+     * @brief Snapshot of one stage's counters.
+     */
+    StageStats get_stage_stats(stage_t stage)
+    {
+        std::lock_guard<std::mutex> lock(m_stats_mutex);
+        return m_stats[stage];
+    }
+
+    /**
+     * @brief Snapshot of the capture-to-result latency of frames that reached the last stage.
+     */
+    StageStats get_end_to_end_stats()
+    {
+        std::lock_guard<std::mutex> lock(m_stats_mutex);
+        return m_end_to_end;
+    }
+
+private:
+    typedef DropOldestQueue<Frame, Depth> queue_t;
+
+    CaptureFn m_capture;
+    StageFn m_detect;
+    StageFn m_recognize;
+    ReleaseFn m_release;
+
+    queue_t m_detect_queue;
+    queue_t m_recognize_queue;
+    std::atomic<bool> m_running{true};
+
+    std::mutex m_stats_mutex;
+    StageStats m_stats[STAGE_MAX];
+    StageStats m_end_to_end;
+
+    /**
+     * @brief Waits for the next frame of a stage's input queue.
+     * @return false once the queue has been closed by the upstream stage.
+     */
+    static bool next_frame(queue_t &queue, Frame &frame)
+    {
+        while (!queue.pop(frame, std::chrono::milliseconds(100))) {
+            if (queue.is_closed()) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void record(stage_t stage, int64_t elapsed_us)
+    {
+        std::lock_guard<std::mutex> lock(m_stats_mutex);
+        m_stats[stage].record(elapsed_us);
+    }
+
+    void forward(queue_t &queue, Frame &&frame, stage_t consumer)
+    {
+        Frame evicted;
+        if (queue.push(std::move(frame), evicted)) {
+            m_release(evicted);
+            std::lock_guard<std::mutex> lock(m_stats_mutex);
+            m_stats[consumer].dropped++;
+        }
+    }
+
+    void drain(queue_t &queue)
+    {
+        Frame frame;
+        while (queue.try_pop(frame)) {
+            m_release(frame);
+        }
+    }
+};
+
+} // namespace facerec
@@ -1,22 +1,24 @@
 /**
  * @file face_recognition.cpp
  * @brief Implements face detection, enrollment, and recognition functionality.
- * @details This file sets up the camera, UART, and a GPIO button. It runs two FreeRTOS
- *          tasks: one to handle the enrollment button and another for the main
- *          face recognition loop. The recognized face ID or enrollment status is
- *          communicated over UART.
+ * @details This file sets up the camera and a GPIO button. It runs one FreeRTOS
+ *          task to handle the enrollment button and a three stage face pipeline
+ *          (capture / detect / feature extraction and matching) whose stages are
+ *          pinned across both cores. The recognized face ID or enrollment status is
+ *          sent to the CH32 controller over the UART link.
  */
 
 // C/C++ and FreeRTOS
 #include <vector>
 #include <string>
+#include <list>
+#include <algorithm>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 
 // ESP-IDF Drivers and Systems
 #include "esp_log.h"
 #include "esp_spiffs.h"
-#include "driver/uart.h"
 #include "driver/gpio.h"
 #include "esp_camera.h"
 #include "driver/i2c.h"
@@ -27,6 +29,8 @@
 
 // Public interface
 #include "face_recognition.hpp"
+#include "face_pipeline.hpp"
+#include "uart_link.h"
 
 // Tag for logging
 static const char *TAG = "face_rec";
@@ -55,15 +59,25 @@ static const char *TAG = "face_rec";
 #define CAM_PIN_HREF     12
 #define CAM_PIN_PCLK     10
 
-// UART (for sending results)
-#define UART_PORT_NUM      UART_NUM_1
-#define UART_BAUD_RATE     115200
-#define UART_TX_PIN        18
-#define UART_RX_PIN        -1
-
 // Enroll Button
 #define ENROLL_BUTTON_GPIO GPIO_NUM_0 
 
+// Pipeline
+#define FACE_CAPTURE_CORE          0   // Capture stage, shares core 0 with Wi-Fi
+#define FACE_DETECT_CORE           1   // Detection stage
+#define FACE_RECOGNIZE_CORE        0   // Feature extraction and matching stage
+#define FACE_PIPELINE_QUEUE_DEPTH  1   // Frames buffered between stages, older ones are dropped
+#define FACE_PIPELINE_STATS_PERIOD 100 // Log stage latencies every N captured frames
+// Frames held at once: one per stage plus a full queue in front of detection and recognition.
+// One more buffer lets the camera driver keep filling while all of those are held, otherwise
+// esp_camera_fb_get() stalls the capture stage until a downstream stage returns a frame.
+#define FACE_CAMERA_FB_COUNT       (2 * FACE_PIPELINE_QUEUE_DEPTH + 3 + 1)
+#define FACE_VERDICT_REPEAT_MS     1000 // Same access verdict is sent again at most this often
+
+// Recognition
+#define FACE_RECOGNIZE_THR   0.5F // Minimum similarity of a match
+#define FACE_RECOGNIZE_TOP_K 5    // Database entries compared per face
+
 // ==================================================================
 //                      INTERNAL IMPLEMENTATION
 // ==================================================================
@@ -100,28 +114,6 @@ static void spiffs_init()
     }
 }
 
-/**
- * @brief Initializes the UART interface.
- * @details Configures UART for sending recognition and enrollment results.
- *          This component shares the UART with the voice recognition component.
- */
-static void uart_init()
-{
-    // Use C++ zero-initialization to ensure all fields are initialized.
-    uart_config_t uart_config = {};
-    uart_config.baud_rate = UART_BAUD_RATE;
-    uart_config.data_bits = UART_DATA_8_BITS;
-    uart_config.parity    = UART_PARITY_DISABLE;
-    uart_config.stop_bits = UART_STOP_BITS_1;
-    uart_config.flow_ctrl = UART_HW_FLOWCTRL_DISABLE;
-    uart_config.source_clk = UART_SCLK_DEFAULT;
-
-    ESP_ERROR_CHECK(uart_param_config(UART_PORT_NUM, &uart_config));
-    uart_set_pin(UART_PORT_NUM, UART_TX_PIN, UART_RX_PIN, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE);
-    uart_driver_install(UART_PORT_NUM, 1024, 0, 0, NULL, 0);
-    ESP_LOGI(TAG, "UART initialized.");
-}
-
 /**
  * @brief Initializes the camera module.
  * @details Configures the camera with the specified GPIO pins, pixel format,
@@ -138,8 +130,8 @@ static void camera_init(void) {
         .ledc_timer = LEDC_TIMER_0, .ledc_channel = LEDC_CHANNEL_0,
         .pixel_format = PIXFORMAT_RGB888,
         .frame_size = FRAMESIZE_QVGA,
-        .jpeg_quality = 12, .fb_count = 2, .fb_location = CAMERA_FB_IN_PSRAM,
-        .grab_mode = CAMERA_GRAB_WHEN_EMPTY,
+        .jpeg_quality = 12, .fb_count = FACE_CAMERA_FB_COUNT, .fb_location = CAMERA_FB_IN_PSRAM,
+        .grab_mode = CAMERA_GRAB_LATEST,
         .sccb_i2c_port = I2C_NUM_0,
     };
     esp_err_t err = esp_camera_init(&camera_config);
@@ -177,12 +169,209 @@ static void enroll_button_task(void *arg) {
     }
 }
 
+// -- Pipeline Stages --
+
+/**
+ * @brief Frame record passed between the pipeline stages.
+ * @details Owns the camera frame buffer until the pipeline releases it.
+ */
+struct face_frame_t {
+    camera_fb_t *fb = NULL;
+    dl::image::img_t img = {};
+    std::list<dl::detect::result_t> detect_result;
+    int64_t t_capture_us = 0;
+};
+
+typedef facerec::FacePipeline<face_frame_t, FACE_PIPELINE_QUEUE_DEPTH> face_pipeline_t;
+
+/// The staged pipeline driving capture, detection and recognition.
+static face_pipeline_t *g_pipeline = NULL;
+
+/// Keeps the stages from sending the same access verdict on every frame.
+static facerec::VerdictLimiter g_verdict_limiter(FACE_VERDICT_REPEAT_MS * 1000LL);
+
+/**
+ * @brief Logs per-stage latency counters of the pipeline.
+ */
+static void log_pipeline_stats()
+{
+    static const char *stage_names[] = {"capture", "detect", "recognize"};
+    for (int i = 0; i < face_pipeline_t::STAGE_MAX; i++) {
+        facerec::StageStats stats = g_pipeline->get_stage_stats((face_pipeline_t::stage_t)i);
+        ESP_LOGI(TAG, "%-9s frames: %lu, dropped: %lu, avg: %lu us, max: %lu us", stage_names[i],
+                 (unsigned long)stats.frames, (unsigned long)stats.dropped,
+                 (unsigned long)stats.avg_us(), (unsigned long)stats.max_us);
+    }
+    facerec::StageStats e2e = g_pipeline->get_end_to_end_stats();
+    ESP_LOGI(TAG, "end-to-end avg: %lu us, max: %lu us", (unsigned long)e2e.avg_us(), (unsigned long)e2e.max_us);
+}
+
+/**
+ * @brief Sends an access verdict to the CH32, unless the same one was sent recently.
+ */
+static void send_verdict(uint8_t op)
+{
+    if (g_verdict_limiter.should_send(op, facerec::now_us())) {
+        uart_link_send(op, NULL, 0);
+    }
+}
+
+/**
+ * @brief Capture stage: grabs a frame from the camera.
+ */
+static bool capture_stage(face_frame_t &frame)
+{
+    static uint32_t frame_count = 0;
+
+    camera_fb_t *fb = esp_camera_fb_get();
+    if (!fb) {
+        ESP_LOGE(TAG, "Failed to get camera frame buffer");
+        return false;
+    }
+    frame.fb = fb;
+    frame.img.width = fb->width;
+    frame.img.height = fb->height;
+    frame.img.data = fb->buf;
+    frame.img.pix_type = dl::image::DL_IMAGE_PIX_TYPE_RGB888;
+
+    if (++frame_count % FACE_PIPELINE_STATS_PERIOD == 0) {
+        log_pipeline_stats();
+    }
+    return true;
+}
+
+/**
+ * @brief Detection stage: runs the face detector on a captured frame.
+ * @return true if at least one face was found and the frame should be recognized.
+ */
+static bool detect_stage(face_frame_t &frame)
+{
+    frame.detect_result = g_detector->run(frame.img);
+    if (!frame.detect_result.empty()) {
+        return true;
+    }
+    if (g_is_enrolling) {
+        ESP_LOGW(TAG, "Enrollment failed: No face detected.");
+        g_is_enrolling = 0;
+    } else {
+        ESP_LOGD(TAG, "Recognition failed: No face detected.");
+        send_verdict(LINK_OP_ACCESS_DENIED);
+    }
+    return false;
+}
+
+/**
+ * @brief Tells whether a database query found an enrolled face.
+ */
+static bool is_match(const std::vector<dl::recognition::result_t> &res)
+{
+    return !res.empty() && res[0].id > -1;
+}
+
+/**
+ * @brief Matches the detected faces of a frame that decide access against the database.
+ * @details With the primary face policy only the first detection is matched, the same face
+ *          HumanFaceRecognizer::recognize() uses. With the any face policy all the faces are
+ *          matched, their features extracted by batches of g_feat->get_batch_size() faces so the
+ *          layers of the feature model are streamed once per batch instead of once per face.
+ * @return The best match among the faces, no match if none of them is in the database.
+ */
+static std::vector<dl::recognition::result_t> recognize_faces(const dl::image::img_t &img,
+                                                              const std::list<dl::detect::result_t> &detect_result)
+{
+    std::vector<std::vector<int>> landmarks;
+#if CONFIG_FACE_RECOGNITION_ACCESS_ANY_FACE
+    for (const auto &face : detect_result) {
+        landmarks.push_back(face.keypoint);
+    }
+#else
+    landmarks.push_back(detect_result.front().keypoint);
+#endif
+
+    std::vector<dl::recognition::result_t> best;
+    int batch = g_feat->get_batch_size();
+    for (size_t start = 0; start < landmarks.size(); start += batch) {
+        size_t end = std::min(landmarks.size(), start + batch);
+        std::vector<std::vector<int>> chunk(landmarks.begin() + start, landmarks.begin() + end);
+        for (dl::TensorBase *feat : g_feat->run_batch(img, chunk)) {
+            auto res = g_recognizer->query_feat(feat, FACE_RECOGNIZE_THR, FACE_RECOGNIZE_TOP_K);
+            if (is_match(res) && (!is_match(best) || res[0].similarity > best[0].similarity)) {
+                best = res;
+            }
+        }
+    }
+    return best;
+}
+
+/**
+ * @brief Recognition stage: enrolls or recognizes the detected faces.
+ * @details If the enrollment flag is set, the face is enrolled into the database.
+ *          Otherwise it is matched against the database. Results are sent over the UART link.
+ */
+static bool recognize_stage(face_frame_t &frame)
+{
+    if (g_is_enrolling) {
+        // Enroll the detected face
+        int8_t enroll_id = g_recognizer->enroll(frame.img, frame.detect_result);
+        if (enroll_id >= 0) {
+            ESP_LOGI(TAG, "Enrollment successful for ID: %d", enroll_id);
+            uint16_t id = enroll_id;
+            uart_link_send(LINK_OP_FACE_ENROLLED, &id, sizeof(id));
+        } else {
+            ESP_LOGW(TAG, "Enrollment failed.");
+        }
+        // Reset the enrollment flag
+        g_is_enrolling = 0;
+        return true;
+    }
+
+    // Recognize the detected faces
+    auto results_recog = recognize_faces(frame.img, frame.detect_result);
+    if (is_match(results_recog)) {
+        ESP_LOGI(TAG, "Recognition successful. ID: %d", results_recog[0].id);
+        send_verdict(LINK_OP_ACCESS_GRANTED);
+    } else {
+        ESP_LOGI(TAG, "Recognition failed: Unknown face detected.");
+        send_verdict(LINK_OP_ACCESS_DENIED);
+    }
+    return true;
+}
+
+/**
+ * @brief Returns a frame buffer to the camera driver so it can be reused.
+ */
+static void release_frame(face_frame_t &frame)
+{
+    if (frame.fb) {
+        esp_camera_fb_return(frame.fb);
+        frame.fb = NULL;
+    }
+}
+
+/**
+ * @brief FreeRTOS task running the detection stage.
+ */
+static void face_detect_task(void *arg)
+{
+    g_pipeline->run_detect_stage();
+    vTaskDelete(NULL);
+}
+
+/**
+ * @brief FreeRTOS task running the feature extraction and matching stage.
+ */
+static void face_recognize_task(void *arg)
+{
+    g_pipeline->run_recognize_stage();
+    vTaskDelete(NULL);
+}
+
 /**
  * @brief Main FreeRTOS task for face recognition and enrollment.
- * @details This task initializes the face detection and recognition models. It then
- *          enters a loop to continuously capture frames from the camera. If the
- *          enrollment flag is set, it attempts to enroll a new face. Otherwise,
- *          it performs face recognition. Results are sent over UART.
+ * @details This task initializes the face detection and recognition models and the
+ *          staged pipeline. It starts the detection and recognition stages on their
+ *          own pinned tasks and then runs the capture stage itself, so capturing,
+ *          detecting and feature extraction of consecutive frames overlap on both cores.
  * @param arg Task arguments (unused).
  */
 static void face_recognition_task(void *arg) {
@@ -190,74 +379,27 @@ static void face_recognition_task(void *arg) {
     // The specific models used are determined by Kconfig settings.
     g_detector = new HumanFaceDetect();
     g_feat = new HumanFaceFeat();
+#if CONFIG_FACE_RECOGNITION_ACCESS_ANY_FACE
+    // Faces of the same frame share one run of the feature model.
+    if (g_feat->set_batch_size(CONFIG_FACE_RECOGNITION_FEAT_BATCH) != ESP_OK) {
+        ESP_LOGW(TAG, "Feature batch of %d not supported, faces are processed one by one.",
+                 CONFIG_FACE_RECOGNITION_FEAT_BATCH);
+    }
+#endif
     // The face database is stored in SPIFFS.
     char *db_path = (char *)"/spiffs/face_db";
-    g_recognizer = new HumanFaceRecognizer(g_feat, db_path, 0.5F, 5);
-    
-    ESP_LOGI(TAG, "Face recognition task started. Press button on GPIO %d to enroll.", ENROLL_BUTTON_GPIO);
+    g_recognizer = new HumanFaceRecognizer(g_feat, db_path, FACE_RECOGNIZE_THR, FACE_RECOGNIZE_TOP_K);
 
-    // 2. Main recognition and enrollment loop
-    while (true) {
-        // Capture a frame from the camera
-        camera_fb_t *fb = esp_camera_fb_get();
-        if (!fb) {
-            ESP_LOGE(TAG, "Failed to get camera frame buffer");
-            continue;
-        }
+    // 2. Build the pipeline and start the downstream stages.
+    g_pipeline = new face_pipeline_t(capture_stage, detect_stage, recognize_stage, release_frame);
+    xTaskCreatePinnedToCore(face_detect_task, "face_det", 8192, NULL, 5, NULL, FACE_DETECT_CORE);
+    xTaskCreatePinnedToCore(face_recognize_task, "face_recog", 8192, NULL, 5, NULL, FACE_RECOGNIZE_CORE);
 
-        // Create a dl_matrix3du_t image object from the frame buffer
-        dl::image::img_t img;
-        img.width = fb->width;
-        img.height = fb->height;
-        img.data = fb->buf;
-        img.pix_type = dl::image::DL_IMAGE_PIX_TYPE_RGB888;
-
-        // 3. Check if enrollment is requested
-        if (g_is_enrolling) {
-            // Detect face in the frame
-            auto result = g_detector->run(img);
-            if(!result.empty()) {
-                // Enroll the detected face
-                int8_t enroll_id = g_recognizer->enroll(img, result);
-                 if (enroll_id >= 0) {
-                    ESP_LOGI(TAG, "Enrollment successful for ID: %d", enroll_id);
-                    char msg[32];
-                    sprintf(msg, "ENROLLED:%d\r\n", enroll_id);
-                    uart_write_bytes(UART_PORT_NUM, msg, strlen(msg));
-                } else {
-                    ESP_LOGW(TAG, "Enrollment failed.");
-                }
-            } else {
-                 ESP_LOGW(TAG, "Enrollment failed: No face detected.");
-            }
-            // Reset the enrollment flag
-            g_is_enrolling = 0;
-        } else {
-            // 4. Perform face recognition
-            // Detect face in the frame
-            auto result_detect = g_detector->run(img);
-            if(!result_detect.empty()){
-                // Recognize the detected face
-                auto results_recog = g_recognizer->recognize(img, result_detect);
-                if (results_recog[0].id > -1) {
-                    ESP_LOGI(TAG, "Recognition successful. ID: %d", results_recog[0].id);
-                    const char *msg = "ReeSuccess\r\n";
-                    uart_write_bytes(UART_PORT_NUM, msg, strlen(msg));
-                } else {
-                    ESP_LOGI(TAG, "Recognition failed: Unknown face detected.");
-                    const char *msg = "ReFail\r\n";
-                    uart_write_bytes(UART_PORT_NUM, msg, strlen(msg));
-                }
-            } else {
-                ESP_LOGI(TAG, "Recognition failed: No face detected.");
-                const char *msg = "ReFail\r\n";
-                uart_write_bytes(UART_PORT_NUM, msg, strlen(msg));
-            }
-        }
-        // Return the frame buffer to be reused
-        esp_camera_fb_return(fb); 
-        vTaskDelay(pdMS_TO_TICKS(100)); // Small delay to yield CPU
-    }
+    ESP_LOGI(TAG, "Face recognition task started. Press button on GPIO %d to enroll.", ENROLL_BUTTON_GPIO);
+
+    // 3. Capture loop. Frames that the detector can not keep up with are dropped.
+    g_pipeline->run_capture_stage();
+    vTaskDelete(NULL);
 }
 
 // ==================================================================
@@ -265,17 +407,17 @@ static void face_recognition_task(void *arg) {
 // ==================================================================
 /**
  * @brief Starts the face recognition functionality.
- * @details Initializes all necessary subsystems (SPIFFS, UART, Camera) and
+ * @details Initializes all necessary subsystems (SPIFFS, Camera) and
  *          creates the FreeRTOS tasks for button handling and face recognition.
+ *          The UART link must already be initialized with uart_link_init().
  */
 void app_facerec_start(void)
 {
     // Initialize all systems first
     spiffs_init();
-    uart_init();
     camera_init();
 
     // Create RTOS tasks
     xTaskCreate(enroll_button_task, "enroll_btn", 2048, NULL, 5, NULL);
-    xTaskCreate(face_recognition_task, "face_rec", 8192, NULL, 5, NULL);
+    xTaskCreatePinnedToCore(face_recognition_task, "face_rec", 8192, NULL, 5, NULL, FACE_CAPTURE_CORE);
 } 
\ No newline at end of file
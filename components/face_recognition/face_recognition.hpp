@@ -9,7 +9,8 @@ extern "C" {
  *
  * This function creates a FreeRTOS task that continuously performs
  * face detection and recognition, and handles enrollment.
- * It also initializes all necessary hardware (Camera, UART) and systems (SPIFFS).
+ * It also initializes all necessary hardware (Camera) and systems (SPIFFS).
+ * Results are sent through the UART link, which must be initialized first.
  */
 void app_facerec_start(void);
 
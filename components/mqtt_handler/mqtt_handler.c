@@ -6,9 +6,9 @@
 #include "esp_event.h"
 #include "esp_log.h"
 #include "mqtt_client.h"
-#include "driver/uart.h"
 
 #include "mqtt_handler.h"
+#include "uart_link.h"
 
 /* --- Alibaba Cloud IoT Credentials --- */
 #define PRODUCT_KEY      "k1t73qLlqf2"
@@ -19,9 +19,6 @@
 /* ------------------------------------- */
 
 
-// UART is shared with other components. We assume UART_NUM_1 has been initialized.
-#define SHARED_UART_NUM     (UART_NUM_1)
-
 static const char *TAG = "mqtt_handler";
 
 // --- MQTT Connection Details (Auto-generated) ---
@@ -92,12 +89,11 @@ static void mqtt_event_handler(void *handler_args, esp_event_base_t base, int32_
         if (strncmp(event->topic, MQTT_TOPIC_SUB, event->topic_len) == 0) {
             ESP_LOGI(TAG, "Received command: %.*s", event->data_len, event->data);
 
-            // Forward command to CH32 via UART, similar to voice recognition
-            // We append "\r\n" to match the expected format.
-            char command_buffer[32];
-            int len = snprintf(command_buffer, sizeof(command_buffer), "%.*s\r\n", event->data_len, event->data);
-            uart_write_bytes(SHARED_UART_NUM, command_buffer, len);
-            ESP_LOGI(TAG, "Forwarded command '%s' to CH32 via UART.", command_buffer);
+            // Forward command to CH32 via the UART link, similar to voice recognition.
+            // Known commands are mapped to their opcode, others are sent as text.
+            if (uart_link_send_text(event->data, event->data_len) == ESP_OK) {
+                ESP_LOGI(TAG, "Forwarded command '%.*s' to CH32.", event->data_len, event->data);
+            }
         }
         break;
     case MQTT_EVENT_ERROR:
@@ -0,0 +1,211 @@
+/**
+ * @file link_protocol.c
+ * @brief Frame codec of the ESP32-S3 <-> CH32V307 UART link, see link_protocol.h.
+ */
+#include "link_protocol.h"
+
+#include <string.h>
+
+enum {
+    DEC_SYNC0 = 0,
+    DEC_SYNC1,
+    DEC_LEN,
+    DEC_SEQ,
+    DEC_OP,
+    DEC_PAYLOAD,
+    DEC_CRC_LO,
+    DEC_CRC_HI,
+};
+
+uint16_t link_crc16_update(uint16_t crc, const uint8_t *data, size_t len)
+{
+    for (size_t i = 0; i < len; i++) {
+        crc ^= (uint16_t)data[i] << 8;
+        for (int j = 0; j < 8; j++) {
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+static inline uint16_t crc16_byte(uint16_t crc, uint8_t byte)
+{
+    return link_crc16_update(crc, &byte, 1);
+}
+
+size_t link_encode(uint8_t *out, size_t out_size, uint8_t seq, uint8_t op, const uint8_t *payload, uint8_t len)
+{
+    size_t size = LINK_HEADER_SIZE + len + LINK_CRC_SIZE;
+    if (len > LINK_MAX_PAYLOAD || out_size < size) {
+        return 0;
+    }
+    out[0] = LINK_SYNC0;
+    out[1] = LINK_SYNC1;
+    out[2] = len;
+    out[3] = seq;
+    out[4] = op;
+    if (len) {
+        memcpy(out + LINK_HEADER_SIZE, payload, len);
+    }
+    uint16_t crc = link_crc16_update(0xFFFF, out + 2, 3 + len);
+    out[LINK_HEADER_SIZE + len] = (uint8_t)(crc & 0xFF);
+    out[LINK_HEADER_SIZE + len + 1] = (uint8_t)(crc >> 8);
+    return size;
+}
+
+void link_decoder_init(link_decoder_t *dec)
+{
+    memset(dec, 0, sizeof(link_decoder_t));
+    dec->state = DEC_SYNC0;
+}
+
+link_dec_result_t link_decoder_feed(link_decoder_t *dec, uint8_t byte)
+{
+    switch (dec->state) {
+    case DEC_SYNC0:
+        if (byte == LINK_SYNC0) {
+            dec->state = DEC_SYNC1;
+        } else {
+            dec->junk_bytes++;
+        }
+        break;
+    case DEC_SYNC1:
+        if (byte == LINK_SYNC1) {
+            dec->state = DEC_LEN;
+        } else if (byte != LINK_SYNC0) {
+            // A repeated SYNC0 may still start the frame.
+            dec->junk_bytes += 2;
+            dec->state = DEC_SYNC0;
+        } else {
+            dec->junk_bytes++;
+        }
+        break;
+    case DEC_LEN:
+        if (byte > LINK_MAX_PAYLOAD) {
+            dec->len_errors++;
+            dec->state = DEC_SYNC0;
+            return LINK_DEC_LENGTH_ERROR;
+        }
+        dec->frame.len = byte;
+        dec->crc = crc16_byte(0xFFFF, byte);
+        dec->state = DEC_SEQ;
+        break;
+    case DEC_SEQ:
+        dec->frame.seq = byte;
+        dec->crc = crc16_byte(dec->crc, byte);
+        dec->state = DEC_OP;
+        break;
+    case DEC_OP:
+        dec->frame.op = byte;
+        dec->crc = crc16_byte(dec->crc, byte);
+        dec->pos = 0;
+        dec->state = dec->frame.len ? DEC_PAYLOAD : DEC_CRC_LO;
+        break;
+    case DEC_PAYLOAD:
+        dec->frame.payload[dec->pos++] = byte;
+        dec->crc = crc16_byte(dec->crc, byte);
+        if (dec->pos == dec->frame.len) {
+            dec->state = DEC_CRC_LO;
+        }
+        break;
+    case DEC_CRC_LO:
+        // The payload is complete, pos is reused to hold the low CRC byte.
+        dec->pos = byte;
+        dec->state = DEC_CRC_HI;
+        break;
+    case DEC_CRC_HI:
+        dec->state = DEC_SYNC0;
+        if ((uint16_t)(dec->pos | (byte << 8)) != dec->crc) {
+            dec->crc_errors++;
+            return LINK_DEC_CRC_ERROR;
+        }
+        dec->frames++;
+        return LINK_DEC_FRAME;
+    default:
+        dec->state = DEC_SYNC0;
+        break;
+    }
+    return LINK_DEC_NONE;
+}
+
+void link_batch_init(link_batch_t *batch)
+{
+    batch->len = 0;
+    batch->count = 0;
+}
+
+bool link_batch_add(link_batch_t *batch, uint8_t op, const uint8_t *data, uint8_t len)
+{
+    if (batch->len + 2 + len > LINK_MAX_PAYLOAD) {
+        return false;
+    }
+    batch->payload[batch->len] = op;
+    batch->payload[batch->len + 1] = len;
+    if (len) {
+        memcpy(batch->payload + batch->len + 2, data, len);
+    }
+    batch->len += 2 + len;
+    batch->count++;
+    return true;
+}
+
+bool link_frame_next_cmd(const link_frame_t *frame, uint8_t *offset, link_cmd_t *cmd)
+{
+    if (frame->op != LINK_OP_BATCH) {
+        if (*offset != 0) {
+            return false;
+        }
+        cmd->op = frame->op;
+        cmd->len = frame->len;
+        cmd->data = frame->payload;
+        *offset = frame->len ? frame->len : 1;
+        return true;
+    }
+    if (*offset + 2 > frame->len) {
+        return false;
+    }
+    uint8_t len = frame->payload[*offset + 1];
+    if (*offset + 2 + len > frame->len) {
+        return false;
+    }
+    cmd->op = frame->payload[*offset];
+    cmd->len = len;
+    cmd->data = frame->payload + *offset + 2;
+    *offset += 2 + len;
+    return true;
+}
+
+bool link_frame_is_well_formed(const link_frame_t *frame)
+{
+    if (frame->op != LINK_OP_BATCH) {
+        return true;
+    }
+    uint8_t offset = 0;
+    link_cmd_t cmd;
+    while (link_frame_next_cmd(frame, &offset, &cmd)) {
+        if (cmd.op == LINK_OP_BATCH) {
+            return false;
+        }
+    }
+    return offset == frame->len;
+}
+
+uint8_t link_opcode_from_text(const char *text, size_t len)
+{
+    static const struct {
+        const char *text;
+        uint8_t op;
+    } table[] = {
+        {"LED2ON", LINK_OP_LED2_ON},
+        {"LED2OFF", LINK_OP_LED2_OFF},
+        {"RecSuccess", LINK_OP_ACCESS_GRANTED},
+        {"ReFail", LINK_OP_ACCESS_DENIED},
+        {"Collect", LINK_OP_COLLECT},
+    };
+    for (size_t i = 0; i < sizeof(table) / sizeof(table[0]); i++) {
+        if (strlen(table[i].text) == len && memcmp(table[i].text, text, len) == 0) {
+            return table[i].op;
+        }
+    }
+    return LINK_OP_TEXT;
+}
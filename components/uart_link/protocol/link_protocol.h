@@ -0,0 +1,202 @@
+/**
+ * @file link_protocol.h
+ * @brief Binary frame protocol between the ESP32-S3 (master) and the CH32V307 (slave).
+ * @details This header and link_protocol.c are plain C99 without any SDK dependency.
+ *          They are compiled into the ESP-IDF `uart_link` component and into the
+ *          CH32 MounRiver project (linked folder `Protocol`), so both MCUs always
+ *          agree on the wire format.
+ *
+ *          Frame layout (little endian):
+ *
+ *          | 0xA5 | 0x5A | LEN | SEQ | OP | PAYLOAD[LEN] | CRC16 |
+ *
+ *          - LEN    : payload length, at most LINK_MAX_PAYLOAD.
+ *          - SEQ    : sequence number of a data frame, 1..255 (0 is never sent).
+ *                     ACK/NACK frames echo the SEQ of the frame they answer.
+ *          - OP     : opcode, see link_opcode_t.
+ *          - CRC16  : CRC-16/CCITT-FALSE over LEN, SEQ, OP and PAYLOAD.
+ *
+ *          Several commands can travel in one frame with OP = LINK_OP_BATCH, whose
+ *          payload is a sequence of { op, len, data[len] } records.
+ *          Every data frame is answered with an ACK, or with a NACK when its CRC
+ *          does not match or the receiver can not take it yet, and the sender
+ *          retransmits until it gets an ACK.
+ *
+ *          The receiver ACKs a frame carrying the same SEQ as the last accepted one
+ *          without executing it again. A sender that restarts its sequence, e.g. after
+ *          a reboot, first sends LINK_OP_SYNC so that its first command can not be
+ *          mistaken for such a retransmission.
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LINK_SYNC0 0xA5
+#define LINK_SYNC1 0x5A
+
+#define LINK_HEADER_SIZE  5  ///< SYNC0, SYNC1, LEN, SEQ, OP
+#define LINK_CRC_SIZE     2
+#define LINK_MAX_PAYLOAD  64
+#define LINK_MAX_FRAME    (LINK_HEADER_SIZE + LINK_MAX_PAYLOAD + LINK_CRC_SIZE)
+#define LINK_MAX_CMD_DATA 32 ///< Largest payload of a single command, e.g. a forwarded text command.
+
+/// Baud rates supported by both sides. Both firmwares must be built with the same value.
+#define LINK_BAUD_115200 115200
+#define LINK_BAUD_460800 460800
+#define LINK_BAUD_921600 921600
+#ifndef LINK_BAUD_RATE
+#define LINK_BAUD_RATE LINK_BAUD_115200
+#endif
+
+#define LINK_ACK_TIMEOUT_MS 20 ///< Time the sender waits for an ACK before retransmitting.
+#define LINK_MAX_RETRIES    3  ///< Retransmissions before a frame is dropped.
+
+typedef enum {
+    /* Link control */
+    LINK_OP_ACK = 0x01,   ///< Frame with SEQ was received and executed (or was a duplicate).
+    LINK_OP_NACK = 0x02,  ///< Frame with SEQ was rejected, payload[0] is a link_nack_reason_t.
+    LINK_OP_BATCH = 0x03, ///< Payload is a sequence of { op, len, data } command records.
+    LINK_OP_SYNC = 0x04,  ///< Sender session start, no payload. The receiver takes SEQ as the last seen one.
+
+    /* Commands from the ESP32-S3 */
+    LINK_OP_LED2_ON = 0x10,
+    LINK_OP_LED2_OFF = 0x11,
+    LINK_OP_ACCESS_GRANTED = 0x12, ///< Face recognized, unlock the door.
+    LINK_OP_ACCESS_DENIED = 0x13,  ///< Unknown or no face, sound the buzzer.
+    LINK_OP_COLLECT = 0x14,        ///< Collect and report sensor data once.
+    LINK_OP_FACE_ENROLLED = 0x15,  ///< Payload: enrolled face id, uint16.
+    LINK_OP_VOICE_READY = 0x16,
+    LINK_OP_TEXT = 0x20, ///< Payload: ASCII command without terminator, e.g. forwarded from MQTT.
+} link_opcode_t;
+
+typedef enum {
+    LINK_NACK_CRC = 1,       ///< CRC mismatch.
+    LINK_NACK_TOO_LONG = 2,  ///< LEN exceeds LINK_MAX_PAYLOAD.
+    LINK_NACK_MALFORMED = 3, ///< Batch records do not add up to LEN.
+    LINK_NACK_BUSY = 4       ///< Receiver queue is full, retry later.
+} link_nack_reason_t;
+
+/**
+ * @brief A decoded frame.
+ */
+typedef struct {
+    uint8_t seq;
+    uint8_t op;
+    uint8_t len;
+    uint8_t payload[LINK_MAX_PAYLOAD];
+} link_frame_t;
+
+/**
+ * @brief One command, either a whole frame or one record of a batch.
+ */
+typedef struct {
+    uint8_t op;
+    uint8_t len;
+    const uint8_t *data;
+} link_cmd_t;
+
+typedef enum {
+    LINK_DEC_NONE = 0,     ///< Frame not complete yet.
+    LINK_DEC_FRAME,        ///< A valid frame is available in link_decoder_t::frame.
+    LINK_DEC_CRC_ERROR,    ///< Frame received with a bad CRC, frame.seq holds the received SEQ.
+    LINK_DEC_LENGTH_ERROR, ///< LEN exceeds LINK_MAX_PAYLOAD, frame.seq is not valid.
+} link_dec_result_t;
+
+/**
+ * @brief Streaming frame decoder, fed one byte at a time.
+ * @details The decoder only needs a few cycles per byte, so it can run directly in a
+ *          UART receive interrupt. Bytes outside a frame are counted and discarded.
+ */
+typedef struct {
+    uint8_t state;
+    uint8_t pos;
+    uint16_t crc;
+    link_frame_t frame;
+
+    uint32_t frames;      ///< Valid frames decoded.
+    uint32_t crc_errors;  ///< Frames dropped because of a CRC mismatch.
+    uint32_t len_errors;  ///< Frames dropped because of an invalid LEN.
+    uint32_t junk_bytes;  ///< Bytes skipped while hunting for a sync pattern.
+} link_decoder_t;
+
+/**
+ * @brief Accumulates commands into the payload of a LINK_OP_BATCH frame.
+ */
+typedef struct {
+    uint8_t len;
+    uint8_t count;
+    uint8_t payload[LINK_MAX_PAYLOAD];
+} link_batch_t;
+
+/**
+ * @brief CRC-16/CCITT-FALSE (poly 0x1021), continue from a previous value.
+ * @param crc 0xFFFF for a new computation.
+ */
+uint16_t link_crc16_update(uint16_t crc, const uint8_t *data, size_t len);
+
+/**
+ * @brief Serializes a frame.
+ * @return number of bytes written to out, 0 if len or out_size is too small.
+ */
+size_t link_encode(uint8_t *out, size_t out_size, uint8_t seq, uint8_t op, const uint8_t *payload, uint8_t len);
+
+/**
+ * @brief Resets a decoder, statistics included.
+ */
+void link_decoder_init(link_decoder_t *dec);
+
+/**
+ * @brief Feeds one received byte.
+ * @return LINK_DEC_FRAME when dec->frame holds a new valid frame. The frame stays
+ *         valid until the next byte is fed.
+ */
+link_dec_result_t link_decoder_feed(link_decoder_t *dec, uint8_t byte);
+
+/**
+ * @brief Starts an empty batch.
+ */
+void link_batch_init(link_batch_t *batch);
+
+/**
+ * @brief Appends one command record to a batch.
+ * @return false if the record does not fit, the batch is left unchanged.
+ */
+bool link_batch_add(link_batch_t *batch, uint8_t op, const uint8_t *data, uint8_t len);
+
+/**
+ * @brief Iterates over the commands carried by a frame.
+ * @details A LINK_OP_BATCH frame yields each of its records, any other frame yields
+ *          itself as one command. Start with *offset = 0.
+ * @return false when there are no more commands, or when a batch is malformed.
+ */
+bool link_frame_next_cmd(const link_frame_t *frame, uint8_t *offset, link_cmd_t *cmd);
+
+/**
+ * @brief Checks that the records of a LINK_OP_BATCH frame exactly cover its payload.
+ * @return true for well formed batches and for any non batch frame.
+ */
+bool link_frame_is_well_formed(const link_frame_t *frame);
+
+/**
+ * @brief Next data frame sequence number, skipping 0.
+ */
+static inline uint8_t link_next_seq(uint8_t seq)
+{
+    return (uint8_t)(seq == 255 ? 1 : seq + 1);
+}
+
+/**
+ * @brief Maps a legacy ASCII command (e.g. "LED2ON") to its opcode.
+ * @return the opcode, or LINK_OP_TEXT if the text is not a known command.
+ */
+uint8_t link_opcode_from_text(const char *text, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,293 @@
+/**
+ * @file uart_link.c
+ * @brief Reliable framed command link from the ESP32-S3 to the CH32 controller.
+ * @details All producers (face, voice, MQTT) queue commands with uart_link_send().
+ *          A single task owns UART_NUM_1: it batches queued commands into one frame,
+ *          sends it and waits for the CH32's ACK, retransmitting on NACK or timeout.
+ *          The stop-and-wait scheme keeps exactly one frame in flight; commands queued
+ *          meanwhile are batched into the next frame. A LINK_OP_SYNC frame opens the
+ *          session, so the CH32 never drops the first command after an ESP32 reboot as
+ *          a retransmission of its last frame.
+ */
+#include <inttypes.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "driver/uart.h"
+#include "esp_check.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "sdkconfig.h"
+
+#include "uart_link.h"
+
+static const char *TAG = "uart_link";
+
+#define LINK_UART_NUM      UART_NUM_1
+#define LINK_UART_RX_BUF   512
+#define LINK_QUEUE_DEPTH   16
+#define LINK_ENQUEUE_WAIT  pdMS_TO_TICKS(10)
+#define LINK_STATS_PERIOD  100 // Log delivery counters every N frames
+
+typedef struct {
+    uint8_t op;
+    uint8_t len;
+    uint8_t data[LINK_MAX_CMD_DATA];
+} link_item_t;
+
+typedef enum {
+    REPLY_ACK,
+    REPLY_NACK,
+    REPLY_BUSY,
+    REPLY_TIMEOUT,
+} link_reply_t;
+
+static QueueHandle_t s_queue = NULL;
+static link_decoder_t s_decoder;
+static uart_link_stats_t s_stats;
+static portMUX_TYPE s_stats_lock = portMUX_INITIALIZER_UNLOCKED;
+
+#define STATS_ADD(field, n)                  \
+    do {                                     \
+        portENTER_CRITICAL(&s_stats_lock);   \
+        s_stats.field += (n);                \
+        portEXIT_CRITICAL(&s_stats_lock);    \
+    } while (0)
+
+/**
+ * @brief Collects queued commands into a batch.
+ * @param carry Command left over from the previous batch, consumed if valid.
+ * @return false if no command arrived within the wait time.
+ */
+static bool collect_batch(link_batch_t *batch, link_item_t *carry, bool *has_carry, TickType_t wait)
+{
+    link_item_t item;
+    link_batch_init(batch);
+    if (*has_carry) {
+        link_batch_add(batch, carry->op, carry->data, carry->len);
+        *has_carry = false;
+    } else if (xQueueReceive(s_queue, &item, wait) == pdTRUE) {
+        link_batch_add(batch, item.op, item.data, item.len);
+    } else {
+        return false;
+    }
+
+    // Give other producers a short window to join this frame.
+    TickType_t window = pdMS_TO_TICKS(CONFIG_UART_LINK_BATCH_WINDOW_MS);
+    while (xQueueReceive(s_queue, &item, batch->count == 1 ? window : 0) == pdTRUE) {
+        if (!link_batch_add(batch, item.op, item.data, item.len)) {
+            *carry = item;
+            *has_carry = true;
+            break;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Reads the UART until the reply to seq arrives or the timeout expires.
+ */
+static link_reply_t wait_reply(uint8_t seq, int64_t timeout_us)
+{
+    int64_t deadline = esp_timer_get_time() + timeout_us;
+    uint8_t buf[32];
+    for (;;) {
+        int64_t left_us = deadline - esp_timer_get_time();
+        if (left_us <= 0) {
+            return REPLY_TIMEOUT;
+        }
+        TickType_t ticks = pdMS_TO_TICKS((left_us + 999) / 1000);
+        int n = uart_read_bytes(LINK_UART_NUM, buf, sizeof(buf), ticks ? ticks : 1);
+        for (int i = 0; i < n; i++) {
+            link_dec_result_t res = link_decoder_feed(&s_decoder, buf[i]);
+            if (res == LINK_DEC_CRC_ERROR || res == LINK_DEC_LENGTH_ERROR) {
+                STATS_ADD(rx_crc_errors, 1);
+            } else if (res == LINK_DEC_FRAME && s_decoder.frame.seq == seq) {
+                if (s_decoder.frame.op == LINK_OP_ACK) {
+                    return REPLY_ACK;
+                }
+                if (s_decoder.frame.op == LINK_OP_NACK) {
+                    bool busy = s_decoder.frame.len && s_decoder.frame.payload[0] == LINK_NACK_BUSY;
+                    return busy ? REPLY_BUSY : REPLY_NACK;
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief Sends one frame and retransmits it until the CH32 acknowledges it.
+ * @return false if the frame was dropped after LINK_MAX_RETRIES retransmissions.
+ */
+static bool send_frame(uint8_t seq, uint8_t op, const uint8_t *payload, uint8_t len, uint8_t cmds)
+{
+    uint8_t frame[LINK_MAX_FRAME];
+    size_t size = link_encode(frame, sizeof(frame), seq, op, payload, len);
+    bool use_ack = CONFIG_UART_LINK_RX_PIN >= 0;
+
+    for (int attempt = 0; attempt <= LINK_MAX_RETRIES; attempt++) {
+        if (attempt) {
+            STATS_ADD(retransmits, 1);
+        }
+        int64_t start = esp_timer_get_time();
+        uart_write_bytes(LINK_UART_NUM, frame, size);
+        STATS_ADD(frames_sent, 1);
+        STATS_ADD(bytes_sent, size);
+        if (!use_ack) {
+            return true;
+        }
+
+        // The ACK can only arrive after the frame has left the TX FIFO.
+        uart_wait_tx_done(LINK_UART_NUM, pdMS_TO_TICKS(LINK_ACK_TIMEOUT_MS));
+        link_reply_t reply = wait_reply(seq, LINK_ACK_TIMEOUT_MS * 1000);
+        if (reply == REPLY_ACK) {
+            uint32_t rtt = (uint32_t)(esp_timer_get_time() - start);
+            portENTER_CRITICAL(&s_stats_lock);
+            s_stats.cmds_acked += cmds;
+            s_stats.rtt_last_us = rtt;
+            if (rtt > s_stats.rtt_max_us) {
+                s_stats.rtt_max_us = rtt;
+            }
+            portEXIT_CRITICAL(&s_stats_lock);
+            return true;
+        }
+        if (reply == REPLY_NACK || reply == REPLY_BUSY) {
+            STATS_ADD(nacks, 1);
+            if (reply == REPLY_BUSY) {
+                // The CH32 command queue is full, give its main loop time to drain it.
+                vTaskDelay(pdMS_TO_TICKS(LINK_ACK_TIMEOUT_MS));
+            }
+        } else {
+            STATS_ADD(timeouts, 1);
+        }
+    }
+    ESP_LOGW(TAG, "Frame %u dropped after %d retries (%u commands).", seq, LINK_MAX_RETRIES, cmds);
+    STATS_ADD(cmds_dropped, cmds);
+    return false;
+}
+
+static void log_stats(void)
+{
+    uart_link_stats_t stats;
+    uart_link_get_stats(&stats);
+    ESP_LOGI(TAG,
+             "cmds queued %" PRIu32 " acked %" PRIu32 " dropped %" PRIu32 " | frames %" PRIu32 " retx %" PRIu32
+             " nack %" PRIu32 " timeout %" PRIu32 " | %" PRIu32 " bytes | rtt last %" PRIu32 " us max %" PRIu32 " us",
+             stats.cmds_queued,
+             stats.cmds_acked,
+             stats.cmds_dropped,
+             stats.frames_sent,
+             stats.retransmits,
+             stats.nacks,
+             stats.timeouts,
+             stats.bytes_sent,
+             stats.rtt_last_us,
+             stats.rtt_max_us);
+}
+
+static void uart_link_task(void *arg)
+{
+    link_batch_t batch;
+    link_item_t carry;
+    bool has_carry = false;
+    uint8_t seq = 0;
+    uint32_t frames = 0;
+    bool synced = false;
+
+    while (1) {
+        if (!collect_batch(&batch, &carry, &has_carry, portMAX_DELAY)) {
+            continue;
+        }
+        if (!synced) {
+            // Until the CH32 has taken the SYNC, a command could be ACKed without being executed.
+            seq = link_next_seq(seq);
+            synced = send_frame(seq, LINK_OP_SYNC, NULL, 0, 0);
+            if (!synced) {
+                ESP_LOGW(TAG, "CH32 not answering the session start, %u commands dropped.", batch.count);
+                STATS_ADD(cmds_dropped, batch.count);
+                continue;
+            }
+        }
+        seq = link_next_seq(seq);
+        if (batch.count == 1) {
+            // A single command goes out as a plain frame, saving the record header.
+            send_frame(seq, batch.payload[0], batch.payload + 2, batch.payload[1], 1);
+        } else {
+            send_frame(seq, LINK_OP_BATCH, batch.payload, batch.len, batch.count);
+        }
+        if (++frames % LINK_STATS_PERIOD == 0) {
+            log_stats();
+        }
+    }
+}
+
+esp_err_t uart_link_init(void)
+{
+    ESP_RETURN_ON_FALSE(!s_queue, ESP_ERR_INVALID_STATE, TAG, "Already initialized.");
+
+    uart_config_t uart_config = {
+        .baud_rate = CONFIG_UART_LINK_BAUD_RATE,
+        .data_bits = UART_DATA_8_BITS,
+        .parity = UART_PARITY_DISABLE,
+        .stop_bits = UART_STOP_BITS_1,
+        .flow_ctrl = UART_HW_FLOWCTRL_DISABLE,
+        .source_clk = UART_SCLK_DEFAULT,
+    };
+    ESP_RETURN_ON_ERROR(uart_param_config(LINK_UART_NUM, &uart_config), TAG, "Failed to configure UART.");
+    ESP_RETURN_ON_ERROR(
+        uart_set_pin(LINK_UART_NUM, CONFIG_UART_LINK_TX_PIN, CONFIG_UART_LINK_RX_PIN, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE),
+        TAG,
+        "Failed to set UART pins.");
+    ESP_RETURN_ON_ERROR(uart_driver_install(LINK_UART_NUM, LINK_UART_RX_BUF, 0, 0, NULL, 0), TAG, "Failed to install UART driver.");
+
+    link_decoder_init(&s_decoder);
+    s_queue = xQueueCreate(LINK_QUEUE_DEPTH, sizeof(link_item_t));
+    ESP_RETURN_ON_FALSE(s_queue, ESP_ERR_NO_MEM, TAG, "Failed to create command queue.");
+    ESP_RETURN_ON_FALSE(xTaskCreate(uart_link_task, "uart_link", 3072, NULL, 6, NULL) == pdPASS,
+                        ESP_ERR_NO_MEM,
+                        TAG,
+                        "Failed to create link task.");
+    ESP_LOGI(TAG, "UART link initialized at %d baud.", CONFIG_UART_LINK_BAUD_RATE);
+    return ESP_OK;
+}
+
+esp_err_t uart_link_send(uint8_t op, const void *data, uint8_t len)
+{
+    ESP_RETURN_ON_FALSE(s_queue, ESP_ERR_INVALID_STATE, TAG, "Link not initialized.");
+    ESP_RETURN_ON_FALSE(len <= LINK_MAX_CMD_DATA, ESP_ERR_INVALID_SIZE, TAG, "Command payload too long.");
+    ESP_RETURN_ON_FALSE(op != LINK_OP_ACK && op != LINK_OP_NACK && op != LINK_OP_BATCH && op != LINK_OP_SYNC,
+                        ESP_ERR_INVALID_ARG,
+                        TAG,
+                        "Reserved opcode.");
+
+    link_item_t item;
+    item.op = op;
+    item.len = len;
+    if (len) {
+        memcpy(item.data, data, len);
+    }
+    if (xQueueSend(s_queue, &item, LINK_ENQUEUE_WAIT) != pdTRUE) {
+        STATS_ADD(cmds_dropped, 1);
+        return ESP_ERR_TIMEOUT;
+    }
+    STATS_ADD(cmds_queued, 1);
+    return ESP_OK;
+}
+
+esp_err_t uart_link_send_text(const char *text, size_t len)
+{
+    uint8_t op = link_opcode_from_text(text, len);
+    if (op != LINK_OP_TEXT) {
+        return uart_link_send(op, NULL, 0);
+    }
+    ESP_RETURN_ON_FALSE(len <= LINK_MAX_CMD_DATA, ESP_ERR_INVALID_SIZE, TAG, "Text command too long.");
+    return uart_link_send(op, text, (uint8_t)len);
+}
+
+void uart_link_get_stats(uart_link_stats_t *stats)
+{
+    portENTER_CRITICAL(&s_stats_lock);
+    *stats = s_stats;
+    portEXIT_CRITICAL(&s_stats_lock);
+}
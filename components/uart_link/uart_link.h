@@ -0,0 +1,61 @@
+#pragma once
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "link_protocol.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Delivery counters of the UART link.
+ */
+typedef struct {
+    uint32_t cmds_queued;    ///< Commands accepted by uart_link_send().
+    uint32_t cmds_dropped;   ///< Commands lost to a full queue or exhausted retries.
+    uint32_t cmds_acked;     ///< Commands confirmed by the CH32.
+    uint32_t frames_sent;    ///< Frames written, retransmissions included.
+    uint32_t retransmits;    ///< Frames sent again after a NACK or an ACK timeout.
+    uint32_t nacks;          ///< NACKs received.
+    uint32_t timeouts;       ///< ACK timeouts.
+    uint32_t bytes_sent;     ///< Bytes written to the UART.
+    uint32_t rx_crc_errors;  ///< Corrupted frames received from the CH32.
+    uint32_t rtt_last_us;    ///< Send to ACK time of the last acknowledged frame.
+    uint32_t rtt_max_us;     ///< Worst send to ACK time.
+} uart_link_stats_t;
+
+/**
+ * @brief Initializes the UART shared with the CH32 and starts the link task.
+ *
+ * Must be called once before any component sends a command.
+ */
+esp_err_t uart_link_init(void);
+
+/**
+ * @brief Queues one command for the CH32.
+ *
+ * Commands queued close together are batched into one frame. The call never blocks
+ * on the UART; it fails with ESP_ERR_TIMEOUT if the queue stays full.
+ *
+ * @param op   Command opcode, see link_opcode_t.
+ * @param data Command payload, may be NULL if len is 0.
+ * @param len  Payload length, at most LINK_MAX_CMD_DATA.
+ */
+esp_err_t uart_link_send(uint8_t op, const void *data, uint8_t len);
+
+/**
+ * @brief Queues a legacy ASCII command such as "LED2ON".
+ *
+ * Known commands are mapped to their opcode, anything else is sent as LINK_OP_TEXT.
+ */
+esp_err_t uart_link_send_text(const char *text, size_t len);
+
+/**
+ * @brief Copies the current delivery counters.
+ */
+void uart_link_get_stats(uart_link_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
@@ -14,7 +14,6 @@
 // ESP-IDF Drivers and Systems
 #include "driver/i2s_std.h"
 #include "driver/gpio.h"
-#include "driver/uart.h" // For uart_write_bytes
 #include "esp_log.h"
 #include "esp_check.h"
 
@@ -27,6 +26,7 @@
 
 // Public interface
 #include "voice_recognition.hpp"
+#include "uart_link.h"
 
 // Tag for logging
 static const char *TAG = "voice_rec";
@@ -42,10 +42,6 @@ static const char *TAG = "voice_rec";
 #define I2S_SAMPLE_RATE     (16000)
 #define I2S_READ_LEN        (1600 * 2) // 200ms audio buffer
 
-// UART is shared with the face_recognition component.
-// We assume UART_NUM_1 has already been initialized.
-#define SHARED_UART_NUM     (UART_NUM_1)
-
 
 // ==================================================================
 //                      INTERNAL IMPLEMENTATION
@@ -89,7 +85,7 @@ static void i2s_init() {
  * @details This task initializes the MultiNet speech recognition model, sets up a list of
  *          custom commands, and enters a loop to continuously process audio from the
  *          I2S microphone. When a command is detected, it sends a corresponding
- *          string over UART.
+ *          command to the CH32 over the UART link.
  * @param arg Task arguments (unused).
  */
 static void speech_recognition_task(void *arg) {
@@ -141,11 +137,11 @@ static void speech_recognition_task(void *arg) {
                 
                 // Handle the detected command based on its ID
                 if (mn_result->command_id[0] == 1) { // da kai deng
-                    uart_write_bytes(SHARED_UART_NUM, "LED2ON\r\n", 8);
+                    uart_link_send(LINK_OP_LED2_ON, NULL, 0);
                 } else if (mn_result->command_id[0] == 2) { // guan deng
-                    uart_write_bytes(SHARED_UART_NUM, "LED2OFF\r\n", 9);
+                    uart_link_send(LINK_OP_LED2_OFF, NULL, 0);
                 } else if (mn_result->command_id[0] == 3) { // cai ji yi ci shu ju
-                    uart_write_bytes(SHARED_UART_NUM, "Collect\r\n", 9);
+                    uart_link_send(LINK_OP_COLLECT, NULL, 0);
                 }
             }
         }
@@ -166,19 +162,18 @@ static void speech_recognition_task(void *arg) {
 /**
  * @brief Starts the voice recognition functionality.
  * @details Initializes the necessary hardware (I2S) and creates the FreeRTOS task
- *          for speech recognition. Assumes UART has been initialized elsewhere.
+ *          for speech recognition. Assumes the UART link has been initialized elsewhere.
  */
 void app_voice_start(void)
 {
     // Initialize hardware
     i2s_init();
 
-    // NOTE: UART is not initialized here.
-    // It is assumed to be initialized by the face_recognition component.
+    // NOTE: The UART link is not initialized here.
+    // It is assumed to be initialized by app_main with uart_link_init().
 
     ESP_LOGI(TAG, "Voice recognition module starting.");
-    const char *msg = "VOICE_READY\r\n";
-    uart_write_bytes(SHARED_UART_NUM, msg, strlen(msg));
+    uart_link_send(LINK_OP_VOICE_READY, NULL, 0);
 
     // Create the speech recognition task
     xTaskCreate(speech_recognition_task, "speech_recognition", 8192, NULL, 5, NULL);
@@ -0,0 +1,148 @@
+/**
+ * @file test_cmd_queue.c
+ * @brief The USART1 ISR to main loop command queue: order, full and oversized commands, index
+ *        wrap-around, and a producer thread standing in for the ISR against a consumer thread.
+ */
+#include "cmd_queue.h"
+#include "host_test.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <string.h>
+#include <time.h>
+
+static Cmd_Queue_t s_queue;
+
+static void test_order_and_full(void)
+{
+    Cmd_t cmd;
+    uint8_t data[CMD_QUEUE_DATA_MAX + 1];
+    memset(data, 0x77, sizeof(data));
+
+    Cmd_Queue_Init(&s_queue);
+    CHECK(!Cmd_Queue_Pop(&s_queue, &cmd));
+    CHECK(Cmd_Queue_Free(&s_queue) == CMD_QUEUE_SIZE);
+    for(int i = 0; i < CMD_QUEUE_SIZE; i++)
+    {
+        data[0] = (uint8_t)i;
+        CHECK(Cmd_Queue_Push(&s_queue, (uint8_t)(0x10 + i), data, (uint8_t)(i % 4)));
+    }
+    CHECK(Cmd_Queue_Free(&s_queue) == 0);
+    CHECK(!Cmd_Queue_Push(&s_queue, 0x10, NULL, 0));
+    CHECK(s_queue.Dropped == 1);
+
+    for(int i = 0; i < CMD_QUEUE_SIZE; i++)
+    {
+        CHECK(Cmd_Queue_Pop(&s_queue, &cmd));
+        CHECK(cmd.Op == 0x10 + i && cmd.Len == i % 4);
+        CHECK(cmd.Len == 0 || cmd.Data[0] == i);
+    }
+    CHECK(!Cmd_Queue_Pop(&s_queue, &cmd));
+
+    // A payload longer than a slot is dropped instead of truncated.
+    CHECK(Cmd_Queue_Push(&s_queue, 0x20, data, CMD_QUEUE_DATA_MAX));
+    CHECK(!Cmd_Queue_Push(&s_queue, 0x20, data, CMD_QUEUE_DATA_MAX + 1));
+    CHECK(s_queue.Dropped == 2);
+    CHECK(Cmd_Queue_Pop(&s_queue, &cmd) && cmd.Len == CMD_QUEUE_DATA_MAX);
+    CHECK(memcmp(cmd.Data, data, CMD_QUEUE_DATA_MAX) == 0);
+}
+
+static void test_index_wrap(void)
+{
+    Cmd_t cmd;
+    Cmd_Queue_Init(&s_queue);
+    // The free running indices overflow after 2^32 commands.
+    s_queue.Head = s_queue.Tail = 0xFFFFFFF8u;
+    for(int round = 0; round < 4; round++)
+    {
+        for(int i = 0; i < CMD_QUEUE_SIZE; i++)
+        {
+            uint8_t v = (uint8_t)(round * CMD_QUEUE_SIZE + i);
+            CHECK(Cmd_Queue_Push(&s_queue, v, &v, 1));
+        }
+        CHECK(Cmd_Queue_Free(&s_queue) == 0);
+        CHECK(!Cmd_Queue_Push(&s_queue, 0, NULL, 0));
+        for(int i = 0; i < CMD_QUEUE_SIZE; i++)
+        {
+            uint8_t v = (uint8_t)(round * CMD_QUEUE_SIZE + i);
+            CHECK(Cmd_Queue_Pop(&s_queue, &cmd) && cmd.Op == v && cmd.Data[0] == v);
+        }
+    }
+    CHECK(s_queue.Head < 0x100);
+}
+
+/*
+ * The queue only has compiler barriers, which is enough on the single core CH32 and on hosts that
+ * keep stores in order (x86). Elsewhere only the single threaded checks run.
+ */
+#if defined(__x86_64__) || defined(__i386__)
+
+#define STRESS_CMDS 2000000u
+
+static void *producer(void *arg)
+{
+    uint32_t next = 0;
+    (void)arg;
+    while(next < STRESS_CMDS)
+    {
+        uint8_t data[4];
+        memcpy(data, &next, sizeof(next));
+        if(Cmd_Queue_Push(&s_queue, (uint8_t)next, data, sizeof(data)))
+        {
+            next++;
+        }
+        else
+        {
+            sched_yield();  // Lets the consumer run when both threads share a core.
+        }
+    }
+    return NULL;
+}
+
+static void test_concurrent(void)
+{
+    pthread_t thread;
+    struct timespec start, end;
+    uint32_t expected = 0;
+    int errors = 0;
+
+    Cmd_Queue_Init(&s_queue);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    pthread_create(&thread, NULL, producer, NULL);
+    while(expected < STRESS_CMDS)
+    {
+        Cmd_t cmd;
+        uint32_t v;
+        if(!Cmd_Queue_Pop(&s_queue, &cmd))
+        {
+            sched_yield();
+            continue;
+        }
+        memcpy(&v, cmd.Data, sizeof(v));
+        if(cmd.Op != (uint8_t)expected || cmd.Len != 4 || v != expected)
+        {
+            errors++;
+        }
+        expected++;
+    }
+    pthread_join(thread, NULL);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    double s = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) * 1e-9;
+    printf("concurrent: %u commands in order, %.1f ns per command, %u pushes refused on a full queue\n",
+           STRESS_CMDS, s * 1e9 / STRESS_CMDS, (unsigned)s_queue.Dropped);
+    CHECK(errors == 0);
+    CHECK(Cmd_Queue_Free(&s_queue) == CMD_QUEUE_SIZE);
+}
+
+#endif
+
+int main(void)
+{
+    test_order_and_full();
+    test_index_wrap();
+#if defined(__x86_64__) || defined(__i386__)
+    test_concurrent();
+#endif
+    return HOST_TEST_RESULT();
+}
@@ -0,0 +1,343 @@
+/**
+ * @file test_ctrl_channel.c
+ * @brief The UDP control channel: SipHash-2-4 reference vectors, key checks, authentication before
+ *        rate limiting, duplicate and replay handling, and replay protection across a reboot with the
+ *        sequence limit kept in a flash_log on simulated NOR flash.
+ */
+#include "ctrl_channel.h"
+#include "flash_log.h"
+#include "host_test.h"
+
+#include <string.h>
+
+static const uint8_t kKey[CTRL_KEY_SIZE] = {0x3a, 0x91, 0x0c, 0x55, 0xe2, 0x17, 0x6b, 0xd4,
+                                             0x80, 0x2f, 0x99, 0x41, 0x06, 0xbe, 0x73, 0xc8};
+
+/* ---- Simulated NOR flash: erase sets 0xFF, programming can only clear bits. ---- */
+
+#define PAGE_SIZE 256
+#define PAGE0     0x1000u
+#define PAGE1     0x2000u
+
+static uint32_t s_flash[2][PAGE_SIZE / 4];
+static int s_erases;
+static int s_programs;
+static int s_fail_after = -1;   // Programs left before the flash starts failing, -1 for never.
+
+static uint32_t *flash_word(uint32_t addr)
+{
+    return &s_flash[addr >= PAGE1][(addr & (PAGE_SIZE - 1)) / 4];
+}
+
+static uint32_t flash_read(uint32_t addr)
+{
+    return *flash_word(addr);
+}
+
+static uint8_t flash_erase(uint32_t page_addr)
+{
+    s_erases++;
+    memset(s_flash[page_addr >= PAGE1], 0xFF, PAGE_SIZE);
+    return 1;
+}
+
+static uint8_t flash_program(uint32_t addr, uint32_t word)
+{
+    if(s_fail_after == 0)
+    {
+        return 0;
+    }
+    if(s_fail_after > 0)
+    {
+        s_fail_after--;
+    }
+    s_programs++;
+    *flash_word(addr) &= word;
+    return 1;
+}
+
+static const Flash_Log_Ops_t kFlashOps = {flash_read, flash_erase, flash_program};
+
+static void flash_reset(void)
+{
+    memset(s_flash, 0xFF, sizeof(s_flash));
+    s_erases = s_programs = 0;
+    s_fail_after = -1;
+}
+
+static uint8_t log_open(Flash_Log_t *log, uint32_t *value)
+{
+    return Flash_Log_Open(log, &kFlashOps, PAGE0, PAGE1, PAGE_SIZE, value);
+}
+
+/* ---- Control channel fixtures ---- */
+
+static int s_executed;
+static uint8_t s_last_op;
+static Flash_Log_t s_log;
+static uint32_t s_persisted;
+static int s_persist_calls;
+
+static void exec_cmd(uint8_t op, const uint8_t *data, uint8_t len)
+{
+    (void)data;
+    (void)len;
+    s_executed++;
+    s_last_op = op;
+}
+
+static uint8_t persist(uint32_t seq_limit)
+{
+    s_persist_calls++;
+    s_persisted = seq_limit;
+    return Flash_Log_Write(&s_log, seq_limit);
+}
+
+/// Builds a command datagram the way encode_command() in udp_server.py does.
+static uint16_t make_cmd(uint8_t *pkt, const uint8_t *key, uint32_t seq, uint8_t op, const char *text)
+{
+    uint8_t len = text ? (uint8_t)strlen(text) : 0;
+    pkt[0] = 'C';
+    pkt[1] = 'M';
+    pkt[2] = CTRL_VERSION;
+    for(int i = 0; i < 4; i++)
+    {
+        pkt[3 + i] = (uint8_t)(seq >> (8 * i));
+    }
+    pkt[7] = op;
+    pkt[8] = len;
+    if(len)
+    {
+        memcpy(pkt + CTRL_CMD_HEADER, text, len);
+    }
+    uint64_t tag = Ctrl_SipHash(key, pkt, CTRL_CMD_HEADER + len);
+    for(int i = 0; i < CTRL_TAG_SIZE; i++)
+    {
+        pkt[CTRL_CMD_HEADER + len + i] = (uint8_t)(tag >> (8 * i));
+    }
+    return (uint16_t)(CTRL_CMD_HEADER + len + CTRL_TAG_SIZE);
+}
+
+/// Sends a command and returns the ACK status, -1 if there was no (valid) ACK.
+static int send(Ctrl_Channel_t *ch, uint32_t now_ms, uint32_t seq, uint8_t op)
+{
+    uint8_t pkt[64], ack[CTRL_ACK_SIZE];
+    uint16_t len = make_cmd(pkt, kKey, seq, op, NULL);
+    if(Ctrl_Handle(ch, now_ms, pkt, len, ack) != CTRL_ACK_SIZE)
+    {
+        return -1;
+    }
+    uint64_t tag = Ctrl_SipHash(kKey, ack, 8);
+    for(int i = 0; i < CTRL_TAG_SIZE; i++)
+    {
+        if(ack[8 + i] != (uint8_t)(tag >> (8 * i)))
+        {
+            return -1;
+        }
+    }
+    CHECK(ack[0] == 'C' && ack[1] == 'A' && memcmp(ack + 3, pkt + 3, 4) == 0);
+    return ack[7];
+}
+
+/// Boots the channel the way main.c does: the limit comes from the flash log.
+static uint8_t boot(Ctrl_Channel_t *ch, uint32_t now_ms)
+{
+    uint32_t limit;
+    uint8_t has_limit = log_open(&s_log, &limit);
+    return Ctrl_Init(ch, kKey, exec_cmd, persist, has_limit ? &limit : NULL, now_ms);
+}
+
+static void test_siphash_vectors(void)
+{
+    // Reference vectors of the SipHash paper: key 00..0f, message 00..len-1.
+    static const struct
+    {
+        uint32_t len;
+        uint64_t tag;
+    } vectors[] = {
+        {0, 0x726fdb47dd0e0e31ULL},  {1, 0x74f839c593dc67fdULL},  {7, 0xab0200f58b01d137ULL},
+        {8, 0x93f5f5799a932462ULL},  {15, 0xa129ca6149be45e5ULL}, {63, 0x958a324ceb064572ULL},
+    };
+    uint8_t key[16], msg[64];
+    for(int i = 0; i < 64; i++)
+    {
+        msg[i] = (uint8_t)i;
+        if(i < 16)
+        {
+            key[i] = (uint8_t)i;
+        }
+    }
+    for(size_t i = 0; i < sizeof(vectors) / sizeof(vectors[0]); i++)
+    {
+        CHECK(Ctrl_SipHash(key, msg, vectors[i].len) == vectors[i].tag);
+    }
+}
+
+static void test_key_checks(void)
+{
+    Ctrl_Channel_t ch;
+    uint8_t weak[CTRL_KEY_SIZE];
+
+    flash_reset();
+    CHECK(!Ctrl_Init(&ch, (const uint8_t *)"CH32-ctrl-key-01", exec_cmd, persist, NULL, 0));
+    CHECK(send(&ch, 0, 100, 0x10) == -1);
+    memset(weak, 0xFF, sizeof(weak));
+    CHECK(!Ctrl_Init(&ch, weak, exec_cmd, persist, NULL, 0));
+    memset(weak, 0x00, sizeof(weak));
+    CHECK(!Ctrl_Init(&ch, weak, exec_cmd, persist, NULL, 0));
+    CHECK(!Ctrl_Init(&ch, kKey, exec_cmd, NULL, NULL, 0));
+    CHECK(Ctrl_Init(&ch, kKey, exec_cmd, persist, NULL, 0));
+}
+
+static void test_duplicates_and_replays(void)
+{
+    Ctrl_Channel_t ch;
+    flash_reset();
+    s_executed = 0;
+    CHECK(boot(&ch, 0));
+
+    CHECK(send(&ch, 0, 1000, 0x10) == CTRL_ACK_OK && s_executed == 1 && s_last_op == 0x10);
+    // A retransmission is acknowledged but not executed again.
+    CHECK(send(&ch, 500, 1000, 0x10) == CTRL_ACK_OK && s_executed == 1);
+    CHECK(send(&ch, 1000, 1001, 0x11) == CTRL_ACK_OK && s_executed == 2);
+    CHECK(send(&ch, 1500, 999, 0x12) == CTRL_ACK_REPLAY && s_executed == 2);
+    CHECK(ch.Stats.Accepted == 2 && ch.Stats.Duplicates == 1 && ch.Stats.Replays == 1);
+
+    // A wrong key or a modified datagram is dropped without an answer.
+    uint8_t pkt[64], ack[CTRL_ACK_SIZE], other[CTRL_KEY_SIZE];
+    memcpy(other, kKey, sizeof(other));
+    other[0] ^= 1;
+    uint16_t len = make_cmd(pkt, other, 2000, 0x12, NULL);
+    CHECK(Ctrl_Handle(&ch, 2000, pkt, len, ack) == 0);
+    len = make_cmd(pkt, kKey, 2000, 0x12, "UNLOCK");
+    pkt[CTRL_CMD_HEADER] ^= 0x20;
+    CHECK(Ctrl_Handle(&ch, 2000, pkt, len, ack) == 0);
+    CHECK(Ctrl_Handle(&ch, 2000, pkt, len - 1, ack) == 0);
+    CHECK(ch.Stats.Bad_Tag == 2 && ch.Stats.Malformed == 1 && s_executed == 2);
+}
+
+static void test_rate_limit_after_auth(void)
+{
+    Ctrl_Channel_t ch;
+    flash_reset();
+    s_executed = 0;
+    CHECK(boot(&ch, 0));
+
+    // A flood of forged datagrams does not use up the tokens of the legitimate sender.
+    uint8_t pkt[64], ack[CTRL_ACK_SIZE], other[CTRL_KEY_SIZE];
+    memset(other, 0x5a, sizeof(other));
+    other[3] = 0;
+    uint16_t len = make_cmd(pkt, other, 5000, 0x12, NULL);
+    for(int i = 0; i < 1000; i++)
+    {
+        CHECK(Ctrl_Handle(&ch, 0, pkt, len, ack) == 0);
+    }
+    CHECK(ch.Stats.Bad_Tag == 1000 && ch.Stats.Rate_Limited == 0);
+
+    // Authentic commands: a burst of CTRL_BURST, then CTRL_RATE_PER_S per second.
+    uint32_t seq = 100;
+    for(int i = 0; i < CTRL_BURST; i++)
+    {
+        CHECK(send(&ch, 0, seq++, 0x10) == CTRL_ACK_OK);
+    }
+    CHECK(send(&ch, 0, seq++, 0x10) == -1);
+    CHECK(ch.Stats.Rate_Limited == 1);
+    CHECK(send(&ch, 1000 / CTRL_RATE_PER_S, seq++, 0x10) == CTRL_ACK_OK);
+    CHECK(s_executed == CTRL_BURST + 1);
+}
+
+static void test_replay_across_reboot(void)
+{
+    Ctrl_Channel_t ch;
+    uint8_t captured[64], ack[CTRL_ACK_SIZE];
+    flash_reset();
+    s_executed = 0;
+    s_persist_calls = 0;
+    CHECK(boot(&ch, 0));
+
+    // The limit is written before the first command runs, then only when a command passes it.
+    uint16_t captured_len = make_cmd(captured, kKey, 7000, 0x12, NULL);
+    CHECK(Ctrl_Handle(&ch, 0, captured, captured_len, ack) == CTRL_ACK_SIZE && s_executed == 1);
+    CHECK(s_persist_calls == 1 && s_persisted == 7000 + CTRL_SEQ_RESERVE);
+    CHECK(send(&ch, 200, 7000 + CTRL_SEQ_RESERVE, 0x10) == CTRL_ACK_OK);
+    CHECK(s_persist_calls == 1);
+    CHECK(send(&ch, 400, 7000 + CTRL_SEQ_RESERVE + 1, 0x10) == CTRL_ACK_OK);
+    CHECK(s_persist_calls == 2 && s_executed == 3);
+
+    // Power cycle: the captured ACCESS_GRANTED datagram must not open the door again.
+    CHECK(boot(&ch, 0));
+    CHECK(Ctrl_Handle(&ch, 0, captured, captured_len, ack) == CTRL_ACK_SIZE);
+    CHECK(ack[7] == CTRL_ACK_REPLAY && s_executed == 3);
+    // Neither may any SEQ up to the saved limit, not even as a "duplicate" of it.
+    uint32_t limit = 7000 + CTRL_SEQ_RESERVE + 1 + CTRL_SEQ_RESERVE;
+    CHECK(send(&ch, 100, limit, 0x10) == CTRL_ACK_REPLAY && s_executed == 3);
+    CHECK(send(&ch, 200, limit + 1, 0x10) == CTRL_ACK_OK && s_executed == 4);
+    CHECK(s_persisted == limit + 1 + CTRL_SEQ_RESERVE);
+
+    // When the limit can not be saved the command is not executed and not acknowledged.
+    s_fail_after = 0;
+    CHECK(send(&ch, 400, limit + 1000, 0x10) == -1);
+    CHECK(ch.Stats.Persist_Errors == 1 && s_executed == 4);
+    s_fail_after = -1;
+    CHECK(send(&ch, 600, limit + 1001, 0x10) == CTRL_ACK_OK && s_executed == 5);
+}
+
+static void test_flash_log(void)
+{
+    Flash_Log_t log;
+    uint32_t value = 0;
+    flash_reset();
+    CHECK(!log_open(&log, &value));
+
+    // Records per page: (256 - 8) / 8 = 31. Several page rotations.
+    for(uint32_t v = 1; v <= 200; v++)
+    {
+        CHECK(Flash_Log_Write(&log, v * 3));
+        Flash_Log_t reopened;
+        CHECK(log_open(&reopened, &value) && value == v * 3);
+    }
+    CHECK(s_erases == (200 + 30) / 31);
+
+    // Power cut in the middle of a record: the previous value is still there.
+    log_open(&log, &value);
+    uint32_t addr = (log.Active ? PAGE1 : PAGE0) + log.Next;
+    *flash_word(addr) = 12345;
+    CHECK(log_open(&log, &value) && value == 600);
+    CHECK(Flash_Log_Write(&log, 601));
+    CHECK(log_open(&log, &value) && value == 601);
+
+    // Power cut during a rotation, after the erase and the record but before the header.
+    while(log.Next + FLASH_LOG_RECORD <= PAGE_SIZE)
+    {
+        CHECK(Flash_Log_Write(&log, 602));
+    }
+    s_fail_after = 3;
+    CHECK(!Flash_Log_Write(&log, 700));
+    s_fail_after = -1;
+    CHECK(log_open(&log, &value) && value == 602);
+    CHECK(Flash_Log_Write(&log, 701));
+    CHECK(log_open(&log, &value) && value == 701);
+
+    // The generation counter picks the newer page, also when it wraps.
+    flash_reset();
+    s_flash[0][0] = 0xFFFFFFFEu;
+    s_flash[0][1] = FLASH_LOG_MAGIC;
+    s_flash[0][2] = 5;
+    s_flash[0][3] = ~5u;
+    s_flash[1][0] = 0x00000001u;
+    s_flash[1][1] = FLASH_LOG_MAGIC;
+    s_flash[1][2] = 9;
+    s_flash[1][3] = ~9u;
+    CHECK(log_open(&log, &value) && value == 9 && log.Active == 1);
+}
+
+int main(void)
+{
+    test_siphash_vectors();
+    test_key_checks();
+    test_duplicates_and_replays();
+    test_rate_limit_after_auth();
+    test_replay_across_reboot();
+    test_flash_log();
+    return HOST_TEST_RESULT();
+}
@@ -0,0 +1,133 @@
+/**
+ * @file test_dht11_decode.c
+ * @brief DHT11 frame decoding from falling edge timestamps: nominal and worst case bit timings,
+ *        glitches before the response, timer wrap-around and every error path.
+ */
+#include "dht11_decode.h"
+#include "host_test.h"
+
+#include <string.h>
+
+#define RESP_US  160
+#define ZERO_US  78
+#define ONE_US   120
+
+/**
+ * @brief Builds the falling edges of a frame carrying data, starting at t0.
+ * @param zero_us, one_us - edge to edge time of a '0' and a '1' bit.
+ * @return number of edges written.
+ */
+static uint8_t make_trace(uint32_t *edges, uint32_t t0, const uint8_t data[5], uint32_t zero_us, uint32_t one_us)
+{
+    uint8_t n = 0;
+    uint32_t t = t0;
+    edges[n++] = t;
+    t += RESP_US;
+    edges[n++] = t;
+    for(int i = 0; i < 40; i++)
+    {
+        t += (data[i / 8] >> (7 - i % 8)) & 1 ? one_us : zero_us;
+        edges[n++] = t;
+    }
+    return n;
+}
+
+static void frame(uint8_t data[5], uint8_t humi, uint8_t temp, uint8_t temp_dec)
+{
+    data[0] = humi;
+    data[1] = 0;
+    data[2] = temp;
+    data[3] = temp_dec;
+    data[4] = (uint8_t)(humi + temp + temp_dec);
+}
+
+static void test_nominal(void)
+{
+    uint32_t edges[64];
+    uint8_t data[5], out[5];
+    frame(data, 55, 23, 4);
+    uint8_t n = make_trace(edges, 1000, data, ZERO_US, ONE_US);
+    CHECK(n == DHT11_FRAME_EDGES);
+    CHECK(DHT11_Decode(edges, n, out) == DHT11_OK);
+    CHECK(memcmp(out, data, 5) == 0);
+
+    // All zeros and all ones, the bit boundaries at their tolerance limits.
+    const uint8_t zeros[5] = {0, 0, 0, 0, 0};
+    n = make_trace(edges, 0, zeros, DHT11_BIT_MIN_US, ONE_US);
+    CHECK(DHT11_Decode(edges, n, out) == DHT11_OK && memcmp(out, zeros, 5) == 0);
+    n = make_trace(edges, 0, zeros, DHT11_BIT_ONE_US, ONE_US);
+    CHECK(DHT11_Decode(edges, n, out) == DHT11_OK && memcmp(out, zeros, 5) == 0);
+    frame(data, 0xFF, 0xFF, 0xFF);
+    data[1] = 0xFF;
+    data[4] = (uint8_t)(data[0] + data[1] + data[2] + data[3]);
+    n = make_trace(edges, 0, data, ZERO_US, DHT11_BIT_MAX_US);
+    CHECK(DHT11_Decode(edges, n, out) == DHT11_OK && memcmp(out, data, 5) == 0);
+    n = make_trace(edges, 0, data, ZERO_US, DHT11_BIT_ONE_US + 1);
+    CHECK(DHT11_Decode(edges, n, out) == DHT11_OK && memcmp(out, data, 5) == 0);
+}
+
+static void test_glitch_and_wrap(void)
+{
+    uint32_t edges[64];
+    uint8_t data[5], out[5];
+    frame(data, 40, 30, 0);
+
+    // Edges caught while the pin changes direction come before the frame and are skipped.
+    edges[0] = 10;
+    edges[1] = 12;
+    edges[2] = 500;
+    uint8_t n = (uint8_t)(3 + make_trace(edges + 3, 2000, data, ZERO_US, ONE_US));
+    CHECK(DHT11_Decode(edges, n, out) == DHT11_OK && memcmp(out, data, 5) == 0);
+
+    // The microsecond timer wraps in the middle of the frame.
+    n = make_trace(edges, 0xFFFFFFFFu - 2000, data, ZERO_US, ONE_US);
+    CHECK(edges[n - 1] < edges[0]);
+    CHECK(DHT11_Decode(edges, n, out) == DHT11_OK && memcmp(out, data, 5) == 0);
+}
+
+static void test_errors(void)
+{
+    uint32_t edges[64] = {0};
+    uint8_t data[5], out[5];
+    frame(data, 60, 21, 1);
+
+    CHECK(DHT11_Decode(edges, 0, out) == DHT11_ERR_NO_RESPONSE);
+    uint8_t n = make_trace(edges, 0, data, ZERO_US, ONE_US);
+    CHECK(DHT11_Decode(edges, n - 1, out) == DHT11_ERR_SHORT);
+
+    // Response too short and too long.
+    n = make_trace(edges, 0, data, ZERO_US, ONE_US);
+    edges[0] = edges[1] - (DHT11_RESP_MIN_US - 1);
+    CHECK(DHT11_Decode(edges, n, out) == DHT11_ERR_TIMING);
+    edges[0] = edges[1] - (DHT11_RESP_MAX_US + 1);
+    CHECK(DHT11_Decode(edges, n, out) == DHT11_ERR_TIMING);
+
+    // A stuck line shows up as a bit far longer than any valid one, a glitch as a very short one.
+    n = make_trace(edges, 0, data, ZERO_US, ONE_US);
+    for(int i = 20; i < n; i++)
+    {
+        edges[i] += 1000;
+    }
+    CHECK(DHT11_Decode(edges, n, out) == DHT11_ERR_TIMING);
+    n = make_trace(edges, 0, data, ZERO_US, ONE_US);
+    edges[30] = edges[29] + DHT11_BIT_MIN_US - 1;
+    CHECK(DHT11_Decode(edges, n, out) == DHT11_ERR_TIMING);
+
+    // Every single flipped bit is caught by the checksum.
+    for(int bit = 0; bit < 40; bit++)
+    {
+        uint8_t bad[5];
+        memcpy(bad, data, 5);
+        bad[bit / 8] ^= (uint8_t)(0x80 >> (bit % 8));
+        n = make_trace(edges, 0, bad, ZERO_US, ONE_US);
+        CHECK(DHT11_Decode(edges, n, out) == DHT11_ERR_CHECKSUM);
+    }
+}
+
+int main(void)
+{
+    test_nominal();
+    test_glitch_and_wrap();
+    test_errors();
+    return HOST_TEST_RESULT();
+}
@@ -0,0 +1,155 @@
+/**
+ * @file test_rx_ring.c
+ * @brief The DMA receive ring against a simulated circular DMA channel: byte stream integrity
+ *        across wrap-arounds, the DMA counter reload position, overflow recovery and statistics.
+ */
+#include "host_test.h"
+#include "rx_ring.h"
+
+#include <string.h>
+
+#define RING_SIZE 64
+
+static uint8_t s_dma_buf[RING_SIZE];
+static uint32_t s_dma_written;  // Bytes written by the simulated DMA.
+static uint32_t s_rng = 1;
+
+static uint32_t rng_next(void)
+{
+    s_rng = s_rng * 1103515245u + 12345u;
+    return s_rng >> 8;
+}
+
+/// Stream byte number i, so that the reader can tell lost or repeated bytes apart.
+static uint8_t stream_byte(uint32_t i)
+{
+    return (uint8_t)(i * 7 + (i >> 8));
+}
+
+/// The DMA writes n bytes and the ISR (half/full transfer or IDLE) publishes its position.
+static void dma_write(Rx_Ring_t *ring, uint32_t n)
+{
+    for(uint32_t i = 0; i < n; i++)
+    {
+        s_dma_buf[s_dma_written % RING_SIZE] = stream_byte(s_dma_written);
+        s_dma_written++;
+    }
+    // Right after the counter reloads the DMA reports Size - CNTR = Size - Size = 0, right before it
+    // reports Size; both are the same position.
+    uint32_t pos = s_dma_written % RING_SIZE;
+    if(pos == 0 && (rng_next() & 1))
+    {
+        pos = RING_SIZE;
+    }
+    Rx_Ring_Update(ring, pos);
+}
+
+static void test_stream(void)
+{
+    Rx_Ring_t ring;
+    uint8_t out[RING_SIZE];
+    uint32_t read = 0;
+    int errors = 0;
+
+    s_dma_written = 0;
+    Rx_Ring_Init(&ring, s_dma_buf, RING_SIZE);
+    for(int round = 0; round < 100000; round++)
+    {
+        // Less than a lap between two updates, and the reader keeps up.
+        dma_write(&ring, rng_next() % (RING_SIZE / 2));
+        uint32_t n;
+        while((n = Rx_Ring_Read(&ring, out, rng_next() % 24 + 1)) > 0)
+        {
+            for(uint32_t i = 0; i < n; i++, read++)
+            {
+                errors += out[i] != stream_byte(read);
+            }
+        }
+    }
+    CHECK(errors == 0);
+    CHECK(read == s_dma_written);
+
+    Rx_Ring_Stats_t stats;
+    Rx_Ring_Get_Stats(&ring, &stats);
+    CHECK(stats.Bytes == s_dma_written && stats.Overflows == 0 && stats.Dropped == 0);
+}
+
+static void test_full_ring(void)
+{
+    Rx_Ring_t ring;
+    uint8_t out[RING_SIZE];
+
+    // Exactly one lap unread is still intact.
+    s_dma_written = 5;
+    Rx_Ring_Init(&ring, s_dma_buf, RING_SIZE);
+    ring.Head = ring.Tail = s_dma_written;
+    dma_write(&ring, RING_SIZE / 2);
+    dma_write(&ring, RING_SIZE / 2);
+    CHECK(Rx_Ring_Read(&ring, out, sizeof(out)) == RING_SIZE);
+    CHECK(out[0] == stream_byte(5) && out[RING_SIZE - 1] == stream_byte(5 + RING_SIZE - 1));
+}
+
+static void test_overflow(void)
+{
+    Rx_Ring_t ring;
+    uint8_t out[RING_SIZE];
+
+    s_dma_written = 0;
+    Rx_Ring_Init(&ring, s_dma_buf, RING_SIZE);
+    dma_write(&ring, 10);
+    CHECK(Rx_Ring_Read(&ring, out, 10) == 10);
+
+    // The main loop stalls while more than a lap arrives: the unread data is dropped as a whole.
+    for(int i = 0; i < 5; i++)
+    {
+        dma_write(&ring, RING_SIZE / 2 - 1);
+    }
+    uint32_t lost = 5 * (RING_SIZE / 2 - 1);
+    CHECK(Rx_Ring_Read(&ring, out, sizeof(out)) == 0);
+    Rx_Ring_Stats_t stats;
+    Rx_Ring_Get_Stats(&ring, &stats);
+    CHECK(stats.Overflows == 1 && stats.Dropped == lost);
+
+    // Reception resumes with the next bytes.
+    dma_write(&ring, 3);
+    CHECK(Rx_Ring_Read(&ring, out, sizeof(out)) == 3);
+    CHECK(out[0] == stream_byte(10 + lost) && out[2] == stream_byte(12 + lost));
+
+    Rx_Ring_Error(&ring);
+    Rx_Ring_Get_Stats(&ring, &stats);
+    CHECK(stats.Errors == 1 && stats.Bytes == 13 + lost);
+}
+
+static void test_head_wrap(void)
+{
+    Rx_Ring_t ring;
+    uint8_t out[RING_SIZE];
+
+    // The free running byte counters overflow after 4 GB.
+    s_dma_written = 0xFFFFFFC0u;
+    Rx_Ring_Init(&ring, s_dma_buf, RING_SIZE);
+    ring.Head = ring.Tail = s_dma_written;
+    uint32_t read = s_dma_written;
+    int errors = 0;
+    for(int i = 0; i < 20; i++)
+    {
+        dma_write(&ring, 13);
+        uint32_t n = Rx_Ring_Read(&ring, out, sizeof(out));
+        CHECK(n == 13);
+        for(uint32_t j = 0; j < n; j++, read++)
+        {
+            errors += out[j] != stream_byte(read);
+        }
+    }
+    CHECK(errors == 0);
+    CHECK(ring.Head == s_dma_written && ring.Head < 0x1000);
+}
+
+int main(void)
+{
+    test_stream();
+    test_full_ring();
+    test_overflow();
+    test_head_wrap();
+    return HOST_TEST_RESULT();
+}
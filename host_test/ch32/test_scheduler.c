@@ -0,0 +1,156 @@
+/**
+ * @file test_scheduler.c
+ * @brief The CH32 cooperative scheduler on a simulated microsecond clock: periods, skipped periods,
+ *        jitter, deadline overruns, clock wrap-around and the stats report.
+ */
+#include "host_test.h"
+#include "scheduler.h"
+
+#include <string.h>
+
+static uint32_t s_now;
+
+static uint32_t fake_clock(void)
+{
+    return s_now;
+}
+
+static int s_fast_runs;
+static int s_slow_runs;
+static uint32_t s_slow_cost;
+
+static void fast_task(void)
+{
+    s_fast_runs++;
+    s_now += 100;
+}
+
+static void slow_task(void)
+{
+    s_slow_runs++;
+    s_now += s_slow_cost;
+}
+
+static void poll_task(void)
+{
+    s_now += 10;
+}
+
+/// Runs the superloop until the clock reaches end, idling 50us per empty pass.
+static void run_until(uint32_t end)
+{
+    while((int32_t)(s_now - end) < 0)
+    {
+        uint32_t before = s_now;
+        Sched_Run_Once();
+        if(s_now == before)
+        {
+            s_now += 50;
+        }
+    }
+}
+
+static void reset(uint32_t start)
+{
+    s_now = start;
+    s_fast_runs = s_slow_runs = 0;
+    s_slow_cost = 0;
+    Sched_Init(fake_clock);
+}
+
+static void test_periods(void)
+{
+    reset(0);
+    int fast = Sched_Add("fast", fast_task, SCHED_MS(10), SCHED_MS(1));
+    int slow = Sched_Add("slow", slow_task, SCHED_MS(100), 0);
+    CHECK(fast == 0 && slow == 1 && Sched_Task_Count() == 2);
+    CHECK(Sched_Add("null", 0, 0, 0) == -1);
+
+    s_slow_cost = 200;
+    run_until(SCHED_MS(1000));
+    // Both run at registration time and then once per period.
+    CHECK(s_fast_runs == 100);
+    CHECK(s_slow_runs == 10);
+    const Sched_Task_t *t = Sched_Get_Task(fast);
+    CHECK(t->Runs == 100 && t->Run_Max_Us == 100 && t->Run_Total_Us == 100 * 100);
+    CHECK(t->Overruns == 0 && t->Skipped == 0);
+    // At worst the fast task waits for the slow one and an idle pass.
+    CHECK(t->Jitter_Max_Us <= 200 + 50);
+    CHECK(Sched_Get_Task(2) == NULL && Sched_Get_Task(-1) == NULL);
+}
+
+static void test_overrun_and_skip(void)
+{
+    reset(0);
+    int fast = Sched_Add("fast", fast_task, SCHED_MS(10), SCHED_MS(1));
+    Sched_Add("slow", slow_task, SCHED_MS(100), 0);
+
+    // The slow task blocks for 35ms once: the fast task starts late and misses periods.
+    s_slow_cost = SCHED_MS(35);
+    Sched_Run_Once();
+    s_slow_cost = 0;
+    run_until(SCHED_MS(100) - 1);
+    const Sched_Task_t *t = Sched_Get_Task(fast);
+    CHECK(t->Overruns == 1);
+    // The 10ms release runs late at 35.1ms, the 20ms and 30ms releases are skipped.
+    CHECK(t->Skipped == 2);
+    CHECK(t->Jitter_Max_Us >= SCHED_MS(25));
+    // Periods are not made up for: 0ms, 35.1ms, then every 10ms from there.
+    CHECK(s_fast_runs == 1 + 1 + 6);
+
+    Sched_Reset_Stats();
+    CHECK(t->Runs == 0 && t->Overruns == 0 && t->Skipped == 0 && t->Jitter_Max_Us == 0);
+    CHECK(t->Period_Us == SCHED_MS(10));
+}
+
+static void test_clock_wrap(void)
+{
+    // The TIM4 based clock wraps after about 71 minutes.
+    reset(0xFFFFFFFFu - SCHED_MS(50));
+    Sched_Add("fast", fast_task, SCHED_MS(10), SCHED_MS(1));
+    run_until(SCHED_MS(50));
+    const Sched_Task_t *t = Sched_Get_Task(0);
+    CHECK(s_fast_runs == 10 || s_fast_runs == 11);
+    CHECK(t->Skipped == 0 && t->Overruns == 0);
+    CHECK(t->Jitter_Max_Us < SCHED_MS(1));
+}
+
+static void test_polling_task(void)
+{
+    reset(1000);
+    int poll = Sched_Add("poll", poll_task, 0, 0);
+    Sched_Add("slow", slow_task, SCHED_MS(20), 0);
+    s_slow_cost = SCHED_MS(3);
+    run_until(SCHED_MS(100));
+    const Sched_Task_t *t = Sched_Get_Task(poll);
+    // A polling task runs on every pass; its jitter is the longest gap between two runs.
+    CHECK(t->Runs > 1000);
+    CHECK(t->Jitter_Max_Us == 10 + SCHED_MS(3));
+}
+
+static void test_format(void)
+{
+    char buf[256];
+    reset(0);
+    Sched_Add("fast", fast_task, SCHED_MS(10), 0);
+    run_until(SCHED_MS(30));
+    int len = Sched_Format_Stats(buf, sizeof(buf));
+    CHECK(len == (int)strlen(buf));
+    CHECK(strcmp(buf, "fast 3 100 100 0 0 0\n") == 0);
+
+    // A short buffer is truncated and still terminated.
+    char small[8];
+    len = Sched_Format_Stats(small, sizeof(small));
+    CHECK(len == (int)sizeof(small) - 1 && small[len] == '\0');
+    CHECK(Sched_Format_Stats(small, 0) == 0);
+}
+
+int main(void)
+{
+    test_periods();
+    test_overrun_and_skip();
+    test_clock_wrap();
+    test_polling_task();
+    test_format();
+    return HOST_TEST_RESULT();
+}
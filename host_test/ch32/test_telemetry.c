@@ -0,0 +1,141 @@
+/**
+ * @file test_telemetry.c
+ * @brief Telemetry datagram encoding: header and record layout, batch limits and sequence numbers.
+ * @details With an output path argument the datagrams and the samples they carry are also written
+ *          out, so that test_telemetry_decode.py can check the decoder of udp_server.py against them.
+ */
+#include "host_test.h"
+#include "telemetry.h"
+
+#include <stdio.h>
+#include <string.h>
+
+static uint16_t get_u16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | p[1] << 8);
+}
+
+static uint32_t get_u32(const uint8_t *p)
+{
+    return get_u16(p) | (uint32_t)get_u16(p + 2) << 16;
+}
+
+static Telem_Sample_t make_sample(uint32_t i, uint32_t time_ms)
+{
+    Telem_Sample_t s;
+    s.Time_Ms = time_ms;
+    s.Temp = (int8_t)(i % 2 ? -(int)(i % 40) : (int)(i % 50));
+    s.Humi = (uint8_t)(i % 100);
+    s.Light = (uint16_t)(i * 97 % 4096);
+    s.State = (uint8_t)(i % 16);
+    s.Dht_Age_S = (uint8_t)(i % 256);
+    return s;
+}
+
+static void test_layout(void)
+{
+    Telem_Batch_t batch;
+    Telem_Batch_Init(&batch);
+    CHECK(Telem_Batch_Finish(&batch, 0) == 0);
+
+    Telem_Sample_t a = make_sample(3, 1000);
+    Telem_Sample_t b = make_sample(4, 3500);
+    CHECK(Telem_Batch_Add(&batch, &a) && Telem_Batch_Add(&batch, &b));
+    uint16_t len = Telem_Batch_Finish(&batch, TELEM_FLAG_EVENT);
+    CHECK(len == TELEM_HEADER_SIZE + 2 * TELEM_RECORD_SIZE);
+
+    const uint8_t *h = batch.Buf;
+    CHECK(h[0] == 'T' && h[1] == 'M' && h[2] == TELEM_VERSION && h[3] == TELEM_FLAG_EVENT);
+    CHECK(get_u16(h + 4) == 0 && h[6] == 2 && h[7] == TELEM_RECORD_SIZE);
+    CHECK(get_u32(h + 8) == 0 && get_u32(h + 12) == 1000);
+
+    const uint8_t *r = h + TELEM_HEADER_SIZE + TELEM_RECORD_SIZE;
+    CHECK(get_u16(r) == 2500);
+    CHECK((int8_t)r[2] == b.Temp && r[3] == b.Humi && get_u16(r + 4) == b.Light);
+    CHECK(r[6] == b.State && r[7] == b.Dht_Age_S);
+
+    // The next batch continues both sequence numbers.
+    CHECK(Telem_Batch_Add(&batch, &a));
+    Telem_Batch_Finish(&batch, 0);
+    CHECK(get_u16(h + 4) == 1 && get_u32(h + 8) == 2 && h[3] == 0);
+}
+
+static void test_limits(void)
+{
+    Telem_Batch_t batch;
+    Telem_Batch_Init(&batch);
+    for(int i = 0; i < TELEM_MAX_SAMPLES; i++)
+    {
+        Telem_Sample_t s = make_sample(i, i * 100);
+        CHECK(Telem_Batch_Add(&batch, &s));
+    }
+    Telem_Sample_t s = make_sample(99, 4000);
+    CHECK(!Telem_Batch_Add(&batch, &s));
+    CHECK(Telem_Batch_Finish(&batch, 0) == TELEM_MAX_DATAGRAM);
+
+    // DT_MS is 16 bits: a sample 65.536s after the first one needs a new datagram.
+    s = make_sample(0, 0xFFFFF000u);
+    CHECK(Telem_Batch_Add(&batch, &s));
+    s.Time_Ms = 0xFFFFF000u + 0xFFFF;
+    CHECK(Telem_Batch_Add(&batch, &s));
+    s.Time_Ms += 1;
+    CHECK(!Telem_Batch_Add(&batch, &s));
+    CHECK(batch.Count == 2);
+}
+
+/**
+ * @brief Writes datagrams as { u16 length, bytes } and one line per sample they carry:
+ *        "seq flags sample_seq time_ms temp humi light state dht_age".
+ */
+static void write_vectors(const char *dir)
+{
+    char path[512];
+    snprintf(path, sizeof(path), "%s/telemetry.bin", dir);
+    FILE *bin = fopen(path, "wb");
+    snprintf(path, sizeof(path), "%s/telemetry.txt", dir);
+    FILE *txt = fopen(path, "w");
+    CHECK(bin && txt);
+    if(!bin || !txt)
+    {
+        return;
+    }
+
+    Telem_Batch_t batch;
+    Telem_Batch_Init(&batch);
+    // Start close to the wrap of the millisecond clock and of the datagram sequence number.
+    batch.Seq = 0xFFFE;
+    uint32_t time_ms = 0xFFFFFF00u;
+    uint32_t sample_seq = 0;
+    for(int datagram = 0; datagram < 6; datagram++)
+    {
+        uint16_t seq = batch.Seq;
+        uint8_t flags = datagram % 3 == 2 ? TELEM_FLAG_EVENT : 0;
+        int count = 1 + datagram * 7 % TELEM_MAX_SAMPLES;
+        for(int i = 0; i < count; i++)
+        {
+            Telem_Sample_t s = make_sample(sample_seq + i, time_ms);
+            CHECK(Telem_Batch_Add(&batch, &s));
+            fprintf(txt, "%u %u %u %u %d %u %u %u %u\n", seq, flags, (unsigned)(sample_seq + i), (unsigned)time_ms,
+                    s.Temp, s.Humi, s.Light, s.State, s.Dht_Age_S);
+            time_ms += 250 + i;
+        }
+        uint16_t len = Telem_Batch_Finish(&batch, flags);
+        uint8_t prefix[2] = {(uint8_t)len, (uint8_t)(len >> 8)};
+        fwrite(prefix, 1, 2, bin);
+        fwrite(batch.Buf, 1, len, bin);
+        sample_seq += count;
+    }
+    fclose(bin);
+    fclose(txt);
+}
+
+int main(int argc, char **argv)
+{
+    test_layout();
+    test_limits();
+    if(argc > 1)
+    {
+        write_vectors(argv[1]);
+    }
+    return HOST_TEST_RESULT();
+}
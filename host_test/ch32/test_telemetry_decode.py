@@ -0,0 +1,56 @@
+"""
+Decodes the datagrams written by test_telemetry with decode_telemetry() of udp_server.py and
+compares every field with the samples the C encoder was given.
+
+    python3 test_telemetry_decode.py <test_telemetry binary> <repo root>
+"""
+import os
+import struct
+import subprocess
+import sys
+import tempfile
+
+sys.dont_write_bytecode = True
+sys.path.insert(0, sys.argv[2])
+import udp_server  # noqa: E402
+
+
+def main():
+    with tempfile.TemporaryDirectory() as tmp:
+        subprocess.run([sys.argv[1], tmp], check=True)
+        with open(os.path.join(tmp, "telemetry.bin"), "rb") as f:
+            stream = f.read()
+        with open(os.path.join(tmp, "telemetry.txt")) as f:
+            expected = [tuple(int(v) for v in line.split()) for line in f]
+
+    decoded = []
+    pos = 0
+    while pos < len(stream):
+        (size,) = struct.unpack_from("<H", stream, pos)
+        datagram = stream[pos + 2:pos + 2 + size]
+        pos += 2 + size
+        header, samples = udp_server.decode_telemetry(datagram)
+        assert header["version"] == 1 and header["count"] == len(samples)
+        decoded += [(header["seq"], header["flags"]) + s for s in samples]
+
+        # A truncated datagram is rejected, anything else is not telemetry.
+        try:
+            udp_server.decode_telemetry(datagram[:-1])
+            raise AssertionError("truncated datagram accepted")
+        except ValueError:
+            pass
+        assert udp_server.decode_telemetry(b"LED2ON") is None
+
+    if decoded != expected:
+        for got, want in zip(decoded, expected):
+            if got != want:
+                print(f"decoded {got}, expected {want}")
+                break
+        print(f"{len(decoded)} samples decoded, {len(expected)} expected")
+        return 1
+    print(f"{len(decoded)} samples decoded by udp_server.py as encoded by telemetry.c")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,21 @@
+/**
+ * @file host_test.h
+ * @brief Minimal check macros shared by the host tests, usable from C and C++.
+ */
+#pragma once
+
+#include <stdio.h>
+
+static int host_test_failures = 0;
+
+/// Records a failure and keeps going, so one run reports every broken check.
+#define CHECK(cond)                                                                   \
+    do {                                                                              \
+        if (!(cond)) {                                                                \
+            fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #cond); \
+            host_test_failures++;                                                     \
+        }                                                                             \
+    } while (0)
+
+/// Exit code of the test binary.
+#define HOST_TEST_RESULT() (host_test_failures ? (fprintf(stderr, "%d check(s) failed\n", host_test_failures), 1) : 0)
@@ -0,0 +1,184 @@
+/**
+ * @file bench_dl_base.cpp
+ * @brief Host benchmark of the C implementations of the dl/base kernels: conv2d, depthwise conv2d, pooling, resize
+ *        and requantize, at int8 and int16.
+ * @details The ISA paths only build for the chips, so the numbers here measure the C fallbacks. Resize has no
+ *          int16 C kernel and requantize_linear none at all, requantize is timed through TensorBase::assign, its
+ *          scalar path. Usage: bench_dl_base [iterations], each operator is run once to warm up and then timed over
+ *          the iterations.
+ */
+#include "dl_base_avg_pool2d.hpp"
+#include "dl_base_conv2d.hpp"
+#include "dl_base_depthwise_conv2d.hpp"
+#include "dl_base_max_pool2d.hpp"
+#include "dl_base_resize.hpp"
+#include "host_test.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <random>
+
+using namespace dl;
+
+namespace {
+
+int g_iterations = 20;
+std::mt19937 g_rng(1);
+
+template <typename T>
+TensorBase *random_tensor(std::vector<int> shape, int exponent)
+{
+    TensorBase *tensor = new TensorBase(shape, nullptr, exponent, sizeof(T) == 1 ? DATA_TYPE_INT8 : DATA_TYPE_INT16);
+    std::uniform_int_distribution<int> dist(sizeof(T) == 1 ? -128 : -4096, sizeof(T) == 1 ? 127 : 4095);
+    T *element = (T *)tensor->get_element_ptr();
+    for (int i = 0; i < tensor->get_size(); i++) {
+        element[i] = dist(g_rng);
+    }
+    return tensor;
+}
+
+template <typename T>
+TensorBase *empty_tensor(std::vector<int> shape, int exponent)
+{
+    return new TensorBase(shape, nullptr, exponent, sizeof(T) == 1 ? DATA_TYPE_INT8 : DATA_TYPE_INT16);
+}
+
+std::string shape_str(const std::vector<int> &shape)
+{
+    std::string str;
+    for (size_t i = 0; i < shape.size(); i++) {
+        str += (i ? "x" : "") + std::to_string(shape[i]);
+    }
+    return str;
+}
+
+/**
+ * @brief Runs the kernel once to warm up and checks that a second run writes the same output, then prints its
+ *        average run time.
+ */
+void bench(const char *op, const char *dtype, TensorBase *input, TensorBase *output, const std::function<void()> &run)
+{
+    size_t bytes = output->get_bytes();
+    run();
+    std::vector<uint8_t> first((uint8_t *)output->get_element_ptr(), (uint8_t *)output->get_element_ptr() + bytes);
+    memset(output->get_element_ptr(), 0, bytes);
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < g_iterations; i++) {
+        run();
+    }
+    auto end = std::chrono::steady_clock::now();
+    CHECK(memcmp(first.data(), output->get_element_ptr(), bytes) == 0);
+
+    double us = std::chrono::duration<double, std::micro>(end - start).count() / g_iterations;
+    printf("%-20s %-6s %-14s %-14s %12.1f\n",
+           op,
+           dtype,
+           shape_str(input->shape).c_str(),
+           shape_str(output->shape).c_str(),
+           us);
+}
+
+template <typename T, typename buffer_t>
+void bench_conv(const char *op, const char *dtype, int kernel, int channel, int group)
+{
+    int pad = kernel / 2;
+    TensorBase *input = random_tensor<T>({1, 32, 32, channel}, -7);
+    TensorBase *filter = random_tensor<T>({kernel, kernel, channel, group == 1 ? channel : 1}, -7);
+    TensorBase *output = empty_tensor<T>({1, 32, 32, channel}, -5);
+    std::vector<int> padding = {pad, pad, pad, pad};
+    std::vector<base::ArgsType<T>> args = base::get_conv_operation_args<T>(
+        output, input, padding, filter, {1, 1}, {1, 1}, group, nullptr, Linear, nullptr, RUNTIME_MODE_SINGLE_CORE);
+    bench(op, dtype, input, output, [&] {
+        // The padding path of the shell edits the arguments, the modules build them again on every run too.
+        base::ArgsType<T> run_args = args[0];
+        if (group == 1) {
+            base::conv2d<T, int32_t, buffer_t>(&run_args);
+        } else {
+            base::depthwise_conv2d<T, int32_t, buffer_t>(&run_args);
+        }
+    });
+    delete input;
+    delete filter;
+    delete output;
+}
+
+template <typename T>
+void bench_pool(const char *dtype)
+{
+    TensorBase *input = random_tensor<T>({1, 32, 32, 32}, -7);
+    TensorBase *output = empty_tensor<T>({1, 16, 16, 32}, -7);
+    std::vector<base::PoolArgsType<T>> args =
+        base::get_pool_args<T>(output, input, {0, 0, 0, 0}, {2, 2}, {2, 2}, RUNTIME_MODE_SINGLE_CORE);
+    bench("avg_pool2d 2x2/2", dtype, input, output, [&] { base::avg_pool2d<T>(&args[0]); });
+    bench("max_pool2d 2x2/2", dtype, input, output, [&] { base::max_pool2d<T>(&args[0]); });
+
+    // The C max pool is simple enough to check against a reference.
+    T *in = (T *)input->get_element_ptr();
+    T *out = (T *)output->get_element_ptr();
+    int wrong = 0;
+    for (int y = 0; y < 16; y++) {
+        for (int x = 0; x < 16; x++) {
+            for (int c = 0; c < 32; c++) {
+                T expected = in[((2 * y) * 32 + 2 * x) * 32 + c];
+                for (int k = 1; k < 4; k++) {
+                    expected = std::max(expected, in[((2 * y + k / 2) * 32 + 2 * x + k % 2) * 32 + c]);
+                }
+                wrong += out[(y * 16 + x) * 32 + c] != expected;
+            }
+        }
+    }
+    CHECK(wrong == 0);
+    delete input;
+    delete output;
+}
+
+template <typename T>
+void bench_resize(const char *op, const char *dtype, resize_mode_t mode)
+{
+    TensorBase *input = random_tensor<T>({1, 16, 16, 32}, -7);
+    TensorBase *output = empty_tensor<T>({1, 32, 32, 32}, -7);
+    float *cache = nullptr;
+    std::vector<base::resizeArgsType<T>> args = base::get_resize_operation_args<T>(
+        output, input, mode, {1.f, 1.f, 2.f, 2.f}, false, cache, RUNTIME_MODE_SINGLE_CORE);
+    bench(op, dtype, input, output, [&] { base::resize<T>(&args[0]); });
+    free(cache);
+    delete input;
+    delete output;
+}
+
+template <typename out_t, typename in_t>
+void bench_requantize(const char *dtype)
+{
+    TensorBase *input = random_tensor<in_t>({1, 32, 32, 32}, -9);
+    TensorBase *output = empty_tensor<out_t>({1, 32, 32, 32}, -5);
+    bench("requantize (assign)", dtype, input, output, [&] { CHECK(output->assign(input)); });
+    delete input;
+    delete output;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    if (argc > 1) {
+        g_iterations = std::max(1, atoi(argv[1]));
+    }
+    printf("%-20s %-6s %-14s %-14s %12s\n", "operator", "dtype", "input", "output", "us");
+    bench_conv<int8_t, int32_t>("conv2d 3x3", "s8", 3, 16, 1);
+    bench_conv<int16_t, int64_t>("conv2d 3x3", "s16", 3, 16, 1);
+    bench_conv<int8_t, int32_t>("conv2d 1x1", "s8", 1, 32, 1);
+    bench_conv<int16_t, int64_t>("conv2d 1x1", "s16", 1, 32, 1);
+    bench_conv<int8_t, int32_t>("depthwise 3x3", "s8", 3, 32, 32);
+    bench_conv<int16_t, int64_t>("depthwise 3x3", "s16", 3, 32, 32);
+    bench_pool<int8_t>("s8");
+    bench_pool<int16_t>("s16");
+    bench_resize<int8_t>("resize nearest 2x", "s8", RESIZE_NEAREST);
+    bench_resize<int8_t>("resize linear 2x", "s8", RESIZE_LINEAR);
+    bench_requantize<int8_t, int8_t>("s8");
+    bench_requantize<int8_t, int16_t>("s16>s8");
+    bench_requantize<int16_t, int16_t>("s16");
+    return HOST_TEST_RESULT();
+}
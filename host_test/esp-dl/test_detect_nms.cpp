@@ -0,0 +1,250 @@
+/**
+ * @file test_detect_nms.cpp
+ * @brief DetectPostprocessor::nms() against the list based NMS it replaced: the same kept boxes, in the same order,
+ *        on random frames with overlapping clusters, tied scores and keypoints, and the time of both.
+ */
+#include "dl_detect_postprocessor.hpp"
+#include "host_test.h"
+
+#include <chrono>
+#include <random>
+
+using namespace dl::detect;
+
+namespace {
+
+/// The candidates of one frame, in parse order.
+struct Frame {
+    std::vector<result_t> boxes;
+    float nms_thr;
+    int top_k;
+};
+
+/**
+ * @brief The previous collection and NMS, as of commit 366eea6: every candidate is inserted at its sorted position in
+ *        a std::list, then suppressed boxes are erased pairwise.
+ */
+class ListNms {
+public:
+    ListNms(float nms_thr, int top_k) : m_nms_thr(nms_thr), m_top_k(top_k) {}
+
+    void add(const result_t &new_box)
+    {
+        m_box_list.insert(std::upper_bound(m_box_list.begin(), m_box_list.end(), new_box, greater_box), new_box);
+    }
+
+    void nms()
+    {
+        int kept_number = 0;
+        for (std::list<result_t>::iterator kept = m_box_list.begin(); kept != m_box_list.end(); kept++) {
+            kept_number++;
+
+            if (kept_number >= m_top_k) {
+                m_box_list.erase(++kept, m_box_list.end());
+                break;
+            }
+
+            int kept_area = (kept->box[2] - kept->box[0] + 1) * (kept->box[3] - kept->box[1] + 1);
+
+            std::list<result_t>::iterator other = kept;
+            other++;
+            for (; other != m_box_list.end();) {
+                int inter_lt_x = DL_MAX(kept->box[0], other->box[0]);
+                int inter_lt_y = DL_MAX(kept->box[1], other->box[1]);
+                int inter_rb_x = DL_MIN(kept->box[2], other->box[2]);
+                int inter_rb_y = DL_MIN(kept->box[3], other->box[3]);
+
+                int inter_height = inter_rb_y - inter_lt_y + 1;
+                int inter_width = inter_rb_x - inter_lt_x + 1;
+
+                if (inter_height > 0 && inter_width > 0) {
+                    int other_area = (other->box[2] - other->box[0] + 1) * (other->box[3] - other->box[1] + 1);
+                    int inter_area = inter_height * inter_width;
+                    float iou = (float)inter_area / (kept_area + other_area - inter_area);
+                    if (iou > m_nms_thr) {
+                        other = m_box_list.erase(other);
+                        continue;
+                    }
+                }
+                other++;
+            }
+        }
+    }
+
+    std::list<result_t> &get_result(int width, int height)
+    {
+        for (result_t &res : m_box_list) {
+            res.limit_box(width, height);
+            res.limit_keypoint(width, height);
+        }
+        return m_box_list;
+    }
+
+private:
+    float m_nms_thr;
+    int m_top_k;
+    std::list<result_t> m_box_list;
+};
+
+/// Feeds the candidates of a frame to the shared engine, the way the parse stages of the postprocessors do.
+class FramePostprocessor : public DetectPostprocessor {
+public:
+    FramePostprocessor(const Frame &frame) :
+        DetectPostprocessor(nullptr, 0.f, frame.nms_thr, frame.top_k), m_frame(frame)
+    {
+    }
+
+    void postprocess() override
+    {
+        for (const result_t &res : m_frame.boxes) {
+            if (res.keypoint.empty()) {
+                add_candidate(res.category, res.score, res.box[0], res.box[1], res.box[2], res.box[3]);
+            } else {
+                add_candidate(res.category,
+                              res.score,
+                              res.box[0],
+                              res.box[1],
+                              res.box[2],
+                              res.box[3],
+                              res.keypoint.data(),
+                              res.keypoint.size());
+            }
+        }
+    }
+
+private:
+    const Frame &m_frame;
+};
+
+const int kWidth = 320;
+const int kHeight = 240;
+
+/// Boxes around a few objects, partly out of the image, with scores on a coarse grid so that ties are common.
+Frame random_frame(std::mt19937 &rng, int candidates, bool keypoints)
+{
+    std::uniform_int_distribution<int> center_x(-20, kWidth + 20), center_y(-20, kHeight + 20);
+    std::uniform_int_distribution<int> size(4, 80), jitter(-12, 12), score(1, 32), objects(1, 12);
+    const float nms_thrs[] = {0.3f, 0.45f, 0.5f, 0.7f};
+    const int top_ks[] = {0, 1, 5, 10, 100};
+
+    Frame frame;
+    frame.nms_thr = nms_thrs[rng() % 4];
+    frame.top_k = top_ks[rng() % 5];
+    std::vector<std::vector<int>> centers(objects(rng));
+    for (std::vector<int> &center : centers) {
+        center = {center_x(rng), center_y(rng), size(rng), size(rng)};
+    }
+    for (int i = 0; i < candidates; i++) {
+        const std::vector<int> &c = centers[rng() % centers.size()];
+        int x = c[0] + jitter(rng), y = c[1] + jitter(rng);
+        int w = c[2] + jitter(rng) / 2, h = c[3] + jitter(rng) / 2;
+        result_t res = {(int)(rng() % 3), score(rng) / 32.f, {x - w / 2, y - h / 2, x + w / 2, y + h / 2}, {}};
+        if (keypoints) {
+            for (int k = 0; k < 5; k++) {
+                res.keypoint.push_back(x + jitter(rng));
+                res.keypoint.push_back(y + jitter(rng));
+            }
+        }
+        frame.boxes.push_back(res);
+    }
+    return frame;
+}
+
+bool same_result(const std::list<result_t> &a, const std::list<result_t> &b)
+{
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (auto ia = a.begin(), ib = b.begin(); ia != a.end(); ia++, ib++) {
+        if (ia->category != ib->category || ia->score != ib->score || ia->box != ib->box ||
+            ia->keypoint != ib->keypoint) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void test_same_as_list()
+{
+    std::mt19937 rng(7);
+    int mismatches = 0;
+    int kept = 0;
+    for (int i = 0; i < 500; i++) {
+        Frame frame = random_frame(rng, rng() % 400, i % 3 == 0);
+        ListNms legacy(frame.nms_thr, frame.top_k);
+        for (const result_t &res : frame.boxes) {
+            legacy.add(res);
+        }
+        legacy.nms();
+
+        FramePostprocessor postprocessor(frame);
+        postprocessor.postprocess();
+        postprocessor.nms();
+
+        std::list<result_t> &expected = legacy.get_result(kWidth, kHeight);
+        if (!same_result(postprocessor.get_result(kWidth, kHeight), expected)) {
+            mismatches++;
+        }
+        kept += expected.size();
+    }
+    printf("500 frames, %d boxes kept, %d mismatches\n", kept, mismatches);
+    CHECK(mismatches == 0);
+    CHECK(kept > 500);
+}
+
+void test_without_nms()
+{
+    // Candidates left without an nms() call come back sorted by score, ties in parse order.
+    Frame frame = {{{0, 0.5f, {0, 0, 9, 9}, {}}, {1, 0.9f, {5, 5, 9, 9}, {}}, {2, 0.5f, {1, 1, 9, 9}, {}}}, 0.5f, 10};
+    FramePostprocessor postprocessor(frame);
+    postprocessor.postprocess();
+    std::list<result_t> &result = postprocessor.get_result(kWidth, kHeight);
+    std::vector<int> categories;
+    for (const result_t &res : result) {
+        categories.push_back(res.category);
+    }
+    CHECK(categories == std::vector<int>({1, 0, 2}));
+}
+
+void bench_nms()
+{
+    std::mt19937 rng(11);
+    std::vector<Frame> frames;
+    for (int i = 0; i < 10; i++) {
+        frames.push_back(random_frame(rng, 3000, false));
+        frames.back().top_k = 10;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    for (const Frame &frame : frames) {
+        ListNms legacy(frame.nms_thr, frame.top_k);
+        for (const result_t &res : frame.boxes) {
+            legacy.add(res);
+        }
+        legacy.nms();
+    }
+    auto middle = std::chrono::steady_clock::now();
+    for (const Frame &frame : frames) {
+        FramePostprocessor postprocessor(frame);
+        postprocessor.postprocess();
+        postprocessor.nms();
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    double list_us = std::chrono::duration<double, std::micro>(middle - start).count() / frames.size();
+    double flat_us = std::chrono::duration<double, std::micro>(end - middle).count() / frames.size();
+    printf("3000 candidates, top_k 10: list %.0f us, flat %.0f us per frame (%.1fx)\n",
+           list_us,
+           flat_us,
+           list_us / flat_us);
+}
+
+} // namespace
+
+int main()
+{
+    test_same_as_list();
+    test_without_nms();
+    bench_nms();
+    return HOST_TEST_RESULT();
+}
@@ -0,0 +1,221 @@
+/**
+ * @file test_feat_store.cpp
+ * @brief FeatStore against the list based database it replaced: same results, and query time at
+ *        10, 100 and 1000 enrolled identities.
+ */
+#include "dl_base_dotprod.hpp"
+#include "dl_recognition_feat_store.hpp"
+#include "host_test.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <list>
+#include <random>
+
+using namespace dl::recognition;
+
+namespace {
+
+const int kFeatLen = 512;
+const float kThr = 0.1f;
+const int kTopK = 5;
+
+/// The previous DataBase storage: one heap block per feature, scalar similarity and a full sort.
+class ListStore {
+public:
+    ~ListStore()
+    {
+        for (auto &feat : m_feats) {
+            heap_caps_free(feat.feat);
+        }
+    }
+
+    void push_back(uint16_t id, const float *feat)
+    {
+        float *copy = (float *)heap_caps_malloc(kFeatLen * sizeof(float), MALLOC_CAP_SPIRAM);
+        memcpy(copy, feat, kFeatLen * sizeof(float));
+        m_feats.push_back({id, copy});
+    }
+
+    std::vector<result_t> query(const float *feat, float thr, int top_k)
+    {
+        std::vector<result_t> results;
+        int i = 1;
+        for (auto it = m_feats.begin(); it != m_feats.end(); it++, i++) {
+            float sim = 0;
+            for (int j = 0; j < kFeatLen; j++) {
+                sim += it->feat[j] * feat[j];
+            }
+            if (sim <= thr) {
+                continue;
+            }
+            results.push_back({(uint16_t)i, sim});
+        }
+        std::sort(results.begin(), results.end(), [](const result_t &a, const result_t &b) -> bool {
+            return a.similarity > b.similarity;
+        });
+        if ((int)results.size() > top_k) {
+            results.resize(top_k);
+        }
+        return results;
+    }
+
+private:
+    std::list<database_feat> m_feats;
+};
+
+std::vector<float> random_feat(std::mt19937 &rng)
+{
+    std::normal_distribution<float> dist(0, 1);
+    std::vector<float> feat(kFeatLen);
+    float norm = 0;
+    for (float &v : feat) {
+        v = dist(rng);
+        norm += v * v;
+    }
+    norm = std::sqrt(norm);
+    for (float &v : feat) {
+        v /= norm;
+    }
+    return feat;
+}
+
+/// A feature close to base, so that queries have hits above the threshold.
+std::vector<float> near_feat(std::mt19937 &rng, const std::vector<float> &base, float noise)
+{
+    std::vector<float> feat = random_feat(rng);
+    float norm = 0;
+    for (int i = 0; i < kFeatLen; i++) {
+        feat[i] = base[i] + noise * feat[i];
+        norm += feat[i] * feat[i];
+    }
+    norm = std::sqrt(norm);
+    for (float &v : feat) {
+        v /= norm;
+    }
+    return feat;
+}
+
+void test_dotprod()
+{
+    std::mt19937 rng(1);
+    std::uniform_int_distribution<int> dist(-128, 127);
+    for (int len : {1, 3, 16, 17, 64, 511}) {
+        std::vector<int8_t> a8(len), b8(len);
+        std::vector<int16_t> a16(len), b16(len);
+        int64_t ref8 = 0, ref16 = 0;
+        for (int i = 0; i < len; i++) {
+            a8[i] = dist(rng);
+            b8[i] = dist(rng);
+            a16[i] = dist(rng) * 64;
+            b16[i] = dist(rng) * 64;
+            ref8 += a8[i] * b8[i];
+            ref16 += a16[i] * b16[i];
+        }
+        CHECK(dl::base::dotprod(a8.data(), b8.data(), len) == ref8);
+        CHECK(dl::base::dotprod(a16.data(), b16.data(), len) == ref16);
+    }
+}
+
+/// Returns the ids of the results, the similarities of the quantized stores are only close.
+std::vector<uint16_t> ids(const std::vector<result_t> &results)
+{
+    std::vector<uint16_t> out;
+    for (const auto &res : results) {
+        out.push_back(res.id);
+    }
+    return out;
+}
+
+void test_same_results()
+{
+    std::mt19937 rng(2);
+    ListStore list;
+    FeatStore store_f32(kFeatLen, FEAT_STORE_FLOAT);
+    FeatStore store_s16(kFeatLen, FEAT_STORE_INT16);
+    FeatStore store_s8(kFeatLen, FEAT_STORE_INT8);
+    std::vector<float> base = random_feat(rng);
+    for (int i = 0; i < 100; i++) {
+        // A cluster around base with well separated similarities, and unrelated features.
+        std::vector<float> feat = i % 4 ? random_feat(rng) : near_feat(rng, base, 0.1f * (i + 1));
+        list.push_back(i + 1, feat.data());
+        CHECK(store_f32.push_back(i + 1, feat.data()) == ESP_OK);
+        CHECK(store_s16.push_back(i + 1, feat.data()) == ESP_OK);
+        CHECK(store_s8.push_back(i + 1, feat.data()) == ESP_OK);
+    }
+    std::vector<result_t> expected = list.query(base.data(), kThr, kTopK);
+    std::vector<result_t> f32 = store_f32.query(base.data(), kThr, kTopK);
+    CHECK(!expected.empty());
+    CHECK(ids(f32) == ids(expected));
+    for (size_t i = 0; i < f32.size() && i < expected.size(); i++) {
+        CHECK(std::fabs(f32[i].similarity - expected[i].similarity) < 1e-5f);
+    }
+    CHECK(ids(store_s16.query(base.data(), kThr, kTopK)) == ids(expected));
+    std::vector<result_t> s8 = store_s8.query(base.data(), kThr, kTopK);
+    CHECK(!s8.empty() && s8[0].id == expected[0].id);
+    for (size_t i = 0; i < s8.size() && i < expected.size(); i++) {
+        CHECK(std::fabs(s8[i].similarity - expected[i].similarity) < 0.05f);
+    }
+
+    // Rows keep their enrollment order when one is erased, ids are looked up by value.
+    CHECK(store_f32.find(1) == 0);
+    store_f32.erase(0);
+    CHECK(store_f32.size() == 99);
+    CHECK(store_f32.find(1) == -1);
+    CHECK(store_f32.get_id(0) == 2);
+    CHECK(store_f32.back_id() == 100);
+    std::vector<float> row(kFeatLen);
+    store_f32.get_feat(0, row.data());
+    FeatStore single(kFeatLen);
+    single.push_back(2, row.data());
+    CHECK(std::fabs(single.query(row.data(), 0.f, 1)[0].similarity - 1.f) < 1e-5f);
+}
+
+template <typename Store>
+double query_us(Store &store, const std::vector<std::vector<float>> &queries)
+{
+    int hits = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (const auto &query : queries) {
+        hits += store.query(query.data(), kThr, kTopK).size();
+    }
+    auto end = std::chrono::steady_clock::now();
+    CHECK(hits >= 0);
+    return std::chrono::duration<double, std::micro>(end - start).count() / queries.size();
+}
+
+void bench_query()
+{
+    std::mt19937 rng(3);
+    std::vector<std::vector<float>> queries;
+    for (int i = 0; i < 200; i++) {
+        queries.push_back(random_feat(rng));
+    }
+    printf("%10s %12s %12s %12s %12s\n", "identities", "list us", "f32 us", "s16 us", "s8 us");
+    for (int n : {10, 100, 1000}) {
+        ListStore list;
+        FeatStore store_f32(kFeatLen, FEAT_STORE_FLOAT);
+        FeatStore store_s16(kFeatLen, FEAT_STORE_INT16);
+        FeatStore store_s8(kFeatLen, FEAT_STORE_INT8);
+        for (int i = 0; i < n; i++) {
+            std::vector<float> feat = random_feat(rng);
+            list.push_back(i + 1, feat.data());
+            store_f32.push_back(i + 1, feat.data());
+            store_s16.push_back(i + 1, feat.data());
+            store_s8.push_back(i + 1, feat.data());
+        }
+        printf("%10d %12.2f %12.2f %12.2f %12.2f\n", n, query_us(list, queries), query_us(store_f32, queries),
+               query_us(store_s16, queries), query_us(store_s8, queries));
+    }
+}
+
+} // namespace
+
+int main()
+{
+    test_dotprod();
+    test_same_results();
+    bench_query();
+    return HOST_TEST_RESULT();
+}
@@ -0,0 +1,156 @@
+/**
+ * @file test_image_resize.cpp
+ * @brief resize_fused against resize_loop, the per pixel path it replaced: the same output bytes for every source
+ *        pixel type, quantized output type, interpolation, channel swap, crop and scale.
+ */
+#include "dl_image_process.hpp"
+#include "host_test.h"
+
+#include <random>
+
+using namespace dl::image;
+
+namespace {
+
+std::mt19937 g_rng(1);
+
+/// Three normalization tables with distinct values per channel, like ImagePreprocessor::create_norm_lut.
+template <typename T>
+std::vector<T> make_norm_lut()
+{
+    const float mean[3] = {123.7f, 116.3f, 103.5f};
+    const float inv_std[3] = {1 / 58.4f, 1 / 57.1f, 1 / 57.4f};
+    float inv_scale = sizeof(T) == 1 ? 32.f : 4096.f;
+    float max = sizeof(T) == 1 ? 127.f : 32767.f;
+    std::vector<T> lut(3 * 256);
+    for (int c = 0; c < 3; c++) {
+        for (int v = 0; v < 256; v++) {
+            float q = std::round((v - mean[c]) * inv_std[c] * inv_scale);
+            lut[c * 256 + v] = (T)std::max(std::min(q, max), -max - 1);
+        }
+    }
+    return lut;
+}
+
+std::vector<uint8_t> random_bytes(size_t size)
+{
+    std::uniform_int_distribution<int> dist(0, 255);
+    std::vector<uint8_t> data(size);
+    for (uint8_t &v : data) {
+        v = dist(g_rng);
+    }
+    return data;
+}
+
+/**
+ * @brief Resizes src into dst with resize_fused and with resize_loop, and compares the outputs.
+ */
+template <typename T>
+bool same_output(const img_t &src,
+                 uint16_t dst_width,
+                 uint16_t dst_height,
+                 pix_type_t dst_type,
+                 interpolate_type_t interpolate_type,
+                 uint32_t caps,
+                 const std::vector<int> &crop_area)
+{
+    std::vector<T> lut = make_norm_lut<T>();
+    img_t fused = {nullptr, dst_width, dst_height, dst_type};
+    img_t loop = fused;
+    size_t bytes = get_img_byte_size(fused);
+    std::vector<uint8_t> fused_data(bytes, 0xa5), loop_data(bytes, 0x5a);
+    fused.data = fused_data.data();
+    loop.data = loop_data.data();
+
+    int crop_width = crop_area.empty() ? src.width : crop_area[2] - crop_area[0];
+    int crop_height = crop_area.empty() ? src.height : crop_area[3] - crop_area[1];
+    float scale_x = (float)dst_width / (float)crop_width;
+    float scale_y = (float)dst_height / (float)crop_height;
+
+    if (!resize_fused(src, fused, interpolate_type, caps, lut.data(), crop_area, scale_x, scale_y)) {
+        return false;
+    }
+    resize_loop<T>(src, loop, interpolate_type, caps, lut.data(), crop_area, scale_x, scale_y);
+    return fused_data == loop_data;
+}
+
+void test_bit_exact()
+{
+    const pix_type_t src_types[] = {DL_IMAGE_PIX_TYPE_RGB888, DL_IMAGE_PIX_TYPE_RGB565, DL_IMAGE_PIX_TYPE_GRAY};
+    const uint32_t caps_list[] = {0,
+                                  DL_IMAGE_CAP_RGB_SWAP,
+                                  DL_IMAGE_CAP_RGB565_BIG_ENDIAN,
+                                  DL_IMAGE_CAP_RGB_SWAP | DL_IMAGE_CAP_RGB565_BYTE_SWAP};
+    const interpolate_type_t interps[] = {DL_IMAGE_INTERPOLATE_NEAREST, DL_IMAGE_INTERPOLATE_BILINEAR};
+    // Down and up scaling, odd ratios and a size that does not divide the source.
+    const uint16_t dst_sizes[][2] = {{32, 24}, {160, 120}, {37, 53}, {1, 1}};
+    const std::vector<int> crops[] = {{}, {10, 7, 71, 50}, {0, 0, 1, 1}};
+
+    int cases = 0;
+    for (pix_type_t src_type : src_types) {
+        img_t src = {nullptr, 80, 60, src_type};
+        std::vector<uint8_t> src_data = random_bytes(get_img_byte_size(src));
+        src.data = src_data.data();
+        bool gray = src_type == DL_IMAGE_PIX_TYPE_GRAY;
+        for (uint32_t caps : caps_list) {
+            for (interpolate_type_t interp : interps) {
+                for (auto &size : dst_sizes) {
+                    for (const std::vector<int> &crop : crops) {
+                        bool ok8 = same_output<int8_t>(src,
+                                                       size[0],
+                                                       size[1],
+                                                       gray ? DL_IMAGE_PIX_TYPE_GRAY_QINT8
+                                                            : DL_IMAGE_PIX_TYPE_RGB888_QINT8,
+                                                       interp,
+                                                       caps,
+                                                       crop);
+                        bool ok16 = same_output<int16_t>(src,
+                                                         size[0],
+                                                         size[1],
+                                                         gray ? DL_IMAGE_PIX_TYPE_GRAY_QINT16
+                                                              : DL_IMAGE_PIX_TYPE_RGB888_QINT16,
+                                                         interp,
+                                                         caps,
+                                                         crop);
+                        if (!ok8 || !ok16) {
+                            printf("mismatch: src %s, caps 0x%x, interp %d, %dx%d, crop %d\n",
+                                   pix_type_to_str(src_type).c_str(),
+                                   (unsigned)caps,
+                                   (int)interp,
+                                   size[0],
+                                   size[1],
+                                   (int)crop.size());
+                        }
+                        CHECK(ok8);
+                        CHECK(ok16);
+                        cases += 2;
+                    }
+                }
+            }
+        }
+    }
+    printf("%d resize cases bit-exact\n", cases);
+}
+
+void test_unsupported()
+{
+    // Outputs that are not quantized and gray to rgb stay on resize_loop.
+    std::vector<uint8_t> data(64 * 3 * 2);
+    std::vector<int8_t> lut = make_norm_lut<int8_t>();
+    img_t src = {data.data(), 8, 8, DL_IMAGE_PIX_TYPE_GRAY};
+    img_t dst = {data.data() + 64 * 3, 4, 4, DL_IMAGE_PIX_TYPE_RGB888_QINT8};
+    CHECK(!resize_fused(src, dst, DL_IMAGE_INTERPOLATE_NEAREST, 0, lut.data(), {}, 0.5f, 0.5f));
+    dst.pix_type = DL_IMAGE_PIX_TYPE_GRAY;
+    CHECK(!resize_fused(src, dst, DL_IMAGE_INTERPOLATE_NEAREST, 0, lut.data(), {}, 0.5f, 0.5f));
+    dst.pix_type = DL_IMAGE_PIX_TYPE_GRAY_QINT8;
+    CHECK(!resize_fused(src, dst, DL_IMAGE_INTERPOLATE_NEAREST, 0, nullptr, {}, 0.5f, 0.5f));
+}
+
+} // namespace
+
+int main()
+{
+    test_bit_exact();
+    test_unsupported();
+    return HOST_TEST_RESULT();
+}
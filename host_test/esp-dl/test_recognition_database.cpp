@@ -0,0 +1,253 @@
+/**
+ * @file test_recognition_database.cpp
+ * @brief Journal replay, torn-tail recovery, version check and background compaction of the face database, on
+ *        FileStorage and on a RAM backed PartitionStorage.
+ */
+#include "dl_recognition_database.hpp"
+#include "host_test.h"
+
+#include <cstdio>
+#include <string>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using namespace dl;
+using namespace dl::recognition;
+
+namespace {
+
+const int kFeatLen = 16;
+const size_t kEnrollSize = sizeof(database_record) + kFeatLen * sizeof(float);
+
+std::string g_dir;
+
+std::vector<float> make_feat(int seed)
+{
+    std::vector<float> feat(kFeatLen, 0.f);
+    feat[seed % kFeatLen] = 1.f;
+    feat[(seed * 7 + 3) % kFeatLen] += 0.5f;
+    return feat;
+}
+
+esp_err_t enroll(DataBase &db, int seed)
+{
+    std::vector<float> feat = make_feat(seed);
+    TensorBase tensor({kFeatLen}, feat.data(), 0, DATA_TYPE_FLOAT);
+    return db.enroll_feat(&tensor);
+}
+
+std::vector<uint16_t> ids(DataBase &db)
+{
+    std::vector<uint16_t> out;
+    for (int i = 0; i < db.get_feat_store().size(); i++) {
+        out.push_back(db.get_feat_store().get_id(i));
+    }
+    return out;
+}
+
+size_t file_size(const std::string &path)
+{
+    struct stat st;
+    return stat(path.c_str(), &st) == 0 ? (size_t)st.st_size : 0;
+}
+
+std::vector<uint8_t> read_file(const std::string &path)
+{
+    std::vector<uint8_t> data(file_size(path));
+    FILE *f = fopen(path.c_str(), "rb");
+    if (f) {
+        data.resize(fread(data.data(), 1, data.size(), f));
+        fclose(f);
+    }
+    return data;
+}
+
+void write_file(const std::string &path, const std::vector<uint8_t> &data)
+{
+    FILE *f = fopen(path.c_str(), "wb");
+    fwrite(data.data(), 1, data.size(), f);
+    fclose(f);
+}
+
+uint32_t crc32(const void *data, size_t len)
+{
+    const uint8_t *p = (const uint8_t *)data;
+    uint32_t crc = 0xffffffff;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= p[i];
+        for (int j = 0; j < 8; j++) {
+            crc = (crc & 1) ? (0xedb88320 ^ (crc >> 1)) : (crc >> 1);
+        }
+    }
+    return ~crc;
+}
+
+/// FileStorage that remembers on which thread the journal was last rewritten.
+class TracingStorage : public FileStorage {
+public:
+    TracingStorage(const char *path) : FileStorage(path) {}
+    esp_err_t rewrite(const void *data, size_t size) override
+    {
+        rewrites++;
+        rewrite_thread = std::this_thread::get_id();
+        return FileStorage::rewrite(data, size);
+    }
+    int rewrites = 0;
+    std::thread::id rewrite_thread;
+};
+
+void test_replay()
+{
+    std::string path = g_dir + "/replay.db";
+    {
+        DataBase db(path.c_str(), kFeatLen);
+        for (int i = 0; i < 5; i++) {
+            CHECK(enroll(db, i) == ESP_OK);
+        }
+        CHECK(db.delete_feat(2) == ESP_OK);
+        CHECK(db.delete_last_feat() == ESP_OK);
+    }
+    CHECK(file_size(path) == sizeof(database_header) + 5 * kEnrollSize + 2 * sizeof(database_record));
+
+    DataBase db(path.c_str(), kFeatLen);
+    CHECK(ids(db) == std::vector<uint16_t>({1, 3, 4}));
+    // Ids are never reused.
+    CHECK(enroll(db, 9) == ESP_OK);
+    CHECK(ids(db).back() == 6);
+
+    std::vector<float> query = make_feat(2);
+    TensorBase tensor({kFeatLen}, query.data(), 0, DATA_TYPE_FLOAT);
+    std::vector<result_t> res = db.query_feat(&tensor, 0.5f, 1);
+    CHECK(res.size() == 1 && db.get_feat_store().get_id(res[0].id - 1) == 3);
+}
+
+void test_torn_tail()
+{
+    std::string path = g_dir + "/torn.db";
+    {
+        DataBase db(path.c_str(), kFeatLen);
+        for (int i = 0; i < 3; i++) {
+            CHECK(enroll(db, i) == ESP_OK);
+        }
+    }
+    // Power cut in the middle of the third enroll record.
+    std::vector<uint8_t> data = read_file(path);
+    data.resize(data.size() - kEnrollSize / 2);
+    write_file(path, data);
+    {
+        DataBase db(path.c_str(), kFeatLen);
+        CHECK(ids(db) == std::vector<uint16_t>({1, 2}));
+        // The torn record is dropped before anything is appended after it.
+        CHECK(file_size(path) == sizeof(database_header) + 2 * kEnrollSize);
+        CHECK(enroll(db, 5) == ESP_OK);
+        CHECK(ids(db).back() == 3);
+    }
+    // A record with a bad checksum ends the journal the same way.
+    data = read_file(path);
+    data[sizeof(database_header) + kEnrollSize + sizeof(database_record)] ^= 0x40;
+    write_file(path, data);
+    DataBase db(path.c_str(), kFeatLen);
+    CHECK(ids(db) == std::vector<uint16_t>({1}));
+}
+
+void test_unknown_version()
+{
+    std::string path = g_dir + "/version.db";
+    database_header header = {};
+    header.magic = DL_RECOGNITION_DB_MAGIC;
+    header.version = DL_RECOGNITION_DB_VERSION + 1;
+    header.feat_len = kFeatLen;
+    header.num_feats_total = 7;
+    header.crc = crc32(&header, offsetof(database_header, crc));
+    std::vector<uint8_t> data((uint8_t *)&header, (uint8_t *)(&header + 1));
+    data.resize(data.size() + kEnrollSize, 0x5a);
+    write_file(path, data);
+
+    DataBase db(path.c_str(), kFeatLen);
+    CHECK(db.get_num_feats() == 0);
+    CHECK(enroll(db, 1) == ESP_ERR_INVALID_STATE);
+    CHECK(db.compact() == ESP_ERR_INVALID_STATE);
+    CHECK(read_file(path) == data);
+
+    // Clearing is an explicit decision to drop the unknown journal.
+    CHECK(db.clear_all_feats() == ESP_OK);
+    CHECK(enroll(db, 1) == ESP_OK);
+    CHECK(file_size(path) == sizeof(database_header) + kEnrollSize);
+}
+
+void test_background_compaction()
+{
+    std::string path = g_dir + "/compact.db";
+    TracingStorage *storage = new TracingStorage(path.c_str());
+    DataBase db(storage, kFeatLen);
+    int initial_rewrites = storage->rewrites;
+    for (int i = 0; i < 20; i++) {
+        CHECK(enroll(db, i) == ESP_OK);
+    }
+    for (uint16_t id = 1; id <= 18; id++) {
+        CHECK(db.delete_feat(id) == ESP_OK);
+    }
+    db.wait_for_compaction();
+    CHECK(storage->rewrites > initial_rewrites);
+    CHECK(storage->rewrite_thread != std::this_thread::get_id());
+    CHECK(file_size(path) == sizeof(database_header) + 2 * kEnrollSize);
+    CHECK(ids(db) == std::vector<uint16_t>({19, 20}));
+
+    // Appends after the compaction land in the new journal.
+    CHECK(enroll(db, 30) == ESP_OK);
+    DataBase reopened((g_dir + "/compact.db").c_str(), kFeatLen);
+    CHECK(ids(reopened) == std::vector<uint16_t>({19, 20, 21}));
+}
+
+void test_partition_storage()
+{
+    const esp_partition_t *partition = esp_partition_host_create("face_db", 4 * 4096, 4096);
+    {
+        DataBase db(new PartitionStorage("face_db"), kFeatLen);
+        for (int i = 0; i < 4; i++) {
+            CHECK(enroll(db, i) == ESP_OK);
+        }
+        CHECK(db.delete_feat(1) == ESP_OK);
+    }
+    // Torn write: the first bytes of a record were programmed, the rest of it is still erased.
+    size_t slot_size = partition->size / 2;
+    int slot = -1;
+    for (int i = 0; i < 2; i++) {
+        if (partition->host_data[i * slot_size] != 0xff) {
+            slot = i;
+        }
+    }
+    CHECK(slot >= 0);
+    size_t tail = slot * slot_size + 8 + sizeof(database_header) + 4 * kEnrollSize + sizeof(database_record);
+    partition->host_data[tail] = 0x01;
+    partition->host_data[tail + 1] = 0x00;
+    {
+        DataBase db(new PartitionStorage("face_db"), kFeatLen);
+        CHECK(ids(db) == std::vector<uint16_t>({2, 3, 4}));
+        CHECK(enroll(db, 7) == ESP_OK);
+    }
+    DataBase db(new PartitionStorage("face_db"), kFeatLen);
+    CHECK(ids(db) == std::vector<uint16_t>({2, 3, 4, 5}));
+    esp_partition_host_reset();
+}
+
+} // namespace
+
+int main()
+{
+    char dir[] = "/tmp/face_db_XXXXXX";
+    CHECK(mkdtemp(dir) != nullptr);
+    g_dir = dir;
+
+    test_replay();
+    test_torn_tail();
+    test_unknown_version();
+    test_background_compaction();
+    test_partition_storage();
+
+    std::string cmd = "rm -rf " + g_dir;
+    CHECK(system(cmd.c_str()) == 0);
+    return HOST_TEST_RESULT();
+}
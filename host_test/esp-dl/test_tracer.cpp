@@ -0,0 +1,141 @@
+/**
+ * @file test_tracer.cpp
+ * @brief Tracer: power-of-two capacity, the buffer kept across enable() calls, ring buffer order and the export, span
+ *        names, and two threads recording while a third one enables, disables and clears.
+ */
+#include "dl_tool_trace.hpp"
+#include "host_test.h"
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace dl::tool;
+
+namespace {
+
+const char *const kNames[] = {"e0", "e1", "e2", "e3", "e4", "e5", "e6", "e7", "e8", "e9", "e10", "e11", "e12"};
+
+std::string export_to_string(Tracer &tracer)
+{
+    FILE *file = tmpfile();
+    CHECK(tracer.export_chrome_trace(file) == ESP_OK);
+    std::string json(ftell(file), '\0');
+    rewind(file);
+    CHECK(fread(&json[0], 1, json.size(), file) == json.size());
+    fclose(file);
+    return json;
+}
+
+void test_capacity()
+{
+    Tracer &tracer = Tracer::get_instance();
+    CHECK(tracer.enable(0) == ESP_ERR_INVALID_ARG);
+    CHECK(tracer.enable(1000) == ESP_ERR_INVALID_ARG);
+    CHECK(!tracer.is_enabled());
+    CHECK(tracer.enable(8) == ESP_OK);
+    // The buffer may be in use on the other core, it is never reallocated.
+    CHECK(tracer.enable(16) == ESP_ERR_INVALID_STATE);
+    CHECK(tracer.is_enabled());
+    tracer.disable();
+    CHECK(tracer.enable(16) == ESP_ERR_INVALID_STATE);
+    CHECK(tracer.enable(8) == ESP_OK);
+}
+
+void test_ring()
+{
+    Tracer &tracer = Tracer::get_instance();
+    tracer.clear();
+    for (int i = 0; i < 5; i++) {
+        tracer.record(kNames[i], "module", i, 0, 0, i);
+    }
+    CHECK(tracer.get_event_count() == 5);
+    CHECK(tracer.get_dropped_count() == 0);
+    for (int i = 5; i < 13; i++) {
+        tracer.record(kNames[i], "module", i, 0, 0, i);
+    }
+    CHECK(tracer.get_event_count() == 8);
+    CHECK(tracer.get_dropped_count() == 5);
+
+    // The 8 newest events, oldest first.
+    std::string json = export_to_string(tracer);
+    size_t pos = 0;
+    for (int i = 5; i < 13; i++) {
+        size_t next = json.find(std::string("\"name\":\"") + kNames[i] + "\"", pos);
+        CHECK(next != std::string::npos);
+        pos = next;
+    }
+    CHECK(json.find("\"e4\"") == std::string::npos);
+
+    tracer.disable();
+    tracer.record("off", "module", 0, 0);
+    CHECK(tracer.get_event_count() == 8);
+    tracer.clear();
+    CHECK(tracer.get_event_count() == 0);
+    CHECK(tracer.get_dropped_count() == 0);
+    CHECK(tracer.enable(8) == ESP_OK);
+}
+
+void test_names()
+{
+    Tracer &tracer = Tracer::get_instance();
+    std::string type = "Conv";
+    const char *conv = Tracer::intern(type);
+    type = "Relu";
+    CHECK(Tracer::intern("Conv") == conv);
+    CHECK(std::string(conv) == "Conv");
+    CHECK(Tracer::intern(type) != conv);
+
+    // A module without a name, built outside of Model, is named after its index.
+    tracer.clear();
+    tracer.record(conv, "module", 0, 0, 0, 2);
+    tracer.record(nullptr, "module", 1, 0, 0, 3);
+    std::string json = export_to_string(tracer);
+    CHECK(json.find("\"name\":\"Conv\"") != std::string::npos);
+    CHECK(json.find("\"name\":\"module_3\"") != std::string::npos);
+    tracer.clear();
+}
+
+void test_concurrent()
+{
+    Tracer &tracer = Tracer::get_instance();
+    std::atomic<bool> stop(false);
+    auto recorder = [&] {
+        while (!stop.load()) {
+            TraceScope scope("zone", "pipeline", 4);
+        }
+    };
+    std::thread a(recorder), b(recorder);
+    for (int i = 0; i < 2000; i++) {
+        tracer.disable();
+        if (i % 500 == 0) {
+            CHECK(tracer.enable(64) == ESP_ERR_INVALID_STATE);
+        }
+        CHECK(tracer.enable(8) == ESP_OK);
+        if (i % 5 == 0) {
+            tracer.clear();
+        }
+        std::this_thread::yield();
+    }
+    stop.store(true);
+    a.join();
+    b.join();
+    CHECK(tracer.get_event_count() <= 8);
+
+    tracer.disable();
+    tracer.clear();
+    std::string json = export_to_string(tracer);
+    CHECK(json.find("\"name\"") == std::string::npos);
+}
+
+} // namespace
+
+int main()
+{
+    test_capacity();
+    test_ring();
+    test_names();
+    test_concurrent();
+    return HOST_TEST_RESULT();
+}
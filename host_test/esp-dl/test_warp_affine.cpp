@@ -0,0 +1,232 @@
+/**
+ * @file test_warp_affine.cpp
+ * @brief warp_affine_fused against warp_affine_loop, the float per pixel path it replaced, over random similarity
+ *        transforms: nearest picks the same source pixel except where a coordinate falls on a rounding tie, bilinear
+ *        stays within 1 LSB. Transforms out of the fixed-point range fall back to warp_affine_loop.
+ */
+#include "dl_image_process.hpp"
+#include "host_test.h"
+
+#include <cmath>
+#include <random>
+
+using namespace dl::image;
+
+namespace {
+
+std::mt19937 g_rng(1);
+
+/// Distance from a source coordinate of warp_affine_loop to the nearest rounding tie, within which the fixed-point
+/// coordinates of warp_affine_fused may round the other way.
+const float kTieTolerance = 4e-3f;
+
+/**
+ * @brief Tables with a step of 1 per source value, so that an output difference in LSB is the difference of the
+ *        interpolated 8 bit values. The int16 channels are offset from each other to catch swapped channels.
+ */
+template <typename T>
+std::vector<T> make_step_lut()
+{
+    std::vector<T> lut(3 * 256);
+    for (int c = 0; c < 3; c++) {
+        for (int v = 0; v < 256; v++) {
+            lut[c * 256 + v] = (T)(sizeof(T) == 1 ? v - 128 : v - 128 + 1000 * c);
+        }
+    }
+    return lut;
+}
+
+/// Source image with a spare row, warp_affine_loop reads the pixel after the last one with a weight of 0.
+struct Source {
+    img_t img;
+    std::vector<uint8_t> data;
+
+    Source(pix_type_t type, uint16_t width, uint16_t height)
+    {
+        img = {nullptr, width, height, type};
+        size_t bytes = get_img_byte_size(img);
+        std::uniform_int_distribution<int> dist(0, 255);
+        data.resize(bytes + bytes / height + 4);
+        for (uint8_t &v : data) {
+            v = dist(g_rng);
+        }
+        img.data = data.data();
+    }
+};
+
+/// Inverse of a rotation and scaling around a random point, with some source coordinates out of the image.
+void random_transform(dl::math::Matrix<float> &M_inv, const img_t &src)
+{
+    std::uniform_real_distribution<float> angle(-M_PI, M_PI), scale(0.25f, 2.5f);
+    std::uniform_real_distribution<float> tx(-40.f, src.width + 40.f), ty(-40.f, src.height + 40.f);
+    float a = angle(g_rng), s = scale(g_rng);
+    M_inv.array[0][0] = s * cosf(a);
+    M_inv.array[0][1] = -s * sinf(a);
+    M_inv.array[0][2] = tx(g_rng);
+    M_inv.array[1][0] = s * sinf(a);
+    M_inv.array[1][1] = s * cosf(a);
+    M_inv.array[1][2] = ty(g_rng);
+}
+
+/// The clamped source coordinate of warp_affine_loop for an output pixel, with its float operations.
+float loop_coord(dl::math::Matrix<float> &M_inv, int k, int i, int j, int size)
+{
+    float coord = M_inv.array[k][0] * j + M_inv.array[k][1] * i + M_inv.array[k][2];
+    return std::max(std::min(coord, (float)(size - 1)), 0.f);
+}
+
+bool near_tie(float coord)
+{
+    return fabsf(coord - floorf(coord) - 0.5f) < kTieTolerance;
+}
+
+struct Stats {
+    long pixels = 0;
+    long nearest_ties = 0;
+    long bilinear_off = 0;
+};
+
+/**
+ * @brief Warps src with warp_affine_fused and warp_affine_loop and checks the outputs against each other.
+ */
+template <typename T>
+void compare(const Source &src,
+             pix_type_t dst_type,
+             uint16_t dst_width,
+             uint16_t dst_height,
+             interpolate_type_t interp,
+             uint32_t caps,
+             dl::math::Matrix<float> &M_inv,
+             Stats &stats)
+{
+    std::vector<T> lut = make_step_lut<T>();
+    img_t fused = {nullptr, dst_width, dst_height, dst_type};
+    img_t loop = fused;
+    size_t bytes = get_img_byte_size(fused);
+    std::vector<uint8_t> fused_data(bytes, 0xa5), loop_data(bytes, 0x5a);
+    fused.data = fused_data.data();
+    loop.data = loop_data.data();
+    CHECK(warp_affine_fused(src.img, fused, interp, &M_inv, caps, lut.data()));
+    warp_affine_loop<T>(src.img, loop, interp, &M_inv, caps, lut.data());
+
+    int channel = dst_type == DL_IMAGE_PIX_TYPE_GRAY_QINT8 || dst_type == DL_IMAGE_PIX_TYPE_GRAY_QINT16 ? 1 : 3;
+    const T *a = (const T *)fused_data.data();
+    const T *b = (const T *)loop_data.data();
+    for (int i = 0; i < dst_height; i++) {
+        for (int j = 0; j < dst_width; j++, a += channel, b += channel) {
+            bool same = true;
+            int max_diff = 0;
+            for (int c = 0; c < channel; c++) {
+                same &= a[c] == b[c];
+                max_diff = std::max(max_diff, std::abs((int)a[c] - (int)b[c]));
+            }
+            stats.pixels++;
+            if (same) {
+                continue;
+            }
+            if (interp == DL_IMAGE_INTERPOLATE_NEAREST) {
+                bool tie = near_tie(loop_coord(M_inv, 0, i, j, src.img.width)) ||
+                    near_tie(loop_coord(M_inv, 1, i, j, src.img.height));
+                CHECK(tie);
+                stats.nearest_ties++;
+            } else {
+                CHECK(max_diff <= 1);
+                stats.bilinear_off++;
+            }
+        }
+    }
+}
+
+void test_against_loop()
+{
+    const pix_type_t src_types[] = {DL_IMAGE_PIX_TYPE_RGB888, DL_IMAGE_PIX_TYPE_RGB565, DL_IMAGE_PIX_TYPE_GRAY};
+    const uint32_t caps_list[] = {0,
+                                  DL_IMAGE_CAP_RGB_SWAP,
+                                  DL_IMAGE_CAP_RGB565_BIG_ENDIAN,
+                                  DL_IMAGE_CAP_RGB_SWAP | DL_IMAGE_CAP_RGB565_BYTE_SWAP};
+    const uint16_t dst_sizes[][2] = {{112, 112}, {37, 53}};
+    Stats nearest, bilinear;
+    dl::math::Matrix<float> M_inv(2, 3);
+    for (pix_type_t src_type : src_types) {
+        Source src(src_type, 160, 120);
+        bool gray = src_type == DL_IMAGE_PIX_TYPE_GRAY;
+        for (uint32_t caps : caps_list) {
+            for (int t = 0; t < 12; t++) {
+                if (t == 0) {
+                    // half pixel steps, every other coordinate is an exact tie
+                    M_inv.array[0][0] = M_inv.array[1][1] = 0.5f;
+                    M_inv.array[0][1] = M_inv.array[1][0] = 0.f;
+                    M_inv.array[0][2] = M_inv.array[1][2] = 3.f;
+                } else {
+                    random_transform(M_inv, src.img);
+                }
+                auto &size = dst_sizes[t % 2];
+                for (interpolate_type_t interp : {DL_IMAGE_INTERPOLATE_NEAREST, DL_IMAGE_INTERPOLATE_BILINEAR}) {
+                    Stats &stats = interp == DL_IMAGE_INTERPOLATE_NEAREST ? nearest : bilinear;
+                    compare<int8_t>(src,
+                                    gray ? DL_IMAGE_PIX_TYPE_GRAY_QINT8 : DL_IMAGE_PIX_TYPE_RGB888_QINT8,
+                                    size[0],
+                                    size[1],
+                                    interp,
+                                    caps,
+                                    M_inv,
+                                    stats);
+                    compare<int16_t>(src,
+                                     gray ? DL_IMAGE_PIX_TYPE_GRAY_QINT16 : DL_IMAGE_PIX_TYPE_RGB888_QINT16,
+                                     size[0],
+                                     size[1],
+                                     interp,
+                                     caps,
+                                     M_inv,
+                                     stats);
+                }
+            }
+        }
+    }
+    printf("nearest: %ld pixels, %.3f%% differ on rounding ties\n",
+           nearest.pixels,
+           100.0 * nearest.nearest_ties / nearest.pixels);
+    printf("bilinear: %ld pixels, %.3f%% differ by 1 LSB\n",
+           bilinear.pixels,
+           100.0 * bilinear.bilinear_off / bilinear.pixels);
+    CHECK(nearest.pixels > 0 && bilinear.pixels > 0);
+}
+
+void test_fixed_point_overflow()
+{
+    Source src(DL_IMAGE_PIX_TYPE_RGB888, 64, 48);
+    std::vector<int8_t> lut = make_step_lut<int8_t>();
+    dl::math::Matrix<float> M_inv(2, 3);
+    size_t bytes = 32 * 32 * 3;
+    std::vector<uint8_t> warp_data(bytes, 0xa5), loop_data(bytes, 0x5a);
+    img_t warp = {warp_data.data(), 32, 32, DL_IMAGE_PIX_TYPE_RGB888_QINT8};
+    img_t loop = {loop_data.data(), 32, 32, DL_IMAGE_PIX_TYPE_RGB888_QINT8};
+
+    // A translation and a scale whose far corner are out of the Q16 range of the fused path.
+    for (int k = 0; k < 2; k++) {
+        M_inv.array[0][0] = M_inv.array[1][1] = k ? 600.f : 1.f;
+        M_inv.array[0][1] = M_inv.array[1][0] = 0.f;
+        M_inv.array[0][2] = k ? 0.f : 20000.f;
+        M_inv.array[1][2] = 5.f;
+        for (interpolate_type_t interp : {DL_IMAGE_INTERPOLATE_NEAREST, DL_IMAGE_INTERPOLATE_BILINEAR}) {
+            CHECK(!warp_affine_fused(src.img, warp, interp, &M_inv, 0, lut.data()));
+            warp_affine(src.img, warp, interp, &M_inv, 0, lut.data());
+            warp_affine_loop<int8_t>(src.img, loop, interp, &M_inv, 0, lut.data());
+            CHECK(warp_data == loop_data);
+        }
+    }
+
+    // Just inside the range the fused path is taken.
+    M_inv.array[0][0] = M_inv.array[1][1] = 1.f;
+    M_inv.array[0][2] = 16000.f;
+    CHECK(warp_affine_fused(src.img, warp, DL_IMAGE_INTERPOLATE_NEAREST, &M_inv, 0, lut.data()));
+}
+
+} // namespace
+
+int main()
+{
+    test_against_loop();
+    test_fixed_point_overflow();
+    return HOST_TEST_RESULT();
+}
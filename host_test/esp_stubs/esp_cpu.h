@@ -0,0 +1,16 @@
+#pragma once
+#include <stdint.h>
+#include <time.h>
+
+/// Nanoseconds stand in for CPU cycles on the host.
+static inline uint32_t esp_cpu_get_cycle_count(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec);
+}
+
+static inline int esp_cpu_get_core_id(void)
+{
+    return 0;
+}
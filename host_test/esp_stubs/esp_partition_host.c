@@ -0,0 +1,103 @@
+/**
+ * @file esp_partition_host.c
+ * @brief RAM backed data partitions with NOR flash write and erase semantics.
+ */
+#include "esp_partition.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define HOST_PARTITION_MAX 4
+
+static esp_partition_t s_partitions[HOST_PARTITION_MAX];
+static int s_num_partitions;
+
+const esp_partition_t *esp_partition_host_create(const char *label, uint32_t size, uint32_t erase_size)
+{
+    if (s_num_partitions == HOST_PARTITION_MAX) {
+        return NULL;
+    }
+    esp_partition_t *partition = &s_partitions[s_num_partitions++];
+    memset(partition, 0, sizeof(*partition));
+    partition->type = ESP_PARTITION_TYPE_DATA;
+    partition->size = size;
+    partition->erase_size = erase_size;
+    strncpy(partition->label, label, sizeof(partition->label) - 1);
+    partition->host_data = (uint8_t *)malloc(size);
+    memset(partition->host_data, 0xff, size);
+    return partition;
+}
+
+void esp_partition_host_reset(void)
+{
+    for (int i = 0; i < s_num_partitions; i++) {
+        free(s_partitions[i].host_data);
+    }
+    s_num_partitions = 0;
+}
+
+const esp_partition_t *esp_partition_find_first(esp_partition_type_t type,
+                                                esp_partition_subtype_t subtype,
+                                                const char *label)
+{
+    for (int i = 0; i < s_num_partitions; i++) {
+        if (s_partitions[i].type == type && (!label || strcmp(s_partitions[i].label, label) == 0)) {
+            return &s_partitions[i];
+        }
+    }
+    return NULL;
+}
+
+static int out_of_range(const esp_partition_t *partition, size_t offset, size_t size)
+{
+    return offset > partition->size || size > partition->size - offset;
+}
+
+esp_err_t esp_partition_read(const esp_partition_t *partition, size_t src_offset, void *dst, size_t size)
+{
+    if (out_of_range(partition, src_offset, size)) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    memcpy(dst, partition->host_data + src_offset, size);
+    return ESP_OK;
+}
+
+esp_err_t esp_partition_write(const esp_partition_t *partition, size_t dst_offset, const void *src, size_t size)
+{
+    if (out_of_range(partition, dst_offset, size)) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    const uint8_t *in = (const uint8_t *)src;
+    for (size_t i = 0; i < size; i++) {
+        partition->host_data[dst_offset + i] &= in[i];
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_partition_erase_range(const esp_partition_t *partition, size_t offset, size_t size)
+{
+    if (out_of_range(partition, offset, size) || offset % partition->erase_size || size % partition->erase_size) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    memset(partition->host_data + offset, 0xff, size);
+    return ESP_OK;
+}
+
+esp_err_t esp_partition_mmap(const esp_partition_t *partition,
+                             size_t offset,
+                             size_t size,
+                             esp_partition_mmap_memory_t memory,
+                             const void **out_ptr,
+                             esp_partition_mmap_handle_t *out_handle)
+{
+    if (out_of_range(partition, offset, size)) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    *out_ptr = partition->host_data + offset;
+    *out_handle = 1;
+    return ESP_OK;
+}
+
+void esp_partition_munmap(esp_partition_mmap_handle_t handle)
+{
+    (void)handle;
+}
@@ -0,0 +1,30 @@
+#pragma once
+#include <limits.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+
+#define pdTRUE 1
+#define pdFALSE 0
+#define pdPASS pdTRUE
+#define pdFAIL pdFALSE
+#define portMAX_DELAY ((TickType_t)0xffffffffUL)
+#define portTICK_PERIOD_MS 1
+#define portNUM_PROCESSORS 2
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+#define tskIDLE_PRIORITY 0
+#define tskNO_AFFINITY 0x7fffffff
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// The host thread calling it is core 0, tasks created with an affinity report that core.
+BaseType_t xPortGetCoreID(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,32 @@
+#pragma once
+#include "freertos/FreeRTOS.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct host_task *TaskHandle_t;
+typedef void (*TaskFunction_t)(void *);
+
+/// Tasks are host threads. Priorities are recorded but not enforced.
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn,
+                                   const char *name,
+                                   uint32_t stack_depth,
+                                   void *arg,
+                                   UBaseType_t priority,
+                                   TaskHandle_t *handle,
+                                   BaseType_t core_id);
+BaseType_t xTaskCreate(
+    TaskFunction_t fn, const char *name, uint32_t stack_depth, void *arg, UBaseType_t priority, TaskHandle_t *handle);
+/// Only vTaskDelete(NULL) is supported: it ends the calling task's thread.
+void vTaskDelete(TaskHandle_t task);
+void vTaskDelay(TickType_t ticks);
+UBaseType_t uxTaskPriorityGet(TaskHandle_t task);
+void vTaskPrioritySet(TaskHandle_t task, UBaseType_t priority);
+TaskHandle_t xTaskGetCurrentTaskHandle(void);
+BaseType_t xTaskNotifyGive(TaskHandle_t task);
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,208 @@
+/**
+ * @file freertos_host.cpp
+ * @brief FreeRTOS tasks, notifications and semaphores on top of host threads.
+ */
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <pthread.h>
+#include <thread>
+
+struct host_task {
+    std::mutex mutex;
+    std::condition_variable cond;
+    uint32_t notify = 0;
+    UBaseType_t priority = 0;
+    BaseType_t core_id = 0;
+};
+
+struct host_semaphore {
+    std::mutex mutex;
+    std::condition_variable cond;
+    uint32_t count = 0;
+    host_task *owner = nullptr; // Recursive mutexes only
+    uint32_t depth = 0;
+};
+
+static thread_local host_task *s_current = nullptr;
+
+static host_task *current_task()
+{
+    if (!s_current) {
+        // Threads not created by xTaskCreate, e.g. main(), get a task record on first use.
+        s_current = new host_task();
+    }
+    return s_current;
+}
+
+template <typename Pred>
+static bool wait_for(std::unique_lock<std::mutex> &lock, std::condition_variable &cond, TickType_t ticks, Pred pred)
+{
+    if (ticks == portMAX_DELAY) {
+        cond.wait(lock, pred);
+        return true;
+    }
+    return cond.wait_for(lock, std::chrono::milliseconds(ticks), pred);
+}
+
+extern "C" {
+
+BaseType_t xPortGetCoreID(void)
+{
+    return current_task()->core_id;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn,
+                                   const char *name,
+                                   uint32_t stack_depth,
+                                   void *arg,
+                                   UBaseType_t priority,
+                                   TaskHandle_t *handle,
+                                   BaseType_t core_id)
+{
+    host_task *task = new host_task();
+    task->priority = priority;
+    task->core_id = core_id == tskNO_AFFINITY ? 0 : core_id;
+    if (handle) {
+        *handle = task;
+    }
+    std::thread([fn, arg, task] {
+        s_current = task;
+        fn(arg);
+    }).detach();
+    return pdPASS;
+}
+
+BaseType_t xTaskCreate(
+    TaskFunction_t fn, const char *name, uint32_t stack_depth, void *arg, UBaseType_t priority, TaskHandle_t *handle)
+{
+    return xTaskCreatePinnedToCore(fn, name, stack_depth, arg, priority, handle, tskNO_AFFINITY);
+}
+
+void vTaskDelete(TaskHandle_t task)
+{
+    if (task == NULL || task == s_current) {
+        pthread_exit(NULL);
+    }
+}
+
+void vTaskDelay(TickType_t ticks)
+{
+    std::this_thread::sleep_for(std::chrono::milliseconds(ticks));
+}
+
+UBaseType_t uxTaskPriorityGet(TaskHandle_t task)
+{
+    return (task ? task : current_task())->priority;
+}
+
+void vTaskPrioritySet(TaskHandle_t task, UBaseType_t priority)
+{
+    (task ? task : current_task())->priority = priority;
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void)
+{
+    return current_task();
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task)
+{
+    {
+        std::lock_guard<std::mutex> lock(task->mutex);
+        task->notify++;
+    }
+    task->cond.notify_all();
+    return pdPASS;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks)
+{
+    host_task *task = current_task();
+    std::unique_lock<std::mutex> lock(task->mutex);
+    wait_for(lock, task->cond, ticks, [task] { return task->notify > 0; });
+    uint32_t value = task->notify;
+    if (value) {
+        task->notify = clear_on_exit ? 0 : value - 1;
+    }
+    return value;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void)
+{
+    host_semaphore *sem = new host_semaphore();
+    sem->count = 1;
+    return sem;
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void)
+{
+    return new host_semaphore();
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks)
+{
+    std::unique_lock<std::mutex> lock(sem->mutex);
+    if (!wait_for(lock, sem->cond, ticks, [sem] { return sem->count > 0; })) {
+        return pdFALSE;
+    }
+    sem->count--;
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem)
+{
+    {
+        std::lock_guard<std::mutex> lock(sem->mutex);
+        if (sem->count) {
+            return pdFALSE;
+        }
+        sem->count = 1;
+    }
+    sem->cond.notify_one();
+    return pdTRUE;
+}
+
+SemaphoreHandle_t xSemaphoreCreateRecursiveMutex(void)
+{
+    return new host_semaphore();
+}
+
+BaseType_t xSemaphoreTakeRecursive(SemaphoreHandle_t sem, TickType_t ticks)
+{
+    host_task *task = current_task();
+    std::unique_lock<std::mutex> lock(sem->mutex);
+    if (sem->owner != task && !wait_for(lock, sem->cond, ticks, [sem] { return sem->owner == nullptr; })) {
+        return pdFALSE;
+    }
+    sem->owner = task;
+    sem->depth++;
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGiveRecursive(SemaphoreHandle_t sem)
+{
+    {
+        std::lock_guard<std::mutex> lock(sem->mutex);
+        if (sem->owner != current_task()) {
+            return pdFALSE;
+        }
+        if (--sem->depth) {
+            return pdTRUE;
+        }
+        sem->owner = nullptr;
+    }
+    sem->cond.notify_one();
+    return pdTRUE;
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t sem)
+{
+    delete sem;
+}
+
+} // extern "C"
@@ -0,0 +1,4 @@
+#pragma once
+// Host build: no target, no PSRAM, no SIMD extensions. The portable C paths are used.
+#define CONFIG_IDF_TARGET_LINUX 1
+#define CONFIG_LOG_MAXIMUM_LEVEL 3
@@ -0,0 +1,181 @@
+/**
+ * @file test_face_pipeline.cpp
+ * @brief Host harness of the face pipeline: frame ownership, drop-oldest queues, verdict
+ *        rate limiting and the throughput of the staged pipeline against a serial loop.
+ * @details The camera and the models are replaced by stages that sleep for a fixed time,
+ *          the same way the FreeRTOS tasks block on the camera DMA and the model runs.
+ */
+#include "face_pipeline.hpp"
+#include "host_test.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+namespace {
+
+const size_t kDepth = 1;
+const int kCaptureUs = 2000;
+const int kDetectUs = 8000;
+const int kRecognizeUs = 6000;
+
+struct fake_frame_t {
+    int buffer = -1; // Camera buffer held by the frame, -1 if none.
+    int64_t t_capture_us = 0;
+};
+
+/// Stands in for the camera driver: counts the buffers handed out and not returned yet.
+struct FakeCamera {
+    std::atomic<int> outstanding{0};
+    std::atomic<int> max_outstanding{0};
+    std::atomic<int> next{0};
+
+    bool get(fake_frame_t &frame)
+    {
+        std::this_thread::sleep_for(std::chrono::microseconds(kCaptureUs));
+        int held = ++outstanding;
+        int seen = max_outstanding.load();
+        while (held > seen && !max_outstanding.compare_exchange_weak(seen, held)) {
+        }
+        frame.buffer = next++;
+        return true;
+    }
+
+    void release(fake_frame_t &frame)
+    {
+        if (frame.buffer >= 0) {
+            outstanding--;
+            frame.buffer = -1;
+        }
+    }
+};
+
+void busy(int us)
+{
+    std::this_thread::sleep_for(std::chrono::microseconds(us));
+}
+
+void test_drop_oldest_queue()
+{
+    facerec::DropOldestQueue<int, 2> queue;
+    int evicted = 0;
+    CHECK(!queue.push(1, evicted));
+    CHECK(!queue.push(2, evicted));
+    CHECK(queue.push(3, evicted));
+    CHECK(evicted == 1);
+
+    int out = 0;
+    CHECK(queue.try_pop(out) && out == 2);
+    CHECK(queue.try_pop(out) && out == 3);
+    CHECK(!queue.try_pop(out));
+
+    queue.close();
+    CHECK(!queue.pop(out, std::chrono::milliseconds(1000)));
+}
+
+void test_verdict_limiter()
+{
+    facerec::VerdictLimiter limiter(1000000);
+    CHECK(limiter.should_send(1, 0));
+    CHECK(!limiter.should_send(1, 500000));  // Same verdict within the period.
+    CHECK(limiter.should_send(2, 600000));   // A change goes through at once.
+    CHECK(limiter.should_send(1, 700000));
+    CHECK(!limiter.should_send(1, 1699999));
+    CHECK(limiter.should_send(1, 1700000));  // Repeated once the period is over.
+}
+
+/**
+ * @brief Runs the pipeline for a while and returns the frames per second out of the last stage.
+ */
+double run_pipeline(FakeCamera &camera, int &verdicts, uint32_t &frames, int64_t duration_us)
+{
+    facerec::VerdictLimiter limiter(100000);
+    std::atomic<int> sent{0};
+    facerec::FacePipeline<fake_frame_t, kDepth> pipeline(
+        [&](fake_frame_t &frame) { return camera.get(frame); },
+        [&](fake_frame_t &frame) {
+            busy(kDetectUs);
+            // Runs of frames without a face, the verdict must not follow the frame rate.
+            if ((frame.buffer / 20) % 2) {
+                if (limiter.should_send(0, facerec::now_us())) {
+                    sent++;
+                }
+                return false;
+            }
+            return true;
+        },
+        [&](fake_frame_t &frame) {
+            busy(kRecognizeUs);
+            if (limiter.should_send(1, facerec::now_us())) {
+                sent++;
+            }
+            return true;
+        },
+        [&](fake_frame_t &frame) { camera.release(frame); });
+
+    std::thread capture([&] { pipeline.run_capture_stage(); });
+    std::thread detect([&] { pipeline.run_detect_stage(); });
+    std::thread recognize([&] { pipeline.run_recognize_stage(); });
+
+    std::this_thread::sleep_for(std::chrono::microseconds(duration_us));
+    facerec::StageStats detected = pipeline.get_stage_stats(decltype(pipeline)::STAGE_DETECT);
+    pipeline.stop();
+    capture.join();
+    detect.join();
+    recognize.join();
+
+    facerec::StageStats e2e = pipeline.get_end_to_end_stats();
+    facerec::StageStats dropped = pipeline.get_stage_stats(decltype(pipeline)::STAGE_DETECT);
+    printf("pipelined: detected %u frames, %u dropped before detection, end-to-end avg %u us, max %u us\n",
+           (unsigned)detected.frames, (unsigned)dropped.dropped, (unsigned)e2e.avg_us(), (unsigned)e2e.max_us);
+    verdicts = sent.load();
+    frames = detected.frames;
+    return detected.frames * 1e6 / duration_us;
+}
+
+double run_serial(int64_t duration_us)
+{
+    int frames = 0;
+    int64_t start = facerec::now_us();
+    while (facerec::now_us() - start < duration_us) {
+        busy(kCaptureUs);
+        busy(kDetectUs);
+        if ((frames / 20) % 2 == 0) {
+            busy(kRecognizeUs);
+        }
+        frames++;
+    }
+    return frames * 1e6 / duration_us;
+}
+
+void test_pipeline_throughput()
+{
+    const int64_t duration_us = 1000000;
+    FakeCamera camera;
+    int verdicts = 0;
+    uint32_t frames = 0;
+    double pipelined_fps = run_pipeline(camera, verdicts, frames, duration_us);
+    double serial_fps = run_serial(duration_us);
+    printf("serial: %.1f fps, pipelined: %.1f fps (%.2fx), %d verdicts sent, at most %d buffers held\n", serial_fps,
+           pipelined_fps, pipelined_fps / serial_fps, verdicts, camera.max_outstanding.load());
+
+    // Every frame handed out by the camera came back, and never more than the pipeline can hold,
+    // see FACE_CAMERA_FB_COUNT.
+    CHECK(camera.outstanding.load() == 0);
+    CHECK(camera.max_outstanding.load() <= (int)(2 * kDepth + 3));
+    // Detection is the bottleneck, so the pipeline runs at its rate instead of the sum of the stages.
+    CHECK(pipelined_fps > serial_fps * 1.2);
+    // Verdicts go out on each change and then once per period, not on every frame.
+    CHECK(verdicts > 0);
+    CHECK(verdicts < (int)frames / 2);
+}
+
+} // namespace
+
+int main()
+{
+    test_drop_oldest_queue();
+    test_verdict_limiter();
+    test_pipeline_throughput();
+    return HOST_TEST_RESULT();
+}
@@ -0,0 +1,269 @@
+/**
+ * @file test_link_protocol.c
+ * @brief Round trip, corruption detection and fuzzing of the UART link protocol, and its
+ *        encode and decode throughput.
+ */
+#include "host_test.h"
+#include "link_protocol.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+/// xorshift32, the test must not depend on the libc rand() sequence.
+static uint32_t s_rng = 0x12345678;
+
+static uint32_t rng_next(void)
+{
+    s_rng ^= s_rng << 13;
+    s_rng ^= s_rng >> 17;
+    s_rng ^= s_rng << 5;
+    return s_rng;
+}
+
+static double now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/// Feeds a buffer and returns the number of valid frames, the last one is left in dec->frame.
+static int feed(link_decoder_t *dec, const uint8_t *data, size_t len)
+{
+    int frames = 0;
+    for (size_t i = 0; i < len; i++) {
+        if (link_decoder_feed(dec, data[i]) == LINK_DEC_FRAME) {
+            frames++;
+        }
+    }
+    return frames;
+}
+
+static void test_round_trip(void)
+{
+    uint8_t payload[LINK_MAX_PAYLOAD];
+    uint8_t buf[LINK_MAX_FRAME];
+    link_decoder_t dec;
+    link_decoder_init(&dec);
+    uint8_t seq = 0;
+    for (int len = 0; len <= LINK_MAX_PAYLOAD; len++) {
+        for (int i = 0; i < len; i++) {
+            payload[i] = (uint8_t)rng_next();
+        }
+        seq = link_next_seq(seq);
+        size_t n = link_encode(buf, sizeof(buf), seq, LINK_OP_TEXT, payload, (uint8_t)len);
+        CHECK(n == (size_t)(LINK_HEADER_SIZE + len + LINK_CRC_SIZE));
+        CHECK(feed(&dec, buf, n) == 1);
+        CHECK(dec.frame.seq == seq && dec.frame.op == LINK_OP_TEXT && dec.frame.len == len);
+        CHECK(memcmp(dec.frame.payload, payload, len) == 0);
+    }
+    CHECK(link_encode(buf, sizeof(buf), 1, LINK_OP_TEXT, payload, LINK_MAX_PAYLOAD + 1) == 0);
+    CHECK(link_encode(buf, LINK_MAX_FRAME - 1, 1, LINK_OP_TEXT, payload, LINK_MAX_PAYLOAD) == 0);
+
+    // Sequence numbers wrap around without ever using 0.
+    CHECK(link_next_seq(255) == 1);
+    CHECK(link_next_seq(0) == 1);
+
+    // A session start frame carries no payload.
+    size_t n = link_encode(buf, sizeof(buf), 7, LINK_OP_SYNC, NULL, 0);
+    CHECK(feed(&dec, buf, n) == 1 && dec.frame.op == LINK_OP_SYNC && dec.frame.seq == 7 && dec.frame.len == 0);
+}
+
+static void test_resync_after_noise(void)
+{
+    uint8_t buf[LINK_MAX_FRAME];
+    uint8_t payload[2] = {0x34, 0x12};
+    size_t n = link_encode(buf, sizeof(buf), 9, LINK_OP_FACE_ENROLLED, payload, sizeof(payload));
+    // Noise with stray sync bytes in front of the frame. A false sync with a small LEN swallows at most
+    // a few bytes of the real frame, so the frame is repeated the way the sender retransmits it.
+    const uint8_t noise[] = {0x00, 0xA5, 0x13, 0xA5, 0xA5, 0x5A, 0xFF, 0x5A, 0xA5};
+    link_decoder_t dec;
+    link_decoder_init(&dec);
+    int frames = feed(&dec, noise, sizeof(noise));
+    for (int i = 0; i < LINK_MAX_RETRIES + 1 && frames == 0; i++) {
+        frames = feed(&dec, buf, n);
+    }
+    CHECK(frames == 1);
+    CHECK(dec.frame.seq == 9 && dec.frame.len == 2 && dec.frame.payload[0] == 0x34);
+    CHECK(dec.junk_bytes > 0);
+}
+
+/**
+ * @brief Every single bit error and every burst of up to 16 bits must be caught by the CRC.
+ */
+static void test_corruption_detected(void)
+{
+    uint8_t buf[LINK_MAX_FRAME];
+    uint8_t bad[LINK_MAX_FRAME + LINK_MAX_FRAME];
+    uint8_t payload[LINK_MAX_PAYLOAD];
+    for (int i = 0; i < (int)sizeof(payload); i++) {
+        payload[i] = (uint8_t)rng_next();
+    }
+    size_t n = link_encode(buf, sizeof(buf), 42, LINK_OP_TEXT, payload, 24);
+    int accepted = 0;
+    for (size_t bit = 0; bit < n * 8; bit++) {
+        for (uint32_t burst = 1; burst < (1u << 16); burst = burst * 3 + 1) {
+            memcpy(bad, buf, n);
+            for (int b = 0; b < 16; b++) {
+                if ((burst >> b) & 1 && bit + b < n * 8) {
+                    bad[(bit + b) / 8] ^= (uint8_t)(1 << ((bit + b) % 8));
+                }
+            }
+            if (memcmp(bad, buf, n) == 0) {
+                continue; // The burst lies past the end of the frame.
+            }
+            // Zero padding completes a frame whose LEN got larger.
+            memset(bad + n, 0, sizeof(bad) - n);
+            link_decoder_t dec;
+            link_decoder_init(&dec);
+            accepted += feed(&dec, bad, sizeof(bad));
+        }
+    }
+    CHECK(accepted == 0);
+}
+
+static void test_batch(void)
+{
+    link_batch_t batch;
+    link_batch_init(&batch);
+    uint8_t data[LINK_MAX_CMD_DATA] = {0};
+    int added = 0;
+    while (link_batch_add(&batch, LINK_OP_TEXT, data, 5)) {
+        added++;
+    }
+    // Records of 2 + 5 bytes until the 64 byte payload is full, a failed add leaves the batch unchanged.
+    CHECK(added == LINK_MAX_PAYLOAD / 7 && batch.count == added && batch.len == added * 7);
+    CHECK(!link_batch_add(&batch, LINK_OP_LED2_ON, NULL, 0));
+    CHECK(batch.count == added && batch.len == added * 7);
+
+    link_frame_t frame = {1, LINK_OP_BATCH, batch.len, {0}};
+    memcpy(frame.payload, batch.payload, batch.len);
+    CHECK(link_frame_is_well_formed(&frame));
+    uint8_t offset = 0;
+    link_cmd_t cmd;
+    int cmds = 0;
+    while (link_frame_next_cmd(&frame, &offset, &cmd)) {
+        cmds++;
+    }
+    CHECK(cmds == batch.count);
+
+    // A record running past LEN is malformed and yields nothing past the payload.
+    frame.len = 8;
+    CHECK(!link_frame_is_well_formed(&frame));
+    offset = 0;
+    while (link_frame_next_cmd(&frame, &offset, &cmd)) {
+        CHECK(cmd.data + cmd.len <= frame.payload + frame.len);
+    }
+}
+
+/**
+ * @brief Random bytes and random mutations of valid frames: no crash, no read outside a frame, and
+ *        every command handed out by a decoded frame lies inside its payload.
+ */
+static void test_fuzz(void)
+{
+    enum { ROUNDS = 200000 };
+    link_decoder_t dec;
+    link_decoder_init(&dec);
+    uint8_t buf[LINK_MAX_FRAME];
+    uint8_t payload[LINK_MAX_PAYLOAD];
+    uint32_t frames = 0;
+    for (int round = 0; round < ROUNDS; round++) {
+        uint8_t len = (uint8_t)(rng_next() % (LINK_MAX_PAYLOAD + 1));
+        for (int i = 0; i < len; i++) {
+            payload[i] = (uint8_t)rng_next();
+        }
+        size_t n = link_encode(buf, sizeof(buf), (uint8_t)rng_next(), rng_next() & 1 ? LINK_OP_BATCH : (uint8_t)rng_next(),
+                               payload, len);
+        switch (rng_next() % 4) {
+        case 0: // Pure noise.
+            for (size_t i = 0; i < n; i++) {
+                buf[i] = (uint8_t)rng_next();
+            }
+            break;
+        case 1: // A few flipped bytes.
+            for (int i = 0; i < 3; i++) {
+                buf[rng_next() % n] ^= (uint8_t)rng_next();
+            }
+            break;
+        case 2: // Truncated.
+            n = rng_next() % n;
+            break;
+        default:
+            break;
+        }
+        for (size_t i = 0; i < n; i++) {
+            if (link_decoder_feed(&dec, buf[i]) != LINK_DEC_FRAME) {
+                continue;
+            }
+            frames++;
+            CHECK(dec.frame.len <= LINK_MAX_PAYLOAD);
+            bool well_formed = link_frame_is_well_formed(&dec.frame);
+            uint8_t offset = 0;
+            link_cmd_t cmd;
+            int covered = 0;
+            while (link_frame_next_cmd(&dec.frame, &offset, &cmd)) {
+                CHECK(cmd.data >= dec.frame.payload);
+                CHECK(cmd.data + cmd.len <= dec.frame.payload + dec.frame.len);
+                covered = offset;
+            }
+            CHECK(!well_formed || dec.frame.op != LINK_OP_BATCH || covered == dec.frame.len);
+        }
+        char text[LINK_MAX_CMD_DATA];
+        for (int i = 0; i < (int)sizeof(text); i++) {
+            text[i] = (char)rng_next();
+        }
+        link_opcode_from_text(text, rng_next() % sizeof(text));
+    }
+    printf("fuzz: %d rounds, %u frames decoded, %u crc errors, %u length errors, %u junk bytes\n", ROUNDS,
+           (unsigned)frames, (unsigned)dec.crc_errors, (unsigned)dec.len_errors, (unsigned)dec.junk_bytes);
+    CHECK(frames > 0);
+}
+
+static void bench_throughput(void)
+{
+    enum { FRAMES = 200000 };
+    static uint8_t stream[FRAMES / 100 * LINK_MAX_FRAME];
+    uint8_t payload[LINK_MAX_PAYLOAD];
+    memset(payload, 0x5a, sizeof(payload));
+
+    double start = now_s();
+    size_t total = 0;
+    uint8_t seq = 0;
+    for (int i = 0; i < FRAMES; i++) {
+        seq = link_next_seq(seq);
+        total += link_encode(stream, LINK_MAX_FRAME, seq, LINK_OP_BATCH, payload, LINK_MAX_PAYLOAD);
+    }
+    double encode_s = now_s() - start;
+
+    size_t n = 0;
+    for (seq = 0; n + LINK_MAX_FRAME <= sizeof(stream);) {
+        seq = link_next_seq(seq);
+        n += link_encode(stream + n, LINK_MAX_FRAME, seq, LINK_OP_TEXT, payload, LINK_MAX_PAYLOAD);
+    }
+    link_decoder_t dec;
+    link_decoder_init(&dec);
+    int frames = 0;
+    start = now_s();
+    for (int i = 0; i < 100; i++) {
+        frames += feed(&dec, stream, n);
+    }
+    double decode_s = now_s() - start;
+    CHECK(frames == 100 * (int)(n / LINK_MAX_FRAME));
+    // Sanitizers are on for this target, so the figures are an upper bound of the cost.
+    printf("encode: %.2f MB/s, decode: %.2f MB/s (%.1f ns/byte), wire at %d baud: %.3f MB/s\n",
+           total / encode_s / 1e6, 100.0 * n / decode_s / 1e6, decode_s * 1e9 / (100.0 * n), LINK_BAUD_RATE,
+           LINK_BAUD_RATE / 10 / 1e6);
+}
+
+int main(void)
+{
+    test_round_trip();
+    test_resync_after_noise();
+    test_corruption_detected();
+    test_batch();
+    test_fuzz();
+    bench_throughput();
+    return HOST_TEST_RESULT();
+}
@@ -4,17 +4,21 @@
 // Include the new handlers
 #include "wifi_connect.h"
 #include "mqtt_handler.h"
+#include "uart_link.h"
 
 
 extern "C" void app_main(void)
 {
-    // 1. Connect to Wi-Fi
+    // 1. Open the UART link to the CH32, shared by all services below
+    ESP_ERROR_CHECK(uart_link_init());
+
+    // 2. Connect to Wi-Fi
     wifi_init_sta();
 
-    // 2. Start the MQTT client
+    // 3. Start the MQTT client
     app_mqtt_start();
 
-    // 3. Start existing services
+    // 4. Start existing services
     // Start face recognition service
     app_facerec_start();
 
@@ -1,49 +1,244 @@
+import os
 import socket
+import sqlite3
+import struct
+import sys
+import time
 
 # 配置服务器IP和端口
 LISTEN_IP = "192.168.1.100"  # 您电脑的IP地址 (CH32发送的目标IP)
 LISTEN_PORT = 2000           # CH32发送的目标端口 (必须与CH32代码中的 udp_desport 一致)
+DB_PATH = "telemetry.db"     # 遥测数据存储文件
 
-# 1. 创建UDP socket对象
-#    AF_INET 表示使用 IPv4 地址族
-#    SOCK_DGRAM 表示使用 UDP 协议
-sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
-
-# 2. 绑定IP地址和端口号
-#    服务器需要绑定到一个固定的IP和端口，以便客户端知道向哪里发送数据
-server_address = (LISTEN_IP, LISTEN_PORT)
-print(f"UDP server starting up on {LISTEN_IP} port {LISTEN_PORT}")
-try:
-    sock.bind(server_address)
-except socket.error as e:
-    print(f"Error binding to socket: {e}")
-    print("Please ensure no other application is using this IP/Port and you have permissions.")
-    exit()
-
-print("Waiting to receive messages...")
-
-try:
-    # 3. 循环接收数据
-    while True:
-        # recvfrom() 会阻塞程序执行，直到接收到数据
-        # 它返回两个值：data (接收到的字节数据) 和 address (发送方的IP和端口)
-        data, address = sock.recvfrom(4096)  # 4096是缓冲区大小，可以根据需要调整
-
-        print(f"\nReceived {len(data)} bytes from {address}")
-
-        # 尝试将接收到的字节数据解码为UTF-8字符串
-        # CH32发送的是格式化字符串，通常是UTF-8兼容的ASCII
-        try:
-            message = data.decode('utf-8')
-            print(f"Data: {message}")
-        except UnicodeDecodeError:
-            print(f"Could not decode data as UTF-8. Raw data (hex): {data.hex()}")
-
-except KeyboardInterrupt:
-    print("\nUDP server is shutting down (KeyboardInterrupt).")
-except Exception as e:
-    print(f"\nAn error occurred: {e}")
-finally:
-    # 4. 关闭socket
-    print("Closing socket.")
-    sock.close()
\ No newline at end of file
+# 遥测数据报格式, 与 CH32_Firmware/CH32Controller/User/telemetry.h 保持一致 (小端)
+TELEM_MAGIC = b"TM"
+TELEM_FLAG_EVENT = 0x01
+TELEM_HEADER = struct.Struct("<2sBBHBBII")   # MAGIC VER FLAGS SEQ COUNT REC_SIZE FIRST_SAMPLE BASE_MS
+TELEM_RECORD = struct.Struct("<HbBHBB")      # DT_MS TEMP HUMI LIGHT STATE DHT_AGE_S
+
+STATE_PIR = 0x01
+STATE_SMOKE = 0x02
+STATE_ALARM = 0x04
+STATE_DHT_VALID = 0x08
+
+# UDP控制通道, 与 CH32_Firmware/CH32Controller/User/ctrl_channel.h 保持一致
+CTRL_PORT = 1001             # CH32控制端口 (main.c 中的 CTRL_PORT)
+# 共享密钥没有默认值: 运行前在环境变量 CTRL_KEY 中以32位十六进制提供,
+# 与编译CH32固件时的 CTRL_KEY 相同
+CTRL_KEY_ENV = "CTRL_KEY"
+CTRL_KEY_SIZE = 16
+CTRL_DEFAULT_KEY = b"CH32-ctrl-key-01"  # 曾随源码发布的默认密钥, 固件拒绝使用
+CTRL_VERSION = 1
+CTRL_ACK_TIMEOUT_S = 0.2
+CTRL_RETRIES = 3
+CTRL_ACK_STATUS = {0: "OK", 1: "REPLAY"}
+# 操作码, 与 components/uart_link/protocol/link_protocol.h 中的 LINK_OP_* 相同
+CTRL_OPS = {"LED2ON": 0x10, "LED2OFF": 0x11, "UNLOCK": 0x12, "DENY": 0x13, "COLLECT": 0x14}
+
+
+def decode_telemetry(data):
+    """
+    解码一个遥测数据报.
+    返回 (header, samples), 不是遥测数据报时返回 None, 格式错误时抛出 ValueError.
+    header 为 dict, samples 为 (sample_seq, time_ms, temp, humi, light, state, dht_age_s) 元组列表.
+    """
+    if len(data) < TELEM_HEADER.size or data[:2] != TELEM_MAGIC:
+        return None
+    magic, version, flags, seq, count, rec_size, first_sample, base_ms = TELEM_HEADER.unpack_from(data)
+    if version < 1 or rec_size < TELEM_RECORD.size:
+        raise ValueError(f"unsupported telemetry version {version} / record size {rec_size}")
+    if len(data) < TELEM_HEADER.size + count * rec_size:
+        raise ValueError(f"truncated telemetry datagram: {len(data)} bytes for {count} records")
+
+    header = {"version": version, "flags": flags, "seq": seq, "count": count,
+              "first_sample": first_sample, "base_ms": base_ms}
+    samples = []
+    for i in range(count):
+        # 新版本只在记录末尾追加字段, 按 REC_SIZE 步进即可跳过
+        dt_ms, temp, humi, light, state, dht_age = TELEM_RECORD.unpack_from(data, TELEM_HEADER.size + i * rec_size)
+        samples.append(((first_sample + i) & 0xFFFFFFFF, (base_ms + dt_ms) & 0xFFFFFFFF,
+                        temp, humi, light, state, dht_age))
+    return header, samples
+
+
+def siphash24(key, data):
+    """SipHash-2-4, 返回64位整数."""
+    mask = 0xFFFFFFFFFFFFFFFF
+
+    def rotl(x, b):
+        return ((x << b) | (x >> (64 - b))) & mask
+
+    def sipround(v0, v1, v2, v3):
+        v0 = (v0 + v1) & mask; v1 = rotl(v1, 13) ^ v0; v0 = rotl(v0, 32)
+        v2 = (v2 + v3) & mask; v3 = rotl(v3, 16) ^ v2
+        v0 = (v0 + v3) & mask; v3 = rotl(v3, 21) ^ v0
+        v2 = (v2 + v1) & mask; v1 = rotl(v1, 17) ^ v2; v2 = rotl(v2, 32)
+        return v0, v1, v2, v3
+
+    k0, k1 = struct.unpack("<QQ", key)
+    v = [k0 ^ 0x736f6d6570736575, k1 ^ 0x646f72616e646f6d, k0 ^ 0x6c7967656e657261, k1 ^ 0x7465646279746573]
+    tail = len(data) & 7
+    blocks = [struct.unpack_from("<Q", data, i)[0] for i in range(0, len(data) - tail, 8)]
+    blocks.append(int.from_bytes(data[len(data) - tail:], "little") | ((len(data) & 0xFF) << 56))
+    for m in blocks:
+        v[3] ^= m
+        v = list(sipround(*sipround(*v)))
+        v[0] ^= m
+    v[2] ^= 0xFF
+    for _ in range(4):
+        v = list(sipround(*v))
+    return v[0] ^ v[1] ^ v[2] ^ v[3]
+
+
+def load_ctrl_key():
+    """从环境变量读取控制密钥, 未设置或为弱密钥时抛出 ValueError."""
+    text = os.environ.get(CTRL_KEY_ENV)
+    if not text:
+        raise ValueError(f"{CTRL_KEY_ENV} is not set (32 hex digits, same key as the CH32 firmware)")
+    key = bytes.fromhex(text)
+    if len(key) != CTRL_KEY_SIZE:
+        raise ValueError(f"{CTRL_KEY_ENV} must be {CTRL_KEY_SIZE} bytes, got {len(key)}")
+    if key == CTRL_DEFAULT_KEY or len(set(key)) == 1:
+        raise ValueError(f"{CTRL_KEY_ENV} is a default or weak key, the CH32 refuses it")
+    return key
+
+
+def encode_command(seq, op, data, key):
+    """生成一个控制命令数据报."""
+    body = struct.pack("<2sBIBB", b"CM", CTRL_VERSION, seq & 0xFFFFFFFF, op, len(data)) + bytes(data)
+    return body + struct.pack("<Q", siphash24(key, body))
+
+
+def decode_ack(data, key):
+    """校验并解码应答, 返回 (seq, status), 非法应答返回 None."""
+    if len(data) != 16 or data[:3] != b"CA" + bytes([CTRL_VERSION]):
+        return None
+    if struct.unpack_from("<Q", data, 8)[0] != siphash24(key, data[:8]):
+        return None
+    seq, status = struct.unpack_from("<IB", data, 3)
+    return seq, status
+
+
+def send_command(host, key, op, data=b""):
+    """
+    向CH32发送一条命令并等待应答, 超时重传 (重传帧SEQ不变, CH32只执行一次).
+    SEQ以0.1秒为单位的时间生成, 跨本程序重启单调递增. CH32复位后, 复位前
+    3.2秒内 (CTRL_SEQ_RESERVE) 的SEQ会被当作重放拒绝.
+    """
+    seq = int(time.time() * 10) & 0xFFFFFFFF
+    pkt = encode_command(seq, op, data, key)
+    with socket.socket(socket.AF_INET, socket.SOCK_DGRAM) as s:
+        s.settimeout(CTRL_ACK_TIMEOUT_S)
+        for _ in range(CTRL_RETRIES + 1):
+            s.sendto(pkt, (host, CTRL_PORT))
+            try:
+                while True:
+                    ack = decode_ack(s.recv(64), key)
+                    if ack is not None and ack[0] == seq:
+                        return CTRL_ACK_STATUS.get(ack[1], str(ack[1]))
+            except socket.timeout:
+                continue
+    return None
+
+
+def open_db(path):
+    """打开遥测数据库, 每条采样一行."""
+    db = sqlite3.connect(path)
+    db.execute("""CREATE TABLE IF NOT EXISTS samples (
+                      host TEXT, recv_time REAL, sample_seq INTEGER, time_ms INTEGER,
+                      temp INTEGER, humi INTEGER, light INTEGER, state INTEGER, dht_age_s INTEGER)""")
+    return db
+
+
+def state_text(state):
+    names = [("PIR", STATE_PIR), ("SMOKE", STATE_SMOKE), ("ALARM", STATE_ALARM)]
+    return ",".join(name for name, bit in names if state & bit) or "-"
+
+
+if __name__ == "__main__" and len(sys.argv) >= 4 and sys.argv[1] == "send":
+    # 用法: CTRL_KEY=<32位十六进制> python udp_server.py send <CH32 IP> <LED2ON|LED2OFF|UNLOCK|DENY|COLLECT|文本命令>
+    try:
+        key = load_ctrl_key()
+    except ValueError as e:
+        sys.exit(f"Refusing to send: {e}")
+    name = sys.argv[3]
+    if name in CTRL_OPS:
+        result = send_command(sys.argv[2], key, CTRL_OPS[name])
+    else:
+        result = send_command(sys.argv[2], key, 0x20, name.encode())  # LINK_OP_TEXT
+    print(f"{name}: {result or 'no ack'}")
+
+elif __name__ == "__main__":
+    # 1. 创建UDP socket对象
+    #    AF_INET 表示使用 IPv4 地址族
+    #    SOCK_DGRAM 表示使用 UDP 协议
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+
+    # 2. 绑定IP地址和端口号
+    #    服务器需要绑定到一个固定的IP和端口，以便客户端知道向哪里发送数据
+    server_address = (LISTEN_IP, LISTEN_PORT)
+    print(f"UDP server starting up on {LISTEN_IP} port {LISTEN_PORT}")
+    try:
+        sock.bind(server_address)
+    except socket.error as e:
+        print(f"Error binding to socket: {e}")
+        print("Please ensure no other application is using this IP/Port and you have permissions.")
+        exit()
+
+    db = open_db(DB_PATH)
+    last_seq = {}  # 每个发送方的上一个数据报序号, 用于统计丢包
+    print("Waiting to receive messages...")
+
+    try:
+        # 3. 循环接收数据
+        while True:
+            # recvfrom() 会阻塞程序执行，直到接收到数据
+            # 它返回两个值：data (接收到的字节数据) 和 address (发送方的IP和端口)
+            data, address = sock.recvfrom(4096)  # 4096是缓冲区大小，可以根据需要调整
+            host = address[0]
+
+            try:
+                decoded = decode_telemetry(data)
+            except ValueError as e:
+                print(f"\nBad telemetry from {address}: {e}. Raw data (hex): {data.hex()}")
+                continue
+
+            if decoded is not None:
+                header, samples = decoded
+                prev = last_seq.get(host)
+                if prev is not None and header["seq"] != (prev + 1) & 0xFFFF:
+                    print(f"\nTelemetry gap from {host}: seq {prev} -> {header['seq']}")
+                last_seq[host] = header["seq"]
+
+                # 一个数据报一次事务, 批量写入
+                recv_time = time.time()
+                with db:
+                    db.executemany("INSERT INTO samples VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?)",
+                                   [(host, recv_time) + s for s in samples])
+
+                last = samples[-1]
+                event = " EVENT" if header["flags"] & TELEM_FLAG_EVENT else ""
+                dht = f"Temp: {last[2]}C, Humi: {last[3]}%" if last[5] & STATE_DHT_VALID else "DHT11 offline"
+                print(f"\nTelemetry{event} seq {header['seq']} from {host}: {len(samples)} samples, "
+                      f"{dht}, Light: {last[4]}, State: {state_text(last[5])}")
+                continue
+
+            print(f"\nReceived {len(data)} bytes from {address}")
+
+            # 尝试将接收到的字节数据解码为UTF-8字符串
+            # 调度统计等文本消息仍以格式化字符串发送
+            try:
+                message = data.decode('utf-8')
+                print(f"Data: {message}")
+            except UnicodeDecodeError:
+                print(f"Could not decode data as UTF-8. Raw data (hex): {data.hex()}")
+
+    except KeyboardInterrupt:
+        print("\nUDP server is shutting down (KeyboardInterrupt).")
+    except Exception as e:
+        print(f"\nAn error occurred: {e}")
+    finally:
+        # 4. 关闭socket
+        print("Closing socket.")
+        sock.close()
+        db.close()